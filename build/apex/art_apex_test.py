@@ -724,6 +724,7 @@ class TestingTargetChecker:
     self._checker.check_art_test_data('art-gtest-jars-ExceptionHandle.jar')
     self._checker.check_art_test_data('art-gtest-jars-ImageLayoutB.jar')
     self._checker.check_art_test_data('art-gtest-jars-Interfaces.jar')
+    self._checker.check_art_test_data('art-gtest-jars-LinkHierarchy.jar')
     self._checker.check_art_test_data('art-gtest-jars-IMTB.jar')
     self._checker.check_art_test_data('art-gtest-jars-Extension2.jar')
     self._checker.check_art_test_data('art-gtest-jars-Extension1.jar')
@@ -42,7 +42,8 @@ namespace art {
         lhs.min_methods_to_save_ == rhs.min_methods_to_save_ &&
         lhs.min_classes_to_save_ == rhs.min_classes_to_save_ &&
         lhs.min_notification_before_wake_ == rhs.min_notification_before_wake_ &&
-        lhs.max_notification_before_wake_ == rhs.max_notification_before_wake_;
+        lhs.max_notification_before_wake_ == rhs.max_notification_before_wake_ &&
+        lhs.jit_warmup_cache_ == rhs.jit_warmup_cache_;
   }
 
   bool UsuallyEquals(double expected, double actual) {
@@ -487,7 +488,10 @@ TEST_F(CmdlineParserTest, TestJitOptions) {
 * -Xps-*
 */
 TEST_F(CmdlineParserTest, ProfileSaverOptions) {
-  ProfileSaverOptions opt = ProfileSaverOptions(true, 1, 2, 3, 4, 5, 6, 7, 8, "abc", true);
+  ProfileSaverOptions opt = ProfileSaverOptions(true, 1, 2, 3, 4, 5, 6, 7, 8, "abc", true,
+                                                /*profile_aot_code=*/ false,
+                                                /*wait_for_jit_notifications_to_save=*/ true,
+                                                /*jit_warmup_cache=*/ true);
 
   EXPECT_SINGLE_PARSE_VALUE(opt,
                             "-Xjitsaveprofilinginfo "
@@ -500,7 +504,8 @@ TEST_F(CmdlineParserTest, ProfileSaverOptions) {
                             "-Xps-min-notification-before-wake:7 "
                             "-Xps-max-notification-before-wake:8 "
                             "-Xps-profile-path:abc "
-                            "-Xps-profile-boot-class-path",
+                            "-Xps-profile-boot-class-path "
+                            "-Xps-jit-warmup-cache",
                             M::ProfileSaverOpts);
 }  // TEST_F
 
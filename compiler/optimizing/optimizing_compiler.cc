@@ -1266,6 +1266,7 @@ bool OptimizingCompiler::JitCompile(Thread* self,
                              stack_map.size(),
                              /* number_of_roots= */ 0,
                              method,
+                             compilation_kind,
                              /*out*/ &reserved_code,
                              /*out*/ &reserved_data)) {
       MaybeRecordStat(compilation_stats_.get(), MethodCompilationStat::kJitOutOfMemoryForCommit);
@@ -1365,6 +1366,7 @@ bool OptimizingCompiler::JitCompile(Thread* self,
                            stack_map.size(),
                            /*number_of_roots=*/codegen->GetNumberOfJitRoots(),
                            method,
+                           compilation_kind,
                            /*out*/ &reserved_code,
                            /*out*/ &reserved_data)) {
     MaybeRecordStat(compilation_stats_.get(), MethodCompilationStat::kJitOutOfMemoryForCommit);
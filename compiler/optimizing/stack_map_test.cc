@@ -20,6 +20,8 @@
 #include "base/arena_bit_vector.h"
 #include "base/macros.h"
 #include "base/malloc_arena_pool.h"
+#include "code_info_cache.h"
+#include "oat_quick_method_header.h"
 #include "stack_map_stream.h"
 
 #include "gtest/gtest.h"
@@ -725,4 +727,93 @@ TEST(StackMapTest, TestDeduplicateStackMask) {
             stack_map2.GetStackMaskIndex());
 }
 
+// Compiled code is laid out as CodeInfo, method header, code. Place each test method in its own
+// slot of a buffer so that the headers are `kCacheSetStride` apart and map to the same set of
+// the CodeInfoCache.
+static constexpr size_t kCacheSetStride = CodeInfoCache::kNumSets * 64u;
+
+static OatQuickMethodHeader* PlaceTestMethod(uint8_t* slot, uint32_t dex_pc) {
+  MallocArenaPool pool;
+  ArenaStack arena_stack(&pool);
+  ScopedArenaAllocator allocator(&arena_stack);
+  StackMapStream stream(&allocator, kRuntimeISA);
+  stream.BeginMethod(32, 0, 0, 0);
+  stream.BeginStackMapEntry(dex_pc, 4 * kPcAlign);
+  stream.EndStackMapEntry();
+  stream.BeginStackMapEntry(dex_pc + 1u, 8 * kPcAlign);
+  stream.EndStackMapEntry();
+  stream.EndMethod(16 * kPcAlign);
+  ScopedArenaVector<uint8_t> memory = stream.Encode();
+
+  size_t header_offset = kCacheSetStride / 2u;
+  CHECK_LE(memory.size(), header_offset);
+  std::copy(memory.begin(), memory.end(), slot);
+  OatQuickMethodHeader* header = new (slot + header_offset) OatQuickMethodHeader();
+  header->SetCodeInfoOffset(dchecked_integral_cast<uint32_t>(header->GetCode() - slot));
+  return header;
+}
+
+TEST(StackMapTest, CodeInfoCacheLookup) {
+  std::vector<uint8_t> buffer(2u * kCacheSetStride);
+  uint8_t* base = AlignUp(buffer.data(), kCacheSetStride);
+  OatQuickMethodHeader* header = PlaceTestMethod(base, 10u);
+
+  CodeInfoCache cache;
+  EXPECT_FALSE(cache.IsCached(header));
+  const CodeInfo& code_info = cache.GetCodeInfo(header);
+  EXPECT_TRUE(cache.IsCached(header));
+  ASSERT_EQ(2u, code_info.GetNumberOfStackMaps());
+  EXPECT_EQ(10u, code_info.GetStackMapAt(0).GetDexPc());
+
+  for (uint32_t pc = 0; pc != 16 * kPcAlign; ++pc) {
+    uint32_t expected = CodeInfo(header).GetStackMapForNativePcOffset(pc).Row();
+    EXPECT_EQ(expected, cache.GetStackMapIndex(header, pc)) << pc;
+  }
+  EXPECT_EQ(0u, cache.GetStackMapIndex(header, 4 * kPcAlign));
+  EXPECT_EQ(1u, cache.GetStackMapIndex(header, 8 * kPcAlign));
+  EXPECT_EQ(StackMap::kNoValue, cache.GetStackMapIndex(header, 12 * kPcAlign));
+}
+
+TEST(StackMapTest, CodeInfoCacheEvictsLeastRecentlyUsed) {
+  static constexpr size_t kNumMethods = CodeInfoCache::kNumWays + 1u;
+  std::vector<uint8_t> buffer((kNumMethods + 1u) * kCacheSetStride);
+  uint8_t* base = AlignUp(buffer.data(), kCacheSetStride);
+  std::vector<OatQuickMethodHeader*> headers;
+  for (size_t i = 0; i != kNumMethods; ++i) {
+    headers.push_back(PlaceTestMethod(base + i * kCacheSetStride, 10u * i));
+  }
+
+  CodeInfoCache cache;
+  // Fill the set, then use the first method again so that the second one is the LRU entry.
+  for (size_t i = 0; i != CodeInfoCache::kNumWays; ++i) {
+    cache.GetCodeInfo(headers[i]);
+  }
+  cache.GetCodeInfo(headers[0]);
+  EXPECT_EQ(10u * (kNumMethods - 1u),
+            cache.GetCodeInfo(headers[kNumMethods - 1u]).GetStackMapAt(0).GetDexPc());
+  EXPECT_TRUE(cache.IsCached(headers[0]));
+  EXPECT_FALSE(cache.IsCached(headers[1]));
+  EXPECT_TRUE(cache.IsCached(headers[kNumMethods - 1u]));
+  // IsCached() must not count as a use: the first method is now the LRU entry.
+  cache.GetCodeInfo(headers[1]);
+  EXPECT_FALSE(cache.IsCached(headers[0]));
+  EXPECT_TRUE(cache.IsCached(headers[1]));
+  EXPECT_TRUE(cache.IsCached(headers[kNumMethods - 1u]));
+}
+
+TEST(StackMapTest, CodeInfoCacheInvalidateAll) {
+  std::vector<uint8_t> buffer(2u * kCacheSetStride);
+  uint8_t* base = AlignUp(buffer.data(), kCacheSetStride);
+  OatQuickMethodHeader* header = PlaceTestMethod(base, 10u);
+
+  CodeInfoCache cache;
+  EXPECT_EQ(10u, cache.GetCodeInfo(header).GetStackMapAt(0).GetDexPc());
+  // Free the code and reuse its memory for a different method, as the JIT code cache does.
+  CodeInfoCache::InvalidateAll();
+  EXPECT_FALSE(cache.IsCached(header));
+  header = PlaceTestMethod(base, 20u);
+  EXPECT_EQ(20u, cache.GetCodeInfo(header).GetStackMapAt(0).GetDexPc());
+  EXPECT_EQ(0u, cache.GetStackMapIndex(header, 4 * kPcAlign));
+}
+
 }  // namespace art
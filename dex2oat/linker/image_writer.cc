@@ -3002,9 +3002,17 @@ void ImageWriter::CopyAndFixupImTable(ImTable* orig, ImTable* copy) {
 }
 
 void ImageWriter::CopyAndFixupImtConflictTable(ImtConflictTable* orig, ImtConflictTable* copy) {
-  const size_t count = orig->NumEntries(target_ptr_size_);
-  for (size_t i = 0; i < count; ++i) {
+  // The entries are copied to the same slots, so the copy, created for the same number of
+  // entries, must have the same layout.
+  const size_t num_slots = orig->NumSlots(target_ptr_size_);
+  CHECK_EQ(orig->ComputeSize(target_ptr_size_),
+           ImtConflictTable::ComputeSize(orig->NumEntries(target_ptr_size_), target_ptr_size_));
+  for (size_t i = 0; i < num_slots; ++i) {
     ArtMethod* interface_method = orig->GetInterfaceMethod(i, target_ptr_size_);
+    if (interface_method == nullptr) {
+      // Empty slot of a hashed table.
+      continue;
+    }
     ArtMethod* implementation_method = orig->GetImplementationMethod(i, target_ptr_size_);
     CopyAndFixupPointer(copy->AddressOfInterfaceMethod(i, target_ptr_size_), interface_method);
     CopyAndFixupPointer(
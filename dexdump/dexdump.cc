@@ -36,12 +36,15 @@
 
 #include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
 
+#include <atomic>
 #include <cctype>
 #include <iomanip>
 #include <memory>
 #include <sstream>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 #include "android-base/file.h"
@@ -66,9 +69,11 @@ namespace art {
 struct Options gOptions;
 
 /*
- * Output file. Defaults to stdout.
+ * Output file. Set to stdout or the -o file by the main driver. Threads
+ * processing dex files in parallel write to their own output buffer.
+ * Constant-initialized, so that accesses do not go through a TLS wrapper.
  */
-FILE* gOutFile = stdout;
+thread_local FILE* gOutFile = nullptr;
 
 /*
  * Data types that match the definitions in the VM specification.
@@ -1944,6 +1949,55 @@ static void processDexFile(const char* fileName,
   }
 }
 
+#ifndef _WIN32  // No open_memstream().
+/*
+ * Processes all dex files of a multi-dex file on up to gOptions.numThreads
+ * threads. Each dex file is dumped into its own memory buffer and the buffers
+ * are written out in order, so the output is the same as when processing the
+ * dex files one after the other.
+ */
+static bool processDexFilesInParallel(
+    const char* fileName, const std::vector<std::unique_ptr<const DexFile>>& dex_files) {
+  const size_t n = dex_files.size();
+  std::vector<char*> buffers(n, nullptr);
+  std::vector<size_t> sizes(n, 0u);
+  std::atomic<size_t> next_index(0u);
+  std::atomic<bool> failed(false);
+  auto worker = [&]() {
+    for (size_t i = next_index++; i < n && !failed.load(); i = next_index++) {
+      FILE* out = open_memstream(&buffers[i], &sizes[i]);
+      if (out == nullptr) {
+        PLOG(ERROR) << "Can't open output buffer";
+        failed.store(true);
+        break;
+      }
+      gOutFile = out;
+      processDexFile(fileName, dex_files[i].get(), i, n);
+      fclose(out);
+    }
+  };
+  FILE* outFile = gOutFile;
+  std::vector<std::thread> threads;
+  for (int t = 1; t < gOptions.numThreads && static_cast<size_t>(t) < n; t++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  gOutFile = outFile;
+
+  // Write the buffers in order.
+  for (size_t i = 0; i < n; i++) {
+    if (!failed.load()) {
+      fwrite(buffers[i], 1, sizes[i], gOutFile);
+    }
+    free(buffers[i]);
+  }
+  return !failed.load();
+}
+#endif  // !_WIN32
+
 /*
  * Processes a single file (either direct .dex or indirect .zip/.jar/.apk).
  */
@@ -1990,8 +2044,19 @@ int processFile(const char* fileName) {
       fprintf(gOutFile, "<api>\n");
     }
 
-    for (size_t i = 0, n = dex_files.size(); i < n; i++) {
-      processDexFile(fileName, dex_files[i].get(), i, n);
+    bool processed = false;
+#ifndef _WIN32
+    if (gOptions.numThreads > 1 && dex_files.size() > 1) {
+      if (!processDexFilesInParallel(fileName, dex_files)) {
+        return -1;
+      }
+      processed = true;
+    }
+#endif
+    if (!processed) {
+      for (size_t i = 0, n = dex_files.size(); i < n; i++) {
+        processDexFile(fileName, dex_files[i].get(), i, n);
+      }
     }
 
     // Close XML context.
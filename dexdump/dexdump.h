@@ -49,13 +49,14 @@ struct Options {
   bool showSectionHeaders;
   bool showDebugInfo;
   bool verbose;
+  int numThreads;
   OutputFormat outputFormat;
   const char* outputFileName;
 };
 
 /* Prototypes. */
 extern struct Options gOptions;
-extern FILE* gOutFile;
+extern thread_local FILE* gOutFile;
 int processFile(const char* fileName);
 
 }  // namespace art
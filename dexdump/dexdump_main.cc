@@ -25,6 +25,7 @@
 #include "dexdump.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
@@ -40,7 +41,7 @@ static const char* gProgName = "dexdump";
 static void usage() {
   LOG(ERROR) << "Copyright (C) 2007 The Android Open Source Project\n";
   LOG(ERROR) << gProgName << ": [-a] [-c] [-d] [-e] [-f] [-h] [-i] [-j] [-l layout] [-n]"
-                  "  [-o outfile] dexfile...\n";
+                  "  [-o outfile] [-t threads] dexfile...\n";
   LOG(ERROR) << " -a : display annotations";
   LOG(ERROR) << " -c : verify checksum and exit";
   LOG(ERROR) << " -d : disassemble code sections";
@@ -53,6 +54,8 @@ static void usage() {
   LOG(ERROR) << " -l : output layout, either 'plain' or 'xml'";
   LOG(ERROR) << " -n : don't display debug information";
   LOG(ERROR) << " -o : output file name (defaults to stdout)";
+  LOG(ERROR) << " -t : number of threads for processing the dex files of a multi-dex file"
+                " (defaults to 1)";
 }
 
 /*
@@ -64,10 +67,11 @@ int dexdumpDriver(int argc, char** argv) {
   memset(&gOptions, 0, sizeof(gOptions));
   gOptions.verbose = true;
   gOptions.showDebugInfo = true;
+  gOptions.numThreads = 1;
 
   // Parse all arguments.
   while (true) {
-    const int ic = getopt(argc, argv, "acdefghijl:no:");
+    const int ic = getopt(argc, argv, "acdefghijl:no:t:");
     if (ic < 0) {
       break;  // done
     }
@@ -115,6 +119,12 @@ int dexdumpDriver(int argc, char** argv) {
       case 'o':  // output file
         gOptions.outputFileName = optarg;
         break;
+      case 't':  // number of threads
+        gOptions.numThreads = atoi(optarg);
+        if (gOptions.numThreads < 1) {
+          wantUsage = true;
+        }
+        break;
       default:
         wantUsage = true;
         break;
@@ -136,6 +146,7 @@ int dexdumpDriver(int argc, char** argv) {
   }
 
   // Open alternative output file.
+  gOutFile = stdout;
   if (gOptions.outputFileName) {
     gOutFile = fopen(gOptions.outputFileName, "w");
     if (!gOutFile) {
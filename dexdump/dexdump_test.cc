@@ -21,6 +21,8 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "android-base/file.h"
+
 #include "arch/instruction_set.h"
 #include "base/os.h"
 #include "base/utils.h"
@@ -77,4 +79,22 @@ TEST_F(DexDumpTest, XMLOutput) {
     dex_file_}, &error_msg)) << error_msg;
 }
 
+TEST_F(DexDumpTest, ParallelOutput) {
+  // Processing the dex files of a multi-dex file in parallel must not change the output.
+  std::string multidex = GetTestDexFileName("MultiDex");
+  ASSERT_GT(OpenTestDexFiles("MultiDex").size(), 1u);
+  ScratchFile sequential;
+  ScratchFile parallel;
+  std::string error_msg;
+  ASSERT_TRUE(Exec({"-d", "-o", sequential.GetFilename(), multidex}, &error_msg)) << error_msg;
+  ASSERT_TRUE(Exec({"-d", "-t", "4", "-o", parallel.GetFilename(), multidex}, &error_msg))
+      << error_msg;
+  std::string sequential_output;
+  std::string parallel_output;
+  ASSERT_TRUE(android::base::ReadFileToString(sequential.GetFilename(), &sequential_output));
+  ASSERT_TRUE(android::base::ReadFileToString(parallel.GetFilename(), &parallel_output));
+  EXPECT_FALSE(sequential_output.empty());
+  EXPECT_EQ(sequential_output, parallel_output);
+}
+
 }  // namespace art
@@ -871,23 +871,33 @@ bool DexWriter::Write(DexContainer* output, std::string* error_msg) {
   // Reserve code item space since we need the debug offsets to actually write them.
   const uint32_t code_items_offset = stream->Tell();
   WriteCodeItems(stream, /*reserve_only=*/ true);
-  // Write debug info section.
-  WriteDebugInfoItems(stream);
-  {
-    // Actually write code items since debug info offsets are calculated now.
-    Stream::ScopedSeek seek(stream, code_items_offset);
-    WriteCodeItems(stream, /*reserve_only=*/ false);
-  }
 
   WriteEncodedArrays(stream);
+  WriteTypeLists(stream);
+  WriteClassDatas(stream);
+  WriteStringDatas(stream);
+
+  // Pack the metadata that is rarely accessed at runtime in a contiguous region at the end of the
+  // data section, so that it does not share pages with the data needed for startup.
+  const uint32_t cold_metadata_offset = stream->Tell();
+  WriteDebugInfoItems(stream);
   WriteAnnotations(stream);
   WriteAnnotationSets(stream);
   WriteAnnotationSetRefs(stream);
   WriteAnnotationsDirectories(stream);
-  WriteTypeLists(stream);
-  WriteClassDatas(stream);
-  WriteStringDatas(stream);
   WriteHiddenapiClassData(stream);
+  if (compute_offsets_ && dex_layout_ != nullptr) {
+    dex_layout_->GetSections().sections_[static_cast<size_t>(
+        DexLayoutSections::SectionType::kSectionTypeColdMetadata)].parts_[static_cast<size_t>(
+            LayoutType::kLayoutTypeSometimesUsed)].CombineSection(cold_metadata_offset,
+                                                                  stream->Tell());
+  }
+
+  {
+    // Actually write code items since debug info offsets are calculated now.
+    Stream::ScopedSeek seek(stream, code_items_offset);
+    WriteCodeItems(stream, /*reserve_only=*/ false);
+  }
 
   // Write delayed id sections that depend on data sections.
   {
@@ -1803,6 +1803,8 @@ void DexLayout::LayoutCodeItems(const DexFile* dex_file) {
 
   std::unordered_map<dex_ir::CodeItem*, LayoutType>& code_item_layout =
       layout_hotness_info_.code_item_layout_;
+  // CPU sample counts of the sampled code items, used to order code items of the same layout type.
+  std::unordered_map<dex_ir::CodeItem*, uint32_t> code_item_sample_counts;
 
   // Assign hotness flags to all code items.
   for (InvokeType invoke_type : invoke_types) {
@@ -1848,6 +1850,11 @@ void DexLayout::LayoutCodeItems(const DexFile* dex_file) {
           // Already exists, merge the hotness.
           layout_type = MergeLayoutType(layout_type, state);
         }
+        if (hotness.GetSampleCount() != 0u) {
+          // Code items may be shared by several methods, keep the highest sample count.
+          uint32_t& sample_count = code_item_sample_counts[code_item];
+          sample_count = std::max(sample_count, hotness.GetSampleCount());
+        }
       }
     }
   }
@@ -1865,8 +1872,13 @@ void DexLayout::LayoutCodeItems(const DexFile* dex_file) {
     }
   }
 
-  // Sort the code items vector by new layout. The writing process will take care of calculating
-  // all the offsets. Stable sort to preserve any existing locality that might be there.
+  // Sort the code items vector by new layout and, within the same layout type, put the code items
+  // with the most CPU samples first. The writing process will take care of calculating all the
+  // offsets. Stable sort to preserve any existing locality that might be there.
+  auto get_sample_count = [&](dex_ir::CodeItem* code_item) {
+    auto it = code_item_sample_counts.find(code_item);
+    return (it != code_item_sample_counts.end()) ? it->second : 0u;
+  };
   std::stable_sort(code_items.begin(),
                    code_items.end(),
                    [&](const std::unique_ptr<dex_ir::CodeItem>& a,
@@ -1877,7 +1889,10 @@ void DexLayout::LayoutCodeItems(const DexFile* dex_file) {
     DCHECK(it_b != code_item_layout.end());
     const LayoutType layout_type_a = it_a->second;
     const LayoutType layout_type_b = it_b->second;
-    return layout_type_a < layout_type_b;
+    if (layout_type_a != layout_type_b) {
+      return layout_type_a < layout_type_b;
+    }
+    return get_sample_count(a.get()) > get_sample_count(b.get());
   });
 }
 
@@ -828,4 +828,81 @@ TEST_F(DexLayoutTest, ClassFilter) {
   }
 }
 
+TEST_F(DexLayoutTest, ColdMetadataSection) {
+  std::vector<std::unique_ptr<const DexFile>> dex_files;
+  std::string error_msg;
+  const ArtDexFileLoader dex_file_loader;
+  const std::string input_jar = GetTestDexFileName("ManyMethods");
+  CHECK(dex_file_loader.Open(input_jar.c_str(),
+                             input_jar.c_str(),
+                             /*verify=*/ true,
+                             /*verify_checksum=*/ true,
+                             &error_msg,
+                             &dex_files)) << error_msg;
+  ASSERT_EQ(dex_files.size(), 1u);
+  for (const std::unique_ptr<const DexFile>& dex_file : dex_files) {
+    Options options;
+    DexLayout dexlayout(options,
+                        /*info=*/ nullptr,
+                        /*out_file=*/ nullptr,
+                        /*header=*/ nullptr);
+    std::unique_ptr<DexContainer> out;
+    bool result = dexlayout.ProcessDexFile(
+        dex_file->GetLocation().c_str(),
+        dex_file.get(),
+        /*dex_file_index=*/ 0,
+        &out,
+        &error_msg);
+    ASSERT_TRUE(result) << "Failed to run dexlayout " << error_msg;
+    auto container = std::make_unique<DexLoaderContainer>(out->GetMainSection()->Begin(),
+                                                          out->GetMainSection()->End(),
+                                                          out->GetDataSection()->Begin(),
+                                                          out->GetDataSection()->End());
+    std::unique_ptr<const DexFile> output_dex_file(
+        dex_file_loader.Open(std::move(container),
+                             dex_file->GetLocation().c_str(),
+                             /* location_checksum= */ 0,
+                             /*oat_dex_file=*/nullptr,
+                             /* verify= */ true,
+                             /*verify_checksum=*/false,
+                             &error_msg));
+    ASSERT_TRUE(output_dex_file != nullptr) << error_msg;
+
+    const DexLayoutSection::Subsection& cold_metadata =
+        dexlayout.GetSections().sections_[static_cast<size_t>(
+            DexLayoutSections::SectionType::kSectionTypeColdMetadata)].parts_[static_cast<size_t>(
+                LayoutType::kLayoutTypeSometimesUsed)];
+    ASSERT_LT(cold_metadata.start_offset_, cold_metadata.end_offset_);
+    ASSERT_LE(cold_metadata.end_offset_, output_dex_file->DataSize());
+
+    // Debug info and annotations are in the cold metadata section, the data needed to run code is
+    // before it.
+    size_t num_cold_items = 0u;
+    const dex::MapList* map = output_dex_file->GetMapList();
+    for (uint32_t i = 0; i < map->size_; ++i) {
+      const dex::MapItem& item = map->list_[i];
+      switch (item.type_) {
+        case DexFile::kDexTypeDebugInfoItem:
+        case DexFile::kDexTypeAnnotationItem:
+        case DexFile::kDexTypeAnnotationSetItem:
+        case DexFile::kDexTypeAnnotationSetRefList:
+        case DexFile::kDexTypeAnnotationsDirectoryItem:
+        case DexFile::kDexTypeHiddenapiClassData:
+          EXPECT_TRUE(cold_metadata.Contains(item.offset_)) << item.type_;
+          ++num_cold_items;
+          break;
+        case DexFile::kDexTypeCodeItem:
+        case DexFile::kDexTypeClassDataItem:
+        case DexFile::kDexTypeStringDataItem:
+        case DexFile::kDexTypeTypeList:
+          EXPECT_LT(item.offset_, cold_metadata.start_offset_) << item.type_;
+          break;
+        default:
+          break;
+      }
+    }
+    EXPECT_NE(num_cold_items, 0u);
+  }
+}
+
 }  // namespace art
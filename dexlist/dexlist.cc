@@ -27,6 +27,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <atomic>
+#include <thread>
+
 #include <android-base/file.h>
 #include <android-base/logging.h>
 
@@ -45,12 +48,15 @@ static struct {
   const char* classToFind;
   const char* methodToFind;
   const char* outputFileName;
+  int numThreads;
 } gOptions;
 
 /*
- * Output file. Defaults to stdout.
+ * Output file. Set to stdout or the -o file by the main driver. Threads
+ * processing dex files in parallel write to their own output buffer.
+ * Constant-initialized, so that accesses do not go through a TLS wrapper.
  */
-static FILE* gOutFile = stdout;
+static thread_local FILE* gOutFile = nullptr;
 
 /*
  * Data types that match the definitions in the VM specification.
@@ -120,14 +126,12 @@ static void dumpMethod(const DexFile* pDexFile,
 
   // Method signature.
   const Signature signature = pDexFile->GetMethodSignature(pMethodId);
-  char* typeDesc = strdup(signature.ToString().c_str());
+  const std::string typeDesc = signature.ToString();
 
   // Dump actual method information.
   fprintf(gOutFile, "0x%08x %d %s %s %s %s %d\n",
           insnsOff, accessor.InsnsSizeInCodeUnits() * 2,
-          className.get(), methodName, typeDesc, fileName, first_line);
-
-  free(typeDesc);
+          className.get(), methodName, typeDesc.c_str(), fileName, first_line);
 }
 
 /*
@@ -152,6 +156,65 @@ void dumpClass(const DexFile* pDexFile, u4 idx) {
   }
 }
 
+/*
+ * Runs through all classes in one dex file.
+ */
+static void processDexFile(const DexFile* pDexFile) {
+  const u4 classDefsSize = pDexFile->GetHeader().class_defs_size_;
+  for (u4 idx = 0; idx < classDefsSize; idx++) {
+    dumpClass(pDexFile, idx);
+  }
+}
+
+#ifndef _WIN32  // No open_memstream().
+/*
+ * Processes all dex files of a multi-dex file on up to gOptions.numThreads
+ * threads. Each dex file is listed into its own memory buffer and the buffers
+ * are written out in order, so the output is the same as when processing the
+ * dex files one after the other.
+ */
+static bool processDexFilesInParallel(
+    const std::vector<std::unique_ptr<const DexFile>>& dex_files) {
+  const size_t n = dex_files.size();
+  std::vector<char*> buffers(n, nullptr);
+  std::vector<size_t> sizes(n, 0u);
+  std::atomic<size_t> next_index(0u);
+  std::atomic<bool> failed(false);
+  auto worker = [&]() {
+    for (size_t i = next_index++; i < n && !failed.load(); i = next_index++) {
+      FILE* out = open_memstream(&buffers[i], &sizes[i]);
+      if (out == nullptr) {
+        PLOG(ERROR) << "Can't open output buffer";
+        failed.store(true);
+        break;
+      }
+      gOutFile = out;
+      processDexFile(dex_files[i].get());
+      fclose(out);
+    }
+  };
+  FILE* outFile = gOutFile;
+  std::vector<std::thread> threads;
+  for (int t = 1; t < gOptions.numThreads && static_cast<size_t>(t) < n; t++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  gOutFile = outFile;
+
+  // Write the buffers in order.
+  for (size_t i = 0; i < n; i++) {
+    if (!failed.load()) {
+      fwrite(buffers[i], 1, sizes[i], gOutFile);
+    }
+    free(buffers[i]);
+  }
+  return !failed.load();
+}
+#endif  // !_WIN32
+
 /*
  * Processes a single file (either direct .dex or indirect .zip/.jar/.apk).
  */
@@ -183,13 +246,13 @@ static int processFile(const char* fileName) {
 
   // Success. Iterate over all dex files found in given file.
   fprintf(gOutFile, "#%s\n", fileName);
+#ifndef _WIN32
+  if (gOptions.numThreads > 1 && dex_files.size() > 1) {
+    return processDexFilesInParallel(dex_files) ? 0 : -1;
+  }
+#endif
   for (size_t i = 0; i < dex_files.size(); i++) {
-    // Iterate over all classes in one dex file.
-    const DexFile* pDexFile = dex_files[i].get();
-    const u4 classDefsSize = pDexFile->GetHeader().class_defs_size_;
-    for (u4 idx = 0; idx < classDefsSize; idx++) {
-      dumpClass(pDexFile, idx);
-    }
+    processDexFile(dex_files[i].get());
   }
   return 0;
 }
@@ -199,7 +262,7 @@ static int processFile(const char* fileName) {
  */
 static void usage() {
   LOG(ERROR) << "Copyright (C) 2007 The Android Open Source Project\n";
-  LOG(ERROR) << gProgName << ": [-m p.c.m] [-o outfile] dexfile...";
+  LOG(ERROR) << gProgName << ": [-m p.c.m] [-o outfile] [-t threads] dexfile...";
   LOG(ERROR) << "";
 }
 
@@ -210,10 +273,11 @@ int dexlistDriver(int argc, char** argv) {
   // Reset options.
   bool wantUsage = false;
   memset(&gOptions, 0, sizeof(gOptions));
+  gOptions.numThreads = 1;
 
   // Parse all arguments.
   while (true) {
-    const int ic = getopt(argc, argv, "o:m:");
+    const int ic = getopt(argc, argv, "o:m:t:");
     if (ic < 0) {
       break;  // done
     }
@@ -238,6 +302,12 @@ int dexlistDriver(int argc, char** argv) {
           }
         }
         break;
+      case 't':  // number of threads
+        gOptions.numThreads = atoi(optarg);
+        if (gOptions.numThreads < 1) {
+          wantUsage = true;
+        }
+        break;
       default:
         wantUsage = true;
         break;
@@ -256,6 +326,7 @@ int dexlistDriver(int argc, char** argv) {
   }
 
   // Open alternative output file.
+  gOutFile = stdout;
   if (gOptions.outputFileName) {
     gOutFile = fopen(gOptions.outputFileName, "we");
     if (!gOutFile) {
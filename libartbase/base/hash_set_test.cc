@@ -27,6 +27,7 @@
 #include <gtest/gtest.h>
 
 #include "hash_map.h"
+#include "swiss_hash_set.h"
 
 namespace art {
 
@@ -488,4 +489,162 @@ TEST_F(HashSetTest, StatefulHashSet) {
   ASSERT_TRUE(search_it == hash_set.end());
 }
 
+TEST_F(HashSetTest, SwissInsertAndErase) {
+  SwissHashSet<std::string, IsEmptyFnString> hash_set;
+  ASSERT_TRUE(hash_set.begin() == hash_set.end());
+  ASSERT_TRUE(hash_set.find(std::string("missing")) == hash_set.end());
+  static constexpr size_t count = 1000;
+  std::vector<std::string> strings;
+  for (size_t i = 0; i < count; ++i) {
+    strings.push_back(RandomString(10));
+    ASSERT_TRUE(hash_set.insert(strings[i]).second);
+    ASSERT_FALSE(hash_set.insert(strings[i]).second);
+    auto it = hash_set.find(strings[i]);
+    ASSERT_TRUE(it != hash_set.end());
+    ASSERT_EQ(*it, strings[i]);
+  }
+  ASSERT_EQ(strings.size(), hash_set.size());
+  ASSERT_EQ(0u, hash_set.Verify());
+  size_t iterated = 0u;
+  for (const std::string& s ATTRIBUTE_UNUSED : hash_set) {
+    ++iterated;
+  }
+  ASSERT_EQ(count, iterated);
+  // Try to erase the odd strings.
+  for (size_t i = 1; i < count; i += 2) {
+    auto it = hash_set.find(strings[i]);
+    ASSERT_TRUE(it != hash_set.end());
+    hash_set.erase(it);
+  }
+  ASSERT_EQ(0u, hash_set.Verify());
+  for (size_t i = 0; i < count; ++i) {
+    auto it = hash_set.find(strings[i]);
+    ASSERT_EQ(i % 2 == 0, it != hash_set.end());
+  }
+}
+
+TEST_F(HashSetTest, SwissStress) {
+  SwissHashSet<std::string, IsEmptyFnString> hash_set;
+  std::unordered_set<std::string> std_set;
+  std::vector<std::string> strings;
+  static constexpr size_t string_count = 2000;
+  static constexpr size_t operations = 100000;
+  static constexpr size_t target_size = 5000;
+  for (size_t i = 0; i < string_count; ++i) {
+    strings.push_back(RandomString(i % 10 + 1));
+  }
+  const size_t seed = time(nullptr);
+  SetSeed(seed);
+  LOG(INFO) << "Starting stress test with seed " << seed;
+  for (size_t i = 0; i < operations; ++i) {
+    ASSERT_EQ(hash_set.size(), std_set.size());
+    size_t delta = std::abs(static_cast<ssize_t>(target_size) -
+                            static_cast<ssize_t>(hash_set.size()));
+    size_t n = PRand();
+    if (n % target_size == 0) {
+      hash_set.clear();
+      std_set.clear();
+    } else  if (n % target_size < delta) {
+      const std::string& s = strings[PRand() % string_count];
+      hash_set.insert(s);
+      std_set.insert(s);
+      ASSERT_EQ(*hash_set.find(s), *std_set.find(s));
+    } else {
+      const std::string& s = strings[PRand() % string_count];
+      auto it1 = hash_set.find(s);
+      auto it2 = std_set.find(s);
+      ASSERT_EQ(it1 == hash_set.end(), it2 == std_set.end());
+      if (it1 != hash_set.end()) {
+        ASSERT_EQ(*it1, *it2);
+        hash_set.erase(it1);
+        std_set.erase(it2);
+      }
+    }
+  }
+  ASSERT_EQ(0u, hash_set.Verify());
+}
+
+// SwissHashSet<> places elements exactly like HashSet<>, so both must serialize to the same
+// bytes and be able to read each other's data.
+TEST_F(HashSetTest, SwissSerializationCompatibility) {
+  HashSet<std::string, IsEmptyFnString> hash_set;
+  SwissHashSet<std::string, IsEmptyFnString> swiss_set;
+  std::vector<std::string> strings;
+  for (size_t i = 0; i < 3000; ++i) {
+    strings.push_back(RandomString(i % 10 + 1));
+    hash_set.insert(strings.back());
+    swiss_set.insert(strings.back());
+  }
+  for (size_t i = 0; i < strings.size(); i += 3) {
+    hash_set.erase(hash_set.find(strings[i]));
+    swiss_set.erase(swiss_set.find(strings[i]));
+  }
+  ASSERT_EQ(hash_set.size(), swiss_set.size());
+  ASSERT_EQ(hash_set.NumBuckets(), swiss_set.NumBuckets());
+  auto begin = hash_set.begin();
+  for (const std::string& s : swiss_set) {
+    ASSERT_EQ(*begin, s);
+    ++begin;
+  }
+  ASSERT_TRUE(begin == hash_set.end());
+
+  // Serialize integers, strings are not trivially copyable.
+  HashSet<uint32_t> int_set;
+  SwissHashSet<uint32_t> swiss_int_set;
+  for (uint32_t i = 1; i != 5000; ++i) {
+    uint32_t value = static_cast<uint32_t>(PRand()) | 1u;  // Avoid the empty value 0.
+    int_set.insert(value);
+    swiss_int_set.insert(value);
+  }
+  size_t size = int_set.WriteToMemory(nullptr);
+  ASSERT_EQ(size, swiss_int_set.WriteToMemory(nullptr));
+  std::vector<uint64_t> data(RoundUp(size, sizeof(uint64_t)) / sizeof(uint64_t));
+  std::vector<uint64_t> swiss_data(data.size());
+  int_set.WriteToMemory(reinterpret_cast<uint8_t*>(data.data()));
+  swiss_int_set.WriteToMemory(reinterpret_cast<uint8_t*>(swiss_data.data()));
+  ASSERT_EQ(data, swiss_data);
+
+  for (bool make_copy_of_data : {false, true}) {
+    size_t read_count = 0u;
+    SwissHashSet<uint32_t> read_set(
+        reinterpret_cast<const uint8_t*>(data.data()), make_copy_of_data, &read_count);
+    ASSERT_EQ(size, read_count);
+    ASSERT_EQ(int_set.size(), read_set.size());
+    ASSERT_EQ(0u, read_set.Verify());
+    for (uint32_t value : int_set) {
+      ASSERT_TRUE(read_set.find(value) != read_set.end());
+    }
+  }
+}
+
+TEST_F(HashSetTest, SwissSmallTable) {
+  // Only deserialization can create a SwissHashSet<> with fewer buckets than a group.
+  static const size_t kBufferSize = 7;
+  uint32_t buffer[kBufferSize];
+  HashSet<uint32_t> hash_set(buffer, kBufferSize);
+  for (uint32_t i = 1; i != 5; ++i) {
+    hash_set.insert(i * 5u);
+  }
+  std::vector<uint64_t> data(RoundUp(hash_set.WriteToMemory(nullptr), 8u) / 8u);
+  hash_set.WriteToMemory(reinterpret_cast<uint8_t*>(data.data()));
+  size_t read_count = 0u;
+  SwissHashSet<uint32_t> swiss_set(
+      reinterpret_cast<const uint8_t*>(data.data()), /*make_copy_of_data=*/ true, &read_count);
+  ASSERT_EQ(kBufferSize, swiss_set.NumBuckets());
+  ASSERT_EQ(0u, swiss_set.Verify());
+  for (uint32_t i = 1; i != 5; ++i) {
+    ASSERT_TRUE(swiss_set.find(i * 5u) != swiss_set.end());
+  }
+  ASSERT_TRUE(swiss_set.find(3u) == swiss_set.end());
+  swiss_set.erase(swiss_set.find(10u));
+  ASSERT_TRUE(swiss_set.find(10u) == swiss_set.end());
+  ASSERT_TRUE(swiss_set.find(15u) != swiss_set.end());
+  ASSERT_EQ(0u, swiss_set.Verify());
+  size_t count = 0u;
+  for (uint32_t value ATTRIBUTE_UNUSED : swiss_set) {
+    ++count;
+  }
+  ASSERT_EQ(3u, count);
+}
+
 }  // namespace art
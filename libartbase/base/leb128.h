@@ -17,6 +17,8 @@
 #ifndef ART_LIBARTBASE_BASE_LEB128_H_
 #define ART_LIBARTBASE_BASE_LEB128_H_
 
+#include <string.h>
+
 #include <vector>
 
 #include <android-base/logging.h>
@@ -102,6 +104,51 @@ static inline bool DecodeUnsignedLeb128Checked(const uint8_t** data,
   return true;
 }
 
+// Skips `count` unsigned LEB128 values, updating the given pointer to point just past the end
+// of the last value exactly like `count` calls to DecodeUnsignedLeb128(). All bytes from the
+// given pointer up to `end` must be readable. Long sequences of values are skipped 8 bytes at
+// a time by counting the bytes without the continuation bit instead of decoding each value.
+static inline void SkipUnsignedLeb128(const uint8_t** data, const uint8_t* end, size_t count) {
+  // For fewer values, the branches of DecodeUnsignedLeb128() are cheaper than counting.
+  static constexpr size_t kMinCountForWordSkip = 32u;
+  static constexpr uint64_t kContinuationBits = UINT64_C(0x8080808080808080);
+  const uint8_t* ptr = *data;
+  if (count >= kMinCountForWordSkip) {
+    while (count != 0u && end - ptr >= static_cast<ptrdiff_t>(sizeof(uint64_t))) {
+      uint64_t word;
+      memcpy(&word, ptr, sizeof(word));
+      uint64_t continuation = word & kContinuationBits;
+      uint64_t stops = continuation ^ kContinuationBits;
+      // DecodeUnsignedLeb128() stops after the fifth byte even if it has the continuation bit,
+      // so take the slow path for a value that could be affected.
+      uint64_t long_runs = continuation & (continuation >> 8) & (continuation >> 16) &
+                           (continuation >> 24) & (continuation >> 32);
+      if (UNLIKELY(long_runs != 0u)) {
+        DecodeUnsignedLeb128(&ptr);
+        --count;
+        continue;
+      }
+      DCHECK_NE(stops, 0u);
+      size_t num_stops = static_cast<size_t>(POPCOUNT(stops));
+      if (num_stops < count) {
+        // Skip all values that end in this word.
+        ptr += (BitSizeOf<uint64_t>() - CLZ(stops)) / kBitsPerByte;
+        count -= num_stops;
+      } else {
+        for (size_t i = 1u; i != count; ++i) {
+          stops &= stops - 1u;  // Clear the lowest stop bit.
+        }
+        ptr += (CTZ(stops) + 1u) / kBitsPerByte;
+        count = 0u;
+      }
+    }
+  }
+  for (; count != 0u; --count) {
+    DecodeUnsignedLeb128(&ptr);
+  }
+  *data = ptr;
+}
+
 // Reads an unsigned LEB128 + 1 value. updating the given pointer to point
 // just past the end of the read value. This function tolerates
 // non-zero high-order bits in the fifth encoded byte.
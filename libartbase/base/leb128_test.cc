@@ -272,6 +272,63 @@ TEST(Leb128Test, UnsignedUpdate) {
   }
 }
 
+TEST(Leb128Test, SkipUnsigned) {
+  // Encode all test values several times, followed by values with garbage in the continuation
+  // bit of the fifth byte that DecodeUnsignedLeb128() tolerates.
+  Leb128EncodingVector<> builder;
+  for (size_t i = 0; i < 8; ++i) {
+    for (size_t j = 0; j < arraysize(uleb128_tests); ++j) {
+      builder.PushBackUnsigned(uleb128_tests[j].decoded);
+    }
+  }
+  std::vector<uint8_t> data = builder.GetData();
+  for (size_t i = 0; i < 4; ++i) {
+    data.insert(data.end(), {0x80, 0x80, 0x80, 0x80, 0x80, 0x01});
+  }
+  const uint8_t* begin = data.data();
+  const uint8_t* end = begin + data.size();
+  size_t num_values = 8 * arraysize(uleb128_tests) + 8;
+  for (size_t start = 0; start != num_values; ++start) {
+    const uint8_t* start_ptr = begin;
+    for (size_t i = 0; i != start; ++i) {
+      DecodeUnsignedLeb128(&start_ptr);
+    }
+    const uint8_t* expected = start_ptr;
+    for (size_t count = 0; start + count <= num_values; ++count) {
+      const uint8_t* skipped = start_ptr;
+      SkipUnsignedLeb128(&skipped, end, count);
+      EXPECT_EQ(expected, skipped) << " start = " << start << " count = " << count;
+      if (start + count != num_values) {
+        DecodeUnsignedLeb128(&expected);
+      }
+    }
+  }
+}
+
+TEST(Leb128Test, SkipLongRuns) {
+  // Encode values resembling field index deltas and access flags in a pseudo-random order and
+  // skip them in chunks of different sizes, so that both the word loop and the scalar path run.
+  static constexpr size_t kNumValues = 64 * 1024;
+  static constexpr uint32_t kValues[] = { 1, 1, 2, 0x19, 0x1a, 0x1012 };
+  Leb128EncodingVector<> builder;
+  for (uint32_t i = 0; i != kNumValues; ++i) {
+    builder.PushBackUnsigned(kValues[((i * 2654435761u) >> 16) % arraysize(kValues)]);
+  }
+  const uint8_t* begin = &builder.GetData()[0];
+  const uint8_t* end = begin + builder.GetData().size();
+  for (size_t count : { 4u, 16u, 31u, 32u, 33u, 64u, 256u }) {
+    const uint8_t* decode_ptr = begin;
+    const uint8_t* skip_ptr = begin;
+    for (size_t i = 0; i != kNumValues / count; ++i) {
+      for (size_t j = 0; j != count; ++j) {
+        DecodeUnsignedLeb128(&decode_ptr);
+      }
+      SkipUnsignedLeb128(&skip_ptr, end, count);
+      ASSERT_EQ(decode_ptr, skip_ptr) << count << " " << i;
+    }
+  }
+}
+
 TEST(Leb128Test, Speed) {
   std::unique_ptr<Histogram<uint64_t>> enc_hist(new Histogram<uint64_t>("Leb128EncodeSpeedTest", 5));
   std::unique_ptr<Histogram<uint64_t>> dec_hist(new Histogram<uint64_t>("Leb128DecodeSpeedTest", 5));
@@ -0,0 +1,873 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_LIBARTBASE_BASE_SWISS_HASH_SET_H_
+#define ART_LIBARTBASE_BASE_SWISS_HASH_SET_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include <android-base/logging.h>
+
+#include "bit_utils.h"
+#include "hash_set.h"
+#include "macros.h"
+
+namespace art {
+
+// Matching of control bytes for a group of SwissHashSet slots. The returned masks have one set
+// bit per matching slot at bit position `slot << kMatchShift`.
+class SwissHashSetGroup {
+ public:
+  static constexpr size_t kGroupSize = 16u;
+
+#if defined(__SSE2__)
+  static constexpr size_t kMatchShift = 0u;
+  static constexpr uint64_t kAllSlots = 0xffffu;
+
+  ALWAYS_INLINE static uint64_t Match(const uint8_t* group, uint8_t ctrl) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    __m128i eq = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(ctrl)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(eq));
+  }
+#elif defined(__aarch64__)
+  static constexpr size_t kMatchShift = 2u;
+  static constexpr uint64_t kAllSlots = UINT64_C(0x8888888888888888);
+
+  ALWAYS_INLINE static uint64_t Match(const uint8_t* group, uint8_t ctrl) {
+    uint8x16_t eq = vceqq_u8(vld1q_u8(group), vdupq_n_u8(ctrl));
+    // Narrow each byte of the comparison result to a nibble and keep one bit per nibble.
+    uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) & kAllSlots;
+  }
+#else
+  static constexpr size_t kMatchShift = 0u;
+  static constexpr uint64_t kAllSlots = 0xffffu;
+
+  ALWAYS_INLINE static uint64_t Match(const uint8_t* group, uint8_t ctrl) {
+    uint64_t result = 0u;
+    for (size_t i = 0; i != kGroupSize; ++i) {
+      result |= static_cast<uint64_t>(group[i] == ctrl) << i;
+    }
+    return result;
+  }
+#endif
+
+  ALWAYS_INLINE static size_t FirstSlot(uint64_t match) {
+    DCHECK_NE(match, 0u);
+    return static_cast<size_t>(CTZ(match)) >> kMatchShift;
+  }
+
+  // Clear all bits for the first match and the slots after it.
+  ALWAYS_INLINE static uint64_t SlotsBefore(uint64_t match) {
+    DCHECK_NE(match, 0u);
+    return (match & -match) - 1u;
+  }
+
+  // Clear the bit for the first match.
+  ALWAYS_INLINE static uint64_t RemoveFirst(uint64_t match) {
+    return match & (match - 1u);
+  }
+};
+
+// Alternative to HashSet<> with a "Swiss table" layout: each slot has a control byte which is
+// either empty or holds 7 bits of the element hash, and lookups compare the control bytes of
+// a group of 16 slots at a time with SIMD instructions. Elements are only compared with `Pred`
+// when their control byte matches, and `EmptyFn` is only used to keep the element array in
+// the same form as HashSet<>.
+//
+// The slot placement is exactly the same as in HashSet<>: probing is linear from the slot
+// `hash % NumBuckets()` (we just check 16 slots at once from that unaligned position) and
+// erase() shifts elements back instead of leaving tombstones. Therefore WriteToMemory() and
+// the read-from-memory constructor use the HashSet<> format and data serialized by one of the
+// two classes can be used by the other. The control bytes are not serialized; they are
+// recalculated from the element hashes when reading, which is the price for the compatibility.
+//
+// The control bytes of the first 15 slots are mirrored after the last slot, so that a group
+// can be loaded from any position without wrap-around checks.
+//
+// Unlike HashSet<>, this class does not support construction with a pre-allocated buffer.
+template <class T,
+          class EmptyFn = DefaultEmptyFn<T>,
+          class HashFn = DefaultHashFn<T>,
+          class Pred = DefaultPred<T>,
+          class Alloc = std::allocator<T>>
+class SwissHashSet {
+ public:
+  using value_type = T;
+  using allocator_type = Alloc;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = HashSetIterator<T, SwissHashSet>;
+  using const_iterator = HashSetIterator<const T, const SwissHashSet>;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+
+  static constexpr double kDefaultMinLoadFactor = 0.4;
+  static constexpr double kDefaultMaxLoadFactor = 0.7;
+  static constexpr size_t kMinBuckets = 1000;
+
+  // If we don't own the data, this will create a new array which owns the data.
+  void clear() {
+    DeallocateStorage();
+    num_elements_ = 0;
+    elements_until_expand_ = 0;
+  }
+
+  SwissHashSet() : SwissHashSet(kDefaultMinLoadFactor, kDefaultMaxLoadFactor) {}
+  explicit SwissHashSet(const allocator_type& alloc) noexcept
+      : SwissHashSet(kDefaultMinLoadFactor, kDefaultMaxLoadFactor, alloc) {}
+
+  SwissHashSet(double min_load_factor, double max_load_factor) noexcept
+      : SwissHashSet(min_load_factor, max_load_factor, allocator_type()) {}
+  SwissHashSet(double min_load_factor,
+               double max_load_factor,
+               const allocator_type& alloc) noexcept
+      : SwissHashSet(min_load_factor, max_load_factor, HashFn(), Pred(), alloc) {}
+
+  SwissHashSet(const HashFn& hashfn,
+               const Pred& pred) noexcept
+      : SwissHashSet(kDefaultMinLoadFactor, kDefaultMaxLoadFactor, hashfn, pred) {}
+  SwissHashSet(const HashFn& hashfn,
+               const Pred& pred,
+               const allocator_type& alloc) noexcept
+      : SwissHashSet(kDefaultMinLoadFactor, kDefaultMaxLoadFactor, hashfn, pred, alloc) {}
+
+  SwissHashSet(double min_load_factor,
+               double max_load_factor,
+               const HashFn& hashfn,
+               const Pred& pred) noexcept
+      : SwissHashSet(min_load_factor, max_load_factor, hashfn, pred, allocator_type()) {}
+  SwissHashSet(double min_load_factor,
+               double max_load_factor,
+               const HashFn& hashfn,
+               const Pred& pred,
+               const allocator_type& alloc) noexcept
+      : allocfn_(alloc),
+        ctrl_allocfn_(alloc),
+        hashfn_(hashfn),
+        emptyfn_(),
+        pred_(pred),
+        num_elements_(0u),
+        num_buckets_(0u),
+        elements_until_expand_(0u),
+        owns_data_(false),
+        data_(nullptr),
+        ctrl_(nullptr),
+        min_load_factor_(min_load_factor),
+        max_load_factor_(max_load_factor) {
+    DCHECK_GT(min_load_factor, 0.0);
+    DCHECK_LT(max_load_factor, 1.0);
+  }
+
+  SwissHashSet(const SwissHashSet& other)
+      : allocfn_(other.allocfn_),
+        ctrl_allocfn_(other.ctrl_allocfn_),
+        hashfn_(other.hashfn_),
+        emptyfn_(other.emptyfn_),
+        pred_(other.pred_),
+        num_elements_(other.num_elements_),
+        num_buckets_(0),
+        elements_until_expand_(other.elements_until_expand_),
+        owns_data_(false),
+        data_(nullptr),
+        ctrl_(nullptr),
+        min_load_factor_(other.min_load_factor_),
+        max_load_factor_(other.max_load_factor_) {
+    AllocateStorage(other.NumBuckets());
+    for (size_t i = 0; i < num_buckets_; ++i) {
+      ElementForIndex(i) = other.data_[i];
+    }
+    if (num_buckets_ != 0u) {
+      memcpy(ctrl_, other.ctrl_, CtrlSize(num_buckets_));
+    }
+  }
+
+  // noexcept required so that the move constructor is used instead of copy constructor.
+  SwissHashSet(SwissHashSet&& other) noexcept
+      : allocfn_(std::move(other.allocfn_)),
+        ctrl_allocfn_(std::move(other.ctrl_allocfn_)),
+        hashfn_(std::move(other.hashfn_)),
+        emptyfn_(std::move(other.emptyfn_)),
+        pred_(std::move(other.pred_)),
+        num_elements_(other.num_elements_),
+        num_buckets_(other.num_buckets_),
+        elements_until_expand_(other.elements_until_expand_),
+        owns_data_(other.owns_data_),
+        data_(other.data_),
+        ctrl_(other.ctrl_),
+        min_load_factor_(other.min_load_factor_),
+        max_load_factor_(other.max_load_factor_) {
+    other.num_elements_ = 0u;
+    other.num_buckets_ = 0u;
+    other.elements_until_expand_ = 0u;
+    other.owns_data_ = false;
+    other.data_ = nullptr;
+    other.ctrl_ = nullptr;
+  }
+
+  // Construct from existing data in the HashSet<> format, see HashSet<>::WriteToMemory().
+  // If make_copy_of_data is false, then data_ points to within the passed in ptr_.
+  // The control bytes are always allocated and computed from the elements.
+  SwissHashSet(const uint8_t* ptr, bool make_copy_of_data, size_t* read_count) noexcept
+      : ctrl_allocfn_(allocfn_), ctrl_(nullptr) {
+    uint64_t temp;
+    size_t offset = 0;
+    offset = ReadFromBytes(ptr, offset, &temp);
+    num_elements_ = static_cast<uint64_t>(temp);
+    offset = ReadFromBytes(ptr, offset, &temp);
+    num_buckets_ = static_cast<uint64_t>(temp);
+    CHECK_LE(num_elements_, num_buckets_);
+    offset = ReadFromBytes(ptr, offset, &temp);
+    elements_until_expand_ = static_cast<uint64_t>(temp);
+    offset = ReadFromBytes(ptr, offset, &min_load_factor_);
+    offset = ReadFromBytes(ptr, offset, &max_load_factor_);
+    if (!make_copy_of_data) {
+      owns_data_ = false;
+      data_ = const_cast<T*>(reinterpret_cast<const T*>(ptr + offset));
+      offset += sizeof(*data_) * num_buckets_;
+      AllocateCtrl(num_buckets_);
+    } else {
+      AllocateStorage(num_buckets_);
+      // Write elements, not that this may not be safe for cross compilation if the elements are
+      // pointer sized.
+      for (size_t i = 0; i < num_buckets_; ++i) {
+        offset = ReadFromBytes(ptr, offset, &data_[i]);
+      }
+    }
+    for (size_t i = 0; i < num_buckets_; ++i) {
+      if (!emptyfn_.IsEmpty(data_[i])) {
+        SetCtrl(i, CtrlForHash(hashfn_(data_[i])));
+      }
+    }
+    // Caller responsible for aligning.
+    *read_count = offset;
+  }
+
+  // Returns how large the table is after being written. If target is null, then no writing happens
+  // but the size is still returned. Target must be 8 byte aligned. Uses the HashSet<> format.
+  size_t WriteToMemory(uint8_t* ptr) const {
+    size_t offset = 0;
+    offset = WriteToBytes(ptr, offset, static_cast<uint64_t>(num_elements_));
+    offset = WriteToBytes(ptr, offset, static_cast<uint64_t>(num_buckets_));
+    offset = WriteToBytes(ptr, offset, static_cast<uint64_t>(elements_until_expand_));
+    offset = WriteToBytes(ptr, offset, min_load_factor_);
+    offset = WriteToBytes(ptr, offset, max_load_factor_);
+    // Write elements, not that this may not be safe for cross compilation if the elements are
+    // pointer sized.
+    for (size_t i = 0; i < num_buckets_; ++i) {
+      offset = WriteToBytes(ptr, offset, data_[i]);
+    }
+    // Caller responsible for aligning.
+    return offset;
+  }
+
+  ~SwissHashSet() {
+    DeallocateStorage();
+  }
+
+  SwissHashSet& operator=(SwissHashSet&& other) noexcept {
+    SwissHashSet(std::move(other)).swap(*this);  // NOLINT [runtime/explicit] [5]
+    return *this;
+  }
+
+  SwissHashSet& operator=(const SwissHashSet& other) {
+    SwissHashSet(other).swap(*this);  // NOLINT(runtime/explicit) - a case of lint gone mad.
+    return *this;
+  }
+
+  // Lower case for c++11 for each.
+  iterator begin() {
+    iterator ret(this, 0);
+    if (num_buckets_ != 0 && IsFreeSlot(ret.index_)) {
+      ++ret;  // Skip all the empty slots.
+    }
+    return ret;
+  }
+
+  // Lower case for c++11 for each. const version.
+  const_iterator begin() const {
+    const_iterator ret(this, 0);
+    if (num_buckets_ != 0 && IsFreeSlot(ret.index_)) {
+      ++ret;  // Skip all the empty slots.
+    }
+    return ret;
+  }
+
+  // Lower case for c++11 for each.
+  iterator end() {
+    return iterator(this, NumBuckets());
+  }
+
+  // Lower case for c++11 for each. const version.
+  const_iterator end() const {
+    return const_iterator(this, NumBuckets());
+  }
+
+  size_t size() const {
+    return num_elements_;
+  }
+
+  bool empty() const {
+    return size() == 0;
+  }
+
+  // Erase the element by shifting back the following elements of the probe sequence, see
+  // HashSet<>::erase(). The control bytes are moved together with the elements, so we never
+  // need tombstones. As with HashSet<>, this may result in the same element being visited twice
+  // during iteration.
+  iterator erase(iterator it) {
+    // empty_index is the index that will become empty.
+    size_t empty_index = it.index_;
+    DCHECK(!IsFreeSlot(empty_index));
+    size_t next_index = empty_index;
+    bool filled = false;  // True if we filled the empty index.
+    while (true) {
+      next_index = NextIndex(next_index);
+      // If the next element is empty, we are done. Make sure to clear the current empty index.
+      if (IsFreeSlot(next_index)) {
+        emptyfn_.MakeEmpty(ElementForIndex(empty_index));
+        SetCtrl(empty_index, kEmptyCtrl);
+        break;
+      }
+      // Otherwise try to see if the next element can fill the current empty index.
+      T& next_element = ElementForIndex(next_index);
+      const size_t next_hash = hashfn_(next_element);
+      // Calculate the ideal index, if it is within empty_index + 1 to next_index then there is
+      // nothing we can do.
+      size_t next_ideal_index = IndexForHash(next_hash);
+      // Loop around if needed for our check.
+      size_t unwrapped_next_index = next_index;
+      if (unwrapped_next_index < empty_index) {
+        unwrapped_next_index += NumBuckets();
+      }
+      // Loop around if needed for our check.
+      size_t unwrapped_next_ideal_index = next_ideal_index;
+      if (unwrapped_next_ideal_index < empty_index) {
+        unwrapped_next_ideal_index += NumBuckets();
+      }
+      if (unwrapped_next_ideal_index <= empty_index ||
+          unwrapped_next_ideal_index > unwrapped_next_index) {
+        // If the target index isn't within our current range it must have been probed from before
+        // the empty index.
+        ElementForIndex(empty_index) = std::move(next_element);
+        SetCtrl(empty_index, ctrl_[next_index]);
+        filled = true;
+        empty_index = next_index;
+      }
+    }
+    --num_elements_;
+    // If we didn't fill the slot then we need go to the next non free slot.
+    if (!filled) {
+      ++it;
+    }
+    return it;
+  }
+
+  // Find an element, returns end() if not found.
+  // Allows custom key (K) types, see HashSet<>::find().
+  template <typename K>
+  iterator find(const K& key) {
+    return FindWithHash(key, hashfn_(key));
+  }
+
+  template <typename K>
+  const_iterator find(const K& key) const {
+    return FindWithHash(key, hashfn_(key));
+  }
+
+  template <typename K>
+  iterator FindWithHash(const K& key, size_t hash) {
+    return iterator(this, FindIndex(key, hash));
+  }
+
+  template <typename K>
+  const_iterator FindWithHash(const K& key, size_t hash) const {
+    return const_iterator(this, FindIndex(key, hash));
+  }
+
+  // Insert an element with hint.
+  std::pair<iterator, bool> insert(const_iterator hint ATTRIBUTE_UNUSED, const T& element) {
+    return insert(element);
+  }
+  std::pair<iterator, bool> insert(const_iterator hint ATTRIBUTE_UNUSED, T&& element) {
+    return insert(std::move(element));
+  }
+
+  // Insert an element.
+  std::pair<iterator, bool> insert(const T& element) {
+    return InsertWithHash(element, hashfn_(element));
+  }
+  std::pair<iterator, bool> insert(T&& element) {
+    return InsertWithHash(std::move(element), hashfn_(element));
+  }
+
+  template <typename U, typename = std::enable_if_t<std::is_convertible_v<U, T>>>
+  std::pair<iterator, bool> InsertWithHash(U&& element, size_t hash) {
+    DCHECK_EQ(hash, hashfn_(element));
+    if (num_elements_ >= elements_until_expand_) {
+      Expand();
+      DCHECK_LT(num_elements_, elements_until_expand_);
+    }
+    bool find_failed = false;
+    auto find_fail_fn = [&](size_t index) ALWAYS_INLINE {
+      find_failed = true;
+      return index;
+    };
+    size_t index = FindIndexImpl(element, hash, find_fail_fn);
+    if (find_failed) {
+      data_[index] = std::forward<U>(element);
+      SetCtrl(index, CtrlForHash(hash));
+      ++num_elements_;
+    }
+    return std::make_pair(iterator(this, index), find_failed);
+  }
+
+  // Insert an element known not to be in the `SwissHashSet<>`.
+  void Put(const T& element) {
+    return PutWithHash(element, hashfn_(element));
+  }
+  void Put(T&& element) {
+    return PutWithHash(std::move(element), hashfn_(element));
+  }
+
+  template <typename U, typename = std::enable_if_t<std::is_convertible_v<U, T>>>
+  void PutWithHash(U&& element, size_t hash) {
+    DCHECK_EQ(hash, hashfn_(element));
+    if (num_elements_ >= elements_until_expand_) {
+      Expand();
+      DCHECK_LT(num_elements_, elements_until_expand_);
+    }
+    auto find_fail_fn = [](size_t index) ALWAYS_INLINE { return index; };
+    size_t index = FindIndexImpl</*kCanFind=*/ false>(element, hash, find_fail_fn);
+    data_[index] = std::forward<U>(element);
+    SetCtrl(index, CtrlForHash(hash));
+    ++num_elements_;
+  }
+
+  void swap(SwissHashSet& other) {
+    // Use argument-dependent lookup with fall-back to std::swap() for function objects.
+    using std::swap;
+    swap(allocfn_, other.allocfn_);
+    swap(ctrl_allocfn_, other.ctrl_allocfn_);
+    swap(hashfn_, other.hashfn_);
+    swap(emptyfn_, other.emptyfn_);
+    swap(pred_, other.pred_);
+    std::swap(data_, other.data_);
+    std::swap(ctrl_, other.ctrl_);
+    std::swap(num_buckets_, other.num_buckets_);
+    std::swap(num_elements_, other.num_elements_);
+    std::swap(elements_until_expand_, other.elements_until_expand_);
+    std::swap(min_load_factor_, other.min_load_factor_);
+    std::swap(max_load_factor_, other.max_load_factor_);
+    std::swap(owns_data_, other.owns_data_);
+  }
+
+  allocator_type get_allocator() const {
+    return allocfn_;
+  }
+
+  void ShrinkToMaximumLoad() {
+    Resize(size() / max_load_factor_);
+  }
+
+  // Reserve enough room to insert until Size() == num_elements without requiring to grow the hash
+  // set. No-op if the hash set is already large enough to do this.
+  void reserve(size_t num_elements) {
+    size_t num_buckets = num_elements / max_load_factor_;
+    // Deal with rounding errors. Add one for rounding.
+    while (static_cast<size_t>(num_buckets * max_load_factor_) <= num_elements + 1u) {
+      ++num_buckets;
+    }
+    if (num_buckets > NumBuckets()) {
+      Resize(num_buckets);
+    }
+  }
+
+  // To distance that inserted elements were probed. Used for measuring how good hash functions
+  // are.
+  size_t TotalProbeDistance() const {
+    size_t total = 0;
+    for (size_t i = 0; i < NumBuckets(); ++i) {
+      if (!IsFreeSlot(i)) {
+        size_t ideal_location = IndexForHash(hashfn_(ElementForIndex(i)));
+        if (ideal_location > i) {
+          total += i + NumBuckets() - ideal_location;
+        } else {
+          total += i - ideal_location;
+        }
+      }
+    }
+    return total;
+  }
+
+  // Calculate the current load factor and return it.
+  double CalculateLoadFactor() const {
+    return static_cast<double>(size()) / static_cast<double>(NumBuckets());
+  }
+
+  // Make sure that everything reinserts in the right spot and that the control bytes match
+  // the elements. Returns the number of errors.
+  size_t Verify() NO_THREAD_SAFETY_ANALYSIS {
+    size_t errors = 0;
+    for (size_t i = 0; i < num_buckets_; ++i) {
+      if (IsFreeSlot(i) != emptyfn_.IsEmpty(data_[i])) {
+        LOG(ERROR) << "Control byte of slot " << i << " does not match the element";
+        ++errors;
+      } else if (!IsFreeSlot(i)) {
+        size_t hash = hashfn_(data_[i]);
+        uint8_t ctrl = ctrl_[i];
+        if (ctrl != CtrlForHash(hash)) {
+          LOG(ERROR) << "Control byte of slot " << i << " does not match the element hash";
+          ++errors;
+        }
+        SetCtrl(i, kEmptyCtrl);
+        size_t first_slot = FirstAvailableSlot(IndexForHash(hash));
+        if (i != first_slot) {
+          LOG(ERROR) << "Element " << i << " should be in slot " << first_slot;
+          ++errors;
+        }
+        SetCtrl(i, ctrl);
+      }
+    }
+    for (size_t i = num_buckets_; num_buckets_ != 0u && i < CtrlSize(num_buckets_); ++i) {
+      if (ctrl_[i] != ctrl_[i % num_buckets_]) {
+        LOG(ERROR) << "Mirrored control byte " << i << " is out of sync";
+        ++errors;
+      }
+    }
+    return errors;
+  }
+
+  double GetMinLoadFactor() const {
+    return min_load_factor_;
+  }
+
+  double GetMaxLoadFactor() const {
+    return max_load_factor_;
+  }
+
+  // Change the load factor of the hash set. If the current load factor is greater than the max
+  // specified, then we resize the hash table storage.
+  void SetLoadFactor(double min_load_factor, double max_load_factor) {
+    DCHECK_LT(min_load_factor, max_load_factor);
+    DCHECK_GT(min_load_factor, 0.0);
+    DCHECK_LT(max_load_factor, 1.0);
+    min_load_factor_ = min_load_factor;
+    max_load_factor_ = max_load_factor;
+    elements_until_expand_ = NumBuckets() * max_load_factor_;
+    // If the current load factor isn't in the range, then resize to the mean of the minimum and
+    // maximum load factor.
+    const double load_factor = CalculateLoadFactor();
+    if (load_factor > max_load_factor_) {
+      Resize(size() / ((min_load_factor_ + max_load_factor_) * 0.5));
+    }
+  }
+
+  // The hash set expands when Size() reaches ElementsUntilExpand().
+  size_t ElementsUntilExpand() const {
+    return elements_until_expand_;
+  }
+
+  size_t NumBuckets() const {
+    return num_buckets_;
+  }
+
+ private:
+  using CtrlAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<uint8_t>;
+
+  static constexpr size_t kGroupSize = SwissHashSetGroup::kGroupSize;
+  static constexpr uint8_t kEmptyCtrl = 0u;
+
+  // The control byte of a full slot has the top bit set and 7 other bits of the hash. Mix the
+  // hash first, the index uses `hash % NumBuckets()` and some hash functions are trivial.
+  static uint8_t CtrlForHash(size_t hash) {
+    uint64_t mixed = static_cast<uint64_t>(hash) * UINT64_C(0x9e3779b97f4a7c15);
+    return static_cast<uint8_t>(0x80u | (mixed >> 57));
+  }
+
+  static size_t CtrlSize(size_t num_buckets) {
+    return num_buckets + kGroupSize - 1u;
+  }
+
+  T& ElementForIndex(size_t index) {
+    DCHECK_LT(index, NumBuckets());
+    DCHECK(data_ != nullptr);
+    return data_[index];
+  }
+
+  const T& ElementForIndex(size_t index) const {
+    DCHECK_LT(index, NumBuckets());
+    DCHECK(data_ != nullptr);
+    return data_[index];
+  }
+
+  size_t IndexForHash(size_t hash) const {
+    // Protect against undefined behavior (division by zero).
+    if (UNLIKELY(num_buckets_ == 0)) {
+      return 0;
+    }
+    return hash % num_buckets_;
+  }
+
+  size_t NextIndex(size_t index) const {
+    if (UNLIKELY(++index >= num_buckets_)) {
+      DCHECK_EQ(index, NumBuckets());
+      return 0;
+    }
+    return index;
+  }
+
+  // Map a position in a group loaded from `index` back to the slot index.
+  size_t WrapIndex(size_t index) const {
+    if (UNLIKELY(index >= num_buckets_)) {
+      // Only tables with fewer than kGroupSize buckets can wrap around more than once.
+      index = (index - num_buckets_ < num_buckets_) ? index - num_buckets_ : index % num_buckets_;
+    }
+    return index;
+  }
+
+  // Set the control byte for a slot, including its mirror copies after the last slot.
+  void SetCtrl(size_t index, uint8_t ctrl) {
+    DCHECK_LT(index, NumBuckets());
+    ctrl_[index] = ctrl;
+    const size_t end = CtrlSize(num_buckets_);
+    for (size_t i = index + num_buckets_; i < end; i += num_buckets_) {
+      ctrl_[i] = ctrl;
+    }
+  }
+
+  // Find the hash table slot for an element, or return NumBuckets() if not found.
+  // This value for not found is important so that iterator(this, FindIndex(...)) == end().
+  template <typename K>
+  ALWAYS_INLINE
+  size_t FindIndex(const K& element, size_t hash) const {
+    // Guard against failing to get an element for a non-existing index.
+    if (UNLIKELY(NumBuckets() == 0)) {
+      return 0;
+    }
+    auto fail_fn = [&](size_t index ATTRIBUTE_UNUSED) ALWAYS_INLINE { return NumBuckets(); };
+    return FindIndexImpl(element, hash, fail_fn);
+  }
+
+  // Find the hash table slot for an element, or return an empty slot index if not found.
+  // Checks the `kGroupSize` slots starting at `index` at once; only the slots before the first
+  // empty one are part of the linear probe sequence.
+  template <bool kCanFind = true, typename K, typename FailFn>
+  ALWAYS_INLINE
+  size_t FindIndexImpl(const K& element, size_t hash, FailFn fail_fn) const {
+    DCHECK_NE(NumBuckets(), 0u);
+    DCHECK_EQ(hashfn_(element), hash);
+    const uint8_t ctrl = CtrlForHash(hash);
+    size_t index = IndexForHash(hash);
+    while (true) {
+      const uint8_t* group = ctrl_ + index;
+      uint64_t empty = SwissHashSetGroup::Match(group, kEmptyCtrl);
+      if (kCanFind) {
+        uint64_t match = SwissHashSetGroup::Match(group, ctrl);
+        if (empty != 0u) {
+          match &= SwissHashSetGroup::SlotsBefore(empty);
+        }
+        for (; match != 0u; match = SwissHashSetGroup::RemoveFirst(match)) {
+          size_t slot = WrapIndex(index + SwissHashSetGroup::FirstSlot(match));
+          if (pred_(ElementForIndex(slot), element)) {
+            return slot;
+          }
+        }
+      } else if (kIsDebugBuild) {
+        for (size_t i = index; ; i = NextIndex(i)) {
+          if (IsFreeSlot(i)) {
+            break;
+          }
+          DCHECK(!pred_(ElementForIndex(i), element));
+        }
+      }
+      if (empty != 0u) {
+        return fail_fn(WrapIndex(index + SwissHashSetGroup::FirstSlot(empty)));
+      }
+      index = WrapIndex(index + kGroupSize);
+    }
+  }
+
+  bool IsFreeSlot(size_t index) const {
+    DCHECK_LT(index, NumBuckets());
+    return ctrl_[index] == kEmptyCtrl;
+  }
+
+  void AllocateCtrl(size_t num_buckets) {
+    if (num_buckets != 0u) {
+      ctrl_ = ctrl_allocfn_.allocate(CtrlSize(num_buckets));
+      memset(ctrl_, kEmptyCtrl, CtrlSize(num_buckets));
+    }
+  }
+
+  // Allocate a number of buckets.
+  void AllocateStorage(size_t num_buckets) {
+    num_buckets_ = num_buckets;
+    data_ = allocfn_.allocate(num_buckets_);
+    owns_data_ = true;
+    for (size_t i = 0; i < num_buckets_; ++i) {
+      allocfn_.construct(allocfn_.address(data_[i]));
+      emptyfn_.MakeEmpty(data_[i]);
+    }
+    AllocateCtrl(num_buckets_);
+  }
+
+  void DeallocateStorage() {
+    if (owns_data_) {
+      for (size_t i = 0; i < NumBuckets(); ++i) {
+        allocfn_.destroy(allocfn_.address(data_[i]));
+      }
+      if (data_ != nullptr) {
+        allocfn_.deallocate(data_, NumBuckets());
+      }
+      owns_data_ = false;
+    }
+    if (ctrl_ != nullptr) {
+      ctrl_allocfn_.deallocate(ctrl_, CtrlSize(NumBuckets()));
+    }
+    data_ = nullptr;
+    ctrl_ = nullptr;
+    num_buckets_ = 0;
+  }
+
+  // Expand the set based on the load factors.
+  void Expand() {
+    size_t min_index = static_cast<size_t>(size() / min_load_factor_);
+    // Resize based on the minimum load factor.
+    Resize(min_index);
+  }
+
+  // Expand / shrink the table to the new specified size.
+  void Resize(size_t new_size) {
+    if (new_size < kMinBuckets) {
+      new_size = kMinBuckets;
+    }
+    DCHECK_GE(new_size, size());
+    T* const old_data = data_;
+    uint8_t* const old_ctrl = ctrl_;
+    size_t old_num_buckets = num_buckets_;
+    // Reinsert all of the old elements.
+    const bool owned_data = owns_data_;
+    AllocateStorage(new_size);
+    for (size_t i = 0; i < old_num_buckets; ++i) {
+      T& element = old_data[i];
+      if (old_ctrl[i] != kEmptyCtrl) {
+        size_t hash = hashfn_(element);
+        size_t index = FirstAvailableSlot(IndexForHash(hash));
+        data_[index] = std::move(element);
+        SetCtrl(index, CtrlForHash(hash));
+      }
+      if (owned_data) {
+        allocfn_.destroy(allocfn_.address(element));
+      }
+    }
+    if (owned_data) {
+      allocfn_.deallocate(old_data, old_num_buckets);
+    }
+    if (old_ctrl != nullptr) {
+      ctrl_allocfn_.deallocate(old_ctrl, CtrlSize(old_num_buckets));
+    }
+
+    // When we hit elements_until_expand_, we are at the max load factor and must expand again.
+    elements_until_expand_ = NumBuckets() * max_load_factor_;
+  }
+
+  ALWAYS_INLINE size_t FirstAvailableSlot(size_t index) const {
+    DCHECK_LT(index, NumBuckets());  // Don't try to get a slot out of range.
+    size_t non_empty_count = 0;
+    uint64_t empty;
+    while ((empty = SwissHashSetGroup::Match(ctrl_ + index, kEmptyCtrl)) == 0u) {
+      index = WrapIndex(index + kGroupSize);
+      non_empty_count += kGroupSize;
+      DCHECK_LE(non_empty_count, NumBuckets());  // Don't loop forever.
+    }
+    return WrapIndex(index + SwissHashSetGroup::FirstSlot(empty));
+  }
+
+  size_t NextNonEmptySlot(size_t index) const {
+    const size_t num_buckets = NumBuckets();
+    DCHECK_LT(index, num_buckets);
+    ++index;
+    while (index < num_buckets) {
+      uint64_t full = ~SwissHashSetGroup::Match(ctrl_ + index, kEmptyCtrl) &
+                      SwissHashSetGroup::kAllSlots;
+      if (full != 0u) {
+        // A match in the mirrored control bytes means that there are no more full slots.
+        return std::min(index + SwissHashSetGroup::FirstSlot(full), num_buckets);
+      }
+      index += kGroupSize;
+    }
+    return num_buckets;
+  }
+
+  // Return new offset.
+  template <typename Elem>
+  static size_t WriteToBytes(uint8_t* ptr, size_t offset, Elem n) {
+    DCHECK_ALIGNED(ptr + offset, sizeof(n));
+    if (ptr != nullptr) {
+      *reinterpret_cast<Elem*>(ptr + offset) = n;
+    }
+    return offset + sizeof(n);
+  }
+
+  template <typename Elem>
+  static size_t ReadFromBytes(const uint8_t* ptr, size_t offset, Elem* out) {
+    DCHECK(ptr != nullptr);
+    DCHECK_ALIGNED(ptr + offset, sizeof(*out));
+    *out = *reinterpret_cast<const Elem*>(ptr + offset);
+    return offset + sizeof(*out);
+  }
+
+  Alloc allocfn_;  // Allocator function.
+  CtrlAlloc ctrl_allocfn_;  // Allocator function for the control bytes.
+  HashFn hashfn_;  // Hashing function.
+  EmptyFn emptyfn_;  // IsEmpty/SetEmpty function.
+  Pred pred_;  // Equals function.
+  size_t num_elements_;  // Number of inserted elements.
+  size_t num_buckets_;  // Number of hash table buckets.
+  size_t elements_until_expand_;  // Maximum number of elements until we expand the table.
+  bool owns_data_;  // If we own data_ and are responsible for freeing it.
+  T* data_;  // Backing storage.
+  uint8_t* ctrl_;  // Control bytes, always owned.
+  double min_load_factor_;
+  double max_load_factor_;
+
+  template <class Elem, class HashSetType>
+  friend class HashSetIterator;
+};
+
+template <class T, class EmptyFn, class HashFn, class Pred, class Alloc>
+void swap(SwissHashSet<T, EmptyFn, HashFn, Pred, Alloc>& lhs,
+          SwissHashSet<T, EmptyFn, HashFn, Pred, Alloc>& rhs) {
+  lhs.swap(rhs);
+}
+
+}  // namespace art
+
+#endif  // ART_LIBARTBASE_BASE_SWISS_HASH_SET_H_
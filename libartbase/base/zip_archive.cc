@@ -54,6 +54,10 @@ bool ZipEntry::IsAlignedTo(size_t alignment) const {
   return IsAlignedParam(zip_entry_->offset, static_cast<int>(alignment));
 }
 
+uint64_t ZipEntry::GetOffset() const {
+  return static_cast<uint64_t>(zip_entry_->offset);
+}
+
 ZipEntry::~ZipEntry() {
   delete zip_entry_;
 }
@@ -286,6 +290,10 @@ ZipEntry* ZipArchive::Find(const char* name, std::string* error_msg) const {
   return new ZipEntry(handle_, zip_entry.release(), name);
 }
 
+int ZipArchive::GetFd() const {
+  return GetFileDescriptor(handle_);
+}
+
 ZipArchive::~ZipArchive() {
   CloseArchive(handle_);
 }
@@ -73,6 +73,9 @@ class ZipEntry {
   bool IsUncompressed();
   bool IsAlignedTo(size_t alignment) const;
 
+  // Returns the offset of the entry data within the zip file.
+  uint64_t GetOffset() const;
+
  private:
   ZipEntry(ZipArchiveHandle handle,
            ::ZipEntry* zip_entry,
@@ -96,6 +99,9 @@ class ZipArchive {
 
   ZipEntry* Find(const char* name, std::string* error_msg) const;
 
+  // Returns the file descriptor the archive was opened with, or -1 if not file backed.
+  int GetFd() const;
+
   ~ZipArchive();
 
  private:
@@ -33,6 +33,7 @@
 #include "dex/compact_dex_file.h"
 #include "dex/dex_file.h"
 #include "dex/dex_file_verifier.h"
+#include "dex/dex_verification_cache.h"
 #include "dex/standard_dex_file.h"
 
 namespace art {
@@ -456,6 +457,7 @@ std::unique_ptr<const DexFile> ArtDexFileLoader::OpenOneDexFileFromZip(
   }
 
   MemMap map;
+  bool mapped_directly = false;
   if (zip_entry->IsUncompressed()) {
     if (!zip_entry->IsAlignedTo(alignof(DexFile::Header))) {
       // Do not mmap unaligned ZIP entries because
@@ -470,6 +472,8 @@ std::unique_ptr<const DexFile> ArtDexFileLoader::OpenOneDexFileFromZip(
         LOG(WARNING) << "Can't mmap dex file " << location << "!" << entry_name << " directly; "
                      << "is your ZIP file corrupted? Falling back to extraction.";
         // Try again with Extraction which still has a chance of recovery.
+      } else {
+        mapped_directly = true;
       }
     }
   }
@@ -490,11 +494,25 @@ std::unique_ptr<const DexFile> ArtDexFileLoader::OpenOneDexFileFromZip(
     *error_code = DexFileLoaderErrorCode::kExtractToMemoryError;
     return nullptr;
   }
+  // Dex files mapped directly from the zip file may have been verified by an earlier open.
+  // The cache only lets us skip the structural verification; the checksum is always checked.
+  DexVerificationCache::Key cache_key;
+  const bool use_verification_cache =
+      verify &&
+      mapped_directly &&
+      DexVerificationCache::CreateKey(zip_archive.GetFd(),
+                                      GetBaseLocation(location),
+                                      zip_entry->GetOffset(),
+                                      map.Begin(),
+                                      map.Size(),
+                                      &cache_key);
+  const bool verified_before =
+      use_verification_cache && DexVerificationCache::IsVerified(cache_key);
   VerifyResult verify_result;
   std::unique_ptr<DexFile> dex_file = OpenCommon(location,
                                                  zip_entry->GetCrc32(),
                                                  kNoOatDexFile,
-                                                 verify,
+                                                 verify && !verified_before,
                                                  verify_checksum,
                                                  error_msg,
                                                  std::make_unique<MemMapContainer>(std::move(map)),
@@ -522,6 +540,9 @@ std::unique_ptr<const DexFile> ArtDexFileLoader::OpenOneDexFileFromZip(
     *error_code = DexFileLoaderErrorCode::kVerifyError;
     return nullptr;
   }
+  if (use_verification_cache && !verified_before) {
+    DexVerificationCache::RecordVerified(cache_key);
+  }
   *error_code = DexFileLoaderErrorCode::kNoError;
   return dex_file;
 }
@@ -179,24 +179,30 @@ inline IterationRange<ClassAccessor::DataIterator<ClassAccessor::Field>>
 // Return an iteration range for the first <count> methods.
 inline IterationRange<ClassAccessor::DataIterator<ClassAccessor::Method>>
     ClassAccessor::GetMethodsInternal(size_t count) const {
-  // Skip over the fields.
-  Field field(dex_file_, ptr_pos_, hiddenapi_ptr_pos_);
-  VisitMembers(NumFields(), VoidFunctor(), &field);
+  // Skip over the fields. The field index deltas and access flags are not needed, so we
+  // do not decode them. The class data and hiddenapi flags are in the data section.
+  const uint8_t* data_end = dex_file_.DataBegin() + dex_file_.DataSize();
+  const uint8_t* ptr_pos = ptr_pos_;
+  SkipUnsignedLeb128(&ptr_pos, data_end, 2u * NumFields());  // Index delta and access flags.
+  const uint8_t* hiddenapi_ptr_pos = hiddenapi_ptr_pos_;
+  if (hiddenapi_ptr_pos != nullptr) {
+    SkipUnsignedLeb128(&hiddenapi_ptr_pos, data_end, NumFields());
+  }
   // Return the iterator pair.
   return {
       DataIterator<Method>(dex_file_,
                            0u,
                            num_direct_methods_,
                            count,
-                           field.ptr_pos_,
-                           field.hiddenapi_ptr_pos_),
+                           ptr_pos,
+                           hiddenapi_ptr_pos),
       DataIterator<Method>(dex_file_,
                            count,
                            num_direct_methods_,
                            count,
                            // The following pointers are bogus but unused in the `end` iterator.
-                           field.ptr_pos_,
-                           field.hiddenapi_ptr_pos_) };
+                           ptr_pos,
+                           hiddenapi_ptr_pos) };
 }
 
 inline IterationRange<ClassAccessor::DataIterator<ClassAccessor::Field>> ClassAccessor::GetFields()
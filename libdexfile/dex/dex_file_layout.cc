@@ -22,6 +22,58 @@
 
 namespace art {
 
+int DexLayoutSection::MadviseLargestPageAlignedRegion(const uint8_t* begin,
+                                                      const uint8_t* end,
+                                                      int advice) {
+#ifdef _WIN32
+  UNUSED(begin, end, advice);
+  return 0;
+#else
+  DCHECK_LE(begin, end);
+  begin = AlignUp(begin, kPageSize);
+  end = AlignDown(end, kPageSize);
+  if (begin < end) {
+    int result = madvise(const_cast<uint8_t*>(begin), end - begin, advice);
+    if (result != 0) {
+      PLOG(WARNING) << "madvise failed " << result;
+    }
+    return result;
+  }
+  return 0;
+#endif
+}
+
+void DexLayoutSection::Subsection::Madvise(const DexFile* dex_file, int advice) const {
+  DCHECK(dex_file != nullptr);
+  DCHECK_LE(end_offset_, dex_file->DataSize());
+  MadviseLargestPageAlignedRegion(dex_file->DataBegin() + start_offset_,
+                                  dex_file->DataBegin() + end_offset_,
+                                  advice);
+}
+
+void DexLayoutSections::MadviseAtLoad(const DexFile* dex_file) const {
+#ifdef _WIN32
+  UNUSED(dex_file);
+#else
+  for (const DexLayoutSection& section : sections_) {
+    // Madvise the hot and startup parts first, they are laid out at the start of each section.
+    section.parts_[static_cast<size_t>(LayoutType::kLayoutTypeHot)].Madvise(
+        dex_file, MADV_WILLNEED);
+    section.parts_[static_cast<size_t>(LayoutType::kLayoutTypeStartupOnly)].Madvise(
+        dex_file, MADV_WILLNEED);
+    // Avoid reading ahead parts that are thought to be unused.
+    section.parts_[static_cast<size_t>(LayoutType::kLayoutTypeUnused)].Madvise(
+        dex_file, MADV_RANDOM);
+  }
+  // The cold metadata is only accessed on demand (stack traces, reflection, hidden API checks),
+  // keep the kernel from reading ahead into it.
+  const DexLayoutSection& cold_metadata =
+      sections_[static_cast<size_t>(SectionType::kSectionTypeColdMetadata)];
+  cold_metadata.parts_[static_cast<size_t>(LayoutType::kLayoutTypeSometimesUsed)].Madvise(
+      dex_file, MADV_RANDOM);
+#endif
+}
+
 std::ostream& operator<<(std::ostream& os, const DexLayoutSection& section) {
   for (size_t i = 0; i < static_cast<size_t>(LayoutType::kLayoutTypeCount); ++i) {
     const DexLayoutSection::Subsection& part = section.parts_[i];
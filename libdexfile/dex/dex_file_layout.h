@@ -82,20 +82,35 @@ class DexLayoutSection {
         end_offset_ = std::max(end_offset_, end_offset);
       }
     }
+
+    // Madvise the pages of the subsection, offsets are relative to the data section of the dex
+    // file.
+    void Madvise(const DexFile* dex_file, int advice) const;
   };
 
+  // Madvise the largest page aligned region within begin and end. Returns the madvise result, or
+  // 0 if the region does not contain a whole page.
+  static int MadviseLargestPageAlignedRegion(const uint8_t* begin, const uint8_t* end, int advice);
+
   Subsection parts_[static_cast<size_t>(LayoutType::kLayoutTypeCount)];
 };
 
-// A set of dex layout sections, currently there is only one section for code and one for strings.
+// A set of dex layout sections: code items, string data and the cold metadata (debug info,
+// annotations and hidden API data) that dexlayout packs at the tail of the data section.
 class DexLayoutSections {
  public:
   enum class SectionType : uint8_t {
     kSectionTypeCode,
     kSectionTypeStrings,
+    kSectionTypeColdMetadata,
     kSectionCount,
   };
 
+  // Advise the kernel of the expected access pattern right after loading the dex file: hot and
+  // startup parts will be needed soon, while unused parts and the cold metadata are only
+  // accessed randomly and should not be read ahead.
+  void MadviseAtLoad(const DexFile* dex_file) const;
+
   DexLayoutSection sections_[static_cast<size_t>(SectionType::kSectionCount)];
 };
 
@@ -17,9 +17,11 @@
 #include "dex_file_verifier.h"
 
 #include <algorithm>
+#include <atomic>
 #include <bitset>
 #include <limits>
 #include <memory>
+#include <thread>
 
 #include "android-base/logging.h"
 #include "android-base/macros.h"
@@ -110,6 +112,26 @@ constexpr bool IsDataSectionType(DexFile::MapItemType map_item_type) {
   return true;
 }
 
+// Returns true for the data sections that are checked with CheckIntraDataSection<>().
+constexpr bool IsIntraDataSectionType(DexFile::MapItemType map_item_type) {
+  switch (map_item_type) {
+    case DexFile::kDexTypeTypeList:
+    case DexFile::kDexTypeAnnotationSetRefList:
+    case DexFile::kDexTypeAnnotationSetItem:
+    case DexFile::kDexTypeClassDataItem:
+    case DexFile::kDexTypeCodeItem:
+    case DexFile::kDexTypeStringDataItem:
+    case DexFile::kDexTypeDebugInfoItem:
+    case DexFile::kDexTypeAnnotationItem:
+    case DexFile::kDexTypeEncodedArrayItem:
+    case DexFile::kDexTypeAnnotationsDirectoryItem:
+    case DexFile::kDexTypeHiddenapiClassData:
+      return true;
+    default:
+      return false;
+  }
+}
+
 // Fields and methods may have only one of public/protected/private.
 ALWAYS_INLINE
 constexpr bool CheckAtMostOneOfPublicProtectedPrivate(uint32_t flags) {
@@ -210,7 +232,9 @@ class DexFileVerifier {
                       std::numeric_limits<size_t>::max()} {
   }
 
-  bool Verify();
+  // Verify the dex file. With `num_threads` > 1, the intra checks of data sections are done in
+  // parallel, see CheckIntraSection().
+  bool Verify(size_t num_threads);
 
   const std::string& FailureReason() const {
     return failure_reason_;
@@ -316,7 +340,17 @@ class DexFileVerifier {
   bool CheckIntraIdSection(size_t offset, uint32_t count);
   template <DexFile::MapItemType kType>
   bool CheckIntraDataSection(size_t offset, uint32_t count);
-  bool CheckIntraSection();
+  bool CheckIntraDataSectionOfType(DexFile::MapItemType type, size_t offset, uint32_t count);
+  bool CheckIntraSection(size_t num_threads);
+
+  // Result of the intra checks of a data section done by a separate verifier.
+  struct ParallelSection {
+    std::unique_ptr<DexFileVerifier> verifier;  // Null if the section was not checked.
+    bool success = false;
+    size_t end_offset = 0u;
+  };
+  std::vector<ParallelSection> CheckIntraDataSectionsInParallel(size_t num_threads);
+  bool UseParallelSectionResult(ParallelSection* section);
 
   bool CheckOffsetToTypeMap(size_t offset, uint16_t type);
 
@@ -2240,13 +2274,102 @@ bool DexFileVerifier::CheckIntraDataSection(size_t offset, uint32_t count) {
   return true;
 }
 
-bool DexFileVerifier::CheckIntraSection() {
+bool DexFileVerifier::CheckIntraDataSectionOfType(DexFile::MapItemType type,
+                                                  size_t offset,
+                                                  uint32_t count) {
+  switch (type) {
+#define CHECK_INTRA_DATA_SECTION_CASE(type)                   \
+    case type:                                                \
+      return CheckIntraDataSection<type>(offset, count);
+    CHECK_INTRA_DATA_SECTION_CASE(DexFile::kDexTypeTypeList)
+    CHECK_INTRA_DATA_SECTION_CASE(DexFile::kDexTypeAnnotationSetRefList)
+    CHECK_INTRA_DATA_SECTION_CASE(DexFile::kDexTypeAnnotationSetItem)
+    CHECK_INTRA_DATA_SECTION_CASE(DexFile::kDexTypeClassDataItem)
+    CHECK_INTRA_DATA_SECTION_CASE(DexFile::kDexTypeCodeItem)
+    CHECK_INTRA_DATA_SECTION_CASE(DexFile::kDexTypeStringDataItem)
+    CHECK_INTRA_DATA_SECTION_CASE(DexFile::kDexTypeDebugInfoItem)
+    CHECK_INTRA_DATA_SECTION_CASE(DexFile::kDexTypeAnnotationItem)
+    CHECK_INTRA_DATA_SECTION_CASE(DexFile::kDexTypeEncodedArrayItem)
+    CHECK_INTRA_DATA_SECTION_CASE(DexFile::kDexTypeAnnotationsDirectoryItem)
+    CHECK_INTRA_DATA_SECTION_CASE(DexFile::kDexTypeHiddenapiClassData)
+#undef CHECK_INTRA_DATA_SECTION_CASE
+    default:
+      LOG(FATAL) << "Unexpected data section type " << type;
+      UNREACHABLE();
+  }
+}
+
+// The intra checks of a data section depend only on the contents of the section, so we can do
+// them for all data sections up front on multiple threads, each with a separate verifier. The
+// results are used when CheckIntraSection() reaches the section in map order, after checking
+// the padding and overlap with the previous section, so the reported error is the same as
+// when checking sequentially.
+std::vector<DexFileVerifier::ParallelSection> DexFileVerifier::CheckIntraDataSectionsInParallel(
+    size_t num_threads) {
+  const dex::MapList* map = reinterpret_cast<const dex::MapList*>(begin_ + header_->map_off_);
+  std::vector<ParallelSection> sections(map->size_);
+  std::vector<uint32_t> tasks;
+  for (uint32_t i = 0; i != map->size_; ++i) {
+    if (IsIntraDataSectionType(static_cast<DexFile::MapItemType>(map->list_[i].type_))) {
+      sections[i].verifier.reset(
+          new DexFileVerifier(dex_file_, begin_, size_, location_, verify_checksum_));
+      tasks.push_back(i);
+    }
+  }
+
+  std::atomic<size_t> next_task(0u);
+  auto run_tasks = [&]() {
+    for (size_t task = next_task.fetch_add(1u, std::memory_order_relaxed);
+         task < tasks.size();
+         task = next_task.fetch_add(1u, std::memory_order_relaxed)) {
+      const dex::MapItem& item = map->list_[tasks[task]];
+      ParallelSection& section = sections[tasks[task]];
+      DexFileVerifier* verifier = section.verifier.get();
+      verifier->ptr_ = begin_ + item.offset_;
+      section.success = verifier->CheckIntraDataSectionOfType(
+          static_cast<DexFile::MapItemType>(item.type_), item.offset_, item.size_);
+      section.end_offset = verifier->ptr_ - begin_;
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1, end = std::min<size_t>(num_threads, tasks.size()); i < end; ++i) {
+    threads.emplace_back(run_tasks);
+  }
+  run_tasks();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  return sections;
+}
+
+bool DexFileVerifier::UseParallelSectionResult(ParallelSection* section) {
+  DexFileVerifier* verifier = section->verifier.get();
+  DCHECK(verifier != nullptr);
+  if (!section->success) {
+    DCHECK(verifier->FailureReasonIsSet());
+    failure_reason_ = std::move(verifier->failure_reason_);
+    return false;
+  }
+  for (const std::pair<uint32_t, uint16_t>& entry : verifier->offset_to_type_map_) {
+    DCHECK(offset_to_type_map_.find(entry.first) == offset_to_type_map_.end());
+    offset_to_type_map_.insert(entry);
+  }
+  ptr_ = begin_ + section->end_offset;
+  return true;
+}
+
+bool DexFileVerifier::CheckIntraSection(size_t num_threads) {
   const dex::MapList* map = reinterpret_cast<const dex::MapList*>(begin_ + header_->map_off_);
   const dex::MapItem* item = map->list_;
   size_t offset = 0;
   uint32_t count = map->size_;
   ptr_ = begin_;
 
+  std::vector<ParallelSection> parallel_sections;
+  if (num_threads > 1u) {
+    parallel_sections = CheckIntraDataSectionsInParallel(num_threads);
+  }
+
   // Preallocate offset map to avoid some allocations. We can only guess from the list items,
   // not derived things.
   offset_to_type_map_.reserve(
@@ -2324,12 +2447,14 @@ bool DexFileVerifier::CheckIntraSection() {
       CHECK_INTRA_SECTION_ITERATE_CASE(DexFile::kDexTypeCallSiteIdItem)
 #undef CHECK_INTRA_SECTION_ITERATE_CASE
 
-#define CHECK_INTRA_DATA_SECTION_CASE(type)                                 \
-      case type:                                                            \
-        if (!CheckIntraDataSection<type>(section_offset, section_count)) {  \
-          return false;                                                     \
-        }                                                                   \
-        offset = ptr_ - begin_;                                             \
+#define CHECK_INTRA_DATA_SECTION_CASE(type)                                              \
+      case type:                                                                         \
+        if (!(parallel_sections.empty()                                                  \
+                  ? CheckIntraDataSection<type>(section_offset, section_count)           \
+                  : UseParallelSectionResult(&parallel_sections[item - map->list_]))) {  \
+          return false;                                                                  \
+        }                                                                                \
+        offset = ptr_ - begin_;                                                          \
         break;
       CHECK_INTRA_DATA_SECTION_CASE(DexFile::kDexTypeTypeList)
       CHECK_INTRA_DATA_SECTION_CASE(DexFile::kDexTypeAnnotationSetRefList)
@@ -3302,7 +3427,7 @@ bool DexFileVerifier::CheckInterSection() {
   return true;
 }
 
-bool DexFileVerifier::Verify() {
+bool DexFileVerifier::Verify(size_t num_threads) {
   // Check the header.
   if (!CheckHeader()) {
     return false;
@@ -3318,7 +3443,7 @@ bool DexFileVerifier::Verify() {
   defined_class_indexes_.resize(header_->type_ids_size_);
 
   // Check structure within remaining sections.
-  if (!CheckIntraSection()) {
+  if (!CheckIntraSection(num_threads)) {
     return false;
   }
 
@@ -3683,15 +3808,37 @@ bool DexFileVerifier::CheckConstructorProperties(
   return true;
 }
 
+// Dex files smaller than this are always verified on the calling thread.
+static constexpr size_t kMinParallelVerificationSize = 1 * MB;
+
+static std::atomic<size_t> gVerifierThreads(1u);
+
+void SetVerifierThreads(size_t num_threads) {
+  gVerifierThreads.store(std::max<size_t>(num_threads, 1u), std::memory_order_relaxed);
+}
+
+bool Verify(const DexFile* dex_file,
+            const uint8_t* begin,
+            size_t size,
+            const char* location,
+            bool verify_checksum,
+            std::string* error_msg) {
+  size_t num_threads = (size >= kMinParallelVerificationSize)
+      ? gVerifierThreads.load(std::memory_order_relaxed)
+      : 1u;
+  return Verify(dex_file, begin, size, location, verify_checksum, num_threads, error_msg);
+}
+
 bool Verify(const DexFile* dex_file,
             const uint8_t* begin,
             size_t size,
             const char* location,
             bool verify_checksum,
+            size_t num_threads,
             std::string* error_msg) {
   std::unique_ptr<DexFileVerifier> verifier(
       new DexFileVerifier(dex_file, begin, size, location, verify_checksum));
-  if (!verifier->Verify()) {
+  if (!verifier->Verify(num_threads)) {
     *error_msg = verifier->FailureReason();
     return false;
   }
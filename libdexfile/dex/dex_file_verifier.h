@@ -20,6 +20,7 @@
 #include <string>
 
 #include <inttypes.h>
+#include <stddef.h>
 
 namespace art {
 
@@ -27,6 +28,8 @@ class DexFile;
 
 namespace dex {
 
+// Verify the dex file. Dex files of at least 1MiB are verified with the number of threads set
+// by SetVerifierThreads().
 bool Verify(const DexFile* dex_file,
             const uint8_t* begin,
             size_t size,
@@ -34,6 +37,20 @@ bool Verify(const DexFile* dex_file,
             bool verify_checksum,
             std::string* error_msg);
 
+// Verify the dex file using up to `num_threads` threads, including the calling thread. The
+// sections are checked in parallel where possible, but the result and the reported error are
+// the same as for sequential verification.
+bool Verify(const DexFile* dex_file,
+            const uint8_t* begin,
+            size_t size,
+            const char* location,
+            bool verify_checksum,
+            size_t num_threads,
+            std::string* error_msg);
+
+// Set the maximum number of threads used for verifying large dex files. The default is 1.
+void SetVerifierThreads(size_t num_threads);
+
 }  // namespace dex
 }  // namespace art
 
@@ -82,6 +82,20 @@ class DexFileVerifierTest : public testing::Test {
                                location,
                                kVerifyChecksum,
                                &error_msg);
+
+    // Verifying with multiple threads must give the same result and error message.
+    static constexpr size_t kNumThreads = 4u;
+    std::string parallel_error_msg;
+    bool parallel_success = dex::Verify(dex_file.get(),
+                                        dex_file->Begin(),
+                                        dex_file->Size(),
+                                        location,
+                                        kVerifyChecksum,
+                                        kNumThreads,
+                                        &parallel_error_msg);
+    EXPECT_EQ(success, parallel_success);
+    EXPECT_EQ(error_msg, parallel_error_msg);
+
     if (expected_error == nullptr) {
       EXPECT_TRUE(success) << error_msg;
     } else {
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dex_verification_cache.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include "android-base/file.h"
+#include "android-base/stringprintf.h"
+#include "base/file_utils.h"
+#include "base/logging.h"
+
+namespace art {
+
+using android::base::StringPrintf;
+
+namespace {
+
+// Sidecar file layout: a header followed by `num_records` records.
+struct SidecarHeader {
+  static constexpr uint8_t kMagic[4] = { 'd', 'v', 'c', '\n' };
+  static constexpr uint8_t kVersion[4] = { '0', '0', '2', '\0' };
+
+  uint8_t magic[4];
+  uint8_t version[4];
+  uint64_t zip_device;
+  uint64_t zip_inode;
+  uint64_t zip_size;
+  uint64_t zip_ctime_ns;
+  uint32_t num_records;
+  uint32_t padding;
+};
+
+struct SidecarRecord {
+  uint64_t entry_offset;
+  uint32_t entry_length;
+  uint32_t dex_checksum;
+  uint8_t dex_signature[DexFile::kSha1DigestSize];
+  uint32_t padding;
+};
+
+static_assert(sizeof(SidecarHeader) == 48u, "Unexpected SidecarHeader size");
+static_assert(sizeof(SidecarRecord) == 40u, "Unexpected SidecarRecord size");
+
+std::mutex g_directory_lock;
+std::string g_directory;
+
+bool HasSameZip(const SidecarHeader& header, const DexVerificationCache::Key& key) {
+  return header.zip_device == key.zip_device &&
+         header.zip_inode == key.zip_inode &&
+         header.zip_size == key.zip_size &&
+         header.zip_ctime_ns == key.zip_ctime_ns;
+}
+
+bool IsSameEntry(const SidecarRecord& record, const DexVerificationCache::Key& key) {
+  return record.entry_offset == key.entry_offset &&
+         record.entry_length == key.entry_length &&
+         record.dex_checksum == key.dex_checksum &&
+         memcmp(record.dex_signature, key.dex_signature, sizeof(key.dex_signature)) == 0;
+}
+
+// Read the records of the sidecar file for `key`. Returns an empty vector if the file does not
+// exist, is malformed or belongs to a different version of the zip file.
+std::vector<SidecarRecord> ReadRecords(const DexVerificationCache::Key& key) {
+  std::string content;
+  if (!android::base::ReadFileToString(key.sidecar_filename, &content)) {
+    return {};
+  }
+  SidecarHeader header;
+  if (content.size() < sizeof(header)) {
+    return {};
+  }
+  memcpy(&header, content.data(), sizeof(header));
+  if (memcmp(header.magic, SidecarHeader::kMagic, sizeof(header.magic)) != 0 ||
+      memcmp(header.version, SidecarHeader::kVersion, sizeof(header.version)) != 0 ||
+      header.num_records > DexVerificationCache::kMaxRecords ||
+      content.size() != sizeof(header) + header.num_records * sizeof(SidecarRecord) ||
+      !HasSameZip(header, key)) {
+    return {};
+  }
+  std::vector<SidecarRecord> records(header.num_records);
+  memcpy(records.data(), content.data() + sizeof(header), records.size() * sizeof(SidecarRecord));
+  return records;
+}
+
+}  // namespace
+
+void DexVerificationCache::SetDirectory(const std::string& directory) {
+  std::lock_guard<std::mutex> lock(g_directory_lock);
+  g_directory = directory;
+}
+
+std::string DexVerificationCache::GetDirectory() {
+  std::lock_guard<std::mutex> lock(g_directory_lock);
+  return g_directory;
+}
+
+bool DexVerificationCache::CreateKey(int zip_fd,
+                                     const std::string& zip_location,
+                                     uint64_t entry_offset,
+                                     const uint8_t* dex_data,
+                                     size_t dex_size,
+                                     /*out*/ Key* key) {
+#ifdef _WIN32
+  UNUSED(zip_fd, zip_location, entry_offset, dex_data, dex_size, key);
+  return false;
+#else
+  std::string directory = GetDirectory();
+  if (directory.empty() || zip_fd < 0) {
+    return false;
+  }
+  if (dex_size < sizeof(DexFile::Header) || dex_size > std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  std::string error_msg;
+  std::string filename;
+  if (!GetDalvikCacheFilename(zip_location.c_str(), directory.c_str(), &filename, &error_msg)) {
+    VLOG(dex) << "No dex verification cache for " << zip_location << ": " << error_msg;
+    return false;
+  }
+  struct stat zip_stat;
+  if (fstat(zip_fd, &zip_stat) != 0) {
+    PLOG(WARNING) << "Failed to stat " << zip_location;
+    return false;
+  }
+  key->sidecar_filename = ReplaceFileExtension(filename, "dvc");
+  key->zip_device = static_cast<uint64_t>(zip_stat.st_dev);
+  key->zip_inode = static_cast<uint64_t>(zip_stat.st_ino);
+  key->zip_size = static_cast<uint64_t>(zip_stat.st_size);
+  key->zip_ctime_ns = static_cast<uint64_t>(zip_stat.st_ctim.tv_sec) * UINT64_C(1000000000) +
+                      static_cast<uint64_t>(zip_stat.st_ctim.tv_nsec);
+  key->entry_offset = entry_offset;
+  key->entry_length = static_cast<uint32_t>(dex_size);
+  // Take the checksum and signature from the mapped data. The header may be unaligned.
+  DexFile::Header dex_header;
+  memcpy(&dex_header, dex_data, sizeof(dex_header));
+  key->dex_checksum = dex_header.checksum_;
+  memcpy(key->dex_signature, dex_header.signature_, sizeof(key->dex_signature));
+  return true;
+#endif
+}
+
+bool DexVerificationCache::IsVerified(const Key& key) {
+  for (const SidecarRecord& record : ReadRecords(key)) {
+    if (IsSameEntry(record, key)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void DexVerificationCache::RecordVerified(const Key& key) {
+#ifdef _WIN32
+  UNUSED(key);
+#else
+  std::vector<SidecarRecord> records = ReadRecords(key);
+  for (const SidecarRecord& record : records) {
+    if (IsSameEntry(record, key)) {
+      return;
+    }
+  }
+  if (records.size() == kMaxRecords) {
+    records.erase(records.begin());
+  }
+  SidecarRecord new_record = {};
+  new_record.entry_offset = key.entry_offset;
+  new_record.entry_length = key.entry_length;
+  new_record.dex_checksum = key.dex_checksum;
+  memcpy(new_record.dex_signature, key.dex_signature, sizeof(new_record.dex_signature));
+  records.push_back(new_record);
+
+  SidecarHeader header = {};
+  memcpy(header.magic, SidecarHeader::kMagic, sizeof(header.magic));
+  memcpy(header.version, SidecarHeader::kVersion, sizeof(header.version));
+  header.zip_device = key.zip_device;
+  header.zip_inode = key.zip_inode;
+  header.zip_size = key.zip_size;
+  header.zip_ctime_ns = key.zip_ctime_ns;
+  header.num_records = records.size();
+  std::string content(reinterpret_cast<const char*>(&header), sizeof(header));
+  content.append(reinterpret_cast<const char*>(records.data()),
+                 records.size() * sizeof(SidecarRecord));
+
+  // Write to a temporary file and rename it, so that concurrent readers in other processes
+  // never see a partially written file. Concurrent writers may lose each other's records.
+  std::string temp_filename = StringPrintf("%s.%d.tmp", key.sidecar_filename.c_str(), getpid());
+  if (!android::base::WriteStringToFile(content, temp_filename)) {
+    VLOG(dex) << "Failed to write dex verification cache " << temp_filename;
+    unlink(temp_filename.c_str());
+    return;
+  }
+  if (rename(temp_filename.c_str(), key.sidecar_filename.c_str()) != 0) {
+    PLOG(WARNING) << "Failed to rename dex verification cache to " << key.sidecar_filename;
+    unlink(temp_filename.c_str());
+  }
+#endif
+}
+
+}  // namespace art
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_LIBDEXFILE_DEX_DEX_VERIFICATION_CACHE_H_
+#define ART_LIBDEXFILE_DEX_DEX_VERIFICATION_CACHE_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "dex/dex_file.h"
+
+namespace art {
+
+// Cache of DexFileVerifier results for dex files stored uncompressed in zip archives (APKs).
+//
+// Dex files mapped directly from an APK without a usable oat/vdex file would otherwise be fully
+// verified on every open. After a successful verification, we record the zip entry in a small
+// sidecar file named after the APK in the cache directory, so that later opens of the same entry
+// (usually from later process starts) can skip the structural verification; the checksum is
+// still checked. Records are keyed by the identity of the APK file (device, inode, size, status
+// change time) and by the offset and length of the entry and the checksum and SHA-1 signature
+// read from the mapped dex header. All records of a sidecar file are dropped when the APK
+// identity changes. We use the status change time rather than the modification time because
+// the latter can be set to any value with utimensat(), while the former is updated by the
+// kernel on every write. Zip metadata such as the entry CRC32 is not used, as it comes from the
+// file itself and is not checked against the mapped data.
+//
+// The cache is disabled unless a directory is set with SetDirectory(). The directory must only
+// be writable by processes that are trusted to produce correct records.
+class DexVerificationCache {
+ public:
+  // Identifies an uncompressed dex file in a zip archive.
+  struct Key {
+    std::string sidecar_filename;
+    uint64_t zip_device = 0u;
+    uint64_t zip_inode = 0u;
+    uint64_t zip_size = 0u;
+    uint64_t zip_ctime_ns = 0u;
+    uint64_t entry_offset = 0u;
+    uint32_t entry_length = 0u;
+    uint32_t dex_checksum = 0u;
+    uint8_t dex_signature[DexFile::kSha1DigestSize] = {};
+  };
+
+  // Set the directory for the sidecar files. An empty directory disables the cache.
+  static void SetDirectory(const std::string& directory);
+  static std::string GetDirectory();
+
+  // Create the key for the entry at `entry_offset` of the zip file opened as `zip_fd`, which is
+  // mapped at `dex_data`, using the location of the zip file to name the sidecar file. Returns
+  // false if the cache is disabled or the key cannot be created, for example because the
+  // location is not absolute or the data is too small for a dex header.
+  static bool CreateKey(int zip_fd,
+                        const std::string& zip_location,
+                        uint64_t entry_offset,
+                        const uint8_t* dex_data,
+                        size_t dex_size,
+                        /*out*/ Key* key);
+
+  // Returns true if the entry has been recorded as successfully verified.
+  static bool IsVerified(const Key& key);
+
+  // Record that the entry was successfully verified. Failures to write the record are ignored.
+  static void RecordVerified(const Key& key);
+
+  // Maximum number of records per sidecar file; the oldest records are dropped first.
+  static constexpr size_t kMaxRecords = 64u;
+};
+
+}  // namespace art
+
+#endif  // ART_LIBDEXFILE_DEX_DEX_VERIFICATION_CACHE_H_
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dex_verification_cache.h"
+
+#include <string.h>
+#include <sys/stat.h>
+
+#include <vector>
+
+#include "base/common_art_test.h"
+#include "base/unix_file/fd_file.h"
+
+namespace art {
+
+class DexVerificationCacheTest : public CommonArtTest {
+ protected:
+  void TearDown() override {
+    DexVerificationCache::SetDirectory("");
+    CommonArtTest::TearDown();
+  }
+
+  // Creates a key for fake dex data whose header has the given checksum and a signature
+  // derived from `signature_seed`.
+  static bool CreateKey(const ScratchFile& zip,
+                        uint64_t offset,
+                        uint32_t checksum,
+                        DexVerificationCache::Key* key,
+                        uint8_t signature_seed = 0u) {
+    std::vector<uint8_t> dex_data(1000u);
+    DexFile::Header header;
+    header.checksum_ = checksum;
+    for (size_t i = 0; i != DexFile::kSha1DigestSize; ++i) {
+      header.signature_[i] = static_cast<uint8_t>(signature_seed + i);
+    }
+    memcpy(dex_data.data(), &header, sizeof(header));
+    return DexVerificationCache::CreateKey(
+        zip.GetFd(), zip.GetFilename(), offset, dex_data.data(), dex_data.size(), key);
+  }
+};
+
+TEST_F(DexVerificationCacheTest, DisabledByDefault) {
+  ScratchFile zip;
+  DexVerificationCache::Key key;
+  EXPECT_FALSE(CreateKey(zip, /*offset=*/ 64u, /*checksum=*/ 0x1234u, &key));
+}
+
+TEST_F(DexVerificationCacheTest, RecordAndLookup) {
+  ScratchDir cache_dir;
+  DexVerificationCache::SetDirectory(cache_dir.GetPath());
+  ScratchFile zip;
+  ASSERT_TRUE(zip.GetFile()->WriteFully("zip contents", 12u));
+
+  DexVerificationCache::Key key;
+  ASSERT_TRUE(CreateKey(zip, /*offset=*/ 64u, /*checksum=*/ 0x1234u, &key));
+  EXPECT_FALSE(DexVerificationCache::IsVerified(key));
+  DexVerificationCache::RecordVerified(key);
+  EXPECT_TRUE(DexVerificationCache::IsVerified(key));
+
+  // Other entries of the same zip file are not verified.
+  DexVerificationCache::Key other_offset_key;
+  ASSERT_TRUE(CreateKey(zip, /*offset=*/ 2048u, /*checksum=*/ 0x1234u, &other_offset_key));
+  EXPECT_FALSE(DexVerificationCache::IsVerified(other_offset_key));
+  DexVerificationCache::Key other_checksum_key;
+  ASSERT_TRUE(CreateKey(zip, /*offset=*/ 64u, /*checksum=*/ 0x4321u, &other_checksum_key));
+  EXPECT_FALSE(DexVerificationCache::IsVerified(other_checksum_key));
+  DexVerificationCache::Key other_signature_key;
+  ASSERT_TRUE(CreateKey(zip, /*offset=*/ 64u, /*checksum=*/ 0x1234u, &other_signature_key, 1u));
+  EXPECT_FALSE(DexVerificationCache::IsVerified(other_signature_key));
+
+  // Both entries are kept in the sidecar file.
+  DexVerificationCache::RecordVerified(other_offset_key);
+  EXPECT_TRUE(DexVerificationCache::IsVerified(key));
+  EXPECT_TRUE(DexVerificationCache::IsVerified(other_offset_key));
+
+  // Changing the zip file invalidates all records.
+  ASSERT_TRUE(zip.GetFile()->WriteFully("more", 4u));
+  DexVerificationCache::Key changed_key;
+  ASSERT_TRUE(CreateKey(zip, /*offset=*/ 64u, /*checksum=*/ 0x1234u, &changed_key));
+  EXPECT_FALSE(DexVerificationCache::IsVerified(changed_key));
+  DexVerificationCache::RecordVerified(changed_key);
+  EXPECT_TRUE(DexVerificationCache::IsVerified(changed_key));
+  EXPECT_FALSE(DexVerificationCache::IsVerified(other_offset_key));
+}
+
+TEST_F(DexVerificationCacheTest, KeyUsesStatusChangeTime) {
+  ScratchDir cache_dir;
+  DexVerificationCache::SetDirectory(cache_dir.GetPath());
+  ScratchFile zip;
+  ASSERT_TRUE(zip.GetFile()->WriteFully("zip contents", 12u));
+
+  // The modification time can be set to anything, so it must not be part of the key.
+  struct stat zip_stat;
+  ASSERT_EQ(0, fstat(zip.GetFd(), &zip_stat));
+  DexVerificationCache::Key key;
+  ASSERT_TRUE(CreateKey(zip, /*offset=*/ 64u, /*checksum=*/ 0x1234u, &key));
+  EXPECT_EQ(static_cast<uint64_t>(zip_stat.st_ctim.tv_sec) * UINT64_C(1000000000) +
+                static_cast<uint64_t>(zip_stat.st_ctim.tv_nsec),
+            key.zip_ctime_ns);
+  EXPECT_EQ(static_cast<uint64_t>(zip_stat.st_ino), key.zip_inode);
+  EXPECT_EQ(12u, key.zip_size);
+}
+
+TEST_F(DexVerificationCacheTest, RelativeLocation) {
+  ScratchDir cache_dir;
+  DexVerificationCache::SetDirectory(cache_dir.GetPath());
+  ScratchFile zip;
+  std::vector<uint8_t> dex_data(1000u);
+  DexVerificationCache::Key key;
+  EXPECT_FALSE(DexVerificationCache::CreateKey(
+      zip.GetFd(), "relative.apk", /*entry_offset=*/ 64u, dex_data.data(), dex_data.size(), &key));
+}
+
+TEST_F(DexVerificationCacheTest, TooSmallForDexHeader) {
+  ScratchDir cache_dir;
+  DexVerificationCache::SetDirectory(cache_dir.GetPath());
+  ScratchFile zip;
+  std::vector<uint8_t> dex_data(sizeof(DexFile::Header) - 1u);
+  DexVerificationCache::Key key;
+  EXPECT_FALSE(DexVerificationCache::CreateKey(zip.GetFd(),
+                                               zip.GetFilename(),
+                                               /*entry_offset=*/ 64u,
+                                               dex_data.data(),
+                                               dex_data.size(),
+                                               &key));
+}
+
+TEST_F(DexVerificationCacheTest, MaxRecords) {
+  ScratchDir cache_dir;
+  DexVerificationCache::SetDirectory(cache_dir.GetPath());
+  ScratchFile zip;
+  std::vector<DexVerificationCache::Key> keys(DexVerificationCache::kMaxRecords + 1u);
+  for (size_t i = 0; i != keys.size(); ++i) {
+    ASSERT_TRUE(CreateKey(zip, /*offset=*/ 64u * i, /*checksum=*/ i, &keys[i]));
+    DexVerificationCache::RecordVerified(keys[i]);
+  }
+  // The oldest record was dropped.
+  EXPECT_FALSE(DexVerificationCache::IsVerified(keys[0]));
+  for (size_t i = 1; i != keys.size(); ++i) {
+    EXPECT_TRUE(DexVerificationCache::IsVerified(keys[i])) << i;
+  }
+}
+
+}  // namespace art
@@ -16,9 +16,16 @@
 
 #include "type_lookup_table.h"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #include "base/bit_utils.h"
 #include "base/leb128.h"
 #include "dex/dex_file-inl.h"
@@ -30,128 +37,112 @@ static inline bool ModifiedUtf8StringEquals(const char* lhs, const char* rhs) {
   return CompareModifiedUtf8ToModifiedUtf8AsUtf16CodePointValues(lhs, rhs) == 0;
 }
 
+// Helpers for matching the tags of a group of TypeLookupTable::kGroupSize slots. The returned
+// mask has one set bit per matching slot at bit position `slot << kMatchShift`.
+#if defined(__SSE2__)
+static constexpr size_t kMatchShift = 0u;
+
+ALWAYS_INLINE static inline uint64_t MatchTags(const uint8_t* group, uint8_t tag) {
+  __m128i tags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+  __m128i eq = _mm_cmpeq_epi8(tags, _mm_set1_epi8(static_cast<char>(tag)));
+  return static_cast<uint32_t>(_mm_movemask_epi8(eq));
+}
+#elif defined(__aarch64__)
+static constexpr size_t kMatchShift = 2u;
+
+ALWAYS_INLINE static inline uint64_t MatchTags(const uint8_t* group, uint8_t tag) {
+  uint8x16_t eq = vceqq_u8(vld1q_u8(group), vdupq_n_u8(tag));
+  // Narrow each byte of the comparison result to a nibble and keep one bit per nibble.
+  uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+  return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) & UINT64_C(0x8888888888888888);
+}
+#else
+static constexpr size_t kMatchShift = 0u;
+
+ALWAYS_INLINE static inline uint64_t MatchTags(const uint8_t* group, uint8_t tag) {
+  uint64_t result = 0u;
+  for (size_t i = 0; i != TypeLookupTable::kGroupSize; ++i) {
+    result |= static_cast<uint64_t>(group[i] == tag) << i;
+  }
+  return result;
+}
+#endif
+
+ALWAYS_INLINE static inline uint32_t MatchedSlot(uint64_t match) {
+  DCHECK_NE(match, 0u);
+  return static_cast<uint32_t>(CTZ(match)) >> kMatchShift;
+}
+
 TypeLookupTable TypeLookupTable::Create(const DexFile& dex_file) {
   uint32_t num_class_defs = dex_file.NumClassDefs();
   if (UNLIKELY(!SupportedSize(num_class_defs))) {
     return TypeLookupTable();
   }
-  size_t mask_bits = CalculateMaskBits(num_class_defs);
-  size_t size = 1u << mask_bits;
-  std::unique_ptr<Entry[]> owned_entries(new Entry[size]);
-  Entry* entries = owned_entries.get();
-
+  uint32_t capacity = CalculateCapacity(num_class_defs);
+  std::unique_ptr<uint8_t[]> owned_data(new uint8_t[RawDataLengthForCapacity(capacity)]());
+  uint8_t* tags = owned_data.get();
   static_assert(alignof(Entry) == 4u, "Expecting Entry to be 4-byte aligned.");
-  const uint32_t mask = Entry::GetMask(mask_bits);
-  std::vector<uint16_t> conflict_class_defs;
-  // The first stage. Put elements on their initial positions. If an initial position is already
-  // occupied then delay the insertion of the element to the second stage to reduce probing
-  // distance.
-  for (size_t class_def_idx = 0; class_def_idx < dex_file.NumClassDefs(); ++class_def_idx) {
-    const dex::ClassDef& class_def = dex_file.GetClassDef(class_def_idx);
-    const dex::TypeId& type_id = dex_file.GetTypeId(class_def.class_idx_);
-    const dex::StringId& str_id = dex_file.GetStringId(type_id.descriptor_idx_);
-    const uint32_t hash = ComputeModifiedUtf8Hash(dex_file.GetStringData(str_id));
-    const uint32_t pos = hash & mask;
-    if (entries[pos].IsEmpty()) {
-      entries[pos] = Entry(str_id.string_data_off_, hash, class_def_idx, mask_bits);
-      DCHECK(entries[pos].IsLast(mask_bits));
-    } else {
-      conflict_class_defs.push_back(class_def_idx);
-    }
-  }
-  // The second stage. The initial position of these elements had a collision. Put these elements
-  // into the nearest free cells and link them together by updating next_pos_delta.
-  for (uint16_t class_def_idx : conflict_class_defs) {
+  static_assert(sizeof(Entry) == 8u, "Expecting Entry to be 8 bytes.");
+  Entry* entries = reinterpret_cast<Entry*>(tags + capacity);
+
+  const uint32_t group_mask = capacity / kGroupSize - 1u;
+  for (size_t class_def_idx = 0; class_def_idx < num_class_defs; ++class_def_idx) {
     const dex::ClassDef& class_def = dex_file.GetClassDef(class_def_idx);
     const dex::TypeId& type_id = dex_file.GetTypeId(class_def.class_idx_);
     const dex::StringId& str_id = dex_file.GetStringId(type_id.descriptor_idx_);
     const uint32_t hash = ComputeModifiedUtf8Hash(dex_file.GetStringData(str_id));
-    // Find the last entry in the chain.
-    uint32_t tail_pos = hash & mask;
-    DCHECK(!entries[tail_pos].IsEmpty());
-    while (!entries[tail_pos].IsLast(mask_bits)) {
-      tail_pos = (tail_pos + entries[tail_pos].GetNextPosDelta(mask_bits)) & mask;
-      DCHECK(!entries[tail_pos].IsEmpty());
+    // Find the first empty slot, starting with the home group. The capacity is always larger
+    // than the number of class defs, so this terminates.
+    uint32_t group = hash & group_mask;
+    uint64_t empty;
+    while ((empty = MatchTags(tags + group * kGroupSize, kEmptyTag)) == 0u) {
+      group = (group + 1u) & group_mask;
     }
-    // Find an empty entry for insertion.
-    uint32_t insert_pos = tail_pos;
-    do {
-      insert_pos = (insert_pos + 1) & mask;
-    } while (!entries[insert_pos].IsEmpty());
-    // Insert and chain the new entry.
-    entries[insert_pos] = Entry(str_id.string_data_off_, hash, class_def_idx, mask_bits);
-    entries[tail_pos].SetNextPosDelta((insert_pos - tail_pos) & mask, mask_bits);
-    DCHECK(entries[insert_pos].IsLast(mask_bits));
-    DCHECK(!entries[tail_pos].IsLast(mask_bits));
+    const uint32_t slot = group * kGroupSize + MatchedSlot(empty);
+    tags[slot] = GetTag(hash);
+    entries[slot] = Entry(str_id.string_data_off_, hash, class_def_idx);
   }
 
-  return TypeLookupTable(dex_file.DataBegin(), mask_bits, entries, std::move(owned_entries));
+  return TypeLookupTable(dex_file.DataBegin(), capacity, tags, std::move(owned_data));
 }
 
 TypeLookupTable TypeLookupTable::Open(const uint8_t* dex_data_pointer,
                                       const uint8_t* raw_data,
                                       uint32_t num_class_defs) {
   DCHECK_ALIGNED(raw_data, alignof(Entry));
-  const Entry* entries = reinterpret_cast<const Entry*>(raw_data);
-  size_t mask_bits = CalculateMaskBits(num_class_defs);
-  return TypeLookupTable(dex_data_pointer, mask_bits, entries, /* owned_entries= */ nullptr);
+  uint32_t capacity = CalculateCapacity(num_class_defs);
+  return TypeLookupTable(dex_data_pointer, capacity, raw_data, /* owned_data= */ nullptr);
 }
 
 uint32_t TypeLookupTable::Lookup(const char* str, uint32_t hash) const {
-  uint32_t mask = Entry::GetMask(mask_bits_);
-  uint32_t pos = hash & mask;
-  // Thanks to special insertion algorithm, the element at position pos can be empty
-  // or start of the right bucket, or anywhere in the wrong bucket's chain.
-  const Entry* entry = &entries_[pos];
-  if (entry->IsEmpty()) {
-    return dex::kDexNoIndex;
-  }
-  // Look for the partial hash match first, even if traversing the wrong bucket's chain.
-  uint32_t compared_hash_bits = static_cast<uint64_t>(hash << mask_bits_) >> (2 * mask_bits_);
-  while (compared_hash_bits != entry->GetHashBits(mask_bits_)) {
-    if (entry->IsLast(mask_bits_)) {
+  const uint32_t group_mask = capacity_ / kGroupSize - 1u;
+  const uint8_t tag = GetTag(hash);
+  uint32_t group = hash & group_mask;
+  // Probe groups until we find one with an empty slot. Every group is visited at most once.
+  for (uint32_t probes = 0; probes <= group_mask; ++probes) {
+    const uint8_t* group_tags = tags_ + group * kGroupSize;
+    for (uint64_t match = MatchTags(group_tags, tag); match != 0u; match &= match - 1u) {
+      // Compare the additional hash bits stored in the table before the string itself.
+      const Entry& entry = entries_[group * kGroupSize + MatchedSlot(match)];
+      if (entry.MatchesHashBits(hash) && ModifiedUtf8StringEquals(str, GetStringData(entry))) {
+        return entry.GetClassDefIdx();
+      }
+    }
+    if (MatchTags(group_tags, kEmptyTag) != 0u) {
       return dex::kDexNoIndex;
     }
-    pos = (pos + entry->GetNextPosDelta(mask_bits_)) & mask;
-    entry = &entries_[pos];
-    DCHECK(!entry->IsEmpty());
+    group = (group + 1u) & group_mask;
   }
-  // Found partial hash match, compare strings (expecting this to succeed).
-  const char* first_checked_str = GetStringData(*entry);
-  if (ModifiedUtf8StringEquals(str, first_checked_str)) {
-    return entry->GetClassDefIdx(mask_bits_);
-  }
-  // If we're at the end of the chain, return before doing further expensive work.
-  if (entry->IsLast(mask_bits_)) {
-    return dex::kDexNoIndex;
-  }
-  // Check if we're traversing the right bucket. This is important if the compared
-  // partial hash has only a few bits (i.e. it can match frequently).
-  if (((ComputeModifiedUtf8Hash(first_checked_str) ^ hash) & mask) != 0u) {
-    return dex::kDexNoIndex;  // Low hash bits mismatch.
-  }
-  // Continue looking for the string in the rest of the chain.
-  do {
-    pos = (pos + entry->GetNextPosDelta(mask_bits_)) & mask;
-    entry = &entries_[pos];
-    DCHECK(!entry->IsEmpty());
-    if (compared_hash_bits == entry->GetHashBits(mask_bits_) &&
-        ModifiedUtf8StringEquals(str, GetStringData(*entry))) {
-      return entry->GetClassDefIdx(mask_bits_);
-    }
-  } while (!entry->IsLast(mask_bits_));
   // Not found.
   return dex::kDexNoIndex;
 }
 
 void TypeLookupTable::Dump(std::ostream& os) const {
-  size_t size = 1u << mask_bits_;
-  for (uint32_t i = 0; i < size; i++) {
-    const Entry& entry = entries_[i];
-    if (entry.IsEmpty()) {
+  for (uint32_t i = 0; i < capacity_; i++) {
+    if (tags_[i] == kEmptyTag) {
       os << i << ": empty";
     } else {
-      const char* first_checked_str = GetStringData(entry);
+      const char* first_checked_str = GetStringData(entries_[i]);
       os << i << ": " << std::string(first_checked_str);
     }
     os << '\n';
@@ -159,11 +150,23 @@ void TypeLookupTable::Dump(std::ostream& os) const {
 }
 
 uint32_t TypeLookupTable::RawDataLength(uint32_t num_class_defs) {
-  return SupportedSize(num_class_defs) ? RoundUpToPowerOfTwo(num_class_defs) * sizeof(Entry) : 0u;
+  return SupportedSize(num_class_defs)
+      ? RawDataLengthForCapacity(CalculateCapacity(num_class_defs))
+      : 0u;
 }
 
-uint32_t TypeLookupTable::CalculateMaskBits(uint32_t num_class_defs) {
-  return SupportedSize(num_class_defs) ? MinimumBitsToStore(num_class_defs - 1u) : 0u;
+uint32_t TypeLookupTable::RawDataLengthForCapacity(uint32_t capacity) {
+  return capacity * (sizeof(uint8_t) + sizeof(Entry));
+}
+
+uint32_t TypeLookupTable::CalculateCapacity(uint32_t num_class_defs) {
+  if (!SupportedSize(num_class_defs)) {
+    return 0u;
+  }
+  // Keep the load factor at or below 7/8 so that probe sequences stay short
+  // and there is always an empty slot to terminate unsuccessful lookups.
+  uint32_t min_capacity = num_class_defs + num_class_defs / 7u + 1u;
+  return std::max(kGroupSize, RoundUpToPowerOfTwo(min_capacity));
 }
 
 bool TypeLookupTable::SupportedSize(uint32_t num_class_defs) {
@@ -171,13 +174,14 @@ bool TypeLookupTable::SupportedSize(uint32_t num_class_defs) {
 }
 
 TypeLookupTable::TypeLookupTable(const uint8_t* dex_data_pointer,
-                                 uint32_t mask_bits,
-                                 const Entry* entries,
-                                 std::unique_ptr<Entry[]> owned_entries)
+                                 uint32_t capacity,
+                                 const uint8_t* raw_data,
+                                 std::unique_ptr<uint8_t[]> owned_data)
     : dex_data_begin_(dex_data_pointer),
-      mask_bits_(mask_bits),
-      entries_(entries),
-      owned_entries_(std::move(owned_entries)) {}
+      capacity_(capacity),
+      tags_(raw_data),
+      entries_(reinterpret_cast<const Entry*>(raw_data + capacity)),
+      owned_data_(std::move(owned_data)) {}
 
 const char* TypeLookupTable::GetStringData(const Entry& entry) const {
   DCHECK(dex_data_begin_ != nullptr);
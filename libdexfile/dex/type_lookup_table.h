@@ -17,8 +17,11 @@
 #ifndef ART_LIBDEXFILE_DEX_TYPE_LOOKUP_TABLE_H_
 #define ART_LIBDEXFILE_DEX_TYPE_LOOKUP_TABLE_H_
 
+#include <memory>
+
 #include <android-base/logging.h>
 
+#include "base/casts.h"
 #include "dex/dex_file_types.h"
 
 namespace art {
@@ -31,9 +34,26 @@ class DexFile;
  * This class instantiated at compile time by calling Create() method and written into OAT file.
  * At runtime, the raw data is read from memory-mapped file by calling Open() method. The table
  * memory remains clean.
+ *
+ * The table is an open-addressing hash table with groups of kGroupSize slots. Each slot has a
+ * one-byte tag in a separate tag array (zero for an empty slot, otherwise 0x80 | 7 bits of the
+ * hash) and an Entry with the string offset, class def index and 16 more hash bits. A lookup
+ * compares the tags of a whole group at once (with SIMD where available) and checks the entry
+ * hash bits before touching the dex string data, so most failed lookups, such as those for
+ * classes defined in other dex files of a multi-dex class loader, are answered from the table
+ * alone. Probing stops at the first group with an empty slot; the table is never full.
+ *
+ * Raw data layout (the size depends only on the number of class defs):
+ *   uint8_t tags[capacity];
+ *   Entry entries[capacity];
+ *
+ * Note: Changes to the layout require updating the vdex version.
  */
 class TypeLookupTable {
  public:
+  // Number of slots whose tags are checked together.
+  static constexpr uint32_t kGroupSize = 16u;
+
   // Method creates lookup table for dex file.
   static TypeLookupTable Create(const DexFile& dex_file);
 
@@ -46,9 +66,10 @@ class TypeLookupTable {
   // Create an invalid lookup table.
   TypeLookupTable()
       : dex_data_begin_(nullptr),
-        mask_bits_(0u),
+        capacity_(0u),
+        tags_(nullptr),
         entries_(nullptr),
-        owned_entries_(nullptr) {}
+        owned_data_(nullptr) {}
 
   TypeLookupTable(TypeLookupTable&& src) noexcept = default;
   TypeLookupTable& operator=(TypeLookupTable&& src) noexcept = default;
@@ -59,13 +80,13 @@ class TypeLookupTable {
 
   // Returns whether the TypeLookupTable is valid.
   bool Valid() const {
-    return entries_ != nullptr;
+    return tags_ != nullptr;
   }
 
-  // Return the number of buckets in the lookup table.
+  // Return the number of slots in the lookup table.
   uint32_t Size() const {
     DCHECK(Valid());
-    return 1u << mask_bits_;
+    return capacity_;
   }
 
   // Method search class_def_idx by class descriptor and it's hash.
@@ -75,13 +96,13 @@ class TypeLookupTable {
   // Method returns pointer to binary data of lookup table. Used by the oat writer.
   const uint8_t* RawData() const {
     DCHECK(Valid());
-    return reinterpret_cast<const uint8_t*>(entries_);
+    return tags_;
   }
 
   // Method returns length of binary data. Used by the oat writer.
   uint32_t RawDataLength() const {
     DCHECK(Valid());
-    return Size() * sizeof(Entry);
+    return RawDataLengthForCapacity(capacity_);
   }
 
   // Method returns length of binary data for the specified number of class definitions.
@@ -90,92 +111,64 @@ class TypeLookupTable {
   void Dump(std::ostream& os) const;
 
  private:
-  /**
-   * To find element we need to compare strings.
-   * It is faster to compare first hashes and then strings itself.
-   * But we have no full hash of element of table. But we can use 2 ideas.
-   * 1. All minor bits of hash inside one bucket are equal.
-   *    (TODO: We're not actually using this, are we?)
-   * 2. If the dex file contains N classes and the size of the hash table is 2^n (where N <= 2^n)
-   *    then we need n bits for the class def index and n bits for the next position delta.
-   *    So we can encode part of element's hash into the remaining 32-2*n (n <= 16) bits which
-   *    would be otherwise wasted as a padding.
-   * So hash of element can be divided on three parts:
-   *     XXXX XXXX XXXY YYYY YYYY YZZZ ZZZZ ZZZZ  (example with n=11)
-   *     Z - a part of hash encoded implicitly in the bucket index
-   *         (these bits are same for all elements in bucket)
-   *     Y - a part of hash that we can write into free 32-2*n bits
-   *     X - a part of hash that we can't use without increasing the size of the entry
-   * So the `data` element of Entry is used to store the next position delta, class_def_index
-   * and a part of hash of the entry.
-   */
   class Entry {
    public:
-    Entry() : str_offset_(0u), data_(0u) {}
-    Entry(uint32_t str_offset, uint32_t hash, uint32_t class_def_index, uint32_t mask_bits)
+    Entry() : str_offset_(0u), class_def_idx_(0u), hash_bits_(0u) {}
+    Entry(uint32_t str_offset, uint32_t hash, uint32_t class_def_idx)
         : str_offset_(str_offset),
-          data_(((hash & ~GetMask(mask_bits)) | class_def_index) << mask_bits) {
-      DCHECK_EQ(class_def_index & ~GetMask(mask_bits), 0u);
-    }
-
-    void SetNextPosDelta(uint32_t next_pos_delta, uint32_t mask_bits) {
-      DCHECK_EQ(GetNextPosDelta(mask_bits), 0u);
-      DCHECK_EQ(next_pos_delta & ~GetMask(mask_bits), 0u);
-      DCHECK_NE(next_pos_delta, 0u);
-      data_ |= next_pos_delta;
-    }
-
-    bool IsEmpty() const {
-      return str_offset_ == 0u;
-    }
-
-    bool IsLast(uint32_t mask_bits) const {
-      return GetNextPosDelta(mask_bits) == 0u;
-    }
+          class_def_idx_(dchecked_integral_cast<uint16_t>(class_def_idx)),
+          hash_bits_(GetHashBits(hash)) {}
 
     uint32_t GetStringOffset() const {
       return str_offset_;
     }
 
-    uint32_t GetNextPosDelta(uint32_t mask_bits) const {
-      return data_ & GetMask(mask_bits);
+    uint32_t GetClassDefIdx() const {
+      return class_def_idx_;
     }
 
-    uint32_t GetClassDefIdx(uint32_t mask_bits) const {
-      return (data_ >> mask_bits) & GetMask(mask_bits);
+    bool MatchesHashBits(uint32_t hash) const {
+      return hash_bits_ == GetHashBits(hash);
     }
 
-    uint32_t GetHashBits(uint32_t mask_bits) const {
-      DCHECK_LE(mask_bits, 16u);
-      return static_cast<uint64_t>(data_) >> (2u * mask_bits);
-    }
-
-    static uint32_t GetMask(uint32_t mask_bits) {
-      DCHECK_LE(mask_bits, 16u);
-      return ~(std::numeric_limits<uint32_t>::max() << mask_bits);
+   private:
+    // The upper half of the hash. The group index uses the low bits and the tag is derived
+    // from a mix of all bits, so this filters most tag collisions.
+    static uint16_t GetHashBits(uint32_t hash) {
+      return static_cast<uint16_t>(hash >> 16);
     }
 
-   private:
     uint32_t str_offset_;
-    uint32_t data_;
+    uint16_t class_def_idx_;
+    uint16_t hash_bits_;
   };
 
-  static uint32_t CalculateMaskBits(uint32_t num_class_defs);
+  static constexpr uint8_t kEmptyTag = 0u;
+
+  static uint8_t GetTag(uint32_t hash) {
+    // Use the top bits of a multiplicative mix. The polynomial hash of short descriptors
+    // leaves its own top bits mostly clear.
+    return static_cast<uint8_t>(0x80u | ((hash * 0x9e3779b1u) >> 25));
+  }
+
+  static uint32_t CalculateCapacity(uint32_t num_class_defs);
+  static uint32_t RawDataLengthForCapacity(uint32_t capacity);
   static bool SupportedSize(uint32_t num_class_defs);
 
   // Construct the TypeLookupTable.
   TypeLookupTable(const uint8_t* dex_data_pointer,
-                  uint32_t mask_bits,
-                  const Entry* entries,
-                  std::unique_ptr<Entry[]> owned_entries);
+                  uint32_t capacity,
+                  const uint8_t* raw_data,
+                  std::unique_ptr<uint8_t[]> owned_data);
 
   const char* GetStringData(const Entry& entry) const;
 
   const uint8_t* dex_data_begin_;
-  uint32_t mask_bits_;
+  uint32_t capacity_;
+  const uint8_t* tags_;
   const Entry* entries_;
-  // `owned_entries_` is either null (not owning `entries_`) or same pointer as `entries_`.
-  std::unique_ptr<Entry[]> owned_entries_;
+  // `owned_data_` is either null (not owning `tags_`) or same pointer as `tags_`.
+  std::unique_ptr<uint8_t[]> owned_data_;
 };
 
 }  // namespace art
@@ -33,7 +33,52 @@ TEST_F(TypeLookupTableTest, CreateLookupTable) {
   TypeLookupTable table = TypeLookupTable::Create(*dex_file);
   ASSERT_TRUE(table.Valid());
   ASSERT_NE(nullptr, table.RawData());
-  ASSERT_EQ(32U, table.RawDataLength());
+  // One group of 16 slots, each with a one-byte tag and an 8-byte entry.
+  ASSERT_EQ(16U * 9U, table.RawDataLength());
+  ASSERT_EQ(table.RawDataLength(), TypeLookupTable::RawDataLength(dex_file->NumClassDefs()));
+}
+
+TEST_F(TypeLookupTableTest, OpenRawData) {
+  std::unique_ptr<const DexFile> dex_file(OpenTestDexFile("Lookup"));
+  TypeLookupTable created = TypeLookupTable::Create(*dex_file);
+  ASSERT_TRUE(created.Valid());
+  TypeLookupTable opened = TypeLookupTable::Open(
+      dex_file->DataBegin(), created.RawData(), dex_file->NumClassDefs());
+  ASSERT_TRUE(opened.Valid());
+  ASSERT_EQ(created.Size(), opened.Size());
+  for (uint32_t i = 0; i != dex_file->NumClassDefs(); ++i) {
+    const char* descriptor = dex_file->GetClassDescriptor(dex_file->GetClassDef(i));
+    ASSERT_EQ(i, opened.Lookup(descriptor, ComputeModifiedUtf8Hash(descriptor)));
+  }
+}
+
+// Checks the lookups done by a multi-dex class loader over larger tables: every descriptor is
+// found in its own dex file, and descriptors that are not defined anywhere are never found.
+TEST_F(TypeLookupTableTest, LookupInLargeTables) {
+  std::vector<std::unique_ptr<const DexFile>> dex_files;
+  for (const std::string& name : GetLibCoreDexFileNames()) {
+    for (std::unique_ptr<const DexFile>& dex_file : OpenDexFiles(name.c_str())) {
+      dex_files.push_back(std::move(dex_file));
+    }
+  }
+  ASSERT_FALSE(dex_files.empty());
+  std::vector<TypeLookupTable> tables;
+  for (const std::unique_ptr<const DexFile>& dex_file : dex_files) {
+    tables.push_back(TypeLookupTable::Create(*dex_file));
+    ASSERT_TRUE(tables.back().Valid());
+  }
+  for (size_t i = 0; i != dex_files.size(); ++i) {
+    const DexFile& dex_file = *dex_files[i];
+    for (uint32_t class_def_idx = 0; class_def_idx != dex_file.NumClassDefs(); ++class_def_idx) {
+      const char* descriptor = dex_file.GetClassDescriptor(dex_file.GetClassDef(class_def_idx));
+      ASSERT_EQ(class_def_idx, tables[i].Lookup(descriptor, ComputeModifiedUtf8Hash(descriptor)));
+      std::string missing = std::string(descriptor, strlen(descriptor) - 1u) + "$Missing;";
+      uint32_t missing_hash = ComputeModifiedUtf8Hash(missing.c_str());
+      for (const TypeLookupTable& table : tables) {
+        ASSERT_EQ(dex::kDexNoIndex, table.Lookup(missing.c_str(), missing_hash)) << missing;
+      }
+    }
+  }
 }
 
 TEST_P(TypeLookupTableTest, Find) {
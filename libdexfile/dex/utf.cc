@@ -16,10 +16,20 @@
 
 #include "utf.h"
 
+#include <array>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
 
+#include "base/bit_utils.h"
 #include "base/casts.h"
 #include "utf-inl.h"
 
@@ -27,6 +37,156 @@ namespace art {
 
 using android::base::StringAppendF;
 
+// SIMD helpers for the conversion and counting routines below. They only deal with runs of
+// one-byte (ASCII) characters and leave multi-byte sequences, surrogates and the modified UTF-8
+// encoding of U+0000 to the scalar code. WidenAscii() and NarrowAscii() are also used for the
+// all-ASCII fast paths where the caller vouches for the data; for non-ASCII input that breaks
+// this contract they produce the same values as the scalar casts, i.e. `char` is widened
+// according to its signedness and UTF-16 chars are truncated to their low byte.
+
+// Returns the number of leading bytes in `utf8[0, length)` that have the high bit clear.
+static inline size_t CountAsciiPrefix(const char* utf8, size_t length) {
+  // Avoid the vector setup for isolated ASCII characters in non-ASCII heavy text.
+  if (length == 0u || (static_cast<uint8_t>(utf8[0]) & 0x80u) != 0u) {
+    return 0u;
+  }
+  size_t i = 0u;
+#if defined(__AVX2__)
+  for (; i + 32u <= length; i += 32u) {
+    __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(utf8 + i));
+    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(data));
+    if (mask != 0u) {
+      return i + CTZ(mask);
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  for (; i + 16u <= length; i += 16u) {
+    __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf8 + i));
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(data));
+    if (mask != 0u) {
+      return i + CTZ(mask);
+    }
+  }
+#elif defined(__aarch64__)
+  for (; i + 16u <= length; i += 16u) {
+    uint8x16_t data = vld1q_u8(reinterpret_cast<const uint8_t*>(utf8 + i));
+    if (vmaxvq_u8(data) >= 0x80u) {
+      break;  // Let the scalar loop below find the exact position.
+    }
+  }
+#endif
+  while (i != length && (static_cast<uint8_t>(utf8[i]) & 0x80u) == 0u) {
+    ++i;
+  }
+  return i;
+}
+
+// Returns the number of leading chars in `utf16[0, length)` that are in the range [1, 0x7f],
+// i.e. that are encoded as a single byte in modified UTF-8.
+static inline size_t CountAsciiPrefix(const uint16_t* utf16, size_t length) {
+  // Avoid the vector setup for isolated ASCII characters in non-ASCII heavy text.
+  if (length == 0u || utf16[0] == 0u || utf16[0] >= 0x80u) {
+    return 0u;
+  }
+  size_t i = 0u;
+#if defined(__AVX2__)
+  const __m256i high_bits256 = _mm256_set1_epi16(static_cast<int16_t>(0xff80));
+  const __m256i zero256 = _mm256_setzero_si256();
+  for (; i + 16u <= length; i += 16u) {
+    __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(utf16 + i));
+    __m256i ok = _mm256_andnot_si256(
+        _mm256_cmpeq_epi16(data, zero256),
+        _mm256_cmpeq_epi16(_mm256_and_si256(data, high_bits256), zero256));
+    uint32_t bad = ~static_cast<uint32_t>(_mm256_movemask_epi8(ok));
+    if (bad != 0u) {
+      return i + CTZ(bad) / 2u;
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  const __m128i high_bits = _mm_set1_epi16(static_cast<int16_t>(0xff80));
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 8u <= length; i += 8u) {
+    __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf16 + i));
+    __m128i ok = _mm_andnot_si128(_mm_cmpeq_epi16(data, zero),
+                                  _mm_cmpeq_epi16(_mm_and_si128(data, high_bits), zero));
+    uint32_t bad = static_cast<uint32_t>(_mm_movemask_epi8(ok)) ^ 0xffffu;
+    if (bad != 0u) {
+      return i + CTZ(bad) / 2u;
+    }
+  }
+#elif defined(__aarch64__)
+  const uint16x8_t one = vdupq_n_u16(1u);
+  const uint16x8_t limit = vdupq_n_u16(0x7fu);
+  for (; i + 8u <= length; i += 8u) {
+    uint16x8_t data = vld1q_u16(utf16 + i);
+    // `ch - 1 < 0x7f` (unsigned) is true exactly for `ch` in [1, 0x7f].
+    if (vminvq_u16(vcltq_u16(vsubq_u16(data, one), limit)) == 0u) {
+      break;  // Let the scalar loop below find the exact position.
+    }
+  }
+#endif
+  while (i != length && utf16[i] != 0u && utf16[i] < 0x80u) {
+    ++i;
+  }
+  return i;
+}
+
+// Widens `length` ASCII bytes to UTF-16 chars.
+static inline void WidenAscii(uint16_t* utf16_out, const char* utf8_in, size_t length) {
+  size_t i = 0u;
+#if defined(__SSE2__)
+  static_assert(std::is_signed_v<char>, "x86 char is expected to be signed");
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16u <= length; i += 16u) {
+    __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf8_in + i));
+    // Sign-extend like the scalar `char` to `uint16_t` conversion.
+    __m128i sign = _mm_cmpgt_epi8(zero, data);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(utf16_out + i), _mm_unpacklo_epi8(data, sign));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(utf16_out + i + 8u),
+                     _mm_unpackhi_epi8(data, sign));
+  }
+#elif defined(__aarch64__)
+  static_assert(std::is_unsigned_v<char>, "aarch64 char is expected to be unsigned");
+  for (; i + 16u <= length; i += 16u) {
+    uint8x16_t data = vld1q_u8(reinterpret_cast<const uint8_t*>(utf8_in + i));
+    vst1q_u16(utf16_out + i, vmovl_u8(vget_low_u8(data)));
+    vst1q_u16(utf16_out + i + 8u, vmovl_high_u8(data));
+  }
+#endif
+  for (; i != length; ++i) {
+    // Safe even if char is signed because ASCII characters always have
+    // the high bit cleared.
+    utf16_out[i] = dchecked_integral_cast<uint16_t>(utf8_in[i]);
+  }
+}
+
+// Narrows `length` UTF-16 chars in the range [0, 0x7f] to ASCII bytes.
+static inline void NarrowAscii(char* utf8_out, const uint16_t* utf16_in, size_t length) {
+  size_t i = 0u;
+#if defined(__SSE2__)
+  // Clear the high bytes so that the saturating pack truncates like the scalar cast.
+  const __m128i low_byte = _mm_set1_epi16(0xff);
+  for (; i + 16u <= length; i += 16u) {
+    __m128i lo = _mm_and_si128(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf16_in + i)), low_byte);
+    __m128i hi = _mm_and_si128(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf16_in + i + 8u)), low_byte);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(utf8_out + i), _mm_packus_epi16(lo, hi));
+  }
+#elif defined(__aarch64__)
+  for (; i + 16u <= length; i += 16u) {
+    uint8x8_t lo = vmovn_u16(vld1q_u16(utf16_in + i));
+    uint8x16_t data = vmovn_high_u16(lo, vld1q_u16(utf16_in + i + 8u));
+    vst1q_u8(reinterpret_cast<uint8_t*>(utf8_out + i), data);
+  }
+#endif
+  for (; i != length; ++i) {
+    utf8_out[i] = dchecked_integral_cast<char>(utf16_in[i]);
+  }
+}
+
 // This is used only from debugger and test code.
 size_t CountModifiedUtf8Chars(const char* utf8) {
   return CountModifiedUtf8Chars(utf8, strlen(utf8));
@@ -55,7 +215,10 @@ size_t CountModifiedUtf8Chars(const char* utf8, size_t byte_count) {
     int ic = *utf8;
     len++;
     if (LIKELY((ic & 0x80) == 0)) {
-      // One-byte encoding.
+      // One-byte encoding. Skip the rest of the ASCII run, if any.
+      size_t ascii_length = CountAsciiPrefix(utf8 + 1, end - (utf8 + 1));
+      len += ascii_length;
+      utf8 += ascii_length;
       continue;
     }
     // Two- or three-byte encoding.
@@ -100,16 +263,20 @@ void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_data_out, size_t out_chars,
 
   if (LIKELY(out_chars == in_bytes)) {
     // Common case where all characters are ASCII.
-    for (const char *p = in_start; p < in_end;) {
-      // Safe even if char is signed because ASCII characters always have
-      // the high bit cleared.
-      *out_p++ = dchecked_integral_cast<uint16_t>(*p++);
-    }
+    WidenAscii(out_p, in_start, in_bytes);
     return;
   }
 
   // String contains non-ASCII characters.
   for (const char *p = in_start; p < in_end;) {
+    if ((static_cast<uint8_t>(*p) & 0x80u) == 0u) {
+      // Copy the whole ASCII run at once.
+      size_t ascii_length = CountAsciiPrefix(p, in_end - p);
+      WidenAscii(out_p, p, ascii_length);
+      out_p += ascii_length;
+      p += ascii_length;
+      continue;
+    }
     const uint32_t ch = GetUtf16FromUtf8(&p);
     const uint16_t leading = GetLeadingUtf16Char(ch);
     const uint16_t trailing = GetTrailingUtf16Char(ch);
@@ -125,10 +292,7 @@ void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
                                 const uint16_t* utf16_in, size_t char_count) {
   if (LIKELY(byte_count == char_count)) {
     // Common case where all characters are ASCII.
-    const uint16_t *utf16_end = utf16_in + char_count;
-    for (const uint16_t *p = utf16_in; p < utf16_end;) {
-      *utf8_out++ = dchecked_integral_cast<char>(*p++);
-    }
+    NarrowAscii(utf8_out, utf16_in, char_count);
     return;
   }
 
@@ -137,6 +301,12 @@ void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
     const uint16_t ch = *utf16_in++;
     if (ch > 0 && ch <= 0x7f) {
       *utf8_out++ = ch;
+      // Copy the rest of the ASCII run at once.
+      size_t ascii_length = CountAsciiPrefix(utf16_in, char_count);
+      NarrowAscii(utf8_out, utf16_in, ascii_length);
+      utf8_out += ascii_length;
+      utf16_in += ascii_length;
+      char_count -= ascii_length;
     } else {
       // Char_count == 0 here implies we've encountered an unpaired
       // surrogate and we have no choice but to encode it as 3-byte UTF
@@ -191,15 +361,112 @@ int32_t ComputeUtf16HashFromModifiedUtf8(const char* utf8, size_t utf16_length)
   return static_cast<int32_t>(hash);
 }
 
-uint32_t ComputeModifiedUtf8Hash(const char* chars) {
-  uint32_t hash = StartModifiedUtf8Hash();
-  while (*chars != '\0') {
-    hash = UpdateModifiedUtf8Hash(hash, *chars);
-    ++chars;
+#if defined(__SSE4_1__) || defined(__aarch64__)
+// Powers of 31 modulo 2^32 used by the vectorized hash: kPowersOf31[i] == 31^(15 - i).
+static constexpr std::array<uint32_t, 16u> kPowersOf31 = []() constexpr {
+  std::array<uint32_t, 16u> result = {};
+  uint32_t power = 1u;
+  for (size_t i = 0; i != result.size(); ++i) {
+    result[result.size() - 1u - i] = power;
+    power *= 31u;
+  }
+  return result;
+}();
+static constexpr uint32_t k31Pow8 = kPowersOf31[8] * 31u;
+static constexpr uint32_t k31Pow16 = kPowersOf31[0] * 31u;
+#endif
+
+// The hash of a block of N chars `c[0..N)` continuing from `hash` is
+//   hash * 31^N + sum(c[i] * 31^(N - 1 - i)).
+// We keep per-lane partial sums in `acc`, multiplying them by 31^N for each new block, and
+// reduce the lanes once at the end. All arithmetic is modulo 2^32, so the result is exactly
+// the same as for the sequential loop.
+uint32_t UpdateHashVectorized(uint32_t hash, const uint8_t* chars, size_t count) {
+  size_t i = 0u;
+#if defined(__SSE4_1__)
+  const __m128i powers0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&kPowersOf31[0]));
+  const __m128i powers1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&kPowersOf31[4]));
+  const __m128i powers2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&kPowersOf31[8]));
+  const __m128i powers3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&kPowersOf31[12]));
+  const __m128i block_multiplier = _mm_set1_epi32(static_cast<int32_t>(k31Pow16));
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 16u <= count; i += 16u) {
+    __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars + i));
+    __m128i sum = _mm_mullo_epi32(_mm_cvtepu8_epi32(data), powers0);
+    sum = _mm_add_epi32(sum, _mm_mullo_epi32(_mm_cvtepu8_epi32(_mm_srli_si128(data, 4)), powers1));
+    sum = _mm_add_epi32(sum, _mm_mullo_epi32(_mm_cvtepu8_epi32(_mm_srli_si128(data, 8)), powers2));
+    sum = _mm_add_epi32(sum, _mm_mullo_epi32(_mm_cvtepu8_epi32(_mm_srli_si128(data, 12)), powers3));
+    acc = _mm_add_epi32(_mm_mullo_epi32(acc, block_multiplier), sum);
+    hash *= k31Pow16;
+  }
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4e));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xb1));
+  hash += static_cast<uint32_t>(_mm_cvtsi128_si32(acc));
+#elif defined(__aarch64__)
+  const uint32x4_t powers0 = vld1q_u32(&kPowersOf31[0]);
+  const uint32x4_t powers1 = vld1q_u32(&kPowersOf31[4]);
+  const uint32x4_t powers2 = vld1q_u32(&kPowersOf31[8]);
+  const uint32x4_t powers3 = vld1q_u32(&kPowersOf31[12]);
+  uint32x4_t acc = vdupq_n_u32(0u);
+  for (; i + 16u <= count; i += 16u) {
+    uint8x16_t data = vld1q_u8(chars + i);
+    uint16x8_t lo = vmovl_u8(vget_low_u8(data));
+    uint16x8_t hi = vmovl_high_u8(data);
+    acc = vmulq_n_u32(acc, k31Pow16);
+    acc = vmlaq_u32(acc, vmovl_u16(vget_low_u16(lo)), powers0);
+    acc = vmlaq_u32(acc, vmovl_high_u16(lo), powers1);
+    acc = vmlaq_u32(acc, vmovl_u16(vget_low_u16(hi)), powers2);
+    acc = vmlaq_u32(acc, vmovl_high_u16(hi), powers3);
+    hash *= k31Pow16;
+  }
+  hash += vaddvq_u32(acc);
+#endif
+  for (; i != count; ++i) {
+    hash = hash * 31u + chars[i];
+  }
+  return hash;
+}
+
+uint32_t UpdateHashVectorized(uint32_t hash, const uint16_t* chars, size_t count) {
+  size_t i = 0u;
+#if defined(__SSE4_1__)
+  const __m128i powers2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&kPowersOf31[8]));
+  const __m128i powers3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&kPowersOf31[12]));
+  const __m128i block_multiplier = _mm_set1_epi32(static_cast<int32_t>(k31Pow8));
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 8u <= count; i += 8u) {
+    __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars + i));
+    __m128i sum = _mm_mullo_epi32(_mm_cvtepu16_epi32(data), powers2);
+    sum = _mm_add_epi32(sum, _mm_mullo_epi32(_mm_cvtepu16_epi32(_mm_srli_si128(data, 8)), powers3));
+    acc = _mm_add_epi32(_mm_mullo_epi32(acc, block_multiplier), sum);
+    hash *= k31Pow8;
+  }
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4e));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xb1));
+  hash += static_cast<uint32_t>(_mm_cvtsi128_si32(acc));
+#elif defined(__aarch64__)
+  const uint32x4_t powers2 = vld1q_u32(&kPowersOf31[8]);
+  const uint32x4_t powers3 = vld1q_u32(&kPowersOf31[12]);
+  uint32x4_t acc = vdupq_n_u32(0u);
+  for (; i + 8u <= count; i += 8u) {
+    uint16x8_t data = vld1q_u16(chars + i);
+    acc = vmulq_n_u32(acc, k31Pow8);
+    acc = vmlaq_u32(acc, vmovl_u16(vget_low_u16(data)), powers2);
+    acc = vmlaq_u32(acc, vmovl_high_u16(data), powers3);
+    hash *= k31Pow8;
+  }
+  hash += vaddvq_u32(acc);
+#endif
+  for (; i != count; ++i) {
+    hash = hash * 31u + chars[i];
   }
   return hash;
 }
 
+uint32_t ComputeModifiedUtf8Hash(const char* chars) {
+  return ComputeModifiedUtf8Hash(std::string_view(chars));
+}
+
 uint32_t ComputeModifiedUtf8Hash(std::string_view chars) {
   return UpdateModifiedUtf8Hash(StartModifiedUtf8Hash(), chars);
 }
@@ -246,7 +513,10 @@ size_t CountUtf8Bytes(const uint16_t* chars, size_t char_count) {
   while (chars < end) {
     const uint16_t ch = *chars++;
     if (LIKELY(ch != 0 && ch < 0x80)) {
-      result++;
+      // Count the rest of the ASCII run at once.
+      size_t ascii_length = CountAsciiPrefix(chars, end - chars);
+      result += 1u + ascii_length;
+      chars += ascii_length;
       continue;
     }
     if (ch < 0x800) {
@@ -93,6 +93,17 @@ void ConvertUtf16ToUtf8(const uint16_t* utf16, size_t char_count, Append&& appen
 void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
                                 const uint16_t* utf16_in, size_t char_count);
 
+/*
+ * Continue the `hash * 31 + c` polynomial hash over `count` chars using SIMD where available.
+ * The result is bit-identical to the scalar loop. Used for longer strings by the hash functions
+ * below; short strings are hashed inline.
+ */
+uint32_t UpdateHashVectorized(uint32_t hash, const uint8_t* chars, size_t count);
+uint32_t UpdateHashVectorized(uint32_t hash, const uint16_t* chars, size_t count);
+
+// Minimum number of chars for which the hash functions use `UpdateHashVectorized()`.
+static constexpr size_t kMinVectorizedHashLength = 16u;
+
 /*
  * The java.lang.String hashCode() algorithm.
  */
@@ -102,6 +113,10 @@ int32_t ComputeUtf16Hash(const MemoryType* chars, size_t char_count) {
                 std::is_same_v<MemoryType, uint8_t> ||
                 std::is_same_v<MemoryType, uint16_t>);
   using UnsignedMemoryType = std::make_unsigned_t<MemoryType>;
+  if (char_count >= kMinVectorizedHashLength) {
+    return static_cast<int32_t>(
+        UpdateHashVectorized(0u, reinterpret_cast<const UnsignedMemoryType*>(chars), char_count));
+  }
   uint32_t hash = 0;
   while (char_count--) {
     hash = hash * 31 + static_cast<UnsignedMemoryType>(*chars++);
@@ -130,6 +145,10 @@ inline uint32_t UpdateModifiedUtf8Hash(uint32_t hash, char c) {
 // Update a modified UTF-8 hash with characters of a `std::string_view`.
 ALWAYS_INLINE
 inline uint32_t UpdateModifiedUtf8Hash(uint32_t hash, std::string_view chars) {
+  if (chars.size() >= kMinVectorizedHashLength) {
+    return UpdateHashVectorized(
+        hash, reinterpret_cast<const uint8_t*>(chars.data()), chars.size());
+  }
   for (char c : chars) {
     hash = UpdateModifiedUtf8Hash(hash, c);
   }
@@ -21,6 +21,7 @@
 
 #include <android-base/stringprintf.h>
 
+#include "base/globals.h"
 #include "gtest/gtest.h"
 #include "utf-inl.h"
 
@@ -380,6 +381,132 @@ TEST_F(UtfTest, ExhaustiveBidirectionalCodePointCheck) {
   }
 }
 
+// Builds a UTF-16 string of `length` chars where each char is non-ASCII with probability
+// `non_ascii_percent` / 100. Non-ASCII chars cycle through U+0000, two- and three-byte chars
+// and surrogate pairs so that every scalar path is exercised between the ASCII runs.
+static std::vector<uint16_t> MakeMixedUtf16(size_t length, uint32_t non_ascii_percent) {
+  static constexpr uint16_t kNonAscii[] = { 0x0000, 0x00e9, 0x4e2d, 0x6587, 0xd83d, 0xdfe0 };
+  std::vector<uint16_t> result;
+  uint32_t seed = 42u;
+  size_t next_non_ascii = 0u;
+  while (result.size() < length) {
+    seed = seed * 1103515245u + 12345u;
+    if ((seed >> 16) % 100u < non_ascii_percent) {
+      uint16_t ch = kNonAscii[next_non_ascii];
+      next_non_ascii = (next_non_ascii + 1u) % arraysize(kNonAscii);
+      if (ch == 0xd83d) {
+        if (result.size() + 2u > length) {
+          continue;
+        }
+        result.push_back(ch);
+        ch = kNonAscii[next_non_ascii];
+        next_non_ascii = (next_non_ascii + 1u) % arraysize(kNonAscii);
+      }
+      result.push_back(ch);
+    } else {
+      result.push_back(static_cast<uint16_t>('a' + (seed >> 16) % 26u));
+    }
+  }
+  return result;
+}
+
+static void CheckLongConversion(const std::vector<uint16_t>& utf16) {
+  size_t byte_count = CountUtf8Bytes_reference(utf16.data(), utf16.size());
+  ASSERT_EQ(byte_count, CountUtf8Bytes(utf16.data(), utf16.size()));
+
+  std::vector<char> utf8_reference(byte_count + 1u, '\0');
+  std::vector<char> utf8(byte_count + 1u, '\0');
+  ConvertUtf16ToModifiedUtf8_reference(utf8_reference.data(), utf16.data(), utf16.size());
+  ConvertUtf16ToModifiedUtf8(utf8.data(), byte_count, utf16.data(), utf16.size());
+  ASSERT_EQ(utf8_reference, utf8);
+
+  ASSERT_EQ(utf16.size(), CountModifiedUtf8Chars_reference(utf8.data()));
+  ASSERT_EQ(utf16.size(), CountModifiedUtf8Chars(utf8.data(), byte_count));
+
+  std::vector<uint16_t> round_trip(utf16.size());
+  ConvertModifiedUtf8ToUtf16(round_trip.data(), round_trip.size(), utf8.data(), byte_count);
+  ASSERT_EQ(utf16, round_trip);
+}
+
+TEST_F(UtfTest, LongMixedStrings) {
+  // Use lengths around the SIMD block sizes to exercise the vector loops and their tails.
+  for (size_t length : { 1u, 7u, 8u, 9u, 15u, 16u, 17u, 31u, 32u, 33u, 63u, 64u, 65u, 1000u }) {
+    for (uint32_t non_ascii_percent : { 0u, 1u, 5u, 20u, 50u, 100u }) {
+      CheckLongConversion(MakeMixedUtf16(length, non_ascii_percent));
+    }
+  }
+}
+
+TEST_F(UtfTest, MalformedAsciiFastPaths) {
+  // When the caller claims that the data is all ASCII (equal char and byte counts), the
+  // conversions just widen or narrow each unit. Pin the values produced for non-ASCII data,
+  // which must be the same for the vector loops and their scalar tails. Debug builds reject
+  // such data with a DCHECK() instead.
+  if (kIsDebugBuild) {
+    return;
+  }
+  for (size_t length : { 15u, 16u, 17u, 33u, 100u }) {
+    std::vector<char> utf8(length);
+    std::vector<uint16_t> utf16(length);
+    for (size_t i = 0; i != length; ++i) {
+      utf8[i] = static_cast<char>(0x41u + 37u * i);
+      utf16[i] = static_cast<uint16_t>(0x41u + 0x1357u * i);
+    }
+
+    std::vector<uint16_t> widened(length);
+    ConvertModifiedUtf8ToUtf16(widened.data(), length, utf8.data(), length);
+    for (size_t i = 0; i != length; ++i) {
+      ASSERT_EQ(static_cast<uint16_t>(utf8[i]), widened[i]) << length << " " << i;
+    }
+
+    std::vector<char> narrowed(length);
+    ConvertUtf16ToModifiedUtf8(narrowed.data(), length, utf16.data(), length);
+    for (size_t i = 0; i != length; ++i) {
+      ASSERT_EQ(static_cast<char>(utf16[i] & 0xffu), narrowed[i]) << length << " " << i;
+    }
+  }
+}
+
+template <typename T>
+static uint32_t ComputeHash_reference(uint32_t hash, const T* chars, size_t count) {
+  while (count--) {
+    hash = hash * 31u + static_cast<std::make_unsigned_t<T>>(*chars++);
+  }
+  return hash;
+}
+
+TEST_F(UtfTest, VectorizedHash) {
+  std::vector<uint8_t> bytes(200u);
+  std::vector<uint16_t> chars(200u);
+  uint32_t seed = 17u;
+  for (size_t i = 0; i != bytes.size(); ++i) {
+    seed = seed * 1103515245u + 12345u;
+    bytes[i] = static_cast<uint8_t>(seed >> 16);
+    chars[i] = static_cast<uint16_t>(seed >> 8);
+  }
+  // Make sure the top bits of the chars are used.
+  bytes[3] = 0xffu;
+  chars[3] = 0xffffu;
+  for (size_t offset : { 0u, 1u, 3u }) {
+    for (size_t length = 0; length + offset <= bytes.size(); ++length) {
+      const uint8_t* b = bytes.data() + offset;
+      const uint16_t* c = chars.data() + offset;
+      for (uint32_t start : { 0u, 1u, 0x87654321u }) {
+        ASSERT_EQ(ComputeHash_reference(start, b, length), UpdateHashVectorized(start, b, length));
+        ASSERT_EQ(ComputeHash_reference(start, c, length), UpdateHashVectorized(start, c, length));
+      }
+      const char* cs = reinterpret_cast<const char*>(b);
+      ASSERT_EQ(ComputeHash_reference(0u, b, length), ComputeModifiedUtf8Hash({cs, length}));
+      ASSERT_EQ(static_cast<int32_t>(ComputeHash_reference(0u, cs, length)),
+                ComputeUtf16Hash(cs, length));
+      ASSERT_EQ(static_cast<int32_t>(ComputeHash_reference(0u, c, length)),
+                ComputeUtf16Hash(c, length));
+    }
+  }
+  EXPECT_EQ(ComputeModifiedUtf8Hash("Ljava/lang/String;"),
+            ComputeHash_reference(0u, "Ljava/lang/String;", strlen("Ljava/lang/String;")));
+}
+
 TEST_F(UtfTest, NonAscii) {
   const char kNonAsciiCharacter = '\x80';
   const char input[] = { kNonAsciiCharacter, '\0' };
@@ -222,8 +222,11 @@ enum class ProfileCompilationInfo::FileSectionType : uint32_t {
   // an optional reserved section not implemented on client yet.
   kAggregationCounts = 4,
 
+  // The number of CPU samples of sampled methods.
+  kMethodSampleCounts = 5,
+
   // The number of known sections.
-  kNumberOfSections = 5
+  kNumberOfSections = 6
 };
 
 class ProfileCompilationInfo::FileSectionInfo {
@@ -879,6 +882,7 @@ static bool WriteBuffer(int fd, const void* buffer, size_t byte_count) {
  *   Classes - optional, zipped
  *   Methods - optional, zipped
  *   AggregationCounts - optional, zipped, server-side
+ *   MethodSampleCounts - optional, zipped
  *
  * DexFiles:
  *    number_of_dex_files
@@ -917,6 +921,13 @@ static bool WriteBuffer(int fd, const void* buffer, size_t byte_count) {
  *    type_index_diff[dex_map_size]
  * where `M` stands for special encodings indicating missing types (kIsMissingTypesEncoding)
  * or memamorphic call (kIsMegamorphicEncoding) which both imply `dex_map_size == 0`.
+ *
+ * MethodSampleCounts contains records for any number of dex files, each consisting of:
+ *    profile_index  // Index of the dex file in DexFiles section.
+ *    number_of_methods
+ *    (method_index_diff,sample_count)[number_of_methods]
+ * where `number_of_methods` and `sample_count` are `uint32_t` and `method_index_diff`
+ * is `uint16_t`.
  **/
 bool ProfileCompilationInfo::Save(int fd) {
   uint64_t start = NanoTime();
@@ -936,6 +947,7 @@ bool ProfileCompilationInfo::Save(int fd) {
   uint64_t dex_files_section_size = sizeof(ProfileIndexType);  // Number of dex files.
   uint64_t classes_section_size = 0u;
   uint64_t methods_section_size = 0u;
+  uint64_t method_sample_counts_section_size = 0u;
   DCHECK_LE(info_.size(), MaxProfileIndex());
   for (const std::unique_ptr<DexFileData>& dex_data : info_) {
     if (dex_data->profile_key.size() > kMaxDexFileKeyLength) {
@@ -948,13 +960,15 @@ bool ProfileCompilationInfo::Save(int fd) {
         sizeof(uint16_t) + dex_data->profile_key.size();
     classes_section_size += dex_data->ClassesDataSize();
     methods_section_size += dex_data->MethodsDataSize();
+    method_sample_counts_section_size += dex_data->MethodSampleCountsDataSize();
   }
 
   const uint32_t file_section_count =
       /* dex files */ 1u +
       /* extra descriptors */ (extra_descriptors_section_size != 0u ? 1u : 0u) +
       /* classes */ (classes_section_size != 0u ? 1u : 0u) +
-      /* methods */ (methods_section_size != 0u ? 1u : 0u);
+      /* methods */ (methods_section_size != 0u ? 1u : 0u) +
+      /* method sample counts */ (method_sample_counts_section_size != 0u ? 1u : 0u);
   uint64_t header_and_infos_size =
       sizeof(FileHeader) + file_section_count * sizeof(FileSectionInfo);
 
@@ -965,7 +979,8 @@ bool ProfileCompilationInfo::Save(int fd) {
       dex_files_section_size +
       extra_descriptors_section_size +
       classes_section_size +
-      methods_section_size;
+      methods_section_size +
+      method_sample_counts_section_size;
   VLOG(profiler) << "Required capacity: " << total_uncompressed_size << " bytes.";
   if (total_uncompressed_size > GetSizeErrorThresholdBytes()) {
     LOG(WARNING) << "Profile data size exceeds "
@@ -1064,6 +1079,22 @@ bool ProfileCompilationInfo::Save(int fd) {
     add_section_info(FileSectionType::kMethods, buffer.Size(), methods_section_size);
   }
 
+  // Write the method sample counts section.
+  if (method_sample_counts_section_size != 0u) {
+    SafeBuffer buffer(method_sample_counts_section_size);
+    for (const std::unique_ptr<DexFileData>& dex_data : info_) {
+      dex_data->WriteMethodSampleCounts(buffer);
+    }
+    if (!buffer.Deflate()) {
+      return false;
+    }
+    if (!WriteBuffer(fd, buffer.Get(), buffer.Size())) {
+      return false;
+    }
+    add_section_info(
+        FileSectionType::kMethodSampleCounts, buffer.Size(), method_sample_counts_section_size);
+  }
+
   if (file_offset > GetSizeWarningThresholdBytes()) {
     LOG(WARNING) << "Profile data size exceeds "
         << GetSizeWarningThresholdBytes()
@@ -1232,6 +1263,22 @@ ProfileCompilationInfo::ExtraDescriptorIndex ProfileCompilationInfo::AddExtraDes
   return new_extra_descriptor_index;
 }
 
+bool ProfileCompilationInfo::AddMethodSampleCount(const MethodReference& method_ref,
+                                                  uint32_t count,
+                                                  const ProfileSampleAnnotation& annotation) {
+  DexFileData* const data = GetOrAddDexFileData(method_ref.dex_file, annotation);
+  if (data == nullptr) {  // checksum mismatch
+    return false;
+  }
+  if (method_ref.index >= data->num_method_ids) {
+    LOG(ERROR) << "Invalid method index " << method_ref.index << ". num_method_ids="
+               << data->num_method_ids;
+    return false;
+  }
+  data->AddMethodSampleCount(method_ref.index, count);
+  return true;
+}
+
 bool ProfileCompilationInfo::AddMethod(const ProfileMethodInfo& pmi,
                                        MethodHotness::Flag flags,
                                        const ProfileSampleAnnotation& annotation) {
@@ -1676,6 +1723,41 @@ ProfileCompilationInfo::ProfileLoadStatus ProfileCompilationInfo::ReadMethodsSec
   return ProfileLoadStatus::kSuccess;
 }
 
+ProfileCompilationInfo::ProfileLoadStatus ProfileCompilationInfo::ReadMethodSampleCountsSection(
+    ProfileSource& source,
+    const FileSectionInfo& section_info,
+    const dchecked_vector<ProfileIndexType>& dex_profile_index_remap,
+    /*out*/ std::string* error) {
+  DCHECK(section_info.GetType() == FileSectionType::kMethodSampleCounts);
+  SafeBuffer buffer;
+  ProfileLoadStatus status = ReadSectionData(source, section_info, &buffer, error);
+  if (status != ProfileLoadStatus::kSuccess) {
+    return status;
+  }
+
+  while (buffer.GetAvailableBytes() != 0u) {
+    ProfileIndexType profile_index;
+    if (!buffer.ReadUintAndAdvance(&profile_index)) {
+      *error = "Error profile index in method sample counts section.";
+      return ProfileLoadStatus::kBadData;
+    }
+    if (profile_index >= dex_profile_index_remap.size()) {
+      *error = "Invalid profile index in method sample counts section.";
+      return ProfileLoadStatus::kBadData;
+    }
+    profile_index = dex_profile_index_remap[profile_index];
+    if (profile_index == MaxProfileIndex()) {
+      status = DexFileData::SkipMethodSampleCounts(buffer, error);
+    } else {
+      status = info_[profile_index]->ReadMethodSampleCounts(buffer, error);
+    }
+    if (status != ProfileLoadStatus::kSuccess) {
+      return status;
+    }
+  }
+  return ProfileLoadStatus::kSuccess;
+}
+
 // TODO(calin): fail fast if the dex checksums don't match.
 ProfileCompilationInfo::ProfileLoadStatus ProfileCompilationInfo::LoadInternal(
     int32_t fd,
@@ -1800,6 +1882,13 @@ ProfileCompilationInfo::ProfileLoadStatus ProfileCompilationInfo::LoadInternal(
       case FileSectionType::kAggregationCounts:
         // This section is only used on server side.
         break;
+      case FileSectionType::kMethodSampleCounts:
+        // Skip if all dex files were filtered out.
+        if (!info_.empty()) {
+          status = ReadMethodSampleCountsSection(
+              *source, section_info, dex_profile_index_remap, error);
+        }
+        break;
       default:
         // Unknown section. Skip it. New versions of ART are allowed
         // to add sections that shall be ignored by old versions.
@@ -1939,6 +2028,11 @@ bool ProfileCompilationInfo::MergeWith(const ProfileCompilationInfo& other,
 
     // Merge the method bitmaps.
     dex_data->MergeBitmap(*other_dex_data);
+
+    // Merge the method sample counts.
+    for (const auto& other_sample_count : other_dex_data->method_sample_counts) {
+      dex_data->AddMethodSampleCount(other_sample_count.first, other_sample_count.second);
+    }
   }
 
   return true;
@@ -2079,6 +2173,17 @@ std::string ProfileCompilationInfo::DumpInfo(const std::vector<const DexFile*>&
         os << type_index.index_ << ",";
       }
     }
+    if (!dex_data->method_sample_counts.empty()) {
+      os << "\n\tmethod sample counts: ";
+      for (const auto& sample_count_it : dex_data->method_sample_counts) {
+        if (dex_file != nullptr) {
+          os << "\n\t\t" << dex_file->PrettyMethod(sample_count_it.first, true) << "="
+             << sample_count_it.second;
+        } else {
+          os << sample_count_it.first << "=" << sample_count_it.second << ", ";
+        }
+      }
+    }
   }
   return os.str();
 }
@@ -2300,9 +2405,22 @@ ProfileCompilationInfo::MethodHotness ProfileCompilationInfo::DexFileData::GetHo
     ret.SetInlineCacheMap(&it->second);
     ret.AddFlag(MethodHotness::kFlagHot);
   }
+  auto sample_count_it = method_sample_counts.find(dex_method_index);
+  if (sample_count_it != method_sample_counts.end()) {
+    ret.SetSampleCount(sample_count_it->second);
+  }
   return ret;
 }
 
+void ProfileCompilationInfo::DexFileData::AddMethodSampleCount(uint16_t method_index,
+                                                               uint32_t count) {
+  DCHECK_LT(method_index, num_method_ids);
+  uint32_t& sample_count = method_sample_counts.GetOrCreate(method_index, []() { return 0u; });
+  sample_count = (count > std::numeric_limits<uint32_t>::max() - sample_count)
+      ? std::numeric_limits<uint32_t>::max()
+      : sample_count + count;
+}
+
 // To simplify the implementation we use the MethodHotness flag values as indexes into the internal
 // bitmap representation. As such, they should never change unless the profile version is updated
 // and the implementation changed accordingly.
@@ -2827,6 +2945,80 @@ ProfileCompilationInfo::ProfileLoadStatus ProfileCompilationInfo::DexFileData::S
   return ProfileLoadStatus::kSuccess;
 }
 
+uint32_t ProfileCompilationInfo::DexFileData::MethodSampleCountsDataSize() const {
+  return method_sample_counts.empty()
+      ? 0u
+      : sizeof(ProfileIndexType) +  // Which dex file.
+        sizeof(uint32_t) +          // Number of methods.
+        (sizeof(uint16_t) + sizeof(uint32_t)) * method_sample_counts.size();
+}
+
+void ProfileCompilationInfo::DexFileData::WriteMethodSampleCounts(SafeBuffer& buffer) const {
+  if (method_sample_counts.empty()) {
+    return;
+  }
+  buffer.WriteUintAndAdvance(profile_index);
+  buffer.WriteUintAndAdvance(dchecked_integral_cast<uint32_t>(method_sample_counts.size()));
+  // Store the difference between the method indexes for better compression.
+  uint16_t last_method_index = 0u;
+  for (const auto& method_sample_count : method_sample_counts) {
+    uint16_t method_index = method_sample_count.first;
+    DCHECK_GE(method_index, last_method_index);
+    buffer.WriteUintAndAdvance(dchecked_integral_cast<uint16_t>(method_index - last_method_index));
+    buffer.WriteUintAndAdvance(method_sample_count.second);
+    last_method_index = method_index;
+  }
+}
+
+ProfileCompilationInfo::ProfileLoadStatus
+ProfileCompilationInfo::DexFileData::ReadMethodSampleCounts(SafeBuffer& buffer,
+                                                            std::string* error) {
+  uint32_t methods_size;
+  if (!buffer.ReadUintAndAdvance(&methods_size)) {
+    *error = "Error reading method sample counts size.";
+    return ProfileLoadStatus::kBadData;
+  }
+  uint16_t method_index = 0u;
+  for (uint32_t i = 0; i != methods_size; ++i) {
+    uint16_t method_index_diff;
+    uint32_t sample_count;
+    if (!buffer.ReadUintAndAdvance(&method_index_diff) ||
+        !buffer.ReadUintAndAdvance(&sample_count)) {
+      *error = "Error reading method sample count.";
+      return ProfileLoadStatus::kBadData;
+    }
+    if (method_index_diff == 0u && i != 0u) {
+      *error = "Duplicate method index in method sample counts.";
+      return ProfileLoadStatus::kBadData;
+    }
+    if (method_index_diff >= num_method_ids - method_index) {
+      *error = "Invalid method index in method sample counts.";
+      return ProfileLoadStatus::kBadData;
+    }
+    method_index += method_index_diff;
+    AddMethodSampleCount(method_index, sample_count);
+  }
+  return ProfileLoadStatus::kSuccess;
+}
+
+ProfileCompilationInfo::ProfileLoadStatus
+ProfileCompilationInfo::DexFileData::SkipMethodSampleCounts(SafeBuffer& buffer,
+                                                            std::string* error) {
+  uint32_t methods_size;
+  if (!buffer.ReadUintAndAdvance(&methods_size)) {
+    *error = "Error reading method sample counts size to skip.";
+    return ProfileLoadStatus::kBadData;
+  }
+  size_t following_data_size =
+      static_cast<size_t>(methods_size) * (sizeof(uint16_t) + sizeof(uint32_t));
+  if (following_data_size > buffer.GetAvailableBytes()) {
+    *error = "Method sample counts data size to skip exceeds remaining data.";
+    return ProfileLoadStatus::kBadData;
+  }
+  buffer.Advance(following_data_size);
+  return ProfileLoadStatus::kSuccess;
+}
+
 void ProfileCompilationInfo::DexFileData::WriteClassSet(
     SafeBuffer& buffer,
     const ArenaSet<dex::TypeIndex>& class_set) {
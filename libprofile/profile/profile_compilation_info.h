@@ -244,14 +244,25 @@ class ProfileCompilationInfo {
       return inline_cache_map_;
     }
 
+    // The number of CPU samples attributed to the method. This weights the hotness of methods
+    // by their share of the sampled execution time; it is 0 if the method was never sampled.
+    uint32_t GetSampleCount() const {
+      return sample_count_;
+    }
+
    private:
     const InlineCacheMap* inline_cache_map_ = nullptr;
     uint32_t flags_ = 0;
+    uint32_t sample_count_ = 0u;
 
     void SetInlineCacheMap(const InlineCacheMap* info) {
       inline_cache_map_ = info;
     }
 
+    void SetSampleCount(uint32_t sample_count) {
+      sample_count_ = sample_count;
+    }
+
     friend class ProfileCompilationInfo;
   };
 
@@ -437,6 +448,15 @@ class ProfileCompilationInfo {
     return true;
   }
 
+  // Add `count` CPU samples to the method. The samples are attributed to the innermost method
+  // of the sampled frame, including inlined methods. Counts saturate at the maximum `uint32_t`.
+  //
+  // Note: see AddMethods docs for the handling of annotations.
+  bool AddMethodSampleCount(
+      const MethodReference& method_ref,
+      uint32_t count,
+      const ProfileSampleAnnotation& annotation = ProfileSampleAnnotation::kNone);
+
   // Load or Merge profile information from the given file descriptor.
   // If the current profile is non-empty the load will fail.
   // If merge_classes is set to false, classes will not be merged/loaded.
@@ -776,6 +796,7 @@ class ProfileCompilationInfo {
           checksum(location_checksum),
           method_map(std::less<uint16_t>(), allocator->Adapter(kArenaAllocProfile)),
           class_set(std::less<dex::TypeIndex>(), allocator->Adapter(kArenaAllocProfile)),
+          method_sample_counts(std::less<uint16_t>(), allocator->Adapter(kArenaAllocProfile)),
           num_type_ids(num_types),
           num_method_ids(num_methods),
           bitmap_storage(allocator->Adapter(kArenaAllocProfile)),
@@ -807,6 +828,7 @@ class ProfileCompilationInfo {
           num_method_ids == other.num_method_ids &&
           method_map == other.method_map &&
           class_set == other.class_set &&
+          method_sample_counts == other.method_sample_counts &&
           BitMemoryRegion::Equals(method_bitmap, other.method_bitmap);
     }
 
@@ -820,6 +842,9 @@ class ProfileCompilationInfo {
       }
     }
 
+    // Add CPU samples to a method, saturating at the maximum `uint32_t`.
+    void AddMethodSampleCount(uint16_t method_index, uint32_t count);
+
     void SetMethodHotness(size_t index, MethodHotness::Flag flags);
     MethodHotness GetHotnessInfo(uint32_t dex_method_index) const;
 
@@ -873,6 +898,11 @@ class ProfileCompilationInfo {
         std::string* error);
     static ProfileLoadStatus SkipMethods(SafeBuffer& buffer, std::string* error);
 
+    uint32_t MethodSampleCountsDataSize() const;
+    void WriteMethodSampleCounts(SafeBuffer& buffer) const;
+    ProfileLoadStatus ReadMethodSampleCounts(SafeBuffer& buffer, std::string* error);
+    static ProfileLoadStatus SkipMethodSampleCounts(SafeBuffer& buffer, std::string* error);
+
     // The allocator used to allocate new inline cache maps.
     ArenaAllocator* const allocator_;
     // The profile key this data belongs to.
@@ -886,6 +916,8 @@ class ProfileCompilationInfo {
     // The classes which have been profiled. Note that these don't necessarily include
     // all the classes that can be found in the inline caches reference.
     ArenaSet<dex::TypeIndex> class_set;
+    // The number of CPU samples of the methods that have been sampled.
+    ArenaSafeMap<uint16_t, uint32_t> method_sample_counts;
     // Find the inline caches of the the given method index. Add an empty entry if
     // no previous data is found.
     InlineCacheMap* FindOrAddHotMethod(uint16_t method_index);
@@ -1013,6 +1045,12 @@ class ProfileCompilationInfo {
       const dchecked_vector<ExtraDescriptorIndex>& extra_descriptors_remap,
       /*out*/ std::string* error);
 
+  ProfileLoadStatus ReadMethodSampleCountsSection(
+      ProfileSource& source,
+      const FileSectionInfo& section_info,
+      const dchecked_vector<ProfileIndexType>& dex_profile_index_remap,
+      /*out*/ std::string* error);
+
   // Entry point for profile loading functionality.
   ProfileLoadStatus LoadInternal(
       int32_t fd,
@@ -1221,6 +1221,66 @@ TEST_F(ProfileCompilationInfoTest, FilteredLoadingWithClasses) {
 }
 
 
+TEST_F(ProfileCompilationInfoTest, MethodSampleCounts) {
+  ScratchFile profile;
+
+  ProfileCompilationInfo saved_info;
+  for (uint16_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(AddMethod(&saved_info, dex1, /*method_idx=*/ i));
+    ASSERT_TRUE(saved_info.AddMethodSampleCount(MethodReference(dex1, i), /*count=*/ i + 1u));
+    ASSERT_TRUE(saved_info.AddMethodSampleCount(MethodReference(dex2, 2 * i), /*count=*/ 7u));
+  }
+  // Samples of the same method are accumulated and saturate.
+  ASSERT_TRUE(saved_info.AddMethodSampleCount(MethodReference(dex1, 0), /*count=*/ 2u));
+  ASSERT_TRUE(saved_info.AddMethodSampleCount(
+      MethodReference(dex1, 1), std::numeric_limits<uint32_t>::max()));
+  // Invalid method index.
+  ASSERT_FALSE(saved_info.AddMethodSampleCount(
+      MethodReference(dex1, dex1->NumMethodIds()), /*count=*/ 1u));
+  // Checksum mismatch.
+  ASSERT_FALSE(saved_info.AddMethodSampleCount(
+      MethodReference(dex1_checksum_missmatch, 0), /*count=*/ 1u));
+
+  EXPECT_EQ(3u, GetMethod(saved_info, dex1, /*method_idx=*/ 0).GetSampleCount());
+  EXPECT_EQ(std::numeric_limits<uint32_t>::max(),
+            GetMethod(saved_info, dex1, /*method_idx=*/ 1).GetSampleCount());
+  EXPECT_EQ(10u, GetMethod(saved_info, dex1, /*method_idx=*/ 9).GetSampleCount());
+  EXPECT_EQ(0u, GetMethod(saved_info, dex1, /*method_idx=*/ 10).GetSampleCount());
+  // Sampled methods are not implicitly hot.
+  EXPECT_EQ(7u, GetMethod(saved_info, dex2, /*method_idx=*/ 2).GetSampleCount());
+  EXPECT_FALSE(GetMethod(saved_info, dex2, /*method_idx=*/ 2).IsHot());
+
+  ASSERT_TRUE(saved_info.Save(GetFd(profile)));
+  ASSERT_EQ(0, profile.GetFile()->Flush());
+
+  // Check that we get back what we saved.
+  ProfileCompilationInfo loaded_info;
+  ASSERT_TRUE(loaded_info.Load(GetFd(profile)));
+  ASSERT_TRUE(loaded_info.Equals(saved_info));
+  EXPECT_EQ(3u, GetMethod(loaded_info, dex1, /*method_idx=*/ 0).GetSampleCount());
+
+  // Check that sample counts are added when merging.
+  ProfileCompilationInfo other_info;
+  ASSERT_TRUE(other_info.AddMethodSampleCount(MethodReference(dex1, 0), /*count=*/ 5u));
+  ASSERT_TRUE(other_info.AddMethodSampleCount(MethodReference(dex3, 0), /*count=*/ 4u));
+  ASSERT_TRUE(loaded_info.MergeWith(other_info));
+  EXPECT_EQ(8u, GetMethod(loaded_info, dex1, /*method_idx=*/ 0).GetSampleCount());
+  EXPECT_EQ(4u, GetMethod(loaded_info, dex3, /*method_idx=*/ 0).GetSampleCount());
+
+  // Check that filtered out dex files are skipped.
+  ASSERT_TRUE(profile.GetFile()->ResetOffset());
+  ASSERT_TRUE(loaded_info.Save(GetFd(profile)));
+  ASSERT_EQ(0, profile.GetFile()->Flush());
+  ProfileCompilationInfo filtered_info;
+  ProfileCompilationInfo::ProfileLoadFilterFn filter_fn =
+      [&dex3 = dex3](const std::string& dex_location, uint32_t checksum) -> bool {
+        return dex_location == dex3->GetLocation() && checksum == dex3->GetLocationChecksum();
+      };
+  ASSERT_TRUE(filtered_info.Load(GetFd(profile), /*merge_classes=*/ true, filter_fn));
+  EXPECT_EQ(0u, GetMethod(filtered_info, dex1, /*method_idx=*/ 0).GetSampleCount());
+  EXPECT_EQ(4u, GetMethod(filtered_info, dex3, /*method_idx=*/ 0).GetSampleCount());
+}
+
 TEST_F(ProfileCompilationInfoTest, ClearData) {
   ProfileCompilationInfo info;
   for (uint16_t i = 0; i < 10; i++) {
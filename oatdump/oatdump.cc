@@ -2185,7 +2185,10 @@ class ImageDumper {
         ImtConflictTable* table = method->GetImtConflictTable(image_header_.GetPointerSize());
         if (table != nullptr) {
           indent_os << "IMT conflict table " << table << " method: ";
-          for (size_t i = 0, count = table->NumEntries(pointer_size); i < count; ++i) {
+          for (size_t i = 0, count = table->NumSlots(pointer_size); i < count; ++i) {
+            if (table->GetInterfaceMethod(i, pointer_size) == nullptr) {
+              continue;  // Empty slot of a hashed table.
+            }
             indent_os << ArtMethod::PrettyMethod(table->GetImplementationMethod(i, pointer_size))
                       << " ";
           }
@@ -2868,14 +2871,11 @@ class IMTDumper {
       std::cerr << "    <No IMT?>" << std::endl;
       return;
     }
-    size_t table_index = 0;
-    for (;;) {
-      ArtMethod* ptr = table->GetInterfaceMethod(table_index, pointer_size);
-      if (ptr == nullptr) {
-        return;
+    for (size_t i = 0, num_slots = table->NumSlots(pointer_size); i < num_slots; ++i) {
+      ArtMethod* ptr = table->GetInterfaceMethod(i, pointer_size);
+      if (ptr != nullptr) {
+        std::cerr << "    " << ptr->PrettyMethod(true) << std::endl;
       }
-      table_index++;
-      std::cerr << "    " << ptr->PrettyMethod(true) << std::endl;
     }
   }
 
@@ -3015,13 +3015,13 @@ class IMTDumper {
           continue;
         }
 
-        size_t table_index = 0;
-        for (;;) {
+        for (size_t table_index = 0, num_slots = current_table->NumSlots(pointer_size);
+             table_index != num_slots;
+             ++table_index) {
           ArtMethod* ptr2 = current_table->GetInterfaceMethod(table_index, pointer_size);
           if (ptr2 == nullptr) {
-            break;
+            continue;  // Empty slot of a hashed table.
           }
-          table_index++;
 
           std::string p_name = ptr2->PrettyMethod(true);
           if (android::base::StartsWith(p_name, method.c_str())) {
@@ -646,16 +646,19 @@ inline void EventHandler::RecalculateGlobalEventMask(ArtJvmtiEvent event) {
 
 inline void EventHandler::RecalculateGlobalEventMaskLocked(ArtJvmtiEvent event) {
   bool union_value = false;
+  bool all_threads_value = false;
   for (const ArtJvmTiEnv* stored_env : envs) {
     if (stored_env == nullptr) {
       continue;
     }
-    union_value |= stored_env->event_masks.global_event_mask.Test(event);
+    all_threads_value |= stored_env->event_masks.global_event_mask.Test(event);
+    union_value |= all_threads_value;
     union_value |= stored_env->event_masks.unioned_thread_event_mask.Test(event);
-    if (union_value) {
+    if (all_threads_value) {
       break;
     }
   }
+  all_threads_mask_.Set(event, all_threads_value);
   global_mask.Set(event, union_value);
 }
 
@@ -681,6 +684,7 @@ inline void EventHandler::HandleChangedCapabilities(ArtJvmTiEnv* env,
     if (caps.can_retransform_classes == 1) {
       RecalculateGlobalEventMask(ArtJvmtiEvent::kClassFileLoadHookRetransformable);
       RecalculateGlobalEventMask(ArtJvmtiEvent::kClassFileLoadHookNonRetransformable);
+      RecalculateThreadEventMasks();
     }
     if (added && caps.can_access_local_variables == 1) {
       HandleLocalAccessCapabilityAdded();
@@ -241,9 +241,40 @@ void EventHandler::RemoveArtJvmTiEnv(ArtJvmTiEnv* env) {
          ++i) {
       RecalculateGlobalEventMaskLocked(static_cast<ArtJvmtiEvent>(i));
     }
+    art::MutexLock tll_mu(art::Thread::Current(), *art::Locks::thread_list_lock_);
+    RecalculateThreadEventMasksLocked();
   }
 }
 
+void EventHandler::RecalculateThreadEventMasks() {
+  art::Thread* self = art::Thread::Current();
+  art::WriterMutexLock mu(self, envs_lock_);
+  art::MutexLock tll_mu(self, *art::Locks::thread_list_lock_);
+  RecalculateThreadEventMasksLocked();
+}
+
+void EventHandler::RecalculateThreadEventMasksLocked() {
+  art::Runtime::Current()->GetThreadList()->ForEach([&](art::Thread* thread)
+      NO_THREAD_SAFETY_ANALYSIS /* Both locks are held by the caller. */ {
+    RecalculateThreadEventMaskLocked(thread);
+  });
+}
+
+void EventHandler::RecalculateThreadEventMaskLocked(art::Thread* thread) {
+  DCHECK(thread != nullptr);
+  uint64_t bits = 0u;
+  for (ArtJvmTiEnv* stored_env : envs) {
+    if (stored_env == nullptr) {
+      continue;
+    }
+    EventMask* mask = stored_env->event_masks.GetEventMaskOrNull(thread);
+    if (mask != nullptr) {
+      bits |= mask->ToBits();
+    }
+  }
+  thread->SetJvmtiEventMask(bits);
+}
+
 static bool IsThreadControllable(ArtJvmtiEvent event) {
   switch (event) {
     case ArtJvmtiEvent::kVmInit:
@@ -320,7 +351,7 @@ class JvmtiEventAllocationListener : public AllocationManager::AllocationCallbac
       override REQUIRES_SHARED(art::Locks::mutator_lock_) {
     DCHECK_EQ(self, art::Thread::Current());
 
-    if (handler_->IsEventEnabledAnywhere(ArtJvmtiEvent::kVmObjectAlloc)) {
+    if (handler_->IsEventEnabledOnThread(ArtJvmtiEvent::kVmObjectAlloc, self)) {
       art::StackHandleScope<1> hs(self);
       auto h = hs.NewHandleWrapper(obj);
       // jvmtiEventVMObjectAlloc parameters:
@@ -627,7 +658,7 @@ class JvmtiMethodTraceListener final : public art::instrumentation::Instrumentat
   void MethodEntered(art::Thread* self, art::ArtMethod* method)
       REQUIRES_SHARED(art::Locks::mutator_lock_) override {
     if (!method->IsRuntimeMethod() &&
-        event_handler_->IsEventEnabledAnywhere(ArtJvmtiEvent::kMethodEntry)) {
+        event_handler_->IsEventEnabledOnThread(ArtJvmtiEvent::kMethodEntry, self)) {
       art::JNIEnvExt* jnienv = self->GetJniEnv();
       RunEventCallback<ArtJvmtiEvent::kMethodEntry>(event_handler_,
                                                     self,
@@ -671,7 +702,7 @@ class JvmtiMethodTraceListener final : public art::instrumentation::Instrumentat
             thr.get(), ArtJvmtiEvent::kForceEarlyReturnUpdateReturnValue, JVMTI_DISABLE);
       }
     }
-    if (event_handler_->IsEventEnabledAnywhere(ArtJvmtiEvent::kMethodExit)) {
+    if (event_handler_->IsEventEnabledOnThread(ArtJvmtiEvent::kMethodExit, self)) {
       DCHECK_EQ(
           method->GetInterfaceMethodIfProxy(art::kRuntimePointerSize)->GetReturnTypePrimitive(),
           art::Primitive::kPrimNot) << method->PrettyMethod();
@@ -718,7 +749,7 @@ class JvmtiMethodTraceListener final : public art::instrumentation::Instrumentat
             thr.get(), ArtJvmtiEvent::kForceEarlyReturnUpdateReturnValue, JVMTI_DISABLE);
       }
     }
-    if (event_handler_->IsEventEnabledAnywhere(ArtJvmtiEvent::kMethodExit)) {
+    if (event_handler_->IsEventEnabledOnThread(ArtJvmtiEvent::kMethodExit, self)) {
       DCHECK_NE(
           method->GetInterfaceMethodIfProxy(art::kRuntimePointerSize)->GetReturnTypePrimitive(),
           art::Primitive::kPrimNot) << method->PrettyMethod();
@@ -746,7 +777,7 @@ class JvmtiMethodTraceListener final : public art::instrumentation::Instrumentat
                     uint32_t dex_pc ATTRIBUTE_UNUSED)
       REQUIRES_SHARED(art::Locks::mutator_lock_) override {
     if (!method->IsRuntimeMethod() &&
-        event_handler_->IsEventEnabledAnywhere(ArtJvmtiEvent::kMethodExit)) {
+        event_handler_->IsEventEnabledOnThread(ArtJvmtiEvent::kMethodExit, self)) {
       jvalue val;
       // Just set this to 0xffffffffffffffff so it's not uninitialized.
       val.j = static_cast<jlong>(-1);
@@ -786,7 +817,7 @@ class JvmtiMethodTraceListener final : public art::instrumentation::Instrumentat
     jmethodID jmethod = art::jni::EncodeArtMethod(method);
     jlocation location = static_cast<jlocation>(new_dex_pc);
     // Step event is reported first according to the spec.
-    if (event_handler_->IsEventEnabledAnywhere(ArtJvmtiEvent::kSingleStep)) {
+    if (event_handler_->IsEventEnabledOnThread(ArtJvmtiEvent::kSingleStep, self)) {
       RunEventCallback<ArtJvmtiEvent::kSingleStep>(event_handler_, self, jnienv, jmethod, location);
     }
     // Next we do the Breakpoint events. The Dispatch code will filter the individual
@@ -802,7 +833,7 @@ class JvmtiMethodTraceListener final : public art::instrumentation::Instrumentat
                  uint32_t dex_pc,
                  art::ArtField* field_p)
       REQUIRES_SHARED(art::Locks::mutator_lock_) override {
-    if (event_handler_->IsEventEnabledAnywhere(ArtJvmtiEvent::kFieldAccess)) {
+    if (event_handler_->IsEventEnabledOnThread(ArtJvmtiEvent::kFieldAccess, self)) {
       art::StackReflectiveHandleScope<1, 1> rhs(self);
       art::ReflectiveHandle<art::ArtField> field(rhs.NewHandle(field_p));
       art::ReflectiveHandle<art::ArtMethod> method(rhs.NewHandle(method_p));
@@ -830,7 +861,7 @@ class JvmtiMethodTraceListener final : public art::instrumentation::Instrumentat
                     art::ArtField* field_p,
                     art::Handle<art::mirror::Object> new_val)
       REQUIRES_SHARED(art::Locks::mutator_lock_) override {
-    if (event_handler_->IsEventEnabledAnywhere(ArtJvmtiEvent::kFieldModification)) {
+    if (event_handler_->IsEventEnabledOnThread(ArtJvmtiEvent::kFieldModification, self)) {
       art::JNIEnvExt* jnienv = self->GetJniEnv();
       art::StackReflectiveHandleScope<1, 1> rhs(self);
       art::ReflectiveHandle<art::ArtField> field(rhs.NewHandle(field_p));
@@ -865,7 +896,7 @@ class JvmtiMethodTraceListener final : public art::instrumentation::Instrumentat
                     art::ArtField* field_p,
                     const art::JValue& field_value)
       REQUIRES_SHARED(art::Locks::mutator_lock_) override {
-    if (event_handler_->IsEventEnabledAnywhere(ArtJvmtiEvent::kFieldModification)) {
+    if (event_handler_->IsEventEnabledOnThread(ArtJvmtiEvent::kFieldModification, self)) {
       art::JNIEnvExt* jnienv = self->GetJniEnv();
       art::StackReflectiveHandleScope<1, 1> rhs(self);
       art::ReflectiveHandle<art::ArtField> field(rhs.NewHandle(field_p));
@@ -989,7 +1020,7 @@ class JvmtiMethodTraceListener final : public art::instrumentation::Instrumentat
     DCHECK(self->IsExceptionThrownByCurrentMethod(exception_object.Get()));
     // The instrumentation events get rid of this for us.
     DCHECK(!self->IsExceptionPending());
-    if (event_handler_->IsEventEnabledAnywhere(ArtJvmtiEvent::kException)) {
+    if (event_handler_->IsEventEnabledOnThread(ArtJvmtiEvent::kException, self)) {
       art::JNIEnvExt* jnienv = self->GetJniEnv();
       art::ArtMethod* catch_method;
       uint32_t catch_pc;
@@ -1018,7 +1049,7 @@ class JvmtiMethodTraceListener final : public art::instrumentation::Instrumentat
       REQUIRES_SHARED(art::Locks::mutator_lock_) override {
     // Since the exception has already been handled there shouldn't be one pending.
     DCHECK(!self->IsExceptionPending());
-    if (event_handler_->IsEventEnabledAnywhere(ArtJvmtiEvent::kExceptionCatch)) {
+    if (event_handler_->IsEventEnabledOnThread(ArtJvmtiEvent::kExceptionCatch, self)) {
       art::JNIEnvExt* jnienv = self->GetJniEnv();
       uint32_t dex_pc;
       art::ArtMethod* method = self->GetCurrentMethod(&dex_pc,
@@ -1479,6 +1510,8 @@ jvmtiError EventHandler::SetInternalEvent(jthread thread,
       }
       if (old_state != new_state) {
         global_mask.Set(event, new_state);
+        // Internal events are not tracked in the per-thread bitmaps.
+        all_threads_mask_.Set(event, new_state);
       }
     }
   }
@@ -1558,6 +1591,9 @@ jvmtiError EventHandler::SetEvent(ArtJvmTiEnv* env,
     if (mode == JVMTI_ENABLE) {
       env->event_masks.EnableEvent(env, target, event);
       global_mask.Set(event);
+      if (target == nullptr) {
+        all_threads_mask_.Set(event);
+      }
       new_state = true;
       new_thread_state = true;
       DCHECK(GetThreadEventState(event, target));
@@ -1570,6 +1606,9 @@ jvmtiError EventHandler::SetEvent(ArtJvmTiEnv* env,
       new_thread_state = GetThreadEventState(event, target);
       DCHECK(new_state || !new_thread_state);
     }
+    if (target != nullptr) {
+      RecalculateThreadEventMaskLocked(target);
+    }
   }
   // Handle any special work required for the event type. We still have the
   // user_code_suspend_count_lock_ so there won't be any interleaving here.
@@ -183,6 +183,18 @@ struct EventMask {
     return bit_set.test(
         static_cast<size_t>(event) - static_cast<size_t>(ArtJvmtiEvent::kMinEventTypeVal));
   }
+
+  // Conversions to the raw bitmap stored in art::Thread for lock-free filtering.
+  static_assert(kEventsSize <= 64u, "Event mask does not fit in a thread's event bitmap");
+  static uint64_t Bit(ArtJvmtiEvent event) {
+    DCHECK(EventIsInRange(event));
+    return UINT64_C(1) <<
+        (static_cast<size_t>(event) - static_cast<size_t>(ArtJvmtiEvent::kMinEventTypeVal));
+  }
+
+  uint64_t ToBits() const {
+    return static_cast<uint64_t>(bit_set.to_ullong());
+  }
 };
 
 struct EventMasks {
@@ -244,6 +256,19 @@ class EventHandler {
     return global_mask.Test(event);
   }
 
+  // Returns whether the event may be enabled on the given thread. This takes no locks and is
+  // meant to filter out high-frequency events before doing any work to dispatch them. When the
+  // event is not enabled anywhere, this is a single load of the global mask.
+  ALWAYS_INLINE bool IsEventEnabledOnThread(ArtJvmtiEvent event, art::Thread* thread) const {
+    if (LIKELY(!IsEventEnabledAnywhere(event))) {
+      return false;
+    }
+    if (all_threads_mask_.Test(event)) {
+      return true;
+    }
+    return thread != nullptr && (thread->GetJvmtiEventMask() & EventMask::Bit(event)) != 0u;
+  }
+
   // Sets an internal event. Unlike normal JVMTI events internal events are not associated with any
   // particular jvmtiEnv and are refcounted. This refcounting is done to allow us to easily enable
   // events during functions and disable them during the requested event callback. Since these are
@@ -362,6 +387,13 @@ class EventHandler {
   ALWAYS_INLINE
   inline void RecalculateGlobalEventMaskLocked(ArtJvmtiEvent event) REQUIRES_SHARED(envs_lock_);
 
+  // Recalculates the event bitmaps stored in the threads.
+  void RecalculateThreadEventMasks() REQUIRES(!envs_lock_, !art::Locks::thread_list_lock_);
+  void RecalculateThreadEventMasksLocked()
+      REQUIRES(envs_lock_, art::Locks::thread_list_lock_);
+  void RecalculateThreadEventMaskLocked(art::Thread* thread)
+      REQUIRES(envs_lock_, art::Locks::thread_list_lock_);
+
   // Returns whether there are any active requests for the given event on the given thread. This
   // should only be used while modifying the events for a thread.
   bool GetThreadEventState(ArtJvmtiEvent event, art::Thread* thread)
@@ -424,6 +456,11 @@ class EventHandler {
   // A union of all enabled events, anywhere.
   EventMask global_mask;
 
+  // A union of the events enabled for all threads by any env, and of the enabled internal events.
+  // Together with the per-thread bitmaps in art::Thread, this lets IsEventEnabledOnThread() avoid
+  // taking envs_lock_.
+  EventMask all_threads_mask_;
+
   std::unique_ptr<JvmtiEventAllocationListener> alloc_listener_;
   std::unique_ptr<JvmtiDdmChunkListener> ddm_listener_;
   std::unique_ptr<JvmtiGcPauseListener> gc_pause_listener_;
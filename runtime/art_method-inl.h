@@ -547,7 +547,7 @@ inline uint16_t ArtMethod::GetCounter() {
 
 inline uint32_t ArtMethod::GetImtIndex() {
   if (LIKELY(IsAbstract())) {
-    return imt_index_;
+    return imt_index_ & ImTable::kImtIndexMask;
   } else {
     return ImTable::GetImtIndex(this);
   }
@@ -555,7 +555,10 @@ inline uint32_t ArtMethod::GetImtIndex() {
 
 inline void ArtMethod::CalculateAndSetImtIndex() {
   DCHECK(IsAbstract()) << PrettyMethod();
-  imt_index_ = ImTable::GetImtIndex(this);
+  uint32_t class_hash, name_hash, signature_hash;
+  ImTable::GetImtHashComponents(this, &class_hash, &name_hash, &signature_hash);
+  SetImtIndexAndInterfaceHash(ImTable::GetImtIndex(class_hash, name_hash, signature_hash),
+                              ImTable::GetInterfaceHash(class_hash));
 }
 
 }  // namespace art
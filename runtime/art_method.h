@@ -35,6 +35,7 @@
 #include "dex/primitive.h"
 #include "interpreter/mterp/nterp.h"
 #include "gc_root.h"
+#include "imtable.h"
 #include "obj_ptr.h"
 #include "offsets.h"
 #include "read_barrier_option.h"
@@ -901,6 +902,25 @@ class ArtMethod final {
 
   void CalculateAndSetImtIndex() REQUIRES_SHARED(Locks::mutator_lock_);
 
+  void SetImtIndexAndInterfaceHash(uint32_t imt_index, uint32_t interface_hash) {
+    DCHECK(IsAbstract()) << PrettyMethod();
+    DCHECK_LT(imt_index, ImTable::kSize);
+    DCHECK_LT(interface_hash, 1u << ImTable::kInterfaceHashBits);
+    imt_index_ = dchecked_integral_cast<uint16_t>(
+        (interface_hash << ImTable::kImtIndexBits) | imt_index);
+  }
+
+  // Return the hash of this interface method in hashed ImtConflictTables. Unlike the address
+  // and the dex method index, it is not changed by image relocation or class redefinition.
+  // Default methods do not store the interface hash, so only their method index is used.
+  uint32_t GetImtConflictTableHash() {
+    uint32_t hash = method_index_;
+    if ((GetAccessFlags() & (kAccAbstract | kAccDefault)) == kAccAbstract) {
+      hash += imt_index_ >> ImTable::kImtIndexBits;
+    }
+    return hash;
+  }
+
   static constexpr MemberOffset HotnessCountOffset() {
     return MemberOffset(OFFSETOF_MEMBER(ArtMethod, hotness_count_));
   }
@@ -996,7 +1016,7 @@ class ArtMethod final {
     // Non-abstract methods: The hotness we measure for this method. Not atomic,
     // as we allow missing increments: if the method is hot, we will see it eventually.
     uint16_t hotness_count_;
-    // Abstract methods: IMT index.
+    // Abstract methods: IMT index and interface hash, see ImTable::kImtIndexBits.
     uint16_t imt_index_;
   };
 
@@ -19,9 +19,11 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <deque>
 #include <forward_list>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
 #include <queue>
@@ -145,6 +147,7 @@
 #include "thread-inl.h"
 #include "thread.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "trace.h"
 #include "transaction.h"
 #include "vdex_file.h"
@@ -1126,7 +1129,9 @@ static uint32_t ComputeMethodHash(ArtMethod* method) REQUIRES_SHARED(Locks::muta
   const DexFile& dex_file = method->GetDeclaringClass<kWithoutReadBarrier>()->GetDexFile();
   const dex::MethodId& method_id = dex_file.GetMethodId(method->GetDexMethodIndex());
   std::string_view name = dex_file.GetMethodNameView(method_id);
-  return ComputeModifiedUtf8Hash(name);
+  // Include the shorty, so that most overloads with the same name get different hashes.
+  std::string_view shorty = dex_file.GetShortyView(dex_file.GetProtoId(method_id.proto_idx_));
+  return UpdateModifiedUtf8Hash(ComputeModifiedUtf8Hash(name), shorty);
 }
 
 ALWAYS_INLINE
@@ -2369,6 +2374,8 @@ void ClassLinker::DeleteClassLoader(Thread* self, const ClassLoaderData& data, b
     // If we don't have a JIT, we need to manually remove the CHA dependencies manually.
     cha_->RemoveDependenciesForLinearAlloc(data.allocator);
   }
+  // Forget the methods that were instrumented individually.
+  runtime->GetInstrumentation()->RemoveInstrumentedMethodsIn(*data.allocator);
   // Cleanup references to single implementation ArtMethods that will be deleted.
   if (cleanup_cha) {
     CHAOnDeleteUpdateClassVisitor visitor(data.allocator);
@@ -3060,6 +3067,164 @@ ObjPtr<mirror::Class> ClassLinker::FindClass(Thread* self,
   return result_ptr;
 }
 
+size_t ClassLinker::PreloadClasses(Thread* self,
+                                   const std::vector<std::string>& descriptors,
+                                   Handle<mirror::ClassLoader> class_loader,
+                                   ThreadPool* thread_pool) {
+  ScopedTrace trace("PreloadClasses");
+  const uint64_t start_time = NanoTime();
+  const size_t num_classes = descriptors.size();
+
+  // Find the superclass and interfaces of each class that are also in the list. The class
+  // definitions are looked up in the boot class path and in the dex files of the class loader
+  // only, which is enough to order the classes; FindClass() still does the actual lookup.
+  std::vector<std::vector<size_t>> dependencies(num_classes);
+  {
+    std::unordered_map<std::string_view, size_t> indexes;
+    for (size_t i = 0; i != num_classes; ++i) {
+      indexes.emplace(descriptors[i], i);
+    }
+    ScopedObjectAccessUnchecked soa(self);
+    const bool use_class_loader_dex_files =
+        class_loader != nullptr &&
+        (IsPathOrDexClassLoader(soa, class_loader) ||
+         IsInMemoryDexClassLoader(soa, class_loader) ||
+         IsDelegateLastClassLoader(soa, class_loader));
+    for (size_t i = 0; i != num_classes; ++i) {
+      const char* descriptor = descriptors[i].c_str();
+      const size_t hash = ComputeModifiedUtf8Hash(descriptor);
+      ClassPathEntry entry = FindInClassPath(descriptor, hash, boot_class_path_);
+      if (entry.second == nullptr && use_class_loader_dex_files) {
+        auto find_class_def = [&](const DexFile* dex_file) REQUIRES_SHARED(Locks::mutator_lock_) {
+          const dex::ClassDef* class_def = OatDexFile::FindClassDef(*dex_file, descriptor, hash);
+          if (class_def != nullptr) {
+            entry = ClassPathEntry(dex_file, class_def);
+            return false;  // Stop the visit.
+          }
+          return true;  // Continue with the next dex file.
+        };
+        VisitClassLoaderDexFiles(soa, class_loader, find_class_def);
+      }
+      if (entry.second == nullptr) {
+        continue;
+      }
+      const DexFile& dex_file = *entry.first;
+      auto add_dependency = [&](dex::TypeIndex type_index) {
+        auto it = indexes.find(dex_file.StringByTypeIdx(type_index));
+        if (it != indexes.end() && it->second != i) {
+          dependencies[i].push_back(it->second);
+        }
+      };
+      if (entry.second->superclass_idx_.IsValid()) {
+        add_dependency(entry.second->superclass_idx_);
+      }
+      const dex::TypeList* interfaces = dex_file.GetInterfacesList(*entry.second);
+      if (interfaces != nullptr) {
+        for (size_t j = 0; j != interfaces->Size(); ++j) {
+          add_dependency(interfaces->GetTypeItem(j).type_idx_);
+        }
+      }
+    }
+  }
+
+  // Compute the level of each class, one more than the highest level of its dependencies, with
+  // a depth-first traversal. Dependencies on a class that is still on the traversal stack are
+  // class circularities, which fail to load anyway, and are ignored.
+  static constexpr size_t kUnvisited = std::numeric_limits<size_t>::max();
+  static constexpr size_t kInProgress = kUnvisited - 1u;
+  std::vector<size_t> levels(num_classes, kUnvisited);
+  std::vector<size_t> stack;
+  size_t num_levels = 0u;
+  for (size_t root = 0; root != num_classes; ++root) {
+    if (levels[root] != kUnvisited) {
+      continue;
+    }
+    levels[root] = kInProgress;
+    stack.push_back(root);
+    while (!stack.empty()) {
+      const size_t i = stack.back();
+      auto unvisited = std::find_if(dependencies[i].begin(),
+                                    dependencies[i].end(),
+                                    [&](size_t dep) { return levels[dep] == kUnvisited; });
+      if (unvisited != dependencies[i].end()) {
+        levels[*unvisited] = kInProgress;
+        stack.push_back(*unvisited);
+        continue;
+      }
+      size_t level = 0u;
+      for (size_t dep : dependencies[i]) {
+        if (levels[dep] != kInProgress) {
+          level = std::max(level, levels[dep] + 1u);
+        }
+      }
+      levels[i] = level;
+      num_levels = std::max(num_levels, level + 1u);
+      stack.pop_back();
+    }
+  }
+
+  std::vector<uint8_t> loaded(num_classes, 0u);
+  if (thread_pool != nullptr &&
+      thread_pool->GetThreadCount() != 0u &&
+      !Runtime::Current()->GetRuntimeCallbacks()->HasClassLoadCallbacks()) {
+    std::vector<std::vector<size_t>> classes_by_level(num_levels);
+    for (size_t i = 0; i != num_classes; ++i) {
+      classes_by_level[levels[i]].push_back(i);
+    }
+    // The handle cannot be used by other threads, give them a global reference instead.
+    JavaVMExt* const vm = Runtime::Current()->GetJavaVM();
+    const jobject jclass_loader = vm->AddGlobalRef(self, class_loader.Get());
+    for (const std::vector<size_t>& level_classes : classes_by_level) {
+      // The classes of a level do not depend on each other, load them in parallel. Classes
+      // outside of the list that several of them depend on are loaded by the first thread that
+      // needs them, the others wait for them in EnsureResolved().
+      std::atomic<size_t> next_index(0u);
+      auto load_classes = [&](Thread* worker) {
+        ScopedObjectAccess soa(worker);
+        StackHandleScope<1> hs(worker);
+        Handle<mirror::ClassLoader> loader =
+            hs.NewHandle(soa.Decode<mirror::ClassLoader>(jclass_loader));
+        for (size_t index = next_index.fetch_add(1u, std::memory_order_relaxed);
+             index < level_classes.size();
+             index = next_index.fetch_add(1u, std::memory_order_relaxed)) {
+          const size_t i = level_classes[index];
+          if (FindClass(worker, descriptors[i].c_str(), loader) != nullptr) {
+            loaded[i] = 1u;
+          } else {
+            // Retried below on the calling thread, which can run Java class loader code.
+            worker->ClearException();
+          }
+        }
+      };
+      const size_t num_tasks = std::min(level_classes.size(), thread_pool->GetThreadCount() + 1u);
+      for (size_t task = 0; task != num_tasks; ++task) {
+        thread_pool->AddTask(self, new FunctionTask(load_classes));
+      }
+      // Go to native since we don't want to suspend while holding the mutator lock.
+      ScopedThreadSuspension sts(self, ThreadState::kNative);
+      thread_pool->Wait(self, /*do_work=*/ true, /*may_hold_locks=*/ false);
+    }
+    vm->DeleteGlobalRef(self, jclass_loader);
+  }
+
+  // Load the remaining classes in the order of the list.
+  size_t num_loaded = 0u;
+  for (size_t i = 0; i != num_classes; ++i) {
+    if (loaded[i] == 0u) {
+      if (FindClass(self, descriptors[i].c_str(), class_loader) == nullptr) {
+        VLOG(class_linker) << "Failed to preload " << descriptors[i] << ": "
+                           << self->GetException()->Dump();
+        self->ClearException();
+        continue;
+      }
+    }
+    ++num_loaded;
+  }
+  VLOG(class_linker) << "Preloaded " << num_loaded << " of " << num_classes << " classes in "
+                     << num_levels << " levels in " << PrettyDuration(NanoTime() - start_time);
+  return num_loaded;
+}
+
 // Helper for maintaining DefineClass counting. We need to notify callbacks when we start/end a
 // define-class and how many recursive DefineClasses we are at in order to allow for doing  things
 // like pausing class definition.
@@ -6408,9 +6573,7 @@ void ClassLinker::FillIMTFromIfTable(ObjPtr<mirror::IfTable> if_table,
           continue;
         }
         ImtConflictTable* table = imt[imt_index]->GetImtConflictTable(image_pointer_size_);
-        const size_t num_entries = table->NumEntries(image_pointer_size_);
-        table->SetInterfaceMethod(num_entries, image_pointer_size_, interface_method);
-        table->SetImplementationMethod(num_entries, image_pointer_size_, implementation_method);
+        table->AddEntry(interface_method, implementation_method, image_pointer_size_);
       }
     }
   }
@@ -7097,44 +7260,52 @@ class ClassLinker::LinkMethodsHelper {
     uint8_t* raw_vtable_;
   };
 
+  // A method with its signature hash. Signature sets are searched with this key and keep the
+  // hashes of their entries in a separate array, so that entries with a different hash are
+  // skipped without comparing signatures, which needs several dex file lookups.
+  struct MethodWithHash {
+    ArtMethod* method;
+    uint32_t hash;
+  };
+
   class VTableSignatureHash {
    public:
-    explicit VTableSignatureHash(VTableAccessor accessor)
-        REQUIRES_SHARED(Locks::mutator_lock_)
-        : accessor_(accessor) {}
+    explicit VTableSignatureHash(const uint32_t* hashes) : hashes_(hashes) {}
 
     // NO_THREAD_SAFETY_ANALYSIS: This is called from unannotated `HashSet<>` functions.
-    size_t operator()(ArtMethod* method) const NO_THREAD_SAFETY_ANALYSIS {
-      return ComputeMethodHash(method);
+    size_t operator()(const MethodWithHash& key) const NO_THREAD_SAFETY_ANALYSIS {
+      DCHECK_EQ(key.hash, ComputeMethodHash(key.method));
+      return key.hash;
     }
 
-    // NO_THREAD_SAFETY_ANALYSIS: This is called from unannotated `HashSet<>` functions.
-    size_t operator()(uint32_t index) const NO_THREAD_SAFETY_ANALYSIS {
-      return ComputeMethodHash(accessor_.GetVTableEntry(index));
+    size_t operator()(uint32_t index) const {
+      return hashes_[index];
     }
 
    private:
-    VTableAccessor accessor_;
+    const uint32_t* hashes_;
   };
 
   class VTableSignatureEqual {
    public:
-    explicit VTableSignatureEqual(VTableAccessor accessor)
+    VTableSignatureEqual(VTableAccessor accessor, const uint32_t* hashes)
         REQUIRES_SHARED(Locks::mutator_lock_)
-        : accessor_(accessor) {}
+        : accessor_(accessor), hashes_(hashes) {}
 
     // NO_THREAD_SAFETY_ANALYSIS: This is called from unannotated `HashSet<>` functions.
-    bool operator()(uint32_t lhs_index, ArtMethod* rhs) const NO_THREAD_SAFETY_ANALYSIS {
-      return MethodSignatureEquals(accessor_.GetVTableEntry(lhs_index), rhs);
+    bool operator()(uint32_t lhs_index, const MethodWithHash& rhs) const NO_THREAD_SAFETY_ANALYSIS {
+      return hashes_[lhs_index] == rhs.hash &&
+             MethodSignatureEquals(accessor_.GetVTableEntry(lhs_index), rhs.method);
     }
 
     // NO_THREAD_SAFETY_ANALYSIS: This is called from unannotated `HashSet<>` functions.
     bool operator()(uint32_t lhs_index, uint32_t rhs_index) const NO_THREAD_SAFETY_ANALYSIS {
-      return (*this)(lhs_index, accessor_.GetVTableEntry(rhs_index));
+      return (*this)(lhs_index, {accessor_.GetVTableEntry(rhs_index), hashes_[rhs_index]});
     }
 
    private:
     VTableAccessor accessor_;
+    const uint32_t* hashes_;
   };
 
   using VTableSignatureSet =
@@ -7142,37 +7313,36 @@ class ClassLinker::LinkMethodsHelper {
 
   class DeclaredVirtualSignatureHash {
    public:
-    explicit DeclaredVirtualSignatureHash(ObjPtr<mirror::Class> klass)
-        REQUIRES_SHARED(Locks::mutator_lock_)
-        : klass_(klass) {}
+    explicit DeclaredVirtualSignatureHash(const uint32_t* hashes) : hashes_(hashes) {}
 
     // NO_THREAD_SAFETY_ANALYSIS: This is called from unannotated `HashSet<>` functions.
-    size_t operator()(ArtMethod* method) const NO_THREAD_SAFETY_ANALYSIS {
-      return ComputeMethodHash(method);
+    size_t operator()(const MethodWithHash& key) const NO_THREAD_SAFETY_ANALYSIS {
+      DCHECK_EQ(key.hash, ComputeMethodHash(key.method));
+      return key.hash;
     }
 
-    // NO_THREAD_SAFETY_ANALYSIS: This is called from unannotated `HashSet<>` functions.
-    size_t operator()(uint32_t index) const NO_THREAD_SAFETY_ANALYSIS {
-      DCHECK_LT(index, klass_->NumDeclaredVirtualMethods());
-      ArtMethod* method = klass_->GetVirtualMethodDuringLinking(index, kPointerSize);
-      return ComputeMethodHash(method->GetInterfaceMethodIfProxy(kPointerSize));
+    size_t operator()(uint32_t index) const {
+      return hashes_[index];
     }
 
    private:
-    ObjPtr<mirror::Class> klass_;
+    const uint32_t* hashes_;
   };
 
   class DeclaredVirtualSignatureEqual {
    public:
-    explicit DeclaredVirtualSignatureEqual(ObjPtr<mirror::Class> klass)
+    DeclaredVirtualSignatureEqual(ObjPtr<mirror::Class> klass, const uint32_t* hashes)
         REQUIRES_SHARED(Locks::mutator_lock_)
-        : klass_(klass) {}
+        : klass_(klass), hashes_(hashes) {}
 
     // NO_THREAD_SAFETY_ANALYSIS: This is called from unannotated `HashSet<>` functions.
-    bool operator()(uint32_t lhs_index, ArtMethod* rhs) const NO_THREAD_SAFETY_ANALYSIS {
+    bool operator()(uint32_t lhs_index, const MethodWithHash& rhs) const NO_THREAD_SAFETY_ANALYSIS {
       DCHECK_LT(lhs_index, klass_->NumDeclaredVirtualMethods());
+      if (hashes_[lhs_index] != rhs.hash) {
+        return false;
+      }
       ArtMethod* lhs = klass_->GetVirtualMethodDuringLinking(lhs_index, kPointerSize);
-      return MethodSignatureEquals(lhs->GetInterfaceMethodIfProxy(kPointerSize), rhs);
+      return MethodSignatureEquals(lhs->GetInterfaceMethodIfProxy(kPointerSize), rhs.method);
     }
 
     // NO_THREAD_SAFETY_ANALYSIS: This is called from unannotated `HashSet<>` functions.
@@ -7184,6 +7354,7 @@ class ClassLinker::LinkMethodsHelper {
 
    private:
     ObjPtr<mirror::Class> klass_;
+    const uint32_t* hashes_;
   };
 
   using DeclaredVirtualSignatureSet = ScopedArenaHashSet<uint32_t,
@@ -7977,16 +8148,21 @@ size_t ClassLinker::LinkMethodsHelper<kPointerSize>::AssignVTableIndexes(
   static constexpr size_t kMaxStackBuferSize = 256;
   const size_t super_vtable_buffer_size = super_vtable_length * 3;
   const size_t declared_virtuals_buffer_size = num_virtual_methods * 3;
-  const size_t total_buffer_size = super_vtable_buffer_size + declared_virtuals_buffer_size;
+  // The hash of each method is computed once and kept next to the hash set buffers.
+  const size_t total_buffer_size =
+      super_vtable_buffer_size + declared_virtuals_buffer_size +
+      super_vtable_length + num_virtual_methods;
   uint32_t* super_vtable_buffer_ptr = (total_buffer_size <= kMaxStackBuferSize)
       ? reinterpret_cast<uint32_t*>(alloca(total_buffer_size * sizeof(uint32_t)))
       : allocator_.AllocArray<uint32_t>(total_buffer_size);
   uint32_t* declared_virtuals_buffer_ptr = super_vtable_buffer_ptr + super_vtable_buffer_size;
+  uint32_t* super_vtable_hashes = declared_virtuals_buffer_ptr + declared_virtuals_buffer_size;
+  uint32_t* declared_virtual_hashes = super_vtable_hashes + super_vtable_length;
   VTableSignatureSet super_vtable_signatures(
       kMinLoadFactor,
       kMaxLoadFactor,
-      VTableSignatureHash(super_vtable_accessor),
-      VTableSignatureEqual(super_vtable_accessor),
+      VTableSignatureHash(super_vtable_hashes),
+      VTableSignatureEqual(super_vtable_accessor, super_vtable_hashes),
       super_vtable_buffer_ptr,
       super_vtable_buffer_size,
       allocator_.Adapter());
@@ -7994,7 +8170,8 @@ size_t ClassLinker::LinkMethodsHelper<kPointerSize>::AssignVTableIndexes(
   // Insert the first `mirror::Object::kVTableLength` indexes with pre-calculated hashes.
   DCHECK_GE(super_vtable_length, mirror::Object::kVTableLength);
   for (uint32_t i = 0; i != mirror::Object::kVTableLength; ++i) {
-    size_t hash = class_linker_->object_virtual_method_hashes_[i];
+    uint32_t hash = class_linker_->object_virtual_method_hashes_[i];
+    super_vtable_hashes[i] = hash;
     // There are no duplicate signatures in `java.lang.Object`, so use `HashSet<>::PutWithHash()`.
     // This avoids equality comparison for the three `java.lang.Object.wait()` overloads.
     super_vtable_signatures.PutWithHash(i, hash);
@@ -8006,7 +8183,8 @@ size_t ClassLinker::LinkMethodsHelper<kPointerSize>::AssignVTableIndexes(
       // Letting `HashSet<>::insert()` use the internal accessor copy in the hash
       // function prevents the compiler from optimizing this properly because the
       // compiler cannot prove that the accessor copy is immutable.
-      size_t hash = ComputeMethodHash(super_vtable_accessor.GetVTableEntry(i));
+      uint32_t hash = ComputeMethodHash(super_vtable_accessor.GetVTableEntry(i));
+      super_vtable_hashes[i] = hash;
       auto [it, inserted] = super_vtable_signatures.InsertWithHash(i, hash);
       if (UNLIKELY(!inserted)) {
         if (same_signature_vtable_lists.empty()) {
@@ -8027,8 +8205,8 @@ size_t ClassLinker::LinkMethodsHelper<kPointerSize>::AssignVTableIndexes(
   DeclaredVirtualSignatureSet declared_virtual_signatures(
       kMinLoadFactor,
       kMaxLoadFactor,
-      DeclaredVirtualSignatureHash(klass),
-      DeclaredVirtualSignatureEqual(klass),
+      DeclaredVirtualSignatureHash(declared_virtual_hashes),
+      DeclaredVirtualSignatureEqual(klass, declared_virtual_hashes),
       declared_virtuals_buffer_ptr,
       declared_virtuals_buffer_size,
       allocator_.Adapter());
@@ -8040,9 +8218,10 @@ size_t ClassLinker::LinkMethodsHelper<kPointerSize>::AssignVTableIndexes(
     ArtMethod* signature_method = UNLIKELY(is_proxy_class)
         ? virtual_method->GetInterfaceMethodForProxyUnchecked(kPointerSize)
         : virtual_method;
-    size_t hash = ComputeMethodHash(signature_method);
+    uint32_t hash = ComputeMethodHash(signature_method);
+    declared_virtual_hashes[i] = hash;
     declared_virtual_signatures.PutWithHash(i, hash);
-    auto it = super_vtable_signatures.FindWithHash(signature_method, hash);
+    auto it = super_vtable_signatures.FindWithHash(MethodWithHash{signature_method, hash}, hash);
     if (it != super_vtable_signatures.end()) {
       size_t super_index = *it;
       DCHECK_LT(super_index, super_vtable_length);
@@ -8111,15 +8290,17 @@ size_t ClassLinker::LinkMethodsHelper<kPointerSize>::AssignVTableIndexes(
     size_t num_methods = (method_array != nullptr) ? method_array->GetLength() : 0u;
     for (size_t j = 0; j != num_methods; ++j) {
       ArtMethod* interface_method = iface->GetVirtualMethod(j, kPointerSize);
-      size_t hash = ComputeMethodHash(interface_method);
+      uint32_t hash = ComputeMethodHash(interface_method);
       ArtMethod* vtable_method = nullptr;
       bool found = false;
-      auto it1 = declared_virtual_signatures.FindWithHash(interface_method, hash);
+      auto it1 =
+          declared_virtual_signatures.FindWithHash(MethodWithHash{interface_method, hash}, hash);
       if (it1 != declared_virtual_signatures.end()) {
         vtable_method = klass->GetVirtualMethodDuringLinking(*it1, kPointerSize);
         found = true;
       } else {
-        auto it2 = super_vtable_signatures.FindWithHash(interface_method, hash);
+        auto it2 =
+            super_vtable_signatures.FindWithHash(MethodWithHash{interface_method, hash}, hash);
         if (it2 != super_vtable_signatures.end()) {
           // If there are multiple vtable methods with the same signature, the one with
           // the highest vtable index is not nessarily the one in most-derived class.
@@ -8221,21 +8402,24 @@ bool ClassLinker::LinkMethodsHelper<kPointerSize>::FindCopiedMethodsForInterface
   static constexpr double kMaxLoadFactor = 0.5;
   static constexpr size_t kMaxStackBuferSize = 256;
   const size_t declared_virtuals_buffer_size = num_virtual_methods * 3;
-  uint32_t* declared_virtuals_buffer_ptr = (declared_virtuals_buffer_size <= kMaxStackBuferSize)
-      ? reinterpret_cast<uint32_t*>(alloca(declared_virtuals_buffer_size * sizeof(uint32_t)))
-      : allocator_.AllocArray<uint32_t>(declared_virtuals_buffer_size);
+  const size_t total_buffer_size = declared_virtuals_buffer_size + num_virtual_methods;
+  uint32_t* declared_virtuals_buffer_ptr = (total_buffer_size <= kMaxStackBuferSize)
+      ? reinterpret_cast<uint32_t*>(alloca(total_buffer_size * sizeof(uint32_t)))
+      : allocator_.AllocArray<uint32_t>(total_buffer_size);
+  uint32_t* declared_virtual_hashes = declared_virtuals_buffer_ptr + declared_virtuals_buffer_size;
   DeclaredVirtualSignatureSet declared_virtual_signatures(
       kMinLoadFactor,
       kMaxLoadFactor,
-      DeclaredVirtualSignatureHash(klass),
-      DeclaredVirtualSignatureEqual(klass),
+      DeclaredVirtualSignatureHash(declared_virtual_hashes),
+      DeclaredVirtualSignatureEqual(klass, declared_virtual_hashes),
       declared_virtuals_buffer_ptr,
       declared_virtuals_buffer_size,
       allocator_.Adapter());
   for (size_t i = 0; i != num_virtual_methods; ++i) {
     ArtMethod* virtual_method = klass->GetVirtualMethodDuringLinking(i, kPointerSize);
     DCHECK(!virtual_method->IsStatic()) << virtual_method->PrettyMethod();
-    size_t hash = ComputeMethodHash(virtual_method);
+    uint32_t hash = ComputeMethodHash(virtual_method);
+    declared_virtual_hashes[i] = hash;
     declared_virtual_signatures.PutWithHash(i, hash);
   }
 
@@ -8259,8 +8443,9 @@ bool ClassLinker::LinkMethodsHelper<kPointerSize>::FindCopiedMethodsForInterface
       if (!interface_method->IsDefault()) {
         continue;  // Do not process this non-default method.
       }
-      size_t hash = ComputeMethodHash(interface_method);
-      auto it1 = declared_virtual_signatures.FindWithHash(interface_method, hash);
+      uint32_t hash = ComputeMethodHash(interface_method);
+      auto it1 =
+          declared_virtual_signatures.FindWithHash(MethodWithHash{interface_method, hash}, hash);
       if (it1 != declared_virtual_signatures.end()) {
         ArtMethod* virtual_method = klass->GetVirtualMethodDuringLinking(*it1, kPointerSize);
         if (!virtual_method->IsAbstract() && !virtual_method->IsPublic()) {
@@ -63,6 +63,7 @@ class ScopedObjectAccessAlreadyRunnable;
 class SdkChecker;
 template<size_t kNumReferences> class PACKED(4) StackHandleScope;
 class Thread;
+class ThreadPool;
 
 enum VisitRootFlags : uint8_t;
 
@@ -213,6 +214,22 @@ class ClassLinker {
     return FindClass(self, descriptor, ScopedNullHandle<mirror::ClassLoader>());
   }
 
+  // Load the classes with the given descriptors as if by FindClass(), for example to preload
+  // the classes of an app or of the zygote. Classes are grouped in levels so that a class is only
+  // loaded after its superclass and interfaces from the list, and the classes of each level are
+  // loaded and linked in parallel on `thread_pool` when it is not null. Classes that fail to load
+  // on the pool, for example because they need Java class loader code, are loaded again on the
+  // calling thread. When ClassLoadCallbacks are registered, the classes are loaded serially in
+  // the given order so that callbacks see the same ordering as with FindClass().
+  // Returns the number of classes that were loaded. Failures are not reported; the errors are
+  // thrown again when the classes are looked up.
+  size_t PreloadClasses(Thread* self,
+                        const std::vector<std::string>& descriptors,
+                        Handle<mirror::ClassLoader> class_loader,
+                        ThreadPool* thread_pool)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!Locks::dex_lock_);
+
   // Finds the array class given for the element class.
   ObjPtr<mirror::Class> FindArrayClass(Thread* self, ObjPtr<mirror::Class> element_class)
       REQUIRES_SHARED(Locks::mutator_lock_)
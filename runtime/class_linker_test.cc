@@ -20,11 +20,13 @@
 #include <string>
 #include <string_view>
 
+#include "android-base/stringprintf.h"
 #include "android-base/strings.h"
 
 #include "art_field-inl.h"
 #include "art_method-inl.h"
 #include "base/enums.h"
+#include "base/time_utils.h"
 #include "class_linker-inl.h"
 #include "class_root-inl.h"
 #include "common_runtime_test.h"
@@ -55,8 +57,11 @@
 #include "mirror/stack_trace_element.h"
 #include "mirror/string-inl.h"
 #include "mirror/var_handle.h"
+#include "runtime_callbacks.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-current-inl.h"
+#include "thread_list.h"
+#include "thread_pool.h"
 
 namespace art {
 
@@ -898,6 +903,126 @@ TEST_F(ClassLinkerTest, FindClassNested) {
   EXPECT_EQ(1U, inner->NumDirectMethods());
 }
 
+TEST_F(ClassLinkerTest, PreloadClasses) {
+  // Subclasses and subinterfaces come first so that they are moved to later levels.
+  const std::vector<std::string> descriptors = {
+      "LInterfaces$B;",
+      "LInterfaces$L;",
+      "LInterfaces$K;",
+      "LInterfaces$A;",
+      "LInterfaces$J;",
+      "LInterfaces$I;",
+      "LInterfaces$Missing;",
+      "Ljava/lang/Object;",
+  };
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool("Preload classes test thread pool", 4u);
+  thread_pool.StartWorkers(self);
+  for (ThreadPool* pool : {static_cast<ThreadPool*>(nullptr), &thread_pool}) {
+    ScopedObjectAccess soa(self);
+    StackHandleScope<1> hs(soa.Self());
+    Handle<mirror::ClassLoader> class_loader(
+        hs.NewHandle(soa.Decode<mirror::ClassLoader>(LoadDex("Interfaces"))));
+    EXPECT_EQ(descriptors.size() - 1u,
+              class_linker_->PreloadClasses(soa.Self(), descriptors, class_loader, pool));
+    EXPECT_FALSE(soa.Self()->IsExceptionPending());
+    for (const std::string& descriptor : descriptors) {
+      ObjPtr<mirror::Class> klass =
+          class_linker_->LookupClass(soa.Self(), descriptor.c_str(), class_loader.Get());
+      if (descriptor == "LInterfaces$Missing;") {
+        EXPECT_TRUE(klass == nullptr);
+      } else {
+        ASSERT_TRUE(klass != nullptr) << descriptor;
+        EXPECT_TRUE(klass->IsResolved()) << descriptor;
+        EXPECT_FALSE(klass->IsErroneous()) << descriptor;
+      }
+    }
+  }
+}
+
+TEST_F(ClassLinkerTest, PreloadClassesParallel) {
+  // Preload all classes of the dex file with subclasses first, so that most of them wait for
+  // classes of earlier levels, on a pool with more threads than classes in most levels.
+  jobject jclass_loader = LoadDex("LinkHierarchy");
+  std::vector<const DexFile*> dex_files = GetDexFiles(jclass_loader);
+  ASSERT_EQ(1u, dex_files.size());
+  std::vector<std::string> descriptors;
+  for (size_t i = dex_files[0]->NumClassDefs(); i != 0u; --i) {
+    descriptors.push_back(dex_files[0]->GetClassDescriptor(dex_files[0]->GetClassDef(i - 1u)));
+  }
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool("Preload classes test thread pool", 8u);
+  thread_pool.StartWorkers(self);
+  ScopedObjectAccess soa(self);
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::ClassLoader> class_loader(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader>(jclass_loader)));
+  EXPECT_EQ(descriptors.size(),
+            class_linker_->PreloadClasses(soa.Self(), descriptors, class_loader, &thread_pool));
+  EXPECT_FALSE(soa.Self()->IsExceptionPending());
+  EXPECT_EQ(0u, thread_pool.GetTaskCount(soa.Self()));
+  for (const std::string& descriptor : descriptors) {
+    ObjPtr<mirror::Class> klass =
+        class_linker_->LookupClass(soa.Self(), descriptor.c_str(), class_loader.Get());
+    ASSERT_TRUE(klass != nullptr) << descriptor;
+    EXPECT_TRUE(klass->IsResolved()) << descriptor;
+    EXPECT_FALSE(klass->IsErroneous()) << descriptor;
+    EXPECT_OBJ_PTR_EQ(klass->GetClassLoader(), class_loader.Get()) << descriptor;
+  }
+}
+
+class PreloadClassesClassLoadCallback : public ClassLoadCallback {
+ public:
+  void ClassLoad(Handle<mirror::Class> klass) override REQUIRES_SHARED(Locks::mutator_lock_) {
+    std::string temp;
+    loaded_.push_back(klass->GetDescriptor(&temp));
+  }
+
+  void ClassPrepare(Handle<mirror::Class> temp_klass ATTRIBUTE_UNUSED,
+                    Handle<mirror::Class> klass ATTRIBUTE_UNUSED) override
+      REQUIRES_SHARED(Locks::mutator_lock_) {}
+
+  std::vector<std::string> loaded_;
+};
+
+TEST_F(ClassLinkerTest, PreloadClassesWithClassLoadCallback) {
+  // Each class comes after the classes of the list it depends on, so FindClass() would report
+  // them in list order, while loading on the pool would reorder J and I, and A and K.
+  const std::vector<std::string> descriptors = {
+      "LInterfaces$J;",
+      "LInterfaces$I;",
+      "LInterfaces$A;",
+      "LInterfaces$K;",
+      "LInterfaces$B;",
+  };
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool("Preload classes test thread pool", 4u);
+  thread_pool.StartWorkers(self);
+  PreloadClassesClassLoadCallback callback;
+  {
+    ScopedObjectAccess soa(self);
+    ScopedThreadSuspension sts(soa.Self(), ThreadState::kSuspended);
+    ScopedSuspendAll ssa("Add class load callback");
+    Runtime::Current()->GetRuntimeCallbacks()->AddClassLoadCallback(&callback);
+  }
+  {
+    ScopedObjectAccess soa(self);
+    StackHandleScope<1> hs(soa.Self());
+    Handle<mirror::ClassLoader> class_loader(
+        hs.NewHandle(soa.Decode<mirror::ClassLoader>(LoadDex("Interfaces"))));
+    EXPECT_EQ(descriptors.size(),
+              class_linker_->PreloadClasses(soa.Self(), descriptors, class_loader, &thread_pool));
+    EXPECT_FALSE(soa.Self()->IsExceptionPending());
+  }
+  {
+    ScopedObjectAccess soa(self);
+    ScopedThreadSuspension sts(soa.Self(), ThreadState::kSuspended);
+    ScopedSuspendAll ssa("Remove class load callback");
+    Runtime::Current()->GetRuntimeCallbacks()->RemoveClassLoadCallback(&callback);
+  }
+  EXPECT_EQ(descriptors, callback.loaded_);
+}
+
 TEST_F(ClassLinkerTest, FindClass_Primitives) {
   ScopedObjectAccess soa(Thread::Current());
   const std::string expected("BCDFIJSZV");
@@ -1298,6 +1423,46 @@ TEST_F(ClassLinkerTest, Interfaces) {
   EXPECT_EQ(Afoo, Kfoo);
 }
 
+TEST_F(ClassLinkerTest, LinkHierarchy) {
+  static constexpr size_t kNumLevels = 16u;
+  static constexpr size_t kNumOverloads = 4u;
+  // Each level declares 8 methods `m<level>_<n>()` and 4 overloads of `p<level>()`.
+  static constexpr size_t kNumNewMethodsPerLevel = 12u;
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::ClassLoader> class_loader(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader>(LoadDex("LinkHierarchy"))));
+
+  // Loading the deepest class loads and links the whole hierarchy.
+  uint64_t start_time = NanoTime();
+  ObjPtr<mirror::Class> klass = class_linker_->FindClass(
+      soa.Self(), android::base::StringPrintf("LLinkHierarchy$C%zu;", kNumLevels - 1u).c_str(),
+      class_loader);
+  uint64_t link_time = NanoTime() - start_time;
+  ASSERT_TRUE(klass != nullptr);
+  LOG(INFO) << "Linked " << kNumLevels << " classes in " << PrettyDuration(link_time);
+
+  EXPECT_EQ(mirror::Object::kVTableLength + kNumOverloads + kNumLevels * kNumNewMethodsPerLevel,
+            static_cast<size_t>(klass->GetVTableLength()));
+  ObjPtr<mirror::Class> super_class = klass->GetSuperClass();
+  for (const char* signature : {"(I)V", "(J)V", "(Ljava/lang/String;)V", "(Ljava/lang/Object;)V"}) {
+    // The overloads of the previous level are overridden and keep their vtable index.
+    std::string name = android::base::StringPrintf("p%zu", kNumLevels - 2u);
+    ArtMethod* method = klass->FindClassMethod(name, signature, kRuntimePointerSize);
+    ArtMethod* super_method = super_class->FindClassMethod(name, signature, kRuntimePointerSize);
+    ASSERT_TRUE(method != nullptr);
+    ASSERT_TRUE(super_method != nullptr);
+    EXPECT_EQ(klass, method->GetDeclaringClass());
+    EXPECT_EQ(super_method->GetMethodIndex(), method->GetMethodIndex());
+    EXPECT_EQ(method, klass->GetVTableEntry(method->GetMethodIndex(), kRuntimePointerSize));
+    // Overloads of the interface methods are implemented by the most recent odd level.
+    ArtMethod* interface_method = klass->FindClassMethod("o", signature, kRuntimePointerSize);
+    ASSERT_TRUE(interface_method != nullptr);
+    EXPECT_TRUE(interface_method->GetDeclaringClass()->DescriptorEquals(
+        android::base::StringPrintf("LLinkHierarchy$C%zu;", kNumLevels - 1u).c_str()));
+  }
+}
+
 TEST_F(ClassLinkerTest, ResolveVerifyAndClinit) {
   // pretend we are trying to get the static storage for the StaticsFromCode class.
 
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "code_info_cache.h"
+
+#include <algorithm>
+
+#include "oat_quick_method_header.h"
+#include "thread-current-inl.h"
+
+namespace art {
+
+std::atomic<uint32_t> CodeInfoCache::generation_(0u);
+
+void CodeInfoCache::CheckGeneration() {
+  uint32_t generation = generation_.load(std::memory_order_acquire);
+  if (UNLIKELY(generation != seen_generation_)) {
+    for (Entry& entry : entries_) {
+      entry.header = nullptr;
+    }
+    seen_generation_ = generation;
+  }
+}
+
+bool CodeInfoCache::IsCached(const OatQuickMethodHeader* header) {
+  DCHECK(header->IsOptimized());
+  CheckGeneration();
+  const Entry* set = &entries_[SetIndexOf(header) * kNumWays];
+  for (size_t way = 0; way != kNumWays; ++way) {
+    if (set[way].header == header) {
+      return true;
+    }
+  }
+  return false;
+}
+
+CodeInfoCache::Entry* CodeInfoCache::Lookup(const OatQuickMethodHeader* header) {
+  DCHECK(header->IsOptimized());
+  CheckGeneration();
+  ++use_counter_;
+  Entry* set = &entries_[SetIndexOf(header) * kNumWays];
+  Entry* victim = set;
+  for (size_t way = 0; way != kNumWays; ++way) {
+    if (set[way].header == header) {
+      set[way].last_use = use_counter_;
+      return &set[way];
+    }
+    if (set[way].header == nullptr ||
+        (victim->header != nullptr && set[way].last_use < victim->last_use)) {
+      victim = &set[way];
+    }
+  }
+
+  // Miss. Decode the CodeInfo and index the native PCs of its stack maps.
+  victim->header = header;
+  victim->last_use = use_counter_;
+  victim->code_info = CodeInfo(header);
+  victim->packed_native_pcs.clear();  // Keeps the capacity for reuse.
+  for (StackMap stack_map : victim->code_info.GetStackMaps()) {
+    if (stack_map.GetKind() == StackMap::Kind::Catch) {
+      break;  // All catch stack maps are stored at the end.
+    }
+    victim->packed_native_pcs.push_back(stack_map.GetPackedNativePc());
+  }
+  return victim;
+}
+
+const CodeInfo& CodeInfoCache::GetCodeInfo(const OatQuickMethodHeader* header) {
+  return Lookup(header)->code_info;
+}
+
+uint32_t CodeInfoCache::GetStackMapIndex(const OatQuickMethodHeader* header,
+                                         uint32_t native_pc_offset) {
+  const Entry* entry = Lookup(header);
+  const CodeInfo& code_info = entry->code_info;
+  uint32_t packed_pc = StackMap::PackNativePc(native_pc_offset, kRuntimeISA);
+  // Same as the binary search in CodeInfo::GetStackMapForNativePcOffset(), but on the index.
+  auto it = std::lower_bound(
+      entry->packed_native_pcs.begin(), entry->packed_native_pcs.end(), packed_pc);
+  uint32_t num_stack_maps = code_info.GetNumberOfStackMaps();
+  for (uint32_t index = it - entry->packed_native_pcs.begin(); index != num_stack_maps; ++index) {
+    StackMap stack_map = code_info.GetStackMapAt(index);
+    if (stack_map.GetNativePcOffset(kRuntimeISA) != native_pc_offset) {
+      break;
+    }
+    StackMap::Kind kind = static_cast<StackMap::Kind>(stack_map.GetKind());
+    if (kind == StackMap::Kind::Default || kind == StackMap::Kind::OSR) {
+      return index;
+    }
+  }
+  return StackMap::kNoValue;
+}
+
+CodeInfo CodeInfoCache::Get(const OatQuickMethodHeader* header) {
+  Thread* self = Thread::Current();
+  if (UNLIKELY(self == nullptr)) {
+    return CodeInfo(header);
+  }
+  return self->GetCodeInfoCache()->GetCodeInfo(header);
+}
+
+bool CodeInfoCache::IsCachedForCurrentThread(const OatQuickMethodHeader* header) {
+  Thread* self = Thread::Current();
+  return self != nullptr && self->GetCodeInfoCache()->IsCached(header);
+}
+
+StackMap CodeInfoCache::GetStackMapForNativePcOffset(const OatQuickMethodHeader* header,
+                                                     const CodeInfo& code_info,
+                                                     uint32_t native_pc_offset) {
+  Thread* self = Thread::Current();
+  if (UNLIKELY(self == nullptr)) {
+    return code_info.GetStackMapForNativePcOffset(native_pc_offset);
+  }
+  uint32_t index = self->GetCodeInfoCache()->GetStackMapIndex(header, native_pc_offset);
+  DCHECK_EQ(index, code_info.GetStackMapForNativePcOffset(native_pc_offset).Row());
+  return (index != StackMap::kNoValue)
+      ? code_info.GetStackMapAt(index)
+      : code_info.GetStackMaps().GetInvalidRow();
+}
+
+}  // namespace art
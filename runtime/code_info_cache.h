@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_CODE_INFO_CACHE_H_
+#define ART_RUNTIME_CODE_INFO_CACHE_H_
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+#include "base/macros.h"
+#include "stack_map.h"
+
+namespace art {
+
+class OatQuickMethodHeader;
+
+// Small thread-local cache of decoded CodeInfo used by stack walks.
+//
+// Decoding a CodeInfo reads the interleaved varint headers of all its bit-tables, and the
+// binary search for a stack map does bit-unaligned loads of the native PC and kind of each
+// probed row. Stack walks over deep stacks (GC root visiting, exception delivery, filling
+// stack traces) repeat both for the same few methods many times, so we keep the decoded
+// CodeInfo together with a word-aligned index of the packed native PCs of its stack maps.
+//
+// The cache is 2-way set associative with LRU replacement, keyed by the method header.
+// All operations must be done from the owning thread. Entries are invalidated lazily through
+// a global generation counter which must be bumped by InvalidateAll() whenever compiled code
+// is freed, since the memory of a method header can later be reused for different code.
+class CodeInfoCache {
+ public:
+  static constexpr size_t kNumSets = 16;
+  static constexpr size_t kNumWays = 2;
+
+  CodeInfoCache() {}
+
+  // Returns the decoded CodeInfo for `header`, decoding it on a cache miss.
+  // The returned reference is valid until the next lookup.
+  const CodeInfo& GetCodeInfo(const OatQuickMethodHeader* header);
+
+  // Returns whether the CodeInfo of `header` is in the cache. Does not decode anything and
+  // does not update the LRU state.
+  bool IsCached(const OatQuickMethodHeader* header);
+
+  // Returns the index of the stack map for `native_pc_offset` in the CodeInfo of `header`, or
+  // StackMap::kNoValue. Matches the result of CodeInfo::GetStackMapForNativePcOffset().
+  uint32_t GetStackMapIndex(const OatQuickMethodHeader* header, uint32_t native_pc_offset);
+
+  // Convenience wrappers using the cache of the current thread. If the current thread is not
+  // attached, they decode the data directly.
+  static CodeInfo Get(const OatQuickMethodHeader* header);
+  // Returns whether the current thread has the CodeInfo of `header` in its cache.
+  static bool IsCachedForCurrentThread(const OatQuickMethodHeader* header);
+  // Returns the stack map for `native_pc_offset` from `code_info`, which must have been
+  // decoded from `header`.
+  static StackMap GetStackMapForNativePcOffset(const OatQuickMethodHeader* header,
+                                               const CodeInfo& code_info,
+                                               uint32_t native_pc_offset);
+
+  // Invalidate the caches of all threads. Must be called when compiled code is freed.
+  static void InvalidateAll() {
+    generation_.fetch_add(1u, std::memory_order_release);
+  }
+
+ private:
+  struct Entry {
+    const OatQuickMethodHeader* header = nullptr;
+    uint32_t last_use = 0u;
+    CodeInfo code_info;
+    // Packed native PCs of the stack maps before the first catch stack map, in row order.
+    std::vector<uint32_t> packed_native_pcs;
+  };
+
+  // Drops all entries if compiled code was freed since the last call.
+  void CheckGeneration();
+  Entry* Lookup(const OatQuickMethodHeader* header);
+
+  static size_t SetIndexOf(const OatQuickMethodHeader* header) {
+    static_assert(IsPowerOfTwo(kNumSets), "Number of sets must be power of two");
+    // Method headers are at least 4-byte aligned and usually farther apart than 64 bytes.
+    return (reinterpret_cast<uintptr_t>(header) >> 6) & (kNumSets - 1u);
+  }
+
+  uint32_t seen_generation_ = 0u;
+  uint32_t use_counter_ = 0u;
+  std::array<Entry, kNumSets * kNumWays> entries_;
+
+  static std::atomic<uint32_t> generation_;
+
+  DISALLOW_COPY_AND_ASSIGN(CodeInfoCache);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_CODE_INFO_CACHE_H_
@@ -2649,7 +2649,11 @@ extern "C" uint64_t artInvokeCustom(uint32_t call_site_idx, Thread* self, ArtMet
 extern "C" void artMethodEntryHook(ArtMethod* method, Thread* self, ArtMethod** sp ATTRIBUTE_UNUSED)
     REQUIRES_SHARED(Locks::mutator_lock_) {
   instrumentation::Instrumentation* instr = Runtime::Current()->GetInstrumentation();
-  instr->MethodEnterEvent(self, method);
+  // The hooks are enabled for all JITed code, but when only some methods are instrumented
+  // (see Instrumentation::InstrumentMethod) we only report events for those.
+  if (instr->ShouldReportEntryExitEvents(self, method)) {
+    instr->MethodEnterEvent(self, method);
+  }
   if (instr->IsDeoptimized(method)) {
     // Instrumentation can request deoptimizing only a particular method (for
     // ex: when there are break points on the method). In such cases deoptimize
@@ -2692,7 +2696,7 @@ extern "C" int artMethodExitHook(Thread* self,
 
     // If we need a deoptimization MethodExitEvent will be called by the interpreter when it
     // re-executes the return instruction.
-    if (!deoptimize) {
+    if (!deoptimize && instr->ShouldReportEntryExitEvents(self, method)) {
       instr->MethodExitEvent(self,
                              method,
                              /* frame= */ {},
@@ -232,6 +232,11 @@ inline mirror::Object* Heap::AllocObjectWithAllocator(Thread* self,
   } else {
     DCHECK(!Runtime::Current()->HasStatsEnabled());
   }
+  // The heap sampler picks allocations independently of the instrumentation, before the object
+  // is initialized. Record them here, once the object has its class.
+  if (UNLIKELY(live_heap_profiler_ != nullptr)) {
+    RecordLiveHeapSample(self, &obj);
+  }
   if (kInstrumented) {
     if (IsAllocTrackingEnabled()) {
       // allocation_records_ is not null since it never becomes null after allocation tracking is
@@ -292,6 +297,11 @@ inline mirror::Object* Heap::AllocLargeObject(Thread* self,
                         (self, *klass, byte_count, kAllocatorTypeLOS, pre_fence_visitor);
   // Java Heap Profiler check and sample allocation.
   JHPCheckNonTlabSampleAllocation(self, obj, byte_count);
+  if (UNLIKELY(live_heap_profiler_ != nullptr) && obj != nullptr) {
+    ObjPtr<mirror::Object> sampled_obj(obj);
+    RecordLiveHeapSample(self, &sampled_obj);
+    obj = sampled_obj.Ptr();
+  }
   return obj;
 }
 
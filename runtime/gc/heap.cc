@@ -102,6 +102,7 @@
 #include "reflection.h"
 #include "runtime.h"
 #include "javaheapprof/javaheapsampler.h"
+#include "javaheapprof/live_heap_profiler.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread_list.h"
 #include "verify_object-inl.h"
@@ -405,6 +406,7 @@ Heap::Heap(size_t initial_size,
                                         kGcCountRateMaxBucketCount),
       alloc_tracking_enabled_(false),
       alloc_record_depth_(AllocRecordObjectMap::kDefaultAllocStackDepth),
+      live_heap_profile_period_ms_(0u),
       backtrace_lock_(nullptr),
       seen_backtrace_count_(0u),
       unique_backtrace_count_(0u),
@@ -4338,6 +4340,52 @@ void Heap::JHPCheckNonTlabSampleAllocation(Thread* self, mirror::Object* obj, si
   }
 }
 
+void Heap::EnableLiveHeapProfiler(const std::string& output_prefix,
+                                  size_t sampling_interval,
+                                  uint32_t dump_period_ms) {
+  CHECK(live_heap_profiler_ == nullptr);
+  live_heap_profiler_.reset(
+      new LiveHeapProfiler(output_prefix, LiveHeapProfiler::kDefaultMaxStackDepth));
+  live_heap_profile_period_ms_ = dump_period_ms;
+  Runtime::Current()->AddSystemWeakHolder(live_heap_profiler_.get());
+  heap_sampler_.SetSamplingInterval(sampling_interval);
+  heap_sampler_.SetRecordPendingSamples(true);
+  heap_sampler_.EnableHeapSampler();
+  VLOG(heap) << "Live heap profiler enabled, writing to " << output_prefix;
+}
+
+void Heap::RecordLiveHeapSample(Thread* self, ObjPtr<mirror::Object>* obj) {
+  size_t byte_count = heap_sampler_.TakePendingSample(self, obj->Ptr());
+  if (byte_count != 0u) {
+    live_heap_profiler_->RecordSample(
+        self, obj, byte_count, heap_sampler_.GetSamplingInterval());
+  }
+}
+
+bool Heap::DumpLiveHeapProfile(Thread* self) {
+  DCHECK(live_heap_profiler_ != nullptr);
+  return live_heap_profiler_->Dump(self, heap_sampler_.GetSamplingInterval());
+}
+
+class Heap::LiveHeapProfileDumpTask : public HeapTask {
+ public:
+  explicit LiveHeapProfileDumpTask(uint64_t target_time) : HeapTask(target_time) {}
+  void Run(Thread* self) override {
+    gc::Heap* heap = Runtime::Current()->GetHeap();
+    heap->DumpLiveHeapProfile(self);
+    heap->RequestLiveHeapProfileDump(self);
+  }
+};
+
+void Heap::RequestLiveHeapProfileDump(Thread* self) {
+  if (live_heap_profiler_ == nullptr || live_heap_profile_period_ms_ == 0u ||
+      !CanAddHeapTask(self)) {
+    return;
+  }
+  task_processor_->AddTask(
+      self, new LiveHeapProfileDumpTask(NanoTime() + MsToNs(live_heap_profile_period_ms_)));
+}
+
 size_t Heap::JHPCalculateNextTlabSize(Thread* self,
                                       size_t jhp_def_tlab_size,
                                       size_t alloc_size,
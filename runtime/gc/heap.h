@@ -50,6 +50,7 @@ namespace art {
 class ConditionVariable;
 enum class InstructionSet;
 class IsMarkedVisitor;
+class LiveHeapProfiler;
 class Mutex;
 class ReflectiveValueVisitor;
 class RootVisitor;
@@ -271,6 +272,11 @@ class Heap {
                                                                   pre_fence_visitor);
     // Java Heap Profiler check and sample allocation.
     JHPCheckNonTlabSampleAllocation(self, obj, num_bytes);
+    if (UNLIKELY(live_heap_profiler_ != nullptr) && obj != nullptr) {
+      ObjPtr<mirror::Object> sampled_obj(obj);
+      RecordLiveHeapSample(self, &sampled_obj);
+      obj = sampled_obj.Ptr();
+    }
     return obj;
   }
 
@@ -907,6 +913,23 @@ class Heap {
   // Reduce the number of bytes to the next sample position by this adjustment.
   void AdjustSampleOffset(size_t adjustment);
 
+  // Live heap profiler support. The profiler records the objects picked by the heap sampler
+  // and periodically writes a pprof profile of the sampled live objects.
+  void EnableLiveHeapProfiler(const std::string& output_prefix,
+                              size_t sampling_interval,
+                              uint32_t dump_period_ms)
+      REQUIRES(!Locks::mutator_lock_);
+  LiveHeapProfiler* GetLiveHeapProfiler() const {
+    return live_heap_profiler_.get();
+  }
+  // Record the object if it is the pending sample of the heap sampler.
+  void RecordLiveHeapSample(Thread* self, ObjPtr<mirror::Object>* obj)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+  // Write the live heap profile now.
+  bool DumpLiveHeapProfile(Thread* self) REQUIRES(!Locks::mutator_lock_);
+  // Schedule a task to write the live heap profile after the dump period, and then periodically.
+  void RequestLiveHeapProfileDump(Thread* self) REQUIRES(!*pending_task_lock_);
+
   // Allocation tracking support
   // Callers to this function use double-checked locking to ensure safety on allocation_records_
   bool IsAllocTrackingEnabled() const {
@@ -991,6 +1014,7 @@ class Heap {
   class HeapTrimTask;
   class TriggerPostForkCCGcTask;
   class ReduceTargetFootprintTask;
+  class LiveHeapProfileDumpTask;
 
   // Compact source space to target space. Returns the collector used.
   collector::GarbageCollector* Compact(space::ContinuousMemMapAllocSpace* target_space,
@@ -1677,6 +1701,10 @@ class Heap {
   // Perfetto Java Heap Profiler support.
   HeapSampler heap_sampler_;
 
+  // Live heap profiler, or null if it is not enabled. Set before the runtime starts.
+  std::unique_ptr<LiveHeapProfiler> live_heap_profiler_;
+  uint32_t live_heap_profile_period_ms_;
+
   // GC stress related data structures.
   Mutex* backtrace_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   // Debugging variables, seen backtraces vs unique backtraces.
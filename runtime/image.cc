@@ -31,8 +31,8 @@
 namespace art {
 
 const uint8_t ImageHeader::kImageMagic[] = { 'a', 'r', 't', '\n' };
-// Last change: Add BootClassLoader instance.
-const uint8_t ImageHeader::kImageVersion[] = { '1', '0', '9', '\0' };
+// Last change: Store a hash of the declaring interface with the IMT index.
+const uint8_t ImageHeader::kImageVersion[] = { '1', '1', '0', '\0' };
 
 ImageHeader::ImageHeader(uint32_t image_reservation_size,
                          uint32_t component_count,
@@ -19,19 +19,27 @@
 
 #include <cstddef>
 
+#include "art_method.h"
+#include "base/bit_utils.h"
 #include "base/casts.h"
 #include "base/enums.h"
 #include "base/macros.h"
 
 namespace art {
 
-class ArtMethod;
-
 // Table to resolve IMT conflicts at runtime. The table is attached to
 // the jni entrypoint of IMT conflict ArtMethods.
 // The table contains a list of pairs of { interface_method, implementation_method }
 // with the last entry being null to make an assembly implementation of a lookup
 // faster.
+//
+// With 64-bit pointers, tables of at least kMinHashedEntries entries use a hashed
+// layout instead, so that megamorphic interface calls do not scan long tables. The
+// first pair is a header { kHashedTableMarker, capacity - 1 }, followed by `capacity`
+// slots forming an open-addressed table with linear probing, indexed by
+// ArtMethod::GetImtConflictTableHash(). Empty slots have a null interface method, and the
+// table is at most half full so that a lookup always ends on an empty slot. Accessors
+// taking an index refer to slots, which can be empty in the hashed layout.
 class ImtConflictTable {
   enum MethodIndex {
     kMethodInterface,
@@ -40,53 +48,90 @@ class ImtConflictTable {
   };
 
  public:
+  // Never a valid ArtMethod pointer.
+  static constexpr size_t kHashedTableMarker = 1u;
+  static constexpr size_t kMinHashedEntries = 8u;
+
   // Build a new table copying `other` and adding the new entry formed of
   // the pair { `interface_method`, `implementation_method` }
   ImtConflictTable(ImtConflictTable* other,
                    ArtMethod* interface_method,
                    ArtMethod* implementation_method,
-                   PointerSize pointer_size) {
-    const size_t count = other->NumEntries(pointer_size);
-    for (size_t i = 0; i < count; ++i) {
-      SetInterfaceMethod(i, pointer_size, other->GetInterfaceMethod(i, pointer_size));
-      SetImplementationMethod(i, pointer_size, other->GetImplementationMethod(i, pointer_size));
-    }
-    SetInterfaceMethod(count, pointer_size, interface_method);
-    SetImplementationMethod(count, pointer_size, implementation_method);
-    // Add the null marker.
-    SetInterfaceMethod(count + 1, pointer_size, nullptr);
-    SetImplementationMethod(count + 1, pointer_size, nullptr);
+                   PointerSize pointer_size)
+      : ImtConflictTable(other->NumEntries(pointer_size) + 1u, pointer_size) {
+    other->Visit([&](const std::pair<ArtMethod*, ArtMethod*>& entry) {
+      AddEntry(entry.first, entry.second, pointer_size);
+      return entry;
+    }, pointer_size);
+    AddEntry(interface_method, implementation_method, pointer_size);
   }
 
-  // num_entries excludes the header.
+  // num_entries excludes the header. The table is empty, entries are added with AddEntry.
   ImtConflictTable(size_t num_entries, PointerSize pointer_size) {
-    SetInterfaceMethod(num_entries, pointer_size, nullptr);
-    SetImplementationMethod(num_entries, pointer_size, nullptr);
+    size_t first_slot_pair = 0u;
+    size_t num_pairs = num_entries + 1u;  // Add one for null terminator.
+    if (UseHashedLayout(num_entries, pointer_size)) {
+      const size_t capacity = HashedCapacity(num_entries);
+      SetMethod(kMethodInterface, pointer_size, reinterpret_cast<ArtMethod*>(kHashedTableMarker));
+      SetMethod(kMethodImplementation, pointer_size, reinterpret_cast<ArtMethod*>(capacity - 1u));
+      first_slot_pair = 1u;
+      num_pairs = capacity + 1u;  // Add one for the header.
+    }
+    for (size_t i = first_slot_pair; i != num_pairs; ++i) {
+      SetMethod(i * kMethodCount + kMethodInterface, pointer_size, nullptr);
+      SetMethod(i * kMethodCount + kMethodImplementation, pointer_size, nullptr);
+    }
+  }
+
+  // Add an entry. The table must have been created with room for it.
+  void AddEntry(ArtMethod* interface_method,
+                ArtMethod* implementation_method,
+                PointerSize pointer_size) {
+    size_t index;
+    if (IsHashed(pointer_size)) {
+      const size_t mask = GetHashMask(pointer_size);
+      index = HashSlot(interface_method, mask);
+      while (GetInterfaceMethod(index, pointer_size) != nullptr) {
+        index = (index + 1u) & mask;
+      }
+    } else {
+      index = NumEntries(pointer_size);
+    }
+    SetInterfaceMethod(index, pointer_size, interface_method);
+    SetImplementationMethod(index, pointer_size, implementation_method);
   }
 
   // Set an entry at an index.
   void SetInterfaceMethod(size_t index, PointerSize pointer_size, ArtMethod* method) {
-    SetMethod(index * kMethodCount + kMethodInterface, pointer_size, method);
+    SetMethod(PairIndex(index, pointer_size) * kMethodCount + kMethodInterface,
+              pointer_size,
+              method);
   }
 
   void SetImplementationMethod(size_t index, PointerSize pointer_size, ArtMethod* method) {
-    SetMethod(index * kMethodCount + kMethodImplementation, pointer_size, method);
+    SetMethod(PairIndex(index, pointer_size) * kMethodCount + kMethodImplementation,
+              pointer_size,
+              method);
   }
 
   ArtMethod* GetInterfaceMethod(size_t index, PointerSize pointer_size) const {
-    return GetMethod(index * kMethodCount + kMethodInterface, pointer_size);
+    return GetMethod(PairIndex(index, pointer_size) * kMethodCount + kMethodInterface,
+                     pointer_size);
   }
 
   ArtMethod* GetImplementationMethod(size_t index, PointerSize pointer_size) const {
-    return GetMethod(index * kMethodCount + kMethodImplementation, pointer_size);
+    return GetMethod(PairIndex(index, pointer_size) * kMethodCount + kMethodImplementation,
+                     pointer_size);
   }
 
   void** AddressOfInterfaceMethod(size_t index, PointerSize pointer_size) {
-    return AddressOfMethod(index * kMethodCount + kMethodInterface, pointer_size);
+    return AddressOfMethod(PairIndex(index, pointer_size) * kMethodCount + kMethodInterface,
+                           pointer_size);
   }
 
   void** AddressOfImplementationMethod(size_t index, PointerSize pointer_size) {
-    return AddressOfMethod(index * kMethodCount + kMethodImplementation, pointer_size);
+    return AddressOfMethod(PairIndex(index, pointer_size) * kMethodCount + kMethodImplementation,
+                           pointer_size);
   }
 
   // Return true if two conflict tables are the same.
@@ -95,6 +140,18 @@ class ImtConflictTable {
     if (num != other->NumEntries(pointer_size)) {
       return false;
     }
+    if (IsHashed(pointer_size) || other->IsHashed(pointer_size)) {
+      // The slots depend on the insertion order, compare the contents.
+      for (size_t i = 0, num_slots = NumSlots(pointer_size); i < num_slots; ++i) {
+        ArtMethod* interface_method = GetInterfaceMethod(i, pointer_size);
+        if (interface_method != nullptr &&
+            other->Lookup(interface_method, pointer_size) !=
+                GetImplementationMethod(i, pointer_size)) {
+          return false;
+        }
+      }
+      return true;
+    }
     for (size_t i = 0; i < num; ++i) {
       if (GetInterfaceMethod(i, pointer_size) != other->GetInterfaceMethod(i, pointer_size) ||
           GetImplementationMethod(i, pointer_size) !=
@@ -107,13 +164,19 @@ class ImtConflictTable {
 
   // Visit all of the entries.
   // NO_THREAD_SAFETY_ANALYSIS for calling with held locks. Visitor is passed a pair of ArtMethod*
-  // and also returns one. The order is <interface, implementation>.
+  // and also returns one. The order is <interface, implementation>. The visitor must not
+  // replace an interface method with a method of a different hash, as the entry would then
+  // be in the wrong slot of a hashed table.
   template<typename Visitor>
   void Visit(const Visitor& visitor, PointerSize pointer_size) NO_THREAD_SAFETY_ANALYSIS {
-    uint32_t table_index = 0;
-    for (;;) {
+    const bool is_hashed = IsHashed(pointer_size);
+    const size_t num_slots = is_hashed ? GetHashMask(pointer_size) + 1u : 0u;
+    for (uint32_t table_index = 0; !is_hashed || table_index != num_slots; ++table_index) {
       ArtMethod* interface_method = GetInterfaceMethod(table_index, pointer_size);
       if (interface_method == nullptr) {
+        if (is_hashed) {
+          continue;
+        }
         break;
       }
       ArtMethod* implementation_method = GetImplementationMethod(table_index, pointer_size);
@@ -125,13 +188,24 @@ class ImtConflictTable {
       if (input.second != updated.second) {
         SetImplementationMethod(table_index, pointer_size, updated.second);
       }
-      ++table_index;
     }
   }
 
   // Lookup the implementation ArtMethod associated to `interface_method`. Return null
   // if not found.
   ArtMethod* Lookup(ArtMethod* interface_method, PointerSize pointer_size) const {
+    if (IsHashed(pointer_size)) {
+      const size_t mask = GetHashMask(pointer_size);
+      for (size_t index = HashSlot(interface_method, mask); ; index = (index + 1u) & mask) {
+        ArtMethod* current_interface_method = GetInterfaceMethod(index, pointer_size);
+        if (current_interface_method == interface_method) {
+          return GetImplementationMethod(index, pointer_size);
+        }
+        if (current_interface_method == nullptr) {
+          return nullptr;
+        }
+      }
+    }
     uint32_t table_index = 0;
     for (;;) {
       ArtMethod* current_interface_method = GetInterfaceMethod(table_index, pointer_size);
@@ -148,6 +222,15 @@ class ImtConflictTable {
 
   // Compute the number of entries in this table.
   size_t NumEntries(PointerSize pointer_size) const {
+    if (IsHashed(pointer_size)) {
+      size_t num_entries = 0u;
+      for (size_t i = 0, num_slots = NumSlots(pointer_size); i < num_slots; ++i) {
+        if (GetInterfaceMethod(i, pointer_size) != nullptr) {
+          ++num_entries;
+        }
+      }
+      return num_entries;
+    }
     uint32_t table_index = 0;
     while (GetInterfaceMethod(table_index, pointer_size) != nullptr) {
       ++table_index;
@@ -155,20 +238,36 @@ class ImtConflictTable {
     return table_index;
   }
 
+  // Return the number of slots to iterate over to see all entries. In the hashed layout,
+  // some of the slots are empty.
+  size_t NumSlots(PointerSize pointer_size) const {
+    return IsHashed(pointer_size) ? GetHashMask(pointer_size) + 1u : NumEntries(pointer_size);
+  }
+
+  bool IsHashed(PointerSize pointer_size) const {
+    return pointer_size == PointerSize::k64 &&
+           GetMethod(kMethodInterface, pointer_size) ==
+               reinterpret_cast<ArtMethod*>(kHashedTableMarker);
+  }
+
   // Compute the size in bytes taken by this table.
   size_t ComputeSize(PointerSize pointer_size) const {
-    // Add the end marker.
-    return ComputeSize(NumEntries(pointer_size), pointer_size);
+    // Add the end marker, or the header of the hashed layout.
+    return (NumSlots(pointer_size) + 1) * EntrySize(pointer_size);
   }
 
   // Compute the size in bytes needed for copying the given `table` and add
   // one more entry.
   static size_t ComputeSizeWithOneMoreEntry(ImtConflictTable* table, PointerSize pointer_size) {
-    return table->ComputeSize(pointer_size) + EntrySize(pointer_size);
+    return ComputeSize(table->NumEntries(pointer_size) + 1u, pointer_size);
   }
 
   // Compute size with a fixed number of entries.
   static size_t ComputeSize(size_t num_entries, PointerSize pointer_size) {
+    if (UseHashedLayout(num_entries, pointer_size)) {
+      // Add one for the header.
+      return (HashedCapacity(num_entries) + 1) * EntrySize(pointer_size);
+    }
     return (num_entries + 1) * EntrySize(pointer_size);  // Add one for null terminator.
   }
 
@@ -177,6 +276,32 @@ class ImtConflictTable {
   }
 
  private:
+  // The assembly stubs only know about the hashed layout for 64-bit pointers.
+  static bool UseHashedLayout(size_t num_entries, PointerSize pointer_size) {
+    return pointer_size == PointerSize::k64 && num_entries >= kMinHashedEntries;
+  }
+
+  // Keep the table at most half full.
+  static size_t HashedCapacity(size_t num_entries) {
+    return RoundUpToPowerOfTwo(2u * num_entries);
+  }
+
+  // This does not read the declaring class, which may not be resolved when the image writer
+  // and oatdump visit the table.
+  static size_t HashSlot(ArtMethod* interface_method, size_t mask) {
+    return interface_method->GetImtConflictTableHash() & mask;
+  }
+
+  size_t GetHashMask(PointerSize pointer_size) const {
+    return reinterpret_cast<uintptr_t>(GetMethod(kMethodImplementation, pointer_size));
+  }
+
+  // Return the index of the pair holding the slot `index`, skipping the header of the
+  // hashed layout.
+  size_t PairIndex(size_t index, PointerSize pointer_size) const {
+    return IsHashed(pointer_size) ? index + 1u : index;
+  }
+
   void** AddressOfMethod(size_t index, PointerSize pointer_size) {
     if (pointer_size == PointerSize::k64) {
       return reinterpret_cast<void**>(&data64_[index]);
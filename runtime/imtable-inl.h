@@ -92,7 +92,12 @@ inline uint32_t ImTable::GetImtIndex(ArtMethod* method) {
   }
   uint32_t class_hash, name_hash, signature_hash;
   GetImtHashComponents(method, &class_hash, &name_hash, &signature_hash);
+  return GetImtIndex(class_hash, name_hash, signature_hash);
+}
 
+inline uint32_t ImTable::GetImtIndex(uint32_t class_hash,
+                                     uint32_t name_hash,
+                                     uint32_t signature_hash) {
   uint32_t mixed_hash;
   if (!kImTableHashUseCoefficients) {
     mixed_hash = class_hash + name_hash + signature_hash;
@@ -105,6 +110,14 @@ inline uint32_t ImTable::GetImtIndex(ArtMethod* method) {
   return mixed_hash % ImTable::kSize;
 }
 
+inline uint32_t ImTable::GetInterfaceHash(uint32_t class_hash) {
+  // Keep the high bits of a multiplicative hash. The descriptors of interfaces declared
+  // together often differ only in their last characters, which only changes the low bits of
+  // the class hash.
+  static constexpr uint32_t kGoldenRatio = 0x9e3779b1u;
+  return (class_hash * kGoldenRatio) >> (32u - kInterfaceHashBits);
+}
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_IMTABLE_INL_H_
@@ -40,6 +40,14 @@ class ImTable {
   // is to simplify fetching it in the interpreter.
   static constexpr size_t kSizeTruncToPowerOfTwo = TruncToPowerOfTwo(kSize);
 
+  // Abstract methods store their IMT index in the low kImtIndexBits bits of
+  // ArtMethod::imt_index_, and a hash of their declaring interface in the remaining bits. The
+  // interface hash lets ImtConflictTable tell apart the methods of different interfaces that
+  // share a method index, which is common for small interfaces.
+  static constexpr size_t kImtIndexBits = MinimumBitsToStore(kSize - 1u);
+  static constexpr uint32_t kImtIndexMask = (1u << kImtIndexBits) - 1u;
+  static constexpr size_t kInterfaceHashBits = 16u - kImtIndexBits;
+
   uint8_t* AddressOfElement(size_t index, PointerSize pointer_size) {
     return reinterpret_cast<uint8_t*>(this) + OffsetOfElement(index, pointer_size);
   }
@@ -91,6 +99,15 @@ class ImTable {
   // (IMT).
   ALWAYS_INLINE static inline uint32_t GetImtIndex(ArtMethod* method)
       REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Same as above, for an abstract method whose hash components are known.
+  ALWAYS_INLINE static inline uint32_t GetImtIndex(uint32_t class_hash,
+                                                   uint32_t name_hash,
+                                                   uint32_t signature_hash);
+
+  // Reduce the class component of the hash to the kInterfaceHashBits bits stored with the IMT
+  // index of abstract methods.
+  ALWAYS_INLINE static inline uint32_t GetInterfaceHash(uint32_t class_hash);
 };
 
 }  // namespace art
@@ -19,12 +19,16 @@
 #include <memory>
 #include <string>
 
+#include "android-base/stringprintf.h"
 #include "jni.h"
 
 #include "base/mutex.h"
+#include "base/time_utils.h"
 #include "class_linker.h"
 #include "common_runtime_test.h"
+#include "dex/utf.h"
 #include "handle_scope-inl.h"
+#include "imt_conflict_table.h"
 #include "mirror/accessible_object.h"
 #include "mirror/class.h"
 #include "mirror/class_loader.h"
@@ -85,6 +89,65 @@ class ImTableTest : public CommonRuntimeTest {
 
     return std::make_pair(method_a, method_b);
   }
+
+  // Create a conflict table mapping each of the `num_entries` first `interface_methods` to the
+  // `implementation_methods` with the same index.
+  static ImtConflictTable* CreateConflictTable(std::vector<ArtMethod>& interface_methods,
+                                               std::vector<ArtMethod>& implementation_methods,
+                                               size_t num_entries,
+                                               /*out*/ std::unique_ptr<uint64_t[]>* storage) {
+    const size_t size = ImtConflictTable::ComputeSize(num_entries, kRuntimePointerSize);
+    storage->reset(new uint64_t[RoundUp(size, sizeof(uint64_t)) / sizeof(uint64_t)]);
+    ImtConflictTable* table = new (storage->get()) ImtConflictTable(num_entries,
+                                                                    kRuntimePointerSize);
+    for (size_t i = 0; i != num_entries; ++i) {
+      table->AddEntry(&interface_methods[i], &implementation_methods[i], kRuntimePointerSize);
+    }
+    EXPECT_EQ(size, table->ComputeSize(kRuntimePointerSize));
+    return table;
+  }
+
+  static std::vector<ArtMethod> CreateMethods(size_t count) REQUIRES_SHARED(Locks::mutator_lock_) {
+    std::vector<ArtMethod> methods(count);
+    for (size_t i = 0; i != count; ++i) {
+      // Spread the indexes so that some of them collide in hashed tables.
+      methods[i].SetMethodIndex(static_cast<uint16_t>(i * 3u));
+      methods[i].SetDexMethodIndex(static_cast<uint32_t>(i));
+    }
+    return methods;
+  }
+
+  // Create the methods of `count` interfaces declaring a single abstract method, which all
+  // share the same IMT index. These all have method index 0.
+  static std::vector<ArtMethod> CreateSingleMethodInterfaceMethods(size_t count)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    static constexpr uint32_t kImtIndex = 7u;
+    std::vector<ArtMethod> methods(count);
+    for (size_t i = 0; i != count; ++i) {
+      methods[i].SetAccessFlags(kAccPublic | kAccAbstract);
+      methods[i].SetMethodIndex(0u);
+      std::string descriptor = android::base::StringPrintf("LItf%zu;", i);
+      methods[i].SetImtIndexAndInterfaceHash(
+          kImtIndex, ImTable::GetInterfaceHash(ComputeModifiedUtf8Hash(descriptor.c_str())));
+      EXPECT_EQ(kImtIndex, methods[i].GetImtIndex());
+    }
+    return methods;
+  }
+
+  // Return the largest number of slots probed before finding an entry of a hashed table.
+  static size_t GetMaxProbeLength(ImtConflictTable* table) REQUIRES_SHARED(Locks::mutator_lock_) {
+    CHECK(table->IsHashed(kRuntimePointerSize));
+    const size_t num_slots = table->NumSlots(kRuntimePointerSize);
+    size_t max_probe_length = 0u;
+    for (size_t i = 0; i != num_slots; ++i) {
+      ArtMethod* interface_method = table->GetInterfaceMethod(i, kRuntimePointerSize);
+      if (interface_method != nullptr) {
+        size_t home_slot = interface_method->GetImtConflictTableHash() & (num_slots - 1u);
+        max_probe_length = std::max(max_probe_length, (i - home_slot) & (num_slots - 1u));
+      }
+    }
+    return max_probe_length;
+  }
 };
 
 TEST_F(ImTableTest, NewMethodBefore) {
@@ -101,4 +164,161 @@ TEST_F(ImTableTest, NewClassBefore) {
   CHECK_EQ(ImTable::GetImtIndex(methods.first), ImTable::GetImtIndex(methods.second));
 }
 
+TEST_F(ImTableTest, ConflictTableLookup) {
+  ScopedObjectAccess soa(Thread::Current());
+  static constexpr size_t kMaxEntries = 100u;
+  std::vector<ArtMethod> interface_methods = CreateMethods(kMaxEntries + 1u);
+  std::vector<ArtMethod> implementation_methods = CreateMethods(kMaxEntries + 1u);
+
+  for (size_t num_entries : {0u, 1u, 7u, 8u, 33u, 100u}) {
+    std::unique_ptr<uint64_t[]> storage;
+    ImtConflictTable* table =
+        CreateConflictTable(interface_methods, implementation_methods, num_entries, &storage);
+    EXPECT_EQ(kRuntimePointerSize == PointerSize::k64 &&
+                  num_entries >= ImtConflictTable::kMinHashedEntries,
+              table->IsHashed(kRuntimePointerSize)) << num_entries;
+    EXPECT_EQ(num_entries, table->NumEntries(kRuntimePointerSize));
+    for (size_t i = 0; i != num_entries; ++i) {
+      EXPECT_EQ(&implementation_methods[i],
+                table->Lookup(&interface_methods[i], kRuntimePointerSize)) << i;
+    }
+    EXPECT_EQ(nullptr, table->Lookup(&interface_methods[num_entries], kRuntimePointerSize));
+
+    size_t num_visited = 0u;
+    table->Visit([&](const std::pair<ArtMethod*, ArtMethod*>& entry) {
+      EXPECT_EQ(entry.first - interface_methods.data(),
+                entry.second - implementation_methods.data());
+      ++num_visited;
+      return entry;
+    }, kRuntimePointerSize);
+    EXPECT_EQ(num_entries, num_visited);
+
+    // Copy the table with one more entry, as when a new conflict is resolved at runtime.
+    std::unique_ptr<uint64_t[]> copy_storage(new uint64_t[
+        ImtConflictTable::ComputeSizeWithOneMoreEntry(table, kRuntimePointerSize) /
+            sizeof(uint64_t) + 1u]);
+    ImtConflictTable* copy = new (copy_storage.get()) ImtConflictTable(
+        table,
+        &interface_methods[num_entries],
+        &implementation_methods[num_entries],
+        kRuntimePointerSize);
+    EXPECT_EQ(num_entries + 1u, copy->NumEntries(kRuntimePointerSize));
+    for (size_t i = 0; i <= num_entries; ++i) {
+      EXPECT_EQ(&implementation_methods[i],
+                copy->Lookup(&interface_methods[i], kRuntimePointerSize)) << i;
+    }
+    EXPECT_FALSE(copy->Equals(table, kRuntimePointerSize));
+  }
+}
+
+TEST_F(ImTableTest, ConflictTableEquals) {
+  ScopedObjectAccess soa(Thread::Current());
+  static constexpr size_t kNumEntries = 20u;
+  std::vector<ArtMethod> interface_methods = CreateMethods(kNumEntries);
+  std::vector<ArtMethod> implementation_methods = CreateMethods(kNumEntries);
+  std::unique_ptr<uint64_t[]> storage;
+  ImtConflictTable* table =
+      CreateConflictTable(interface_methods, implementation_methods, kNumEntries, &storage);
+
+  // Insert the same entries in reverse order.
+  std::unique_ptr<uint64_t[]> reversed_storage(new uint64_t[
+      ImtConflictTable::ComputeSize(kNumEntries, kRuntimePointerSize) / sizeof(uint64_t) + 1u]);
+  ImtConflictTable* reversed =
+      new (reversed_storage.get()) ImtConflictTable(kNumEntries, kRuntimePointerSize);
+  for (size_t i = kNumEntries; i != 0u; --i) {
+    reversed->AddEntry(
+        &interface_methods[i - 1u], &implementation_methods[i - 1u], kRuntimePointerSize);
+  }
+  // The linear layout is compared entry by entry, the hashed layout by contents.
+  EXPECT_EQ(table->IsHashed(kRuntimePointerSize), table->Equals(reversed, kRuntimePointerSize));
+  EXPECT_TRUE(table->Equals(table, kRuntimePointerSize));
+}
+
+// Class redefinition changes the dex method index of the interface methods, which must not
+// move them in hashed tables.
+TEST_F(ImTableTest, ConflictTableLookupAfterDexMethodIndexChange) {
+  ScopedObjectAccess soa(Thread::Current());
+  static constexpr size_t kNumEntries = 2u * ImtConflictTable::kMinHashedEntries;
+  std::vector<ArtMethod> interface_methods = CreateMethods(kNumEntries);
+  std::vector<ArtMethod> implementation_methods = CreateMethods(kNumEntries);
+  std::unique_ptr<uint64_t[]> storage;
+  ImtConflictTable* table =
+      CreateConflictTable(interface_methods, implementation_methods, kNumEntries, &storage);
+  for (size_t i = 0; i != kNumEntries; ++i) {
+    interface_methods[i].SetDexMethodIndex(static_cast<uint32_t>(kNumEntries - i + 7u));
+  }
+  for (size_t i = 0; i != kNumEntries; ++i) {
+    EXPECT_EQ(&implementation_methods[i],
+              table->Lookup(&interface_methods[i], kRuntimePointerSize)) << i;
+  }
+  EXPECT_EQ(kNumEntries, table->NumEntries(kRuntimePointerSize));
+}
+
+// The methods of small interfaces almost all have method index 0 or 1. The hash of their
+// interface keeps them from piling up in the same slots.
+TEST_F(ImTableTest, ConflictTableSingleMethodInterfaces) {
+  if (kRuntimePointerSize != PointerSize::k64) {
+    GTEST_SKIP() << "Conflict tables are only hashed with 64-bit pointers";
+  }
+  ScopedObjectAccess soa(Thread::Current());
+  static constexpr size_t kNumEntries = 64u;
+  static constexpr size_t kMaxProbeLength = 4u;
+  std::vector<ArtMethod> interface_methods = CreateSingleMethodInterfaceMethods(kNumEntries);
+  std::vector<ArtMethod> implementation_methods = CreateMethods(kNumEntries);
+  std::unique_ptr<uint64_t[]> storage;
+  ImtConflictTable* table =
+      CreateConflictTable(interface_methods, implementation_methods, kNumEntries, &storage);
+  ASSERT_TRUE(table->IsHashed(kRuntimePointerSize));
+  for (size_t i = 0; i != kNumEntries; ++i) {
+    EXPECT_EQ(&implementation_methods[i],
+              table->Lookup(&interface_methods[i], kRuntimePointerSize)) << i;
+  }
+  EXPECT_LE(GetMaxProbeLength(table), kMaxProbeLength);
+}
+
+// Compares lookups in conflict tables with a linear scan of the same entries, as done
+// before the hashed layout, for megamorphic call sites on methods of many small interfaces.
+TEST_F(ImTableTest, ConflictTableLookupSpeed) {
+  ScopedObjectAccess soa(Thread::Current());
+  static constexpr size_t kNumLookups = 1000000u;
+  for (size_t num_entries : {4u, 16u, 64u, 256u}) {
+    std::vector<ArtMethod> interface_methods = CreateSingleMethodInterfaceMethods(num_entries);
+    std::vector<ArtMethod> implementation_methods = CreateMethods(num_entries);
+    std::unique_ptr<uint64_t[]> storage;
+    ImtConflictTable* table =
+        CreateConflictTable(interface_methods, implementation_methods, num_entries, &storage);
+    std::vector<std::pair<ArtMethod*, ArtMethod*>> linear_entries;
+    for (size_t i = 0; i != num_entries; ++i) {
+      linear_entries.emplace_back(&interface_methods[i], &implementation_methods[i]);
+    }
+
+    size_t found = 0u;
+    uint64_t start = NanoTime();
+    for (size_t i = 0; i != kNumLookups; ++i) {
+      ArtMethod* interface_method = &interface_methods[i % num_entries];
+      for (const auto& entry : linear_entries) {
+        if (entry.first == interface_method) {
+          found += (entry.second != nullptr) ? 1u : 0u;
+          break;
+        }
+      }
+    }
+    uint64_t linear_time = NanoTime() - start;
+    start = NanoTime();
+    for (size_t i = 0; i != kNumLookups; ++i) {
+      found += (table->Lookup(&interface_methods[i % num_entries], kRuntimePointerSize) != nullptr)
+          ? 1u : 0u;
+    }
+    uint64_t table_time = NanoTime() - start;
+    EXPECT_EQ(2u * kNumLookups, found);
+    LOG(INFO) << "ImtConflictTable with " << num_entries << " single method interfaces"
+              << (table->IsHashed(kRuntimePointerSize)
+                      ? android::base::StringPrintf(" (hashed, max probe length %zu): ",
+                                                    GetMaxProbeLength(table))
+                      : std::string(": "))
+              << (table_time / kNumLookups) << "ns per lookup, linear scan "
+              << (linear_time / kNumLookups) << "ns per lookup";
+  }
+}
+
 }  // namespace art
@@ -42,6 +42,7 @@
 #include "jit/jit_code_cache.h"
 #include "jvalue-inl.h"
 #include "jvalue.h"
+#include "linear_alloc.h"
 #include "mirror/class-inl.h"
 #include "mirror/dex_cache.h"
 #include "mirror/object-inl.h"
@@ -184,6 +185,7 @@ Instrumentation::Instrumentation()
       have_exception_handled_listeners_(false),
       deoptimized_methods_lock_(new ReaderWriterMutex("deoptimized methods lock",
                                                       kGenericBottomLock)),
+      num_instrumented_methods_(0u),
       quick_alloc_entry_points_instrumentation_counter_(0),
       alloc_entrypoints_instrumented_(false) {
 }
@@ -441,7 +443,7 @@ void Instrumentation::InstallStubsForMethod(ArtMethod* method) {
     return;
   }
 
-  if (EntryExitStubsInstalled()) {
+  if (NeedsEntryExitEvents(method)) {
     // Install the instrumentation entry point if needed.
     if (CodeNeedsEntryExitStub(method->GetEntryPointFromQuickCompiledCode(), method)) {
       UpdateEntryPoints(method, GetQuickInstrumentationEntryPoint());
@@ -901,9 +903,12 @@ void Instrumentation::UpdateInstrumentationLevel(InstrumentationLevel requested_
 }
 
 void Instrumentation::MaybeRestoreInstrumentationStack() {
-  // Restore stack only if there is no method currently deoptimized.
-  if (!IsDeoptimizedMethodsEmpty()) {
-    return;
+  // Restore stack only if there is no method currently deoptimized or instrumented.
+  {
+    ReaderMutexLock mu(Thread::Current(), *GetDeoptimizedMethodsLock());
+    if (!deoptimized_methods_.empty() || !instrumented_methods_.empty()) {
+      return;
+    }
   }
 
   Thread* self = Thread::Current();
@@ -1076,7 +1081,7 @@ void Instrumentation::UpdateMethodsCodeImpl(ArtMethod* method, const void* new_c
     return;
   }
 
-  if (EntryExitStubsInstalled() && CodeNeedsEntryExitStub(new_code, method)) {
+  if (NeedsEntryExitEvents(method) && CodeNeedsEntryExitStub(new_code, method)) {
     DCHECK(method->GetEntryPointFromQuickCompiledCode() == GetQuickInstrumentationEntryPoint() ||
         class_linker->IsQuickToInterpreterBridge(method->GetEntryPointFromQuickCompiledCode()))
               << EntryPointString(method->GetEntryPointFromQuickCompiledCode())
@@ -1093,7 +1098,7 @@ void Instrumentation::UpdateNativeMethodsCodeToJitCode(ArtMethod* method, const
   // We don't do any read barrier on `method`'s declaring class in this code, as the JIT might
   // enter here on a soon-to-be deleted ArtMethod. Updating the entrypoint is OK though, as
   // the ArtMethod is still in memory.
-  if (EntryExitStubsInstalled()) {
+  if (NeedsEntryExitEvents(method)) {
     // If stubs are installed don't update.
     return;
   }
@@ -1203,6 +1208,77 @@ void Instrumentation::Undeoptimize(ArtMethod* method) {
   }
 }
 
+void Instrumentation::InstrumentMethod(ArtMethod* method) {
+  Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
+  CHECK(!method->IsProxyMethod());
+  CHECK(method->IsInvokable());
+  CHECK(!IsProxyInit(method));
+  {
+    WriterMutexLock mu(Thread::Current(), *GetDeoptimizedMethodsLock());
+    bool inserted = instrumented_methods_.insert(method).second;
+    CHECK(inserted) << "Method " << ArtMethod::PrettyMethod(method) << " is already instrumented";
+    num_instrumented_methods_.store(instrumented_methods_.size(), std::memory_order_relaxed);
+  }
+
+  // The entry stub pushes instrumentation frames, which need to be handled on deoptimization. This
+  // also enables the entry / exit hooks of JITed code, which only report events for the
+  // instrumented methods when entry/exit stubs are not installed for all methods.
+  // Frames already on the stack don't need to be instrumented, as we only report events for new
+  // invocations of the method.
+  instrumentation_stubs_installed_ = true;
+  InstallStubsForMethod(method);
+}
+
+void Instrumentation::UninstrumentMethod(ArtMethod* method) {
+  Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
+  {
+    WriterMutexLock mu(Thread::Current(), *GetDeoptimizedMethodsLock());
+    bool erased = instrumented_methods_.erase(method) != 0u;
+    CHECK(erased) << "Method " << ArtMethod::PrettyMethod(method) << " is not instrumented";
+    num_instrumented_methods_.store(instrumented_methods_.size(), std::memory_order_relaxed);
+  }
+
+  // If entry/exit stubs are still needed for all methods nothing to do.
+  if (EntryExitStubsInstalled()) {
+    return;
+  }
+  InstallStubsForMethod(method);
+  MaybeRestoreInstrumentationStack();
+}
+
+bool Instrumentation::IsMethodInstrumented(ArtMethod* method) const {
+  // Instrumenting a method suspends all threads, so a reader holding the mutator lock cannot
+  // miss it. A method being removed concurrently has a class loader that is being deleted.
+  if (num_instrumented_methods_.load(std::memory_order_relaxed) == 0u) {
+    return false;
+  }
+  ReaderMutexLock mu(Thread::Current(), *GetDeoptimizedMethodsLock());
+  return instrumented_methods_.find(method) != instrumented_methods_.end();
+}
+
+bool Instrumentation::ShouldReportEntryExitEvents(Thread* thread, ArtMethod* method) const {
+  if (EntryExitStubsInstalled() ||
+      thread->IsForceInterpreter() ||
+      num_instrumented_methods_.load(std::memory_order_relaxed) == 0u) {
+    return true;
+  }
+  ReaderMutexLock mu(Thread::Current(), *GetDeoptimizedMethodsLock());
+  return instrumented_methods_.empty() ||
+         instrumented_methods_.find(method) != instrumented_methods_.end();
+}
+
+void Instrumentation::RemoveInstrumentedMethodsIn(const LinearAlloc& alloc) {
+  WriterMutexLock mu(Thread::Current(), *GetDeoptimizedMethodsLock());
+  for (auto it = instrumented_methods_.begin(); it != instrumented_methods_.end(); ) {
+    if (alloc.ContainsUnsafe(*it)) {
+      it = instrumented_methods_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  num_instrumented_methods_.store(instrumented_methods_.size(), std::memory_order_relaxed);
+}
+
 bool Instrumentation::IsDeoptimizedMethodsEmpty() const {
   ReaderMutexLock mu(Thread::Current(), *GetDeoptimizedMethodsLock());
   return deoptimized_methods_.empty();
@@ -1291,7 +1367,7 @@ const void* Instrumentation::GetMaybeInstrumentedCodeForInvoke(ArtMethod* method
   // This is called by resolution trampolines and that should never be getting proxy methods.
   DCHECK(!method->IsProxyMethod()) << method->PrettyMethod();
   const void* code = GetCodeForInvoke(method);
-  if (EntryExitStubsInstalled() && CodeNeedsEntryExitStub(code, method)) {
+  if (NeedsEntryExitEvents(method) && CodeNeedsEntryExitStub(code, method)) {
     return GetQuickInstrumentationEntryPoint();
   }
   return code;
@@ -26,6 +26,7 @@
 #include <unordered_set>
 
 #include "arch/instruction_set.h"
+#include "base/atomic.h"
 #include "base/enums.h"
 #include "base/locks.h"
 #include "base/macros.h"
@@ -41,6 +42,7 @@ class Throwable;
 }  // namespace mirror
 class ArtField;
 class ArtMethod;
+class LinearAlloc;
 template <typename T> class Handle;
 template <typename T> class MutableHandle;
 struct NthCallerVisitor;
@@ -265,6 +267,39 @@ class Instrumentation {
   bool IsDeoptimizedMethodsEmpty() const
       REQUIRES(!GetDeoptimizedMethodsLock()) REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Install the instrumentation entry/exit stubs on a single method so that its invocations
+  // report method entry and exit events, without touching the code of any other method. Unlike
+  // EnableMethodTracing, this neither visits all classes nor walks the thread stacks. Invocations
+  // already on the stack, and invocations inlined in compiled code, are not reported.
+  void InstrumentMethod(ArtMethod* method)
+      REQUIRES(Locks::mutator_lock_, !GetDeoptimizedMethodsLock());
+
+  // Restore the entrypoint of a method instrumented with InstrumentMethod.
+  void UninstrumentMethod(ArtMethod* method)
+      REQUIRES(Locks::mutator_lock_, !Locks::thread_list_lock_, !GetDeoptimizedMethodsLock());
+
+  // Indicates whether the method has been instrumented with InstrumentMethod.
+  bool IsMethodInstrumented(ArtMethod* method) const
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!GetDeoptimizedMethodsLock());
+
+  // Indicates whether invocations of the method need to report entry and exit events.
+  bool NeedsEntryExitEvents(ArtMethod* method) const
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!GetDeoptimizedMethodsLock()) {
+    return EntryExitStubsInstalled() || IsMethodInstrumented(method);
+  }
+
+  // Indicates whether an invocation of the method on `thread` that reports entry and exit
+  // events by itself (in the interpreter or in JITed code) should send them to the listeners.
+  // Once methods are instrumented with InstrumentMethod, only those get events, unless entry/exit
+  // events are needed for all methods or the thread is forced into the interpreter.
+  bool ShouldReportEntryExitEvents(Thread* thread, ArtMethod* method) const
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!GetDeoptimizedMethodsLock());
+
+  // Forget the instrumented methods allocated in `alloc`, which belongs to a class loader being
+  // deleted.
+  void RemoveInstrumentedMethodsIn(const LinearAlloc& alloc)
+      REQUIRES(!GetDeoptimizedMethodsLock());
+
   // Enable method tracing by installing instrumentation entry/exit stubs or interpreter.
   void EnableMethodTracing(const char* key,
                            bool needs_interpreter = kDeoptimizeForAccurateMethodEntryExitListeners)
@@ -721,6 +756,15 @@ class Instrumentation {
   mutable std::unique_ptr<ReaderWriterMutex> deoptimized_methods_lock_ BOTTOM_MUTEX_ACQUIRED_AFTER;
   std::unordered_set<ArtMethod*> deoptimized_methods_ GUARDED_BY(GetDeoptimizedMethodsLock());
 
+  // The set of methods with instrumentation entry/exit stubs installed by InstrumentMethod.
+  // Methods are removed when their class loader is deleted, which only holds the mutator lock
+  // shared, so this uses the deoptimized methods lock.
+  std::unordered_set<ArtMethod*> instrumented_methods_ GUARDED_BY(GetDeoptimizedMethodsLock());
+
+  // The size of `instrumented_methods_`, updated with the deoptimized methods lock held. Lets
+  // the common case where no method is instrumented skip taking the lock.
+  Atomic<size_t> num_instrumented_methods_;
+
   // Current interpreter handler table. This is updated each time the thread state flags are
   // modified.
 
@@ -55,25 +55,28 @@ class TestInstrumentationListener final : public instrumentation::Instrumentatio
 
   virtual ~TestInstrumentationListener() {}
 
-  void MethodEntered(Thread* thread ATTRIBUTE_UNUSED, ArtMethod* method ATTRIBUTE_UNUSED) override
+  void MethodEntered(Thread* thread ATTRIBUTE_UNUSED, ArtMethod* method) override
       REQUIRES_SHARED(Locks::mutator_lock_) {
     received_method_enter_event = true;
+    entered_methods.push_back(method);
   }
 
   void MethodExited(Thread* thread ATTRIBUTE_UNUSED,
-                    ArtMethod* method ATTRIBUTE_UNUSED,
+                    ArtMethod* method,
                     instrumentation::OptionalFrame frame ATTRIBUTE_UNUSED,
                     MutableHandle<mirror::Object>& return_value ATTRIBUTE_UNUSED)
       override REQUIRES_SHARED(Locks::mutator_lock_) {
     received_method_exit_object_event = true;
+    exited_methods.push_back(method);
   }
 
   void MethodExited(Thread* thread ATTRIBUTE_UNUSED,
-                    ArtMethod* method ATTRIBUTE_UNUSED,
+                    ArtMethod* method,
                     instrumentation::OptionalFrame frame ATTRIBUTE_UNUSED,
                     JValue& return_value ATTRIBUTE_UNUSED)
       override REQUIRES_SHARED(Locks::mutator_lock_) {
     received_method_exit_event = true;
+    exited_methods.push_back(method);
   }
 
   void MethodUnwind(Thread* thread ATTRIBUTE_UNUSED,
@@ -159,6 +162,8 @@ class TestInstrumentationListener final : public instrumentation::Instrumentatio
     received_exception_handled_event = false;
     received_branch_event = false;
     received_watched_frame_pop = false;
+    entered_methods.clear();
+    exited_methods.clear();
   }
 
   bool received_method_enter_event;
@@ -173,6 +178,8 @@ class TestInstrumentationListener final : public instrumentation::Instrumentatio
   bool received_exception_handled_event;
   bool received_branch_event;
   bool received_watched_frame_pop;
+  std::vector<ArtMethod*> entered_methods;
+  std::vector<ArtMethod*> exited_methods;
 
  private:
   DISALLOW_COPY_AND_ASSIGN(TestInstrumentationListener);
@@ -637,6 +644,102 @@ TEST_F(InstrumentationTest, DeoptimizeDirectMethod) {
   EXPECT_FALSE(instr->IsDeoptimized(method_to_deoptimize));
 }
 
+TEST_F(InstrumentationTest, InstrumentMethod) {
+  ScopedObjectAccess soa(Thread::Current());
+  jobject class_loader = LoadDex("Instrumentation");
+  Runtime* const runtime = Runtime::Current();
+  instrumentation::Instrumentation* instr = runtime->GetInstrumentation();
+  ClassLinker* class_linker = runtime->GetClassLinker();
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::ClassLoader> loader(hs.NewHandle(soa.Decode<mirror::ClassLoader>(class_loader)));
+  ObjPtr<mirror::Class> klass = class_linker->FindClass(soa.Self(), "LInstrumentation;", loader);
+  ASSERT_TRUE(klass != nullptr);
+  ArtMethod* method_to_instrument =
+      klass->FindClassMethod("instanceMethod", "()V", kRuntimePointerSize);
+  ASSERT_TRUE(method_to_instrument != nullptr);
+  ArtMethod* other_method =
+      klass->FindClassMethod("returnPrimitive", "()I", kRuntimePointerSize);
+  ASSERT_TRUE(other_method != nullptr);
+
+  EXPECT_FALSE(instr->IsMethodInstrumented(method_to_instrument));
+  {
+    ScopedThreadSuspension sts(soa.Self(), ThreadState::kSuspended);
+    ScopedSuspendAll ssa("Single method instrumentation");
+    instr->InstrumentMethod(method_to_instrument);
+  }
+
+  EXPECT_TRUE(instr->IsMethodInstrumented(method_to_instrument));
+  EXPECT_TRUE(instr->NeedsEntryExitEvents(method_to_instrument));
+  EXPECT_FALSE(instr->NeedsEntryExitEvents(other_method));
+  EXPECT_FALSE(instr->EntryExitStubsInstalled());
+  EXPECT_TRUE(instr->AreExitStubsInstalled());
+
+  {
+    ScopedThreadSuspension sts(soa.Self(), ThreadState::kSuspended);
+    ScopedSuspendAll ssa("Single method uninstrumentation");
+    instr->UninstrumentMethod(method_to_instrument);
+  }
+
+  EXPECT_FALSE(instr->IsMethodInstrumented(method_to_instrument));
+  EXPECT_FALSE(instr->AreExitStubsInstalled());
+}
+
+TEST_F(InstrumentationTest, InstrumentMethodReportsOnlyInstrumentedMethods) {
+  ScopedObjectAccess soa(Thread::Current());
+  jobject class_loader = LoadDex("Instrumentation");
+  Runtime* const runtime = Runtime::Current();
+  instrumentation::Instrumentation* instr = runtime->GetInstrumentation();
+  ClassLinker* class_linker = runtime->GetClassLinker();
+  StackHandleScope<2> hs(soa.Self());
+  Handle<mirror::ClassLoader> loader(hs.NewHandle(soa.Decode<mirror::ClassLoader>(class_loader)));
+  Handle<mirror::Class> klass(
+      hs.NewHandle(class_linker->FindClass(soa.Self(), "LInstrumentation;", loader)));
+  ASSERT_TRUE(klass != nullptr);
+  ASSERT_TRUE(class_linker->EnsureInitialized(soa.Self(), klass, true, true));
+  ArtMethod* caller = klass->FindClassMethod("caller", "()I", kRuntimePointerSize);
+  ASSERT_TRUE(caller != nullptr);
+  ArtMethod* callee = klass->FindClassMethod("callee", "()I", kRuntimePointerSize);
+  ASSERT_TRUE(callee != nullptr);
+
+  TestInstrumentationListener listener;
+  const uint32_t events = instrumentation::Instrumentation::kMethodEntered |
+                          instrumentation::Instrumentation::kMethodExited;
+  {
+    ScopedThreadSuspension sts(soa.Self(), ThreadState::kSuspended);
+    ScopedSuspendAll ssa("Single method instrumentation");
+    instr->AddListener(&listener, events);
+    instr->InstrumentMethod(callee);
+  }
+
+  // Only the instrumented callee reports events, even though the listener gets events from the
+  // interpreter, which runs both methods.
+  JValue result;
+  caller->Invoke(soa.Self(), nullptr, 0u, &result, caller->GetShorty());
+  ASSERT_FALSE(soa.Self()->IsExceptionPending());
+  EXPECT_EQ(2, result.GetI());
+  EXPECT_EQ(std::vector<ArtMethod*>({callee}), listener.entered_methods);
+  EXPECT_EQ(std::vector<ArtMethod*>({callee}), listener.exited_methods);
+
+  {
+    ScopedThreadSuspension sts(soa.Self(), ThreadState::kSuspended);
+    ScopedSuspendAll ssa("Single method uninstrumentation");
+    instr->UninstrumentMethod(callee);
+  }
+
+  // Without instrumented methods, listeners get the events of all methods again.
+  listener.Reset();
+  caller->Invoke(soa.Self(), nullptr, 0u, &result, caller->GetShorty());
+  ASSERT_FALSE(soa.Self()->IsExceptionPending());
+  EXPECT_EQ(std::vector<ArtMethod*>({caller, callee}), listener.entered_methods);
+  EXPECT_EQ(std::vector<ArtMethod*>({callee, caller}), listener.exited_methods);
+
+  {
+    ScopedThreadSuspension sts(soa.Self(), ThreadState::kSuspended);
+    ScopedSuspendAll ssa("Remove instrumentation listener");
+    instr->RemoveListener(&listener, events);
+  }
+}
+
 TEST_F(InstrumentationTest, FullDeoptimization) {
   ScopedObjectAccess soa(Thread::Current());
   Runtime* const runtime = Runtime::Current();
@@ -273,7 +273,8 @@ static inline JValue Execute(
     instrumentation::Instrumentation* instrumentation = Runtime::Current()->GetInstrumentation();
     ArtMethod *method = shadow_frame.GetMethod();
 
-    if (UNLIKELY(instrumentation->HasMethodEntryListeners())) {
+    if (UNLIKELY(instrumentation->HasMethodEntryListeners()) &&
+        instrumentation->ShouldReportEntryExitEvents(self, method)) {
       instrumentation->MethodEnterEvent(self, method);
       if (UNLIKELY(shadow_frame.GetForcePopFrame())) {
         // The caller will retry this invoke or ignore the result. Just return immediately without
@@ -38,6 +38,8 @@ class Thread;
 //   iget/iput: The field offset. The field must be non-volatile.
 //   sget/sput: The ArtField* pointer. The field must be non-volitile.
 //   invoke: The ArtMethod* pointer (before vtable indirection, etc).
+//   invoke-interface + kInvokeInterfaceKeyOffset: The ArtMethod* pointer of the
+//       implementation last called through an IMT conflict for the receiver's class.
 //
 // We ensure consistency of the cache by clearing it
 // whenever any dex file is unloaded.
@@ -53,6 +55,11 @@ class ALIGNED(16) InterpreterCache {
   // Value of 256 has around 75% cache hit rate.
   static constexpr size_t kSize = 256;
 
+  // Offset added to the dex pc pointer of an invoke-interface to get the key of its inline
+  // cache entry. The key is odd, so it is never the address of an instruction, and it maps
+  // to the entry following the one of the instruction.
+  static constexpr size_t kInvokeInterfaceKeyOffset = 5;
+
   InterpreterCache() {
     // We can not use the Clear() method since the constructor will not
     // be called from the owning thread.
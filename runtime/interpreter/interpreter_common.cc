@@ -110,7 +110,9 @@ bool SendMethodExitEvents(Thread* self,
   // respect these and send additional instrumentation events.
   do {
     frame.SetForcePopFrame(false);
-    if (UNLIKELY(instrumentation->HasMethodExitListeners() && !frame.GetSkipMethodExitEvents())) {
+    if (UNLIKELY(instrumentation->HasMethodExitListeners() &&
+                 !frame.GetSkipMethodExitEvents() &&
+                 instrumentation->ShouldReportEntryExitEvents(self, method))) {
       had_event = true;
       instrumentation->MethodExitEvent(self, method, instrumentation::OptionalFrame{frame}, result);
     }
@@ -184,10 +186,13 @@ bool MoveToExceptionHandler(Thread* self,
       }
       // Exception is not caught by the current method. We will unwind to the
       // caller. Notify any instrumentation listener.
-      instrumentation->MethodUnwindEvent(self,
-                                         shadow_frame.GetThisObject(),
-                                         shadow_frame.GetMethod(),
-                                         shadow_frame.GetDexPC());
+      if (instrumentation->HasMethodUnwindListeners() &&
+          instrumentation->ShouldReportEntryExitEvents(self, shadow_frame.GetMethod())) {
+        instrumentation->MethodUnwindEvent(self,
+                                           shadow_frame.GetThisObject(),
+                                           shadow_frame.GetMethod(),
+                                           shadow_frame.GetDexPC());
+      }
     }
     return shadow_frame.GetForcePopFrame();
   } else {
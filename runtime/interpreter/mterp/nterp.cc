@@ -353,6 +353,80 @@ extern "C" size_t NterpGetMethod(Thread* self, ArtMethod* caller, uint16_t* dex_
   }
 }
 
+// Called by nterp when the IMT entry for an invoke-interface is a runtime method, which
+// happens on IMT conflicts. Returns the implementation of `interface_method` for the class
+// of `receiver`, or `imt_method` if it cannot be determined without going through the
+// conflict trampoline. The result is recorded in the inline cache entry of the call site,
+// which nterp checks before calling the conflict trampoline.
+extern "C" ArtMethod* NterpGetInterfaceTarget(Thread* self,
+                                              ArtMethod* interface_method,
+                                              mirror::Object* receiver,
+                                              uint16_t* dex_pc_ptr,
+                                              ArtMethod* imt_method)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  ScopedAssertNoThreadSuspension sants("In nterp");
+  DCHECK(imt_method->IsRuntimeMethod());
+  ObjPtr<mirror::Class> klass = receiver->GetClass();
+  ArtMethod* target = klass->FindVirtualMethodForInterface(interface_method, kRuntimePointerSize);
+  if (target == nullptr || target->IsAbstract() || target->IsDefaultConflicting()) {
+    // Let the conflict trampoline throw the appropriate error.
+    return imt_method;
+  }
+  // Nterp compares the declaring class of the cached method with the class of the receiver,
+  // so only record methods that can match.
+  if (target->GetDeclaringClass() == klass) {
+    const uint8_t* key = reinterpret_cast<const uint8_t*>(dex_pc_ptr) +
+        InterpreterCache::kInvokeInterfaceKeyOffset;
+    self->GetInterpreterCache()->Set(self, key, reinterpret_cast<size_t>(target));
+  }
+  return target;
+}
+
+// Performs an invoke-polymorphic or invoke-polymorphic/range. The registers of the caller
+// are copied into a shadow frame so that the method handle or var handle is invoked by the
+// interpreter's implementation of signature polymorphic methods, which calls simple kinds
+// of handles directly instead of first moving the arguments to the quick calling convention.
+extern "C" uint64_t NterpInvokePolymorphic(Thread* self,
+                                           ArtMethod* caller,
+                                           uint32_t* registers,
+                                           uint32_t* references,
+                                           uint16_t* dex_pc_ptr)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  const Instruction* inst = Instruction::At(dex_pc_ptr);
+  CodeItemDataAccessor accessor(caller->DexInstructionData());
+  const uint16_t num_regs = accessor.RegistersSize();
+  const uint32_t dex_pc = dex_pc_ptr - accessor.Insns();
+
+  const char* old_cause = self->StartAssertNoThreadSuspension("Building shadow frame");
+  ShadowFrameAllocaUniquePtr shadow_frame_unique_ptr =
+      CREATE_SHADOW_FRAME(num_regs, caller, dex_pc);
+  ShadowFrame* shadow_frame = shadow_frame_unique_ptr.get();
+  for (uint16_t i = 0; i < num_regs; ++i) {
+    if (references[i] != 0u) {
+      shadow_frame->SetVRegReference(i, reinterpret_cast<mirror::Object*>(references[i]));
+    } else {
+      shadow_frame->SetVReg(i, registers[i]);
+    }
+  }
+  ScopedStackedShadowFramePusher frame_pusher(self, shadow_frame);
+  self->EndAssertNoThreadSuspension(old_cause);
+
+  // Push a transition back into managed code onto the linked list in thread.
+  ManagedStack fragment;
+  self->PushManagedStackFragment(&fragment);
+  JValue result;
+  if (inst->Opcode() == Instruction::INVOKE_POLYMORPHIC) {
+    DoInvokePolymorphic</* is_range= */ false>(
+        self, *shadow_frame, inst, inst->Fetch16(0), &result);
+  } else {
+    DCHECK_EQ(inst->Opcode(), Instruction::INVOKE_POLYMORPHIC_RANGE);
+    DoInvokePolymorphic</* is_range= */ true>(
+        self, *shadow_frame, inst, inst->Fetch16(0), &result);
+  }
+  self->PopManagedStackFragment(fragment);
+  return result.GetJ();
+}
+
 FLATTEN
 static ArtField* ResolveFieldWithAccessChecks(Thread* self,
                                               ClassLinker* class_linker,
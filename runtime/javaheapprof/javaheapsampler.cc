@@ -22,6 +22,7 @@
 #include "perfetto/heap_profile.h"
 #endif
 #include "runtime.h"
+#include "thread-current-inl.h"
 
 namespace art {
 
@@ -62,6 +63,14 @@ size_t HeapSampler::PickAndAdjustNextSample(size_t sample_adjust_bytes) {
 // Thus next bytes_until_sample is previously calculated (before allocation) to be able to
 // get the next tlab_size, but only saved/updated here.
 void HeapSampler::ReportSample(art::mirror::Object* obj, size_t allocation_size) {
+  if (record_pending_samples_.load(std::memory_order_acquire)) {
+    // The object is recorded by the LiveHeapProfiler once it is initialized. Samples of native
+    // allocations have no object and are dropped.
+    if (obj != nullptr) {
+      art::Thread::Current()->SetPendingHeapSample(obj, allocation_size);
+    }
+    return;
+  }
   VLOG(heap) << "JHP:***Report Perfetto Allocation: alloc_size: " << allocation_size;
   uint64_t perf_alloc_id = reinterpret_cast<uint64_t>(obj);
   VLOG(heap) << "JHP:***Report Perfetto Allocation: obj: " << perf_alloc_id;
@@ -70,6 +79,13 @@ void HeapSampler::ReportSample(art::mirror::Object* obj, size_t allocation_size)
 #endif
 }
 
+size_t HeapSampler::TakePendingSample(art::Thread* self, art::mirror::Object* obj) {
+  size_t allocation_size =
+      (self->GetPendingHeapSample() == obj) ? self->GetPendingHeapSampleSize() : 0u;
+  self->SetPendingHeapSample(nullptr, 0u);
+  return allocation_size;
+}
+
 // Check whether we should take a sample or not at this allocation and calculate the sample
 // offset to use in the expand Tlab calculation. Thus the offset from current pos to the next
 // sample.
@@ -51,8 +51,17 @@ class HeapSampler {
   void DisableHeapSampler() {
     enabled_.store(false, std::memory_order_release);
   }
-  // Report a sample to Perfetto.
+  // Keep samples for the LiveHeapProfiler instead of reporting them to Perfetto.
+  void SetRecordPendingSamples(bool record) {
+    record_pending_samples_.store(record, std::memory_order_release);
+  }
+  // Report a sample to Perfetto, or keep it as the pending sample of the thread. Samples are
+  // pending when they are reported before the object is initialized, for instance in the TLAB
+  // allocation path, which does not set the class of the object.
   void ReportSample(art::mirror::Object* obj, size_t allocation_size);
+  // Return the size of the pending sample of the thread if it is `obj`, or 0. The pending
+  // sample is cleared in both cases.
+  size_t TakePendingSample(art::Thread* self, art::mirror::Object* obj);
   // Check whether we should take a sample or not at this allocation, and return the
   // number of bytes from current pos to the next sample to use in the expand Tlab
   // calculation.
@@ -81,6 +90,7 @@ class HeapSampler {
   size_t PickAndAdjustNextSample(size_t sample_adj_bytes = 0) REQUIRES(!geo_dist_rng_lock_);
 
   std::atomic<bool> enabled_;
+  std::atomic<bool> record_pending_samples_{false};
   // Default sampling interval is 4kb.
   // Writes guarded by geo_dist_rng_lock_.
   std::atomic<int> p_sampling_interval_{4 * 1024};
@@ -0,0 +1,399 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "live_heap_profiler.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <map>
+#include <string_view>
+
+#include "android-base/file.h"
+#include "android-base/stringprintf.h"
+#include "art_method-inl.h"
+#include "base/enums.h"
+#include "base/logging.h"
+#include "base/time_utils.h"
+#include "gc_root-inl.h"
+#include "handle_scope-inl.h"
+#include "mirror/class-inl.h"
+#include "mirror/object-inl.h"
+#include "obj_ptr-inl.h"
+#include "object_callbacks.h"
+#include "scoped_thread_state_change-inl.h"
+#include "stack.h"
+#include "thread-inl.h"
+
+namespace art {
+
+using android::base::StringPrintf;
+
+namespace {
+
+// Minimal writer for the protobuf wire format, enough for the pprof `Profile` message.
+class ProtoWriter {
+ public:
+  void WriteVarint(uint32_t field, uint64_t value) {
+    WriteRawVarint(field << 3 | kWireTypeVarint);
+    WriteRawVarint(value);
+  }
+
+  void WriteBytes(uint32_t field, std::string_view bytes) {
+    WriteRawVarint(field << 3 | kWireTypeLengthDelimited);
+    WriteRawVarint(bytes.size());
+    data_.append(bytes);
+  }
+
+  void WriteMessage(uint32_t field, const ProtoWriter& message) {
+    WriteBytes(field, message.data_);
+  }
+
+  void WritePackedVarints(uint32_t field, const std::vector<uint64_t>& values) {
+    ProtoWriter packed;
+    for (uint64_t value : values) {
+      packed.WriteRawVarint(value);
+    }
+    WriteMessage(field, packed);
+  }
+
+  const std::string& GetData() const {
+    return data_;
+  }
+
+ private:
+  static constexpr uint32_t kWireTypeVarint = 0u;
+  static constexpr uint32_t kWireTypeLengthDelimited = 2u;
+
+  void WriteRawVarint(uint64_t value) {
+    while (value >= 0x80u) {
+      data_.push_back(static_cast<char>((value & 0x7fu) | 0x80u));
+      value >>= 7;
+    }
+    data_.push_back(static_cast<char>(value));
+  }
+
+  std::string data_;
+};
+
+// Field numbers of the pprof messages, see perftools/profiles/proto/profile.proto.
+namespace pprof {
+// Profile.
+static constexpr uint32_t kSampleType = 1u;
+static constexpr uint32_t kSample = 2u;
+static constexpr uint32_t kLocation = 4u;
+static constexpr uint32_t kFunction = 5u;
+static constexpr uint32_t kStringTable = 6u;
+static constexpr uint32_t kTimeNanos = 9u;
+static constexpr uint32_t kDurationNanos = 10u;
+static constexpr uint32_t kPeriodType = 11u;
+static constexpr uint32_t kPeriod = 12u;
+static constexpr uint32_t kDefaultSampleType = 14u;
+// ValueType.
+static constexpr uint32_t kValueTypeType = 1u;
+static constexpr uint32_t kValueTypeUnit = 2u;
+// Sample.
+static constexpr uint32_t kSampleLocationId = 1u;
+static constexpr uint32_t kSampleValue = 2u;
+static constexpr uint32_t kSampleLabel = 3u;
+// Label.
+static constexpr uint32_t kLabelKey = 1u;
+static constexpr uint32_t kLabelStr = 2u;
+// Location.
+static constexpr uint32_t kLocationId = 1u;
+static constexpr uint32_t kLocationLine = 4u;
+// Line.
+static constexpr uint32_t kLineFunctionId = 1u;
+static constexpr uint32_t kLineLine = 2u;
+// Function.
+static constexpr uint32_t kFunctionId = 1u;
+static constexpr uint32_t kFunctionName = 2u;
+static constexpr uint32_t kFunctionSystemName = 3u;
+static constexpr uint32_t kFunctionFilename = 4u;
+}  // namespace pprof
+
+// The string table of a pprof profile. Index 0 is always the empty string.
+class StringTable {
+ public:
+  StringTable() {
+    Intern("");
+  }
+
+  uint64_t Intern(const std::string& str) {
+    auto it = ids_.find(str);
+    if (it != ids_.end()) {
+      return it->second;
+    }
+    uint64_t id = strings_.size();
+    strings_.push_back(str);
+    ids_.emplace(str, id);
+    return id;
+  }
+
+  void WriteTo(ProtoWriter* profile) const {
+    for (const std::string& str : strings_) {
+      profile->WriteBytes(pprof::kStringTable, str);
+    }
+  }
+
+ private:
+  std::vector<std::string> strings_;
+  std::unordered_map<std::string, uint64_t> ids_;
+};
+
+static ProtoWriter ValueType(StringTable* strings, const std::string& type, const char* unit) {
+  ProtoWriter value_type;
+  value_type.WriteVarint(pprof::kValueTypeType, strings->Intern(type));
+  value_type.WriteVarint(pprof::kValueTypeUnit, strings->Intern(unit));
+  return value_type;
+}
+
+static uint64_t Round(double value) {
+  return static_cast<uint64_t>(std::llround(value));
+}
+
+}  // namespace
+
+LiveHeapProfiler::LiveHeapProfiler(const std::string& output_prefix, size_t max_stack_depth)
+    : gc::SystemWeakHolder(kAllocTrackerLock),
+      output_prefix_(output_prefix),
+      max_stack_depth_(max_stack_depth),
+      start_time_ns_(NanoTime()) {
+  stack_nodes_.push_back({kRootStackId, /*location_id=*/ 0u});
+}
+
+void LiveHeapProfiler::RecordSample(Thread* self,
+                                    ObjPtr<mirror::Object>* obj,
+                                    size_t byte_count,
+                                    size_t sampling_interval) {
+  // Get the stack outside of the lock in case there are allocations during the stack walk.
+  std::vector<std::pair<ArtMethod*, uint32_t>> frames;
+  {
+    StackHandleScope<1> hs(self);
+    auto obj_wrapper = hs.NewHandleWrapper(obj);
+    StackVisitor::WalkStack(
+        [&](const art::StackVisitor* stack_visitor) REQUIRES_SHARED(Locks::mutator_lock_) {
+          if (frames.size() >= max_stack_depth_) {
+            return false;
+          }
+          ArtMethod* m = stack_visitor->GetMethod();
+          if (m != nullptr && !m->IsRuntimeMethod()) {
+            m = m->GetInterfaceMethodIfProxy(kRuntimePointerSize);
+            frames.emplace_back(m, stack_visitor->GetDexPc());
+          }
+          return true;
+        },
+        self,
+        /* context= */ nullptr,
+        art::StackVisitor::StackWalkKind::kIncludeInlinedFrames);
+  }
+
+  // An allocation of `byte_count` bytes is sampled with probability
+  // 1 - exp(-byte_count / sampling_interval).
+  double weight = 1.0;
+  if (sampling_interval > 1u) {
+    weight = 1.0 / -std::expm1(-static_cast<double>(byte_count) / sampling_interval);
+  }
+
+  MutexLock mu(self, allow_disallow_lock_);
+  Wait(self);
+  uint32_t stack_id = kRootStackId;
+  for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+    stack_id = InternStackNode(stack_id, InternLocation(it->first, it->second));
+  }
+  samples_.push_back({GcRoot<mirror::Object>(*obj), stack_id, byte_count, weight});
+  AllocatedTotals& totals = allocated_totals_[stack_id];
+  totals.objects += weight;
+  totals.bytes += weight * byte_count;
+}
+
+uint32_t LiveHeapProfiler::InternFunction(ArtMethod* method) {
+  auto it = function_ids_.find(method);
+  if (it != function_ids_.end()) {
+    return it->second;
+  }
+  const char* source_file = method->GetDeclaringClassSourceFile();
+  uint32_t function_id = functions_.size();
+  functions_.push_back({method->PrettyMethod(), source_file != nullptr ? source_file : ""});
+  function_ids_.emplace(method, function_id);
+  return function_id;
+}
+
+uint32_t LiveHeapProfiler::InternLocation(ArtMethod* method, uint32_t dex_pc) {
+  auto key = std::make_pair(method, dex_pc);
+  auto it = location_ids_.find(key);
+  if (it != location_ids_.end()) {
+    return it->second;
+  }
+  // Unknown lines are reported as line 0, which pprof treats as unknown.
+  int32_t line = method->IsNative() ? -1 : method->GetLineNumFromDexPC(dex_pc);
+  uint32_t location_id = locations_.size();
+  locations_.push_back({InternFunction(method), std::max(line, 0)});
+  location_ids_.emplace(key, location_id);
+  return location_id;
+}
+
+uint32_t LiveHeapProfiler::InternStackNode(uint32_t parent, uint32_t location_id) {
+  uint64_t key = (static_cast<uint64_t>(parent) << 32) | location_id;
+  auto it = stack_node_ids_.find(key);
+  if (it != stack_node_ids_.end()) {
+    return it->second;
+  }
+  uint32_t node_id = stack_nodes_.size();
+  stack_nodes_.push_back({parent, location_id});
+  stack_node_ids_.emplace(key, node_id);
+  return node_id;
+}
+
+void LiveHeapProfiler::Sweep(IsMarkedVisitor* visitor) {
+  MutexLock mu(Thread::Current(), allow_disallow_lock_);
+  size_t num_live = 0u;
+  for (Sample& sample : samples_) {
+    // This does not need a read barrier because this is called by GC.
+    mirror::Object* old_object = sample.object.Read<kWithoutReadBarrier>();
+    mirror::Object* new_object = visitor->IsMarked(old_object);
+    if (new_object == nullptr) {
+      continue;
+    }
+    if (new_object != old_object) {
+      sample.object = GcRoot<mirror::Object>(new_object);
+    }
+    samples_[num_live] = sample;
+    ++num_live;
+  }
+  VLOG(heap) << "Live heap profiler swept " << (samples_.size() - num_live) << " samples";
+  samples_.resize(num_live);
+}
+
+std::string LiveHeapProfiler::GetProfile(Thread* self, size_t sampling_interval) {
+  MutexLock mu(self, allow_disallow_lock_);
+  Wait(self);
+
+  ProtoWriter profile;
+  StringTable strings;
+  profile.WriteMessage(pprof::kSampleType, ValueType(&strings, "alloc_objects", "count"));
+  profile.WriteMessage(pprof::kSampleType, ValueType(&strings, "alloc_space", "bytes"));
+  profile.WriteMessage(pprof::kSampleType, ValueType(&strings, "inuse_objects", "count"));
+  profile.WriteMessage(pprof::kSampleType, ValueType(&strings, "inuse_space", "bytes"));
+
+  auto get_location_ids = [&](uint32_t stack_id) REQUIRES(allow_disallow_lock_) {
+    std::vector<uint64_t> location_ids;
+    for (uint32_t node = stack_id; node != kRootStackId; node = stack_nodes_[node].parent) {
+      location_ids.push_back(stack_nodes_[node].location_id + 1u);
+    }
+    return location_ids;
+  };
+  auto write_sample = [&](uint32_t stack_id,
+                          const std::vector<uint64_t>& values,
+                          const std::string* class_name) REQUIRES(allow_disallow_lock_) {
+    ProtoWriter sample;
+    sample.WritePackedVarints(pprof::kSampleLocationId, get_location_ids(stack_id));
+    sample.WritePackedVarints(pprof::kSampleValue, values);
+    if (class_name != nullptr) {
+      ProtoWriter label;
+      label.WriteVarint(pprof::kLabelKey, strings.Intern("object"));
+      label.WriteVarint(pprof::kLabelStr, strings.Intern(*class_name));
+      sample.WriteMessage(pprof::kSampleLabel, label);
+    }
+    profile.WriteMessage(pprof::kSample, sample);
+  };
+
+  // In-use values, per stack and class of the sampled objects.
+  std::unordered_map<mirror::Class*, std::string> class_names;
+  std::map<std::pair<uint32_t, std::string>, AllocatedTotals> inuse_totals;
+  for (const Sample& sample : samples_) {
+    ObjPtr<mirror::Class> klass = sample.object.Read()->GetClass();
+    auto it = class_names.find(klass.Ptr());
+    if (it == class_names.end()) {
+      it = class_names.emplace(klass.Ptr(), klass->PrettyDescriptor()).first;
+    }
+    AllocatedTotals& totals = inuse_totals[std::make_pair(sample.stack_id, it->second)];
+    totals.objects += sample.weight;
+    totals.bytes += sample.weight * sample.byte_count;
+  }
+  for (const auto& [key, totals] : inuse_totals) {
+    write_sample(key.first, {0u, 0u, Round(totals.objects), Round(totals.bytes)}, &key.second);
+  }
+  // Allocated values, per stack.
+  for (const auto& [stack_id, totals] : allocated_totals_) {
+    write_sample(stack_id, {Round(totals.objects), Round(totals.bytes), 0u, 0u}, nullptr);
+  }
+
+  for (size_t i = 0; i != locations_.size(); ++i) {
+    ProtoWriter line;
+    line.WriteVarint(pprof::kLineFunctionId, locations_[i].function_id + 1u);
+    line.WriteVarint(pprof::kLineLine, locations_[i].line);
+    ProtoWriter location;
+    location.WriteVarint(pprof::kLocationId, i + 1u);
+    location.WriteMessage(pprof::kLocationLine, line);
+    profile.WriteMessage(pprof::kLocation, location);
+  }
+  for (size_t i = 0; i != functions_.size(); ++i) {
+    ProtoWriter function;
+    uint64_t name = strings.Intern(functions_[i].name);
+    function.WriteVarint(pprof::kFunctionId, i + 1u);
+    function.WriteVarint(pprof::kFunctionName, name);
+    function.WriteVarint(pprof::kFunctionSystemName, name);
+    function.WriteVarint(pprof::kFunctionFilename, strings.Intern(functions_[i].filename));
+    profile.WriteMessage(pprof::kFunction, function);
+  }
+
+  profile.WriteVarint(pprof::kTimeNanos, MsToNs(MilliTime()));
+  profile.WriteVarint(pprof::kDurationNanos, NanoTime() - start_time_ns_);
+  profile.WriteMessage(pprof::kPeriodType, ValueType(&strings, "space", "bytes"));
+  profile.WriteVarint(pprof::kPeriod, sampling_interval);
+  profile.WriteVarint(pprof::kDefaultSampleType, strings.Intern("inuse_space"));
+  // The string table goes last, once all strings are interned.
+  strings.WriteTo(&profile);
+  return profile.GetData();
+}
+
+bool LiveHeapProfiler::Dump(Thread* self, size_t sampling_interval) {
+  std::string profile;
+  {
+    ScopedObjectAccess soa(self);
+    profile = GetProfile(self, sampling_interval);
+  }
+  std::string filename = StringPrintf("%s.%d.pprof", output_prefix_.c_str(), getpid());
+  // Write to a temporary file and rename it, so that readers never see a partially written
+  // profile. The periodic and the shutdown dumps may run concurrently.
+  std::string temp_filename = StringPrintf("%s.%d.tmp", filename.c_str(), self->GetTid());
+  if (!android::base::WriteStringToFile(profile, temp_filename)) {
+    PLOG(WARNING) << "Failed to write live heap profile " << temp_filename;
+    unlink(temp_filename.c_str());
+    return false;
+  }
+  if (rename(temp_filename.c_str(), filename.c_str()) != 0) {
+    PLOG(WARNING) << "Failed to rename live heap profile to " << filename;
+    unlink(temp_filename.c_str());
+    return false;
+  }
+  VLOG(heap) << "Wrote live heap profile " << filename;
+  return true;
+}
+
+size_t LiveHeapProfiler::GetNumLiveSamples(Thread* self) {
+  MutexLock mu(self, allow_disallow_lock_);
+  return samples_.size();
+}
+
+size_t LiveHeapProfiler::GetNumStackNodes(Thread* self) {
+  MutexLock mu(self, allow_disallow_lock_);
+  return stack_nodes_.size();
+}
+
+}  // namespace art
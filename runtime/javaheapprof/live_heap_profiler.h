@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_JAVAHEAPPROF_LIVE_HEAP_PROFILER_H_
+#define ART_RUNTIME_JAVAHEAPPROF_LIVE_HEAP_PROFILER_H_
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/locks.h"
+#include "base/macros.h"
+#include "gc/system_weak.h"
+#include "gc_root.h"
+#include "obj_ptr.h"
+
+namespace art {
+
+class ArtMethod;
+class IsMarkedVisitor;
+class Thread;
+
+namespace mirror {
+class Object;
+}  // namespace mirror
+
+// Live heap profiler built on top of the allocations picked by the HeapSampler, for hosts and
+// devices without heapprofd.
+//
+// Each sampled object is recorded with the stack of the allocating thread. Stacks are kept in a
+// trie of (method, dex pc) locations, so identical stacks are stored only once and a sample is a
+// single entry in the sample table. The samples are system weaks: when the GC sweeps them, the
+// samples of dead objects are dropped, so the table always describes the sampled part of the
+// live heap.
+//
+// The profile is written in the pprof protobuf format, with the allocated (since startup) and
+// in-use object counts and sizes as sample values, scaled by the inverse of the probability of
+// sampling an allocation of that size.
+class LiveHeapProfiler : public gc::SystemWeakHolder {
+ public:
+  LiveHeapProfiler(const std::string& output_prefix, size_t max_stack_depth);
+
+  // Record a sampled allocation of `byte_count` bytes. `obj` must be fully initialized.
+  void RecordSample(Thread* self,
+                    ObjPtr<mirror::Object>* obj,
+                    size_t byte_count,
+                    size_t sampling_interval)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!allow_disallow_lock_);
+
+  void Sweep(IsMarkedVisitor* visitor) override
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!allow_disallow_lock_);
+
+  // Return the current profile as a serialized pprof `Profile` message.
+  std::string GetProfile(Thread* self, size_t sampling_interval)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!allow_disallow_lock_);
+
+  // Write the current profile to `<output prefix>.<pid>.pprof`. The file is replaced atomically,
+  // so that it can be collected at any time.
+  bool Dump(Thread* self, size_t sampling_interval)
+      REQUIRES(!Locks::mutator_lock_, !allow_disallow_lock_);
+
+  size_t GetNumLiveSamples(Thread* self) REQUIRES(!allow_disallow_lock_);
+  size_t GetNumStackNodes(Thread* self) REQUIRES(!allow_disallow_lock_);
+
+  const std::string& GetOutputPrefix() const {
+    return output_prefix_;
+  }
+
+  static constexpr size_t kDefaultMaxStackDepth = 64u;
+
+ private:
+  struct Sample {
+    GcRoot<mirror::Object> object;
+    uint32_t stack_id;
+    size_t byte_count;
+    // The number of allocations this sample stands for.
+    double weight;
+  };
+
+  struct AllocatedTotals {
+    double objects = 0.0;
+    double bytes = 0.0;
+  };
+
+  struct StackNode {
+    // Index of the node of the caller, or kRootStackId.
+    uint32_t parent;
+    uint32_t location_id;
+  };
+
+  struct Location {
+    uint32_t function_id;
+    int32_t line;
+  };
+
+  struct Function {
+    std::string name;
+    std::string filename;
+  };
+
+  struct LocationKeyHash {
+    size_t operator()(const std::pair<ArtMethod*, uint32_t>& key) const {
+      return std::hash<ArtMethod*>()(key.first) ^ (static_cast<size_t>(key.second) * 0x9e3779b9u);
+    }
+  };
+
+  // The stack id of the empty stack. The stack id of other stacks is the index of the node of
+  // their innermost frame.
+  static constexpr uint32_t kRootStackId = 0u;
+
+  uint32_t InternFunction(ArtMethod* method)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(allow_disallow_lock_);
+  uint32_t InternLocation(ArtMethod* method, uint32_t dex_pc)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(allow_disallow_lock_);
+  uint32_t InternStackNode(uint32_t parent, uint32_t location_id) REQUIRES(allow_disallow_lock_);
+
+  const std::string output_prefix_;
+  const size_t max_stack_depth_;
+
+  std::vector<Sample> samples_ GUARDED_BY(allow_disallow_lock_);
+  std::unordered_map<uint32_t, AllocatedTotals> allocated_totals_ GUARDED_BY(allow_disallow_lock_);
+
+  // The stack trie. Node 0 is the root.
+  std::vector<StackNode> stack_nodes_ GUARDED_BY(allow_disallow_lock_);
+  std::unordered_map<uint64_t, uint32_t> stack_node_ids_ GUARDED_BY(allow_disallow_lock_);
+
+  // Locations and functions are resolved when first seen, so that the profile does not depend on
+  // methods that may have been unloaded since. A method allocated at the address of an unloaded
+  // one is reported with the name of the unloaded method.
+  std::vector<Location> locations_ GUARDED_BY(allow_disallow_lock_);
+  std::unordered_map<std::pair<ArtMethod*, uint32_t>, uint32_t, LocationKeyHash> location_ids_
+      GUARDED_BY(allow_disallow_lock_);
+  std::vector<Function> functions_ GUARDED_BY(allow_disallow_lock_);
+  std::unordered_map<ArtMethod*, uint32_t> function_ids_ GUARDED_BY(allow_disallow_lock_);
+
+  const uint64_t start_time_ns_;
+
+  DISALLOW_COPY_AND_ASSIGN(LiveHeapProfiler);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_JAVAHEAPPROF_LIVE_HEAP_PROFILER_H_
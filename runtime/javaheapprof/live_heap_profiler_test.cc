@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "live_heap_profiler.h"
+
+#include <unistd.h>
+
+#include "android-base/file.h"
+#include "android-base/stringprintf.h"
+#include "common_runtime_test.h"
+#include "gc/heap.h"
+#include "handle_scope-inl.h"
+#include "javaheapprof/javaheapsampler.h"
+#include "mirror/object-inl.h"
+#include "mirror/string.h"
+#include "scoped_thread_state_change-inl.h"
+
+namespace art {
+
+class LiveHeapProfilerTest : public CommonRuntimeTest {
+ protected:
+  static constexpr size_t kSamplingInterval = 4 * KB;
+};
+
+TEST_F(LiveHeapProfilerTest, SweepDeadSamples) {
+  LiveHeapProfiler profiler("unused", LiveHeapProfiler::kDefaultMaxStackDepth);
+  Runtime::Current()->AddSystemWeakHolder(&profiler);
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    StackHandleScope<1> hs(soa.Self());
+    Handle<mirror::String> live(
+        hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "live")));
+    ObjPtr<mirror::Object> live_obj = live.Get();
+    profiler.RecordSample(soa.Self(), &live_obj, /*byte_count=*/ 32u, kSamplingInterval);
+    ObjPtr<mirror::Object> dead_obj = mirror::String::AllocFromModifiedUtf8(soa.Self(), "dead");
+    profiler.RecordSample(soa.Self(), &dead_obj, /*byte_count=*/ 32u, kSamplingInterval);
+    EXPECT_EQ(2u, profiler.GetNumLiveSamples(soa.Self()));
+
+    Runtime::Current()->GetHeap()->CollectGarbage(/* clear_soft_references= */ false);
+
+    // Only the sample of the reachable string is left.
+    EXPECT_EQ(1u, profiler.GetNumLiveSamples(soa.Self()));
+    // Both samples were taken with the same (empty) stack.
+    EXPECT_EQ(1u, profiler.GetNumStackNodes(soa.Self()));
+  }
+  Runtime::Current()->RemoveSystemWeakHolder(&profiler);
+}
+
+TEST_F(LiveHeapProfilerTest, PendingSampleSurvivesGc) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::String> sampled(
+      hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "sampled")));
+  soa.Self()->SetPendingHeapSample(sampled.Get().Ptr(), /*allocation_size=*/ 32u);
+
+  // The GC may move the object before the heap records the sample.
+  Runtime::Current()->GetHeap()->CollectGarbage(/* clear_soft_references= */ false);
+
+  HeapSampler& sampler = Runtime::Current()->GetHeap()->GetHeapSampler();
+  EXPECT_EQ(32u, sampler.TakePendingSample(soa.Self(), sampled.Get().Ptr()));
+  EXPECT_EQ(nullptr, soa.Self()->GetPendingHeapSample());
+  EXPECT_EQ(0u, sampler.TakePendingSample(soa.Self(), sampled.Get().Ptr()));
+}
+
+TEST_F(LiveHeapProfilerTest, Dump) {
+  ScratchDir output_dir;
+  std::string output_prefix = output_dir.GetPath() + "heap";
+  LiveHeapProfiler profiler(output_prefix, LiveHeapProfiler::kDefaultMaxStackDepth);
+  Runtime::Current()->AddSystemWeakHolder(&profiler);
+  std::string profile;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    StackHandleScope<1> hs(soa.Self());
+    Handle<mirror::String> live(
+        hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "live")));
+    ObjPtr<mirror::Object> live_obj = live.Get();
+    profiler.RecordSample(soa.Self(), &live_obj, /*byte_count=*/ 32u, kSamplingInterval);
+    profile = profiler.GetProfile(soa.Self(), kSamplingInterval);
+  }
+  // The profile starts with the first sample type and contains the class of the sample.
+  ASSERT_FALSE(profile.empty());
+  EXPECT_EQ('\x0a', profile[0]);
+  EXPECT_NE(std::string::npos, profile.find("java.lang.String"));
+  EXPECT_NE(std::string::npos, profile.find("inuse_space"));
+
+  ASSERT_TRUE(profiler.Dump(Thread::Current(), kSamplingInterval));
+  std::string filename =
+      android::base::StringPrintf("%s.%d.pprof", output_prefix.c_str(), getpid());
+  std::string dumped;
+  ASSERT_TRUE(android::base::ReadFileToString(filename, &dumped));
+  EXPECT_GE(dumped.size(), profile.size());
+  EXPECT_NE(std::string::npos, dumped.find("java.lang.String"));
+  Runtime::Current()->RemoveSystemWeakHolder(&profiler);
+}
+
+}  // namespace art
@@ -30,6 +30,7 @@
 #include "class_root-inl.h"
 #include "compilation_kind.h"
 #include "debugger.h"
+#include "dex/dex_file_loader.h"
 #include "dex/type_lookup_table.h"
 #include "gc/space/image_space.h"
 #include "entrypoints/entrypoint_utils-inl.h"
@@ -383,9 +384,25 @@ void Jit::StartProfileSaver(const std::string& profile_filename,
                         code_cache_,
                         code_paths,
                         ref_profile_filename);
+    if (UseJitWarmupCache()) {
+      // Compile the methods that were compiled optimized during previous runs of the app
+      // before they get hot again.
+      thread_pool_->AddTask(
+          Thread::Current(),
+          new JitWarmupCacheTask(ProfileSaver::GetJitWarmupCacheFilename(profile_filename),
+                                 code_paths));
+    }
   }
 }
 
+bool Jit::UseJitWarmupCache() const {
+  return options_->GetSaveProfilingInfo() &&
+      options_->GetProfileSaverOptions().GetJitWarmupCache() &&
+      UseJitCompilation() &&
+      thread_pool_ != nullptr &&
+      !Runtime::Current()->IsJavaDebuggable();
+}
+
 void Jit::StopProfileSaver() {
   if (options_->GetSaveProfilingInfo() && ProfileSaver::IsStarted()) {
     ProfileSaver::Stop(options_->DumpJitInfoOnShutdown());
@@ -1071,6 +1088,24 @@ class JitProfileTask final : public Task {
   DISALLOW_COPY_AND_ASSIGN(JitProfileTask);
 };
 
+class JitWarmupCacheTask final : public SelfDeletingTask {
+ public:
+  JitWarmupCacheTask(const std::string& warmup_cache_path,
+                     const std::vector<std::string>& code_paths)
+      : warmup_cache_path_(warmup_cache_path), code_paths_(code_paths) {}
+
+  void Run(Thread* self) override {
+    Runtime::Current()->GetJit()->CompileMethodsFromJitWarmupCache(
+        self, code_paths_, warmup_cache_path_);
+  }
+
+ private:
+  const std::string warmup_cache_path_;
+  const std::vector<std::string> code_paths_;
+
+  DISALLOW_COPY_AND_ASSIGN(JitWarmupCacheTask);
+};
+
 static void CopyIfDifferent(void* s1, const void* s2, size_t n) {
   if (memcmp(s1, s2, n) != 0) {
     memcpy(s1, s2, n);
@@ -1336,6 +1371,17 @@ void Jit::RegisterDexFiles(const std::vector<std::unique_ptr<const DexFile>>& de
     // - System server dex files are registered *before* we set the runtime as
     //   system server (though we are in the system server process).
     thread_pool_->AddTask(Thread::Current(), new JitProfileTask(dex_files, class_loader));
+  } else if (UseJitWarmupCache() && class_loader != nullptr) {
+    // App dex files are usually loaded before the app registers its profile. Register them
+    // with the class linker now so that the warmup cache task can find them.
+    ScopedObjectAccess soa(Thread::Current());
+    StackHandleScope<1> hs(soa.Self());
+    Handle<mirror::ClassLoader> h_loader(hs.NewHandle(
+        soa.Decode<mirror::ClassLoader>(class_loader)));
+    ClassLinker* class_linker = runtime->GetClassLinker();
+    for (const auto& dex_file : dex_files) {
+      class_linker->RegisterDexFile(*dex_file.get(), h_loader.Get());
+    }
   }
 }
 
@@ -1511,6 +1557,83 @@ uint32_t Jit::CompileMethodsFromProfile(
   return added_to_queue;
 }
 
+uint32_t Jit::CompileMethodsFromJitWarmupCache(Thread* self,
+                                               const std::vector<std::string>& code_paths,
+                                               const std::string& warmup_cache_path) {
+  if (!OS::FileExists(warmup_cache_path.c_str())) {
+    VLOG(jit) << "No JIT warmup cache: " << warmup_cache_path;
+    return 0u;
+  }
+  ProfileCompilationInfo profile_info;
+  if (!profile_info.Load(warmup_cache_path, /*clear_if_invalid=*/ false)) {
+    LOG(WARNING) << "Could not load JIT warmup cache " << warmup_cache_path;
+    return 0u;
+  }
+
+  class CollectDexCachesVisitor : public DexCacheVisitor {
+   public:
+    CollectDexCachesVisitor(const std::vector<std::string>& code_paths,
+                            VariableSizedHandleScope* handles,
+                            std::vector<Handle<mirror::DexCache>>* dex_caches)
+        : code_paths_(code_paths), handles_(handles), dex_caches_(dex_caches) {}
+
+    void Visit(ObjPtr<mirror::DexCache> dex_cache)
+        REQUIRES_SHARED(Locks::dex_lock_, Locks::mutator_lock_) override {
+      const DexFile* dex_file = dex_cache->GetDexFile();
+      if (ContainsElement(code_paths_, DexFileLoader::GetBaseLocation(dex_file->GetLocation()))) {
+        dex_caches_->push_back(handles_->NewHandle(dex_cache));
+      }
+    }
+
+   private:
+    const std::vector<std::string>& code_paths_;
+    VariableSizedHandleScope* const handles_;
+    std::vector<Handle<mirror::DexCache>>* const dex_caches_;
+  };
+
+  ScopedObjectAccess soa(self);
+  VariableSizedHandleScope handles(self);
+  std::vector<Handle<mirror::DexCache>> dex_caches;
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  {
+    CollectDexCachesVisitor visitor(code_paths, &handles, &dex_caches);
+    ReaderMutexLock mu(self, *Locks::dex_lock_);
+    class_linker->VisitDexCaches(&visitor);
+  }
+
+  uint32_t added_to_queue = 0u;
+  for (Handle<mirror::DexCache> dex_cache : dex_caches) {
+    std::set<dex::TypeIndex> class_types;
+    std::set<uint16_t> hot_methods;
+    std::set<uint16_t> other_methods;
+    // This fails if the dex file changed since the warmup cache was saved, as the
+    // profile records the checksums of the dex files.
+    if (!profile_info.GetClassesAndMethods(*dex_cache->GetDexFile(),
+                                           &class_types,
+                                           &hot_methods,
+                                           &other_methods,
+                                           &other_methods)) {
+      continue;
+    }
+    StackHandleScope<1> hs(self);
+    Handle<mirror::ClassLoader> class_loader = hs.NewHandle(dex_cache->GetClassLoader());
+    for (uint16_t method_idx : hot_methods) {
+      if (CompileMethodFromProfile(self,
+                                   class_linker,
+                                   method_idx,
+                                   dex_cache,
+                                   class_loader,
+                                   /*add_to_queue=*/ true,
+                                   /*compile_after_boot=*/ false)) {
+        ++added_to_queue;
+      }
+    }
+  }
+  VLOG(jit) << "Added " << added_to_queue << " methods from JIT warmup cache "
+            << warmup_cache_path;
+  return added_to_queue;
+}
+
 bool Jit::IgnoreSamplesForMethod(ArtMethod* method) REQUIRES_SHARED(Locks::mutator_lock_) {
   if (method->IsClassInitializer() || !method->IsCompilable()) {
     // We do not want to compile such methods.
@@ -414,6 +414,14 @@ class Jit {
                                          Handle<mirror::ClassLoader> class_loader,
                                          bool add_to_queue);
 
+  // Compile the methods recorded in the JIT warmup cache `warmup_cache_path` that belong
+  // to the dex files of `code_paths` already registered with the class linker. Methods of
+  // dex files whose checksum does not match the one in the warmup cache are ignored.
+  // Return the number of methods added to the queue.
+  uint32_t CompileMethodsFromJitWarmupCache(Thread* self,
+                                            const std::vector<std::string>& code_paths,
+                                            const std::string& warmup_cache_path);
+
   // Register the dex files to the JIT. This is to perform any compilation/optimization
   // at the point of loading the dex files.
   void RegisterDexFiles(const std::vector<std::unique_ptr<const DexFile>>& dex_files,
@@ -460,6 +468,9 @@ class Jit {
                                 bool compile_after_boot)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Whether methods compiled optimized are recorded and compiled early on the next start.
+  bool UseJitWarmupCache() const;
+
   static bool BindCompilerMethods(std::string* error_msg);
 
   void AddCompileTask(Thread* self,
@@ -34,6 +34,7 @@
 #include "base/time_utils.h"
 #include "base/utils.h"
 #include "cha.h"
+#include "code_info_cache.h"
 #include "debugger_interface.h"
 #include "dex/dex_file_loader.h"
 #include "dex/method_reference.h"
@@ -273,6 +274,8 @@ JitCodeCache::JitCodeCache()
       number_of_optimized_compilations_(0),
       number_of_osr_compilations_(0),
       number_of_collections_(0),
+      number_of_evictions_(0),
+      number_of_recompilations_after_eviction_(0),
       histogram_stack_map_memory_use_("Memory used for stack maps", 16),
       histogram_code_memory_use_("Memory used for compiled code", 16),
       histogram_profiling_info_memory_use_("Memory used for profiling info", 16) {
@@ -456,6 +459,8 @@ void JitCodeCache::FreeCodeAndData(const void* code_ptr) {
   }  // else this is a JNI stub without any data.
 
   FreeLocked(&private_region_, reinterpret_cast<uint8_t*>(allocation), data);
+  // The memory can be reused for other code, so drop CodeInfo decoded by stack walks.
+  CodeInfoCache::InvalidateAll();
 }
 
 void JitCodeCache::FreeAllMethodHeaders(
@@ -932,6 +937,7 @@ bool JitCodeCache::Reserve(Thread* self,
                            size_t stack_map_size,
                            size_t number_of_roots,
                            ArtMethod* method,
+                           CompilationKind compilation_kind,
                            /*out*/ArrayRef<const uint8_t>* reserved_code,
                            /*out*/ArrayRef<const uint8_t>* reserved_data) {
   code_size = OatQuickMethodHeader::InstructionAlignedSize() + code_size;
@@ -946,7 +952,8 @@ bool JitCodeCache::Reserve(Thread* self,
       MutexLock mu(self, *Locks::jit_lock_);
       WaitForPotentialCollectionToComplete(self);
       ScopedCodeCacheWrite ccw(*region);
-      code = region->AllocateCode(code_size);
+      code = region->AllocateCode(code_size,
+                                  /*is_hot=*/ compilation_kind != CompilationKind::kBaseline);
       data = region->AllocateData(data_size);
       at_max_capacity = IsAtMaxCapacity();
     }
@@ -1108,11 +1115,11 @@ void JitCodeCache::GarbageCollectCache(Thread* self) {
       return;
     } else {
       number_of_collections_++;
+      // Cover the hot code space and the cold code space that follows it.
       live_bitmap_.reset(CodeCacheBitmap::Create(
           "code-cache-bitmap",
           reinterpret_cast<uintptr_t>(private_region_.GetExecPages()->Begin()),
-          reinterpret_cast<uintptr_t>(
-              private_region_.GetExecPages()->Begin() + private_region_.GetCurrentCapacity() / 2)));
+          reinterpret_cast<uintptr_t>(private_region_.GetCodeSpacesEnd())));
       collection_in_progress_ = true;
     }
   }
@@ -1154,11 +1161,9 @@ void JitCodeCache::GarbageCollectCache(Thread* self) {
       bool next_collection_will_be_full = ShouldDoFullCollection();
 
       // Start polling the liveness of compiled code to prepare for the next full collection.
+      // Baseline code liveness is tracked by DoCollection() without resetting the hotness
+      // counters, which would otherwise delay optimized compilation of hot methods.
       if (next_collection_will_be_full) {
-        for (auto it : profiling_infos_) {
-          it.second->ResetCounter();
-        }
-
         // Change entry points of native methods back to the GenericJNI entrypoint.
         for (const auto& entry : jni_stubs_map_) {
           const JniStubData& data = entry.second;
@@ -1304,22 +1309,32 @@ void JitCodeCache::DoCollection(Thread* self, bool collect_profiling_info) {
     MutexLock mu(self, *Locks::jit_lock_);
 
     // Update to interpreter the methods that have baseline entrypoints and whose baseline
-    // hotness count hasn't changed.
+    // hotness count hasn't changed for `kBaselineCodeEvictionAge` collections. This is a
+    // clock-style policy: running the code resets its age, so code that is used between
+    // collections is kept even if it is not on a thread stack when we collect.
     // Note that these methods may be in thread stack or concurrently revived
     // between. That's OK, as the thread executing it will mark it.
     uint16_t warmup_threshold = Runtime::Current()->GetJITOptions()->GetWarmupThreshold();
     for (auto it : profiling_infos_) {
       ProfilingInfo* info = it.second;
-      if (!info->CounterHasChanged()) {
-        const void* entry_point = info->GetMethod()->GetEntryPointFromQuickCompiledCode();
-        if (ContainsPc(entry_point)) {
-          OatQuickMethodHeader* method_header =
-              OatQuickMethodHeader::FromEntryPoint(entry_point);
-          if (CodeInfo::IsBaseline(method_header->GetOptimizedCodeInfoPtr())) {
-            info->GetMethod()->ResetCounter(warmup_threshold);
-            Runtime::Current()->GetInstrumentation()->InitializeMethodsCode(
-                info->GetMethod(), /*aot_code=*/ nullptr);
+      if (info->CounterHasChangedSinceLastCollection()) {
+        info->eviction_age_ = 0u;
+        continue;
+      }
+      const void* entry_point = info->GetMethod()->GetEntryPointFromQuickCompiledCode();
+      if (ContainsPc(entry_point)) {
+        OatQuickMethodHeader* method_header =
+            OatQuickMethodHeader::FromEntryPoint(entry_point);
+        if (CodeInfo::IsBaseline(method_header->GetOptimizedCodeInfoPtr())) {
+          if (++info->eviction_age_ < kBaselineCodeEvictionAge) {
+            continue;
           }
+          info->eviction_age_ = 0u;
+          info->evicted_ = true;
+          number_of_evictions_++;
+          info->GetMethod()->ResetCounter(warmup_threshold);
+          Runtime::Current()->GetInstrumentation()->InitializeMethodsCode(
+              info->GetMethod(), /*aot_code=*/ nullptr);
         }
       }
     }
@@ -1588,6 +1603,29 @@ void JitCodeCache::GetProfiledMethods(const std::set<std::string>& dex_base_loca
   }
 }
 
+void JitCodeCache::GetOptimizedMethods(const std::set<std::string>& dex_base_locations,
+                                       std::vector<ProfileMethodInfo>& methods) {
+  MutexLock mu(Thread::Current(), *Locks::jit_lock_);
+  ScopedTrace trace(__FUNCTION__);
+  for (const auto& it : method_code_map_) {
+    const void* code_ptr = it.first;
+    ArtMethod* method = it.second;
+    const OatQuickMethodHeader* method_header = OatQuickMethodHeader::FromCodePointer(code_ptr);
+    if (method_header->GetEntryPoint() != method->GetEntryPointFromQuickCompiledCode() ||
+        CodeInfo::IsBaseline(method_header->GetOptimizedCodeInfoPtr())) {
+      // Only consider optimized code that is currently used by the method.
+      continue;
+    }
+    const DexFile* dex_file = method->GetDexFile();
+    if (!ContainsElement(dex_base_locations,
+                         DexFileLoader::GetBaseLocation(dex_file->GetLocation()))) {
+      continue;
+    }
+    methods.emplace_back(/*ProfileMethodInfo*/
+        MethodReference(dex_file, method->GetDexMethodIndex()));
+  }
+}
+
 bool JitCodeCache::IsOsrCompiled(ArtMethod* method) {
   MutexLock mu(Thread::Current(), *Locks::jit_lock_);
   return osr_code_map_.find(method) != osr_code_map_.end();
@@ -1695,7 +1733,15 @@ bool JitCodeCache::NotifyCompilationOf(ArtMethod* method,
       bool has_profiling_info = false;
       {
         MutexLock mu(self, *Locks::jit_lock_);
-        has_profiling_info = (profiling_infos_.find(method) != profiling_infos_.end());
+        auto it = profiling_infos_.find(method);
+        if (it != profiling_infos_.end()) {
+          has_profiling_info = true;
+          if (it->second->evicted_) {
+            // The method became hot again after its baseline code was evicted.
+            it->second->evicted_ = false;
+            number_of_recompilations_after_eviction_++;
+          }
+        }
       }
       if (!has_profiling_info) {
         if (ProfilingInfo::Create(self, method) == nullptr) {
@@ -1798,6 +1844,11 @@ void JitCodeCache::Dump(std::ostream& os) {
      << "Current JIT data cache size (used / resident): "
      << GetCurrentRegion()->GetUsedMemoryForData() / KB << "KB / "
      << GetCurrentRegion()->GetResidentMemoryForData() / KB << "KB\n";
+  if (GetCurrentRegion()->GetHotCodeCapacity() != 0u) {
+    os << "Current JIT hot code size (used / capacity): "
+       << GetCurrentRegion()->GetUsedMemoryForHotCode() / KB << "KB / "
+       << GetCurrentRegion()->GetHotCodeCapacity() / KB << "KB\n";
+  }
   if (!Runtime::Current()->IsZygote()) {
     os << "Zygote JIT code cache size (at point of fork): "
        << shared_region_.GetUsedMemoryForCode() / KB << "KB / "
@@ -1814,7 +1865,10 @@ void JitCodeCache::Dump(std::ostream& os) {
      << "Total number of JIT optimized compilations: " << number_of_optimized_compilations_ << "\n"
      << "Total number of JIT compilations for on stack replacement: "
         << number_of_osr_compilations_ << "\n"
-     << "Total number of JIT code cache collections: " << number_of_collections_ << std::endl;
+     << "Total number of JIT code cache collections: " << number_of_collections_ << "\n"
+     << "Total number of JIT code evictions: " << number_of_evictions_ << "\n"
+     << "Total number of JIT recompilations of evicted code: "
+        << number_of_recompilations_after_eviction_ << std::endl;
   histogram_stack_map_memory_use_.PrintMemoryUse(os);
   histogram_code_memory_use_.PrintMemoryUse(os);
   histogram_profiling_info_memory_use_.PrintMemoryUse(os);
@@ -1849,6 +1903,8 @@ void JitCodeCache::PostForkChildAction(bool is_system_server, bool is_zygote) {
   number_of_optimized_compilations_ = 0;
   number_of_osr_compilations_ = 0;
   number_of_collections_ = 0;
+  number_of_evictions_ = 0;
+  number_of_recompilations_after_eviction_ = 0;
   histogram_stack_map_memory_use_.Reset();
   histogram_code_memory_use_.Reset();
   histogram_profiling_info_memory_use_.Reset();
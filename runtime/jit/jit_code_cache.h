@@ -43,6 +43,8 @@ template<class T> class Handle;
 class LinearAlloc;
 class InlineCache;
 class IsMarkedVisitor;
+class JitCodeCacheEvictionTestHelper;
+class JitCodeCacheThrashTestHelper;
 class JitJniStubTestHelper;
 class OatQuickMethodHeader;
 struct ProfileMethodInfo;
@@ -188,6 +190,10 @@ class JitCodeCache {
   // By default, do not GC until reaching 256KB.
   static constexpr size_t kReservedCapacity = kInitialCapacity * 4;
 
+  // Number of consecutive collections during which baseline compiled code must not have run
+  // before it gets evicted.
+  static constexpr uint8_t kBaselineCodeEvictionAge = 2u;
+
   // Create the code cache with a code + data capacity equal to "capacity", error message is passed
   // in the out arg error_msg.
   static JitCodeCache* Create(bool used_only_for_profile_data,
@@ -238,13 +244,15 @@ class JitCodeCache {
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!Locks::jit_lock_);
 
   // Allocate a region for both code and data in the JIT code cache.
-  // The reserved memory is left completely uninitialized.
+  // The reserved memory is left completely uninitialized. Baseline code is kept apart from
+  // optimized code, see JitMemoryRegion::AllocateCode().
   bool Reserve(Thread* self,
                JitMemoryRegion* region,
                size_t code_size,
                size_t stack_map_size,
                size_t number_of_roots,
                ArtMethod* method,
+               CompilationKind compilation_kind,
                /*out*/ArrayRef<const uint8_t>* reserved_code,
                /*out*/ArrayRef<const uint8_t>* reserved_data)
       REQUIRES_SHARED(Locks::mutator_lock_)
@@ -333,6 +341,13 @@ class JitCodeCache {
       REQUIRES(!Locks::jit_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Adds to `methods` all methods which are part of any of the given dex locations and
+  // currently use optimized JIT code.
+  void GetOptimizedMethods(const std::set<std::string>& dex_base_locations,
+                           std::vector<ProfileMethodInfo>& methods)
+      REQUIRES(!Locks::jit_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   void InvalidateAllCompiledCode()
       REQUIRES(!Locks::jit_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -588,6 +603,13 @@ class JitCodeCache {
   // Number of code cache collections done throughout the lifetime of the JIT.
   size_t number_of_collections_ GUARDED_BY(Locks::jit_lock_);
 
+  // Number of baseline compiled methods evicted by code cache collections.
+  size_t number_of_evictions_ GUARDED_BY(Locks::jit_lock_);
+
+  // Number of baseline compilations of methods whose baseline code was evicted. A high
+  // value compared to `number_of_evictions_` means the code cache is thrashing.
+  size_t number_of_recompilations_after_eviction_ GUARDED_BY(Locks::jit_lock_);
+
   // Histograms for keeping track of stack map size statistics.
   Histogram<uint64_t> histogram_stack_map_memory_use_ GUARDED_BY(Locks::jit_lock_);
 
@@ -597,6 +619,8 @@ class JitCodeCache {
   // Histograms for keeping track of profiling info statistics.
   Histogram<uint64_t> histogram_profiling_info_memory_use_ GUARDED_BY(Locks::jit_lock_);
 
+  friend class art::JitCodeCacheEvictionTestHelper;
+  friend class art::JitCodeCacheThrashTestHelper;
   friend class art::JitJniStubTestHelper;
   friend class ScopedCodeCacheWrite;
   friend class MarkCodeClosure;
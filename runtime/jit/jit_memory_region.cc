@@ -17,6 +17,7 @@
 #include "jit_memory_region.h"
 
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
 #include <android-base/unique_fd.h>
@@ -42,6 +43,15 @@ namespace jit {
 // TODO: Make this variable?
 static constexpr size_t kCodeAndDataCapacityDivider = 2;
 
+// A quarter of the maximum code capacity is reserved for hot (optimized) code, see AllocateCode().
+static constexpr size_t kHotCodeCapacityDivider = 4;
+
+// Regions with a smaller hot code space are not worth segregating.
+static constexpr size_t kMinHotCodeCapacity = 64 * kPageSize;
+
+// Size of the huge pages the hot code space is aligned to when it is large enough.
+static constexpr size_t kHotCodeHugePageSize = 2 * MB;
+
 bool JitMemoryRegion::Initialize(size_t initial_capacity,
                                  size_t max_capacity,
                                  bool rwx_memory_allowed,
@@ -62,6 +72,23 @@ bool JitMemoryRegion::Initialize(size_t initial_capacity,
   const size_t data_capacity = capacity / kCodeAndDataCapacityDivider;
   const size_t exec_capacity = capacity - data_capacity;
 
+  // Reserve the beginning of the code portion for hot code. The zygote does not collect code,
+  // so there is nothing to gain from segregating its code.
+  hot_code_capacity_ = 0u;
+  hot_exec_end_ = 0u;
+  if (!is_zygote) {
+    size_t hot_code_capacity = RoundDown(exec_capacity / kHotCodeCapacityDivider, kPageSize);
+    if (hot_code_capacity >= kHotCodeHugePageSize) {
+      hot_code_capacity = RoundDown(hot_code_capacity, kHotCodeHugePageSize);
+    }
+    if (hot_code_capacity >= kMinHotCodeCapacity && exec_end_ > kPageSize) {
+      hot_code_capacity_ = hot_code_capacity;
+      // Give the hot code space its initial page from the initial code capacity.
+      hot_exec_end_ = kPageSize;
+      exec_end_ -= hot_exec_end_;
+    }
+  }
+
   // File descriptor enabling dual-view mapping of code section.
   unique_fd mem_fd;
 
@@ -259,6 +286,19 @@ bool JitMemoryRegion::Initialize(size_t initial_capacity,
   non_exec_pages_ = std::move(non_exec_pages);
   writable_data_pages_ = std::move(writable_data_pages);
 
+#ifdef MADV_HUGEPAGE
+  if (hot_code_capacity_ >= kHotCodeHugePageSize && exec_pages_.IsValid()) {
+    // Back the hot code space with huge pages to reduce iTLB misses. This is only a hint: the
+    // kernel may not support transparent huge pages for this memory. Note that both views of
+    // the code share the same physical pages in the dual view case.
+    if (madvise(exec_pages_.Begin(), hot_code_capacity_, MADV_HUGEPAGE) != 0 ||
+        (non_exec_pages_.IsValid() &&
+         madvise(non_exec_pages_.Begin(), hot_code_capacity_, MADV_HUGEPAGE) != 0)) {
+      VLOG(jit) << "Failed to madvise huge pages for hot JIT code: " << strerror(errno);
+    }
+  }
+#endif
+
   VLOG(jit) << "Created JitMemoryRegion"
             << ": data_pages=" << reinterpret_cast<void*>(data_pages_.Begin())
             << ", exec_pages=" << reinterpret_cast<void*>(exec_pages_.Begin())
@@ -291,7 +331,13 @@ bool JitMemoryRegion::Initialize(size_t initial_capacity,
     // heap, will take and initialize pages in create_mspace_with_base().
     {
       ScopedCodeCacheWrite scc(*this);
-      exec_mspace_ = create_mspace_with_base(code_heap->Begin(), exec_end_, false /*locked*/);
+      exec_mspace_ = create_mspace_with_base(
+          code_heap->Begin() + hot_code_capacity_, exec_end_, false /*locked*/);
+      if (hot_code_capacity_ != 0u) {
+        hot_exec_mspace_ =
+            create_mspace_with_base(code_heap->Begin(), hot_exec_end_, false /*locked*/);
+        CHECK(hot_exec_mspace_ != nullptr) << "create_mspace_with_base (hot exec) failed";
+      }
     }
     CHECK(exec_mspace_ != nullptr) << "create_mspace_with_base (exec) failed";
     SetFootprintLimit(current_capacity_);
@@ -306,12 +352,31 @@ void JitMemoryRegion::SetFootprintLimit(size_t new_footprint) {
   size_t data_space_footprint = new_footprint / kCodeAndDataCapacityDivider;
   DCHECK(IsAlignedParam(data_space_footprint, kPageSize));
   DCHECK_EQ(data_space_footprint * kCodeAndDataCapacityDivider, new_footprint);
+  code_footprint_limit_ = new_footprint - data_space_footprint;
   if (HasCodeMapping()) {
     ScopedCodeCacheWrite scc(*this);
-    mspace_set_footprint_limit(exec_mspace_, new_footprint - data_space_footprint);
+    UpdateCodeFootprintLimits();
   }
 }
 
+void JitMemoryRegion::UpdateCodeFootprintLimits() {
+  if (hot_exec_mspace_ == nullptr) {
+    mspace_set_footprint_limit(exec_mspace_, code_footprint_limit_);
+    return;
+  }
+  // Each code space can grow into the part of the limit not used by the other one, within the
+  // bounds of its own portion of the region.
+  const size_t cold_code_capacity = exec_pages_.Size() - hot_code_capacity_;
+  size_t cold_limit = (code_footprint_limit_ > hot_exec_end_)
+      ? code_footprint_limit_ - hot_exec_end_
+      : 0u;
+  size_t hot_limit = (code_footprint_limit_ > exec_end_) ? code_footprint_limit_ - exec_end_ : 0u;
+  mspace_set_footprint_limit(exec_mspace_, std::min(std::max(cold_limit, exec_end_),
+                                                    cold_code_capacity));
+  mspace_set_footprint_limit(hot_exec_mspace_, std::min(std::max(hot_limit, hot_exec_end_),
+                                                        hot_code_capacity_));
+}
+
 bool JitMemoryRegion::IncreaseCodeCacheCapacity() {
   if (current_capacity_ == max_capacity_) {
     return false;
@@ -341,9 +406,15 @@ void* JitMemoryRegion::MoreCore(const void* mspace, intptr_t increment) NO_THREA
   if (mspace == exec_mspace_) {
     CHECK(exec_mspace_ != nullptr);
     const MemMap* const code_pages = GetUpdatableCodeMapping();
-    void* result = code_pages->Begin() + exec_end_;
+    void* result = code_pages->Begin() + hot_code_capacity_ + exec_end_;
     exec_end_ += increment;
     return result;
+  } else if (hot_exec_mspace_ != nullptr && mspace == hot_exec_mspace_) {
+    const MemMap* const code_pages = GetUpdatableCodeMapping();
+    void* result = code_pages->Begin() + hot_exec_end_;
+    hot_exec_end_ += increment;
+    DCHECK_LE(hot_exec_end_, hot_code_capacity_);
+    return result;
   } else {
     CHECK_EQ(data_mspace_, mspace);
     const MemMap* const writable_data_pages = GetWritableDataMapping();
@@ -467,20 +538,44 @@ bool JitMemoryRegion::CommitData(ArrayRef<const uint8_t> reserved_data,
   return true;
 }
 
-const uint8_t* JitMemoryRegion::AllocateCode(size_t size) {
+const uint8_t* JitMemoryRegion::AllocateCode(size_t size, bool is_hot) {
   size_t alignment = GetInstructionSetAlignment(kRuntimeISA);
-  void* result = mspace_memalign(exec_mspace_, alignment, size);
+  void* result = nullptr;
+  if (hot_exec_mspace_ == nullptr) {
+    result = mspace_memalign(exec_mspace_, alignment, size);
+  } else {
+    void* preferred_mspace = is_hot ? hot_exec_mspace_ : exec_mspace_;
+    UpdateCodeFootprintLimits();
+    result = mspace_memalign(preferred_mspace, alignment, size);
+    if (result == nullptr) {
+      // Rather than failing the allocation and collecting the code cache, use the other space.
+      UpdateCodeFootprintLimits();
+      void* other_mspace = is_hot ? exec_mspace_ : hot_exec_mspace_;
+      result = mspace_memalign(other_mspace, alignment, size);
+    }
+  }
   if (UNLIKELY(result == nullptr)) {
     return nullptr;
   }
+  const uint8_t* code = reinterpret_cast<uint8_t*>(GetExecutableAddress(result));
   used_memory_for_code_ += mspace_usable_size(result);
-  return reinterpret_cast<uint8_t*>(GetExecutableAddress(result));
+  if (IsInHotExecSpace(code)) {
+    used_memory_for_hot_code_ += mspace_usable_size(result);
+  }
+  return code;
 }
 
 void JitMemoryRegion::FreeCode(const uint8_t* code) {
+  const bool is_hot = IsInHotExecSpace(code);
   code = GetNonExecutableAddress(code);
-  used_memory_for_code_ -= mspace_usable_size(code);
-  mspace_free(exec_mspace_, const_cast<uint8_t*>(code));
+  size_t usable_size = mspace_usable_size(code);
+  used_memory_for_code_ -= usable_size;
+  if (is_hot) {
+    used_memory_for_hot_code_ -= usable_size;
+    mspace_free(hot_exec_mspace_, const_cast<uint8_t*>(code));
+  } else {
+    mspace_free(exec_mspace_, const_cast<uint8_t*>(code));
+  }
 }
 
 const uint8_t* JitMemoryRegion::AllocateData(size_t data_size) {
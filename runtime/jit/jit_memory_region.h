@@ -17,6 +17,7 @@
 #ifndef ART_RUNTIME_JIT_JIT_MEMORY_REGION_H_
 #define ART_RUNTIME_JIT_JIT_MEMORY_REGION_H_
 
+#include <algorithm>
 #include <string>
 
 #include "arch/instruction_set.h"
@@ -58,12 +59,17 @@ class JitMemoryRegion {
         exec_end_(0),
         used_memory_for_code_(0),
         used_memory_for_data_(0),
+        code_footprint_limit_(0),
+        hot_code_capacity_(0),
+        hot_exec_end_(0),
+        used_memory_for_hot_code_(0),
         data_pages_(),
         writable_data_pages_(),
         exec_pages_(),
         non_exec_pages_(),
         data_mspace_(nullptr),
-        exec_mspace_(nullptr) {}
+        exec_mspace_(nullptr),
+        hot_exec_mspace_(nullptr) {}
 
   bool Initialize(size_t initial_capacity,
                   size_t max_capacity,
@@ -79,7 +85,12 @@ class JitMemoryRegion {
   // Set the footprint limit of the code cache.
   void SetFootprintLimit(size_t new_footprint) REQUIRES(Locks::jit_lock_);
 
-  const uint8_t* AllocateCode(size_t code_size) REQUIRES(Locks::jit_lock_);
+  // Allocate code memory. Code for which `is_hot` is set (optimized code) is preferably
+  // allocated in the hot code space at the beginning of the code region, and other code
+  // (baseline code) in the cold code space that follows it, so that the code that runs the most
+  // is packed in as few pages as possible. Allocations fall back to the other space when the
+  // preferred one is full.
+  const uint8_t* AllocateCode(size_t code_size, bool is_hot = false) REQUIRES(Locks::jit_lock_);
   void FreeCode(const uint8_t* code) REQUIRES(Locks::jit_lock_);
   const uint8_t* AllocateData(size_t data_size) REQUIRES(Locks::jit_lock_);
   void FreeData(const uint8_t* data) REQUIRES(Locks::jit_lock_);
@@ -107,6 +118,7 @@ class JitMemoryRegion {
     // Also clear the mspaces, which, in their implementation,
     // point to the discarded mappings.
     exec_mspace_ = nullptr;
+    hot_exec_mspace_ = nullptr;
     data_mspace_ = nullptr;
   }
 
@@ -146,6 +158,11 @@ class JitMemoryRegion {
     return exec_pages_.HasAddress(ptr);
   }
 
+  bool IsInHotExecSpace(const void* ptr) const NO_THREAD_SAFETY_ANALYSIS {
+    const uint8_t* raw_ptr = reinterpret_cast<const uint8_t*>(ptr);
+    return raw_ptr >= exec_pages_.Begin() && raw_ptr < exec_pages_.Begin() + hot_code_capacity_;
+  }
+
   const MemMap* GetExecPages() const {
     return &exec_pages_;
   }
@@ -153,7 +170,9 @@ class JitMemoryRegion {
   void* MoreCore(const void* mspace, intptr_t increment);
 
   bool OwnsSpace(const void* mspace) const NO_THREAD_SAFETY_ANALYSIS {
-    return mspace == data_mspace_ || mspace == exec_mspace_;
+    return mspace == data_mspace_ ||
+           mspace == exec_mspace_ ||
+           (hot_exec_mspace_ != nullptr && mspace == hot_exec_mspace_);
   }
 
   size_t GetCurrentCapacity() const REQUIRES(Locks::jit_lock_) {
@@ -169,7 +188,22 @@ class JitMemoryRegion {
   }
 
   size_t GetResidentMemoryForCode() const REQUIRES(Locks::jit_lock_) {
-    return exec_end_;
+    return exec_end_ + hot_exec_end_;
+  }
+
+  size_t GetHotCodeCapacity() const REQUIRES(Locks::jit_lock_) {
+    return hot_code_capacity_;
+  }
+
+  // Returns the end of the part of the executable code mapping that the hot and the cold code
+  // spaces can use at the current capacity. All code allocated in this region is below it.
+  const uint8_t* GetCodeSpacesEnd() const REQUIRES(Locks::jit_lock_) {
+    return exec_pages_.Begin() +
+        std::min(hot_code_capacity_ + code_footprint_limit_, exec_pages_.Size());
+  }
+
+  size_t GetUsedMemoryForHotCode() const REQUIRES(Locks::jit_lock_) {
+    return used_memory_for_hot_code_;
   }
 
   size_t GetUsedMemoryForData() const REQUIRES(Locks::jit_lock_) {
@@ -234,6 +268,10 @@ class JitMemoryRegion {
     return TranslateAddress(src_ptr, exec_pages_, non_exec_pages_);
   }
 
+  // Distribute the footprint limit of the code portion between the hot and the cold code spaces,
+  // allowing each space to grow into whatever the other one does not use.
+  void UpdateCodeFootprintLimits() REQUIRES(Locks::jit_lock_);
+
   static int CreateZygoteMemory(size_t capacity, std::string* error_msg);
   static bool ProtectZygoteMemory(int fd, std::string* error_msg);
 
@@ -258,6 +296,20 @@ class JitMemoryRegion {
   // The size in bytes of used memory for the data portion of the region.
   size_t used_memory_for_data_ GUARDED_BY(Locks::jit_lock_);
 
+  // The footprint limit in bytes of the code portion of the region, shared by the hot and the
+  // cold code spaces.
+  size_t code_footprint_limit_ GUARDED_BY(Locks::jit_lock_);
+
+  // The size in bytes reserved for hot code at the beginning of the code portion of the region.
+  // Zero if the region has no hot code space.
+  size_t hot_code_capacity_ GUARDED_BY(Locks::jit_lock_);
+
+  // The current footprint in bytes of the hot code space.
+  size_t hot_exec_end_ GUARDED_BY(Locks::jit_lock_);
+
+  // The size in bytes of used memory for the hot code space.
+  size_t used_memory_for_hot_code_ GUARDED_BY(Locks::jit_lock_);
+
   // Mem map which holds data (stack maps and profiling info).
   MemMap data_pages_;
 
@@ -278,6 +330,9 @@ class JitMemoryRegion {
   // The opaque mspace for allocating code.
   void* exec_mspace_ GUARDED_BY(Locks::jit_lock_);
 
+  // The opaque mspace for allocating hot code, or null if the region has no hot code space.
+  void* hot_exec_mspace_ GUARDED_BY(Locks::jit_lock_);
+
   friend class ScopedCodeCacheWrite;  // For GetUpdatableCodeMapping
   friend class TestZygoteMemory;
 };
@@ -21,6 +21,9 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <vector>
+
 #include <android-base/unique_fd.h>
 #include <gtest/gtest.h>
 
@@ -28,6 +31,9 @@
 #include "base/memfd.h"
 #include "base/utils.h"
 #include "common_runtime_test.h"
+#include "jit/jit_code_cache.h"
+#include "jit/jit_scoped_code_cache_write.h"
+#include "thread-current-inl.h"
 
 namespace art {
 namespace jit {
@@ -577,5 +583,116 @@ TEST_F(TestZygoteMemory, TestVmMayWriteAfter) {
 
 #endif  // defined (__BIONIC__)
 
+class JitMemoryRegionTest : public CommonRuntimeTest {
+ protected:
+  void SetUpRuntimeOptions(RuntimeOptions* options) override {
+    // Reset the callbacks so that the runtime doesn't think it's for AOT.
+    callbacks_ = nullptr;
+    CommonRuntimeTest::SetUpRuntimeOptions(options);
+    options->push_back(std::make_pair("-Xusejit:true", nullptr));
+    // Large enough for a hot code space, small enough to fill it quickly.
+    options->push_back(std::make_pair("-Xjitinitialsize:64K", nullptr));
+    options->push_back(std::make_pair("-Xjitmaxsize:4M", nullptr));
+  }
+
+  void SetUp() override {
+    CommonRuntimeTest::SetUp();
+    // The runtime is not started, so create the code cache ourselves. Growing its mspaces
+    // goes through the runtime's code cache, so we cannot use a standalone region.
+    runtime_->CreateJitCodeCache(/*rwx_memory_allowed=*/ true);
+    ASSERT_TRUE(runtime_->GetJitCodeCache() != nullptr);
+    region_ = runtime_->GetJitCodeCache()->GetCurrentRegion();
+  }
+
+  // Allocates code of `size` bytes until an allocation fails or `done` returns true for it.
+  // Returns the allocations.
+  template <typename Done>
+  std::vector<const uint8_t*> AllocateCodeUntil(size_t size, bool is_hot, Done done)
+      REQUIRES(Locks::jit_lock_) {
+    std::vector<const uint8_t*> allocations;
+    ScopedCodeCacheWrite scc(*region_);
+    while (true) {
+      const uint8_t* code = region_->AllocateCode(size, is_hot);
+      if (code == nullptr) {
+        break;
+      }
+      allocations.push_back(code);
+      if (done(code)) {
+        break;
+      }
+    }
+    return allocations;
+  }
+
+  void FreeAllCode(const std::vector<const uint8_t*>& allocations) REQUIRES(Locks::jit_lock_) {
+    ScopedCodeCacheWrite scc(*region_);
+    for (const uint8_t* code : allocations) {
+      region_->FreeCode(code);
+    }
+  }
+
+  JitMemoryRegion* region_ = nullptr;
+};
+
+TEST_F(JitMemoryRegionTest, HotCodeInHotSpace) {
+  MutexLock mu(Thread::Current(), *Locks::jit_lock_);
+  ASSERT_NE(0u, region_->GetHotCodeCapacity());
+  const uint8_t* hot_code;
+  const uint8_t* cold_code;
+  {
+    ScopedCodeCacheWrite scc(*region_);
+    hot_code = region_->AllocateCode(128u, /*is_hot=*/ true);
+    cold_code = region_->AllocateCode(128u, /*is_hot=*/ false);
+  }
+  ASSERT_TRUE(hot_code != nullptr);
+  ASSERT_TRUE(cold_code != nullptr);
+  EXPECT_TRUE(region_->IsInExecSpace(hot_code));
+  EXPECT_TRUE(region_->IsInHotExecSpace(hot_code));
+  EXPECT_TRUE(region_->IsInExecSpace(cold_code));
+  EXPECT_FALSE(region_->IsInHotExecSpace(cold_code));
+  EXPECT_NE(0u, region_->GetUsedMemoryForHotCode());
+  FreeAllCode({hot_code, cold_code});
+  EXPECT_EQ(0u, region_->GetUsedMemoryForHotCode());
+}
+
+TEST_F(JitMemoryRegionTest, HotCodeFallsBackToColdSpace) {
+  MutexLock mu(Thread::Current(), *Locks::jit_lock_);
+  ASSERT_NE(0u, region_->GetHotCodeCapacity());
+  // The hot space can only grow into the part of the code footprint limit that the cold space
+  // does not use, so it fills up long before the hot code capacity is reached.
+  std::vector<const uint8_t*> allocations = AllocateCodeUntil(
+      1 * KB, /*is_hot=*/ true, [&](const uint8_t* code) REQUIRES(Locks::jit_lock_) {
+        return !region_->IsInHotExecSpace(code);
+      });
+  ASSERT_GE(allocations.size(), 2u);
+  EXPECT_TRUE(region_->IsInHotExecSpace(allocations.front()));
+  EXPECT_FALSE(region_->IsInHotExecSpace(allocations.back()));
+  EXPECT_TRUE(region_->IsInExecSpace(allocations.back()));
+  EXPECT_LT(region_->GetUsedMemoryForHotCode(), region_->GetHotCodeCapacity());
+  FreeAllCode(allocations);
+}
+
+TEST_F(JitMemoryRegionTest, CodeSpacesEndCoversAllCode) {
+  MutexLock mu(Thread::Current(), *Locks::jit_lock_);
+  ASSERT_NE(0u, region_->GetHotCodeCapacity());
+  // Grow the cache a few times and fill it with cold code. The cold space starts after the
+  // hot code capacity, so it extends beyond the first half of the current capacity.
+  ASSERT_TRUE(region_->IncreaseCodeCacheCapacity());
+  ASSERT_TRUE(region_->IncreaseCodeCacheCapacity());
+  const uint8_t* begin = region_->GetExecPages()->Begin();
+  const uint8_t* end = region_->GetCodeSpacesEnd();
+  std::vector<const uint8_t*> allocations =
+      AllocateCodeUntil(4 * KB, /*is_hot=*/ false, [](const uint8_t*) { return false; });
+  ASSERT_FALSE(allocations.empty());
+  const uint8_t* max_code_end = begin;
+  for (const uint8_t* code : allocations) {
+    EXPECT_GE(code, begin);
+    EXPECT_LE(code + 4 * KB, end);
+    max_code_end = std::max(max_code_end, code + 4 * KB);
+  }
+  EXPECT_GT(max_code_end, begin + region_->GetCurrentCapacity() / 2);
+  FreeAllCode(allocations);
+}
+
 }  // namespace jit
 }  // namespace art
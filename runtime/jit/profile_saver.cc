@@ -26,6 +26,7 @@
 #include "art_method-inl.h"
 #include "base/compiler_filter.h"
 #include "base/enums.h"
+#include "base/file_utils.h"
 #include "base/logging.h"  // For VLOG.
 #include "base/scoped_arena_containers.h"
 #include "base/stl_util.h"
@@ -796,14 +797,7 @@ void ProfileSaver::FetchAndCacheResolvedClassesAndMethods(bool startup) {
     MutexLock mu(self, *Locks::profiler_lock_);
     for (const auto& it : tracked_dex_base_locations_) {
       const std::string& filename = it.first;
-      auto info_it = profile_cache_.find(filename);
-      if (info_it == profile_cache_.end()) {
-        info_it = profile_cache_.Put(
-            filename,
-            new ProfileCompilationInfo(
-                Runtime::Current()->GetArenaPool(), options_.GetProfileBootClassPath()));
-      }
-      ProfileCompilationInfo* cached_info = info_it->second;
+      ProfileCompilationInfo* cached_info = GetOrCreateCachedProfile(filename);
 
       const std::set<std::string>& locations = it.second;
       VLOG(profiler) << "Locations for " << it.first << " " << android::base::Join(locations, ':');
@@ -821,6 +815,94 @@ void ProfileSaver::FetchAndCacheResolvedClassesAndMethods(bool startup) {
                  << " in " << PrettyDuration(NanoTime() - start_time);
 }
 
+ProfileCompilationInfo* ProfileSaver::GetOrCreateCachedProfile(const std::string& filename) {
+  auto info_it = profile_cache_.find(filename);
+  if (info_it == profile_cache_.end()) {
+    info_it = profile_cache_.Put(
+        filename,
+        new ProfileCompilationInfo(
+            Runtime::Current()->GetArenaPool(), options_.GetProfileBootClassPath()));
+  }
+  return info_it->second;
+}
+
+void ProfileSaver::AddMethodSamples(const std::vector<MethodReference>& methods) {
+  // Aggregate the samples first, so that each method is looked up once per cached profile.
+  SafeMap<MethodReference, uint32_t> sample_counts;
+  for (const MethodReference& method_ref : methods) {
+    ++sample_counts.GetOrCreate(method_ref, []() { return 0u; });
+  }
+  if (sample_counts.empty()) {
+    return;
+  }
+
+  ProfileCompilationInfo::ProfileSampleAnnotation annotation = GetProfileSampleAnnotation();
+  for (const auto& it : tracked_dex_base_locations_) {
+    const std::set<std::string>& locations = it.second;
+    ProfileCompilationInfo* cached_info = nullptr;
+    for (const auto& sample_count : sample_counts) {
+      const DexFile* dex_file = sample_count.first.dex_file;
+      if (locations.find(DexFileLoader::GetBaseLocation(dex_file->GetLocation())) ==
+              locations.end()) {
+        continue;
+      }
+      if (cached_info == nullptr) {
+        cached_info = GetOrCreateCachedProfile(it.first);
+      }
+      cached_info->AddMethodSampleCount(sample_count.first, sample_count.second, annotation);
+    }
+  }
+}
+
+std::string ProfileSaver::GetJitWarmupCacheFilename(const std::string& profile_filename) {
+  return ReplaceFileExtension(profile_filename, "jit.prof");
+}
+
+void ProfileSaver::SaveJitWarmupCache(const std::string& filename,
+                                      const std::set<std::string>& locations) {
+  std::vector<ProfileMethodInfo> optimized_methods;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    jit_code_cache_->GetOptimizedMethods(locations, optimized_methods);
+  }
+  if (optimized_methods.empty()) {
+    // Nothing has been compiled optimized yet in this run. Keep the methods of earlier runs.
+    return;
+  }
+  std::set<MethodReference> methods;
+  for (const ProfileMethodInfo& method : optimized_methods) {
+    methods.insert(method.ref);
+  }
+  std::string warmup_filename = GetJitWarmupCacheFilename(filename);
+  auto it = jit_warmup_cache_methods_.find(warmup_filename);
+  if (it != jit_warmup_cache_methods_.end() && it->second == methods) {
+    return;
+  }
+
+  // Replace the warmup cache with the methods currently using optimized code, so that methods
+  // that have been deoptimized or whose code has been collected are dropped.
+  ProfileCompilationInfo info(Runtime::Current()->GetArenaPool());
+  if (!info.AddMethods(optimized_methods, Hotness::kFlagHot)) {
+    LOG(WARNING) << "Could not add methods to JIT warmup cache " << warmup_filename;
+    return;
+  }
+  if (!OS::FileExists(warmup_filename.c_str())) {
+    unix_file::FdFile file(warmup_filename.c_str(),
+                           O_WRONLY | O_TRUNC | O_CREAT,
+                           S_IRUSR | S_IWUSR,
+                           /*check_usage=*/ false);
+    if (!file.IsValid()) {
+      LOG(WARNING) << "Could not create JIT warmup cache " << warmup_filename;
+      return;
+    }
+  }
+  if (!info.Save(warmup_filename, /*bytes_written=*/ nullptr)) {
+    LOG(WARNING) << "Could not save JIT warmup cache to " << warmup_filename;
+    return;
+  }
+  jit_warmup_cache_methods_.Overwrite(warmup_filename, std::move(methods));
+}
+
 bool ProfileSaver::ProcessProfilingInfo(
         bool force_save,
         bool skip_class_and_method_fetching,
@@ -867,6 +949,9 @@ bool ProfileSaver::ProcessProfilingInfo(
       jit_code_cache_->GetProfiledMethods(locations, profile_methods);
       total_number_of_code_cache_queries_++;
     }
+    if (options_.GetJitWarmupCache()) {
+      SaveJitWarmupCache(filename, locations);
+    }
     {
       ProfileCompilationInfo info(Runtime::Current()->GetArenaPool(),
                                   /*for_boot_image=*/ options_.GetProfileBootClassPath());
@@ -1156,6 +1241,14 @@ bool ProfileSaver::ShuttingDown(Thread* self) {
   return shutting_down_;
 }
 
+void ProfileSaver::NotifyMethodSamples(const std::vector<MethodReference>& methods) {
+  MutexLock mu(Thread::Current(), *Locks::profiler_lock_);
+  if (instance_ == nullptr || instance_->shutting_down_) {
+    return;
+  }
+  instance_->AddMethodSamples(methods);
+}
+
 bool ProfileSaver::IsStarted() {
   MutexLock mu(Thread::Current(), *Locks::profiler_lock_);
   return instance_ != nullptr;
@@ -58,6 +58,16 @@ class ProfileSaver {
   // Notify that startup has completed.
   static void NotifyStartupCompleted() REQUIRES(!Locks::profiler_lock_, !instance_->wait_lock_);
 
+  // Record CPU samples of the given methods, one sample per entry, in the cached profiles of
+  // the tracked locations that cover the methods. Used by the sampling profiler to weight the
+  // hotness of methods by their share of the sampled execution time.
+  static void NotifyMethodSamples(const std::vector<MethodReference>& methods)
+      REQUIRES(!Locks::profiler_lock_);
+
+  // Returns the name of the JIT warmup cache associated with the given profile. The warmup
+  // cache is a profile of the methods that were compiled optimized by the JIT.
+  static std::string GetJitWarmupCacheFilename(const std::string& profile_filename);
+
  private:
   // Helper classes for collecting classes and methods.
   class GetClassesAndMethodsHelper;
@@ -87,6 +97,12 @@ class ProfileSaver {
       REQUIRES(!Locks::profiler_lock_)
       REQUIRES(!Locks::mutator_lock_);
 
+  // Replaces the contents of the JIT warmup cache associated with the profile `filename` with
+  // the methods of `locations` currently using optimized JIT code.
+  void SaveJitWarmupCache(const std::string& filename, const std::set<std::string>& locations)
+      REQUIRES(!Locks::profiler_lock_)
+      REQUIRES(!Locks::mutator_lock_);
+
   void NotifyJitActivityInternal() REQUIRES(!wait_lock_);
   void WakeUpSaver() REQUIRES(wait_lock_);
 
@@ -102,6 +118,13 @@ class ProfileSaver {
   // profile_cache_ for later save.
   void FetchAndCacheResolvedClassesAndMethods(bool startup) REQUIRES(!Locks::profiler_lock_);
 
+  // Returns the cached profile for the given profile filename, creating it if needed.
+  ProfileCompilationInfo* GetOrCreateCachedProfile(const std::string& filename)
+      REQUIRES(Locks::profiler_lock_);
+
+  void AddMethodSamples(const std::vector<MethodReference>& methods)
+      REQUIRES(Locks::profiler_lock_);
+
   void DumpInfo(std::ostream& os);
 
   // Resolve the realpath of the locations stored in tracked_dex_base_locations_to_be_resolved_
@@ -154,6 +177,10 @@ class ProfileSaver {
   // to just a few hundreds entries in the ProfileCompilationInfo objects.
   SafeMap<std::string, ProfileCompilationInfo*> profile_cache_ GUARDED_BY(Locks::profiler_lock_);
 
+  // The methods last written to each JIT warmup cache, so that we only write a warmup cache
+  // when the set of optimized methods changes. Only used by the profile saver thread.
+  SafeMap<std::string, std::set<MethodReference>> jit_warmup_cache_methods_;
+
   // Whether or not this is the first ever profile save.
   // Note this is an approximation and is not 100% precise. It relies on checking
   // whether or not the profiles are empty which is not a precise indication
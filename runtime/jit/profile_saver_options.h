@@ -47,7 +47,8 @@ struct ProfileSaverOptions {
     profile_path_(""),
     profile_boot_class_path_(false),
     profile_aot_code_(false),
-    wait_for_jit_notifications_to_save_(true) {}
+    wait_for_jit_notifications_to_save_(true),
+    jit_warmup_cache_(false) {}
 
   ProfileSaverOptions(
       bool enabled,
@@ -62,7 +63,8 @@ struct ProfileSaverOptions {
       const std::string& profile_path,
       bool profile_boot_class_path,
       bool profile_aot_code = false,
-      bool wait_for_jit_notifications_to_save = true)
+      bool wait_for_jit_notifications_to_save = true,
+      bool jit_warmup_cache = false)
   : enabled_(enabled),
     min_save_period_ms_(min_save_period_ms),
     min_first_save_ms_(min_first_save_ms),
@@ -75,7 +77,8 @@ struct ProfileSaverOptions {
     profile_path_(profile_path),
     profile_boot_class_path_(profile_boot_class_path),
     profile_aot_code_(profile_aot_code),
-    wait_for_jit_notifications_to_save_(wait_for_jit_notifications_to_save) {}
+    wait_for_jit_notifications_to_save_(wait_for_jit_notifications_to_save),
+    jit_warmup_cache_(jit_warmup_cache) {}
 
   bool IsEnabled() const {
     return enabled_;
@@ -127,6 +130,9 @@ struct ProfileSaverOptions {
   void SetWaitForJitNotificationsToSave(bool value) {
     wait_for_jit_notifications_to_save_ = value;
   }
+  bool GetJitWarmupCache() const {
+    return jit_warmup_cache_;
+  }
 
   friend std::ostream & operator<<(std::ostream &os, const ProfileSaverOptions& pso) {
     os << "enabled_" << pso.enabled_
@@ -140,7 +146,8 @@ struct ProfileSaverOptions {
         << ", max_notification_before_wake_" << pso.max_notification_before_wake_
         << ", profile_boot_class_path_" << pso.profile_boot_class_path_
         << ", profile_aot_code_" << pso.profile_aot_code_
-        << ", wait_for_jit_notifications_to_save_" << pso.wait_for_jit_notifications_to_save_;
+        << ", wait_for_jit_notifications_to_save_" << pso.wait_for_jit_notifications_to_save_
+        << ", jit_warmup_cache_" << pso.jit_warmup_cache_;
     return os;
   }
 
@@ -159,6 +166,9 @@ struct ProfileSaverOptions {
   bool profile_boot_class_path_;
   bool profile_aot_code_;
   bool wait_for_jit_notifications_to_save_;
+  // Whether to record the methods compiled optimized by the JIT, and to compile them
+  // again as soon as the app is registered on its next start.
+  bool jit_warmup_cache_;
 };
 
 }  // namespace art
@@ -29,7 +29,10 @@ ProfilingInfo::ProfilingInfo(ArtMethod* method, const std::vector<uint32_t>& ent
       : baseline_hotness_count_(GetOptimizeThreshold()),
         method_(method),
         number_of_inline_caches_(entries.size()),
-        current_inline_uses_(0) {
+        current_inline_uses_(0),
+        last_seen_baseline_hotness_count_(baseline_hotness_count_),
+        eviction_age_(0u),
+        evicted_(false) {
   memset(&cache_, 0, number_of_inline_caches_ * sizeof(InlineCache));
   for (size_t i = 0; i < number_of_inline_caches_; ++i) {
     cache_[i].dex_pc_ = entries[i];
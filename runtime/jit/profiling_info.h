@@ -111,14 +111,19 @@ class ProfilingInfo {
     baseline_hotness_count_ = GetOptimizeThreshold();
   }
 
-  bool CounterHasChanged() const {
-    return baseline_hotness_count_ != GetOptimizeThreshold();
-  }
-
   uint16_t GetBaselineHotnessCount() const {
     return baseline_hotness_count_;
   }
 
+  // Returns whether the baseline hotness count changed since the last call, that is whether
+  // the baseline compiled code of the method ran since the last code cache collection.
+  // Unlike ResetCounter(), this does not lose the progress towards optimized compilation.
+  bool CounterHasChangedSinceLastCollection() {
+    bool changed = baseline_hotness_count_ != last_seen_baseline_hotness_count_;
+    last_seen_baseline_hotness_count_ = baseline_hotness_count_;
+    return changed;
+  }
+
  private:
   ProfilingInfo(ArtMethod* method, const std::vector<uint32_t>& entries);
 
@@ -141,6 +146,18 @@ class ProfilingInfo {
   // it updates this counter so that the GC does not try to clear the inline caches.
   uint16_t current_inline_uses_;
 
+  // Value of `baseline_hotness_count_` at the last code cache collection.
+  uint16_t last_seen_baseline_hotness_count_;
+
+  // Number of consecutive code cache collections during which the baseline compiled
+  // code of the method did not run. Used by the code cache as the age of a clock-style
+  // eviction policy.
+  uint8_t eviction_age_;
+
+  // Whether the baseline compiled code of the method was evicted by the code cache.
+  // Used to track recompilations of evicted code.
+  bool evicted_;
+
   // Dynamically allocated array of size `number_of_inline_caches_`.
   InlineCache cache_[0];
 
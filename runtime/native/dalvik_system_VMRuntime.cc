@@ -38,6 +38,7 @@ extern "C" void android_set_application_target_sdk_version(uint32_t version);
 #include "common_throws.h"
 #include "debugger.h"
 #include "dex/class_accessor-inl.h"
+#include "dex/descriptors_names.h"
 #include "dex/dex_file-inl.h"
 #include "dex/dex_file_types.h"
 #include "gc/accounting/card_table-inl.h"
@@ -46,12 +47,14 @@ extern "C" void android_set_application_target_sdk_version(uint32_t version);
 #include "gc/space/dlmalloc_space.h"
 #include "gc/space/image_space.h"
 #include "gc/task_processor.h"
+#include "handle_scope-inl.h"
 #include "intern_table.h"
 #include "jit/jit.h"
 #include "jni/java_vm_ext.h"
 #include "jni/jni_internal.h"
 #include "mirror/array-alloc-inl.h"
 #include "mirror/class-inl.h"
+#include "mirror/class_loader.h"
 #include "mirror/dex_cache-inl.h"
 #include "mirror/object-inl.h"
 #include "native_util.h"
@@ -367,6 +370,44 @@ static void VMRuntime_runHeapTasks(JNIEnv* env, jobject) {
 static void VMRuntime_preloadDexCaches(JNIEnv* env ATTRIBUTE_UNUSED, jobject) {
 }
 
+/*
+ * Load the classes with the given binary names through the given class loader, for example the
+ * preloaded classes of the zygote, using the runtime thread pool while it still exists. Classes
+ * that fail to load are skipped, their errors are thrown again on the next lookup.
+ * Returns the number of classes that were loaded.
+ */
+static jint VMRuntime_preloadClasses(JNIEnv* env,
+                                     jclass klass ATTRIBUTE_UNUSED,
+                                     jobjectArray jclass_names,
+                                     jobject jclass_loader) {
+  if (UNLIKELY(jclass_names == nullptr)) {
+    ScopedObjectAccess soa(env);
+    ThrowNullPointerException("class_names == null");
+    return 0;
+  }
+  std::vector<std::string> descriptors;
+  const jsize length = env->GetArrayLength(jclass_names);
+  descriptors.reserve(length);
+  for (jsize i = 0; i < length; ++i) {
+    ScopedLocalRef<jstring> jclass_name(
+        env, reinterpret_cast<jstring>(env->GetObjectArrayElement(jclass_names, i)));
+    ScopedUtfChars class_name(env, jclass_name.get());
+    if (class_name.c_str() == nullptr) {
+      return 0;  // NullPointerException pending.
+    }
+    descriptors.push_back(DotToDescriptor(class_name.c_str()));
+  }
+
+  Runtime::ScopedThreadPoolUsage stpu;
+  ScopedObjectAccess soa(env);
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::ClassLoader> class_loader =
+      hs.NewHandle(soa.Decode<mirror::ClassLoader>(jclass_loader));
+  size_t num_loaded = Runtime::Current()->GetClassLinker()->PreloadClasses(
+      soa.Self(), descriptors, class_loader, stpu.GetThreadPool());
+  return static_cast<jint>(num_loaded);
+}
+
 /*
  * This is called by the framework after it loads a code path on behalf of the app.
  * The code_path_type indicates the type of the apk being loaded and can be used
@@ -546,6 +587,7 @@ static JNINativeMethod gMethods[] = {
   FAST_NATIVE_METHOD(VMRuntime, is64Bit, "()Z"),
   FAST_NATIVE_METHOD(VMRuntime, isCheckJniEnabled, "()Z"),
   NATIVE_METHOD(VMRuntime, preloadDexCaches, "()V"),
+  NATIVE_METHOD(VMRuntime, preloadClasses, "([Ljava/lang/String;Ljava/lang/ClassLoader;)I"),
   NATIVE_METHOD(VMRuntime, registerAppInfo,
       "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;[Ljava/lang/String;I)V"),
   NATIVE_METHOD(VMRuntime, isBootClassPathOnDisk, "(Ljava/lang/String;)Z"),
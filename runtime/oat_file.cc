@@ -52,6 +52,7 @@
 #include "base/utils.h"
 #include "dex/art_dex_file_loader.h"
 #include "dex/dex_file.h"
+#include "dex/dex_file_layout.h"
 #include "dex/dex_file_loader.h"
 #include "dex/dex_file_structs.h"
 #include "dex/dex_file_types.h"
@@ -2345,6 +2346,17 @@ const dex::ClassDef* OatDexFile::FindClassDef(const DexFile& dex_file,
   return nullptr;
 }
 
+void OatDexFile::MadviseDexFileAtLoad(const DexFile& dex_file) {
+  const OatDexFile* oat_dex_file = dex_file.GetOatDexFile();
+  if (oat_dex_file == nullptr) {
+    return;
+  }
+  const DexLayoutSections* const sections = oat_dex_file->GetDexLayoutSections();
+  if (sections != nullptr) {
+    sections->MadviseAtLoad(&dex_file);
+  }
+}
+
 OatFile::OatClass::OatClass(const OatFile* oat_file,
                             ClassStatus status,
                             OatClassType type,
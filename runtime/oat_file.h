@@ -575,6 +575,9 @@ class OatDexFile final {
     return dex_layout_sections_;
   }
 
+  // Madvise the dex file based on the layout sections recorded by dexlayout, if any.
+  static void MadviseDexFileAtLoad(const DexFile& dex_file);
+
  private:
   OatDexFile(const OatFile* oat_file,
              const std::string& dex_file_location,
@@ -35,8 +35,10 @@
 #include "base/systrace.h"
 #include "class_linker.h"
 #include "class_loader_context.h"
+#include "code_info_cache.h"
 #include "dex/art_dex_file_loader.h"
 #include "dex/dex_file-inl.h"
+#include "dex/dex_file_layout.h"
 #include "dex/dex_file_loader.h"
 #include "dex/dex_file_tracking_registrar.h"
 #include "gc/scoped_gc_critical_section.h"
@@ -65,6 +67,27 @@ using android::base::StringPrintf;
 // If true, we attempt to load the application image if it exists.
 static constexpr bool kEnableAppImage = true;
 
+// Returns the end of the range of `dex_file` to prefetch at load time. The cold metadata that
+// dexlayout packs at the end of the data section is left out.
+static const uint8_t* GetDexFilePrefetchEnd(const DexFile& dex_file) {
+  const uint8_t* end = dex_file.Begin() + dex_file.Size();
+  const OatDexFile* oat_dex_file = dex_file.GetOatDexFile();
+  if (oat_dex_file == nullptr || oat_dex_file->GetDexLayoutSections() == nullptr) {
+    return end;
+  }
+  const DexLayoutSection::Subsection& cold_metadata =
+      oat_dex_file->GetDexLayoutSections()->sections_[static_cast<size_t>(
+          DexLayoutSections::SectionType::kSectionTypeColdMetadata)].parts_[static_cast<size_t>(
+              LayoutType::kLayoutTypeSometimesUsed)];
+  const uint8_t* cold_begin = dex_file.DataBegin() + cold_metadata.start_offset_;
+  if (cold_metadata.start_offset_ == cold_metadata.end_offset_ ||
+      cold_begin < dex_file.Begin() ||
+      cold_begin >= end) {
+    return end;
+  }
+  return cold_begin;
+}
+
 const OatFile* OatFileManager::RegisterOatFile(std::unique_ptr<const OatFile> oat_file,
                                                bool in_memory) {
   // Use class_linker vlog to match the log for dex file registration.
@@ -101,6 +124,8 @@ void OatFileManager::UnRegisterAndDeleteOatFile(const OatFile* oat_file) {
   CHECK(it != oat_files_.end());
   oat_files_.erase(it);
   compare.release();  // NOLINT b/117926937
+  // Stack walks may have cached CodeInfo decoded from the oat file's code.
+  CodeInfoCache::InvalidateAll();
 }
 
 const OatFile* OatFileManager::FindOpenedOatFileFromDexLocation(
@@ -351,6 +376,9 @@ std::vector<std::unique_ptr<const DexFile>> OatFileManager::OpenDexFilesFromOat(
           }
         }
       }
+      for (const std::unique_ptr<const DexFile>& dex_file : dex_files) {
+        OatDexFile::MadviseDexFileAtLoad(*dex_file);
+      }
       if (dex_files.empty()) {
         ScopedTrace failed_to_open_dex_files("FailedToOpenDexFilesFromOat");
         error_msgs->push_back("Failed to open dex files from " + odex_location);
@@ -360,10 +388,11 @@ std::vector<std::unique_ptr<const DexFile>> OatFileManager::OpenDexFilesFromOat(
           // Prefetch the dex file based on vdex size limit (name should
           // have been dex size limit).
           VLOG(oat) << "Madvising dex file: " << dex_file->GetLocation();
+          const uint8_t* prefetch_end = GetDexFilePrefetchEnd(*dex_file);
           Runtime::MadviseFileForRange(madvise_size_limit,
-                                       dex_file->Size(),
+                                       prefetch_end - dex_file->Begin(),
                                        dex_file->Begin(),
-                                       dex_file->Begin() + dex_file->Size(),
+                                       prefetch_end,
                                        dex_file->GetLocation());
           if (dex_file->Size() >= madvise_size_limit) {
             break;
@@ -370,6 +370,16 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
                          {"all",      verifier::VerifyMode::kEnable},
                          {"softfail", verifier::VerifyMode::kSoftFail}})
           .IntoKey(M::Verify)
+      .Define("-Xdexverificationcachedir:_")
+          .WithType<std::string>()
+          .WithHelp("Directory for caching the results of verifying uncompressed dex files in "
+                    "APKs, so that they do not need to be verified again on the next open.")
+          .IntoKey(M::DexVerificationCacheDir)
+      .Define("-Xdexverifierthreads:_")
+          .WithType<unsigned int>()
+          .WithHelp("Maximum number of threads used for verifying the sections of large dex "
+                    "files.")
+          .IntoKey(M::DexVerifierThreads)
       .Define("-XX:NativeBridge=_")
           .WithType<std::string>()
           .IntoKey(M::NativeBridge)
@@ -464,7 +474,16 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-XX:PerfettoJavaHeapStackProf=_")
           .WithType<bool>()
           .WithValueMap({{"false", false}, {"true", true}})
-          .IntoKey(M::PerfettoJavaHeapStackProf);
+          .IntoKey(M::PerfettoJavaHeapStackProf)
+      .Define("-XX:LiveHeapProfile=_")
+          .WithType<std::string>()
+          .IntoKey(M::LiveHeapProfile)
+      .Define("-XX:LiveHeapProfileSamplingInterval=_")
+          .WithType<unsigned int>()
+          .IntoKey(M::LiveHeapProfileSamplingInterval)
+      .Define("-XX:LiveHeapProfilePeriodMs=_")
+          .WithType<unsigned int>()
+          .IntoKey(M::LiveHeapProfilePeriodMs);
 
       FlagBase::AddFlagsToCmdlineParser(parser_builder.get());
 
@@ -73,6 +73,8 @@
 #include "debugger.h"
 #include "dex/art_dex_file_loader.h"
 #include "dex/dex_file_loader.h"
+#include "dex/dex_file_verifier.h"
+#include "dex/dex_verification_cache.h"
 #include "elf_file.h"
 #include "entrypoints/runtime_asm_entrypoints.h"
 #include "entrypoints/entrypoint_utils-inl.h"
@@ -383,6 +385,10 @@ Runtime::~Runtime() {
         << "\n";
   }
 
+  if (heap_->GetLiveHeapProfiler() != nullptr) {
+    heap_->DumpLiveHeapProfile(self);
+  }
+
   // Wait for the workers of thread pools to be created since there can't be any
   // threads attaching during shutdown.
   WaitForThreadPoolWorkersToStart();
@@ -1051,6 +1057,10 @@ bool Runtime::Start() {
   VLOG(startup) << "Runtime::Start exiting";
   finished_starting_ = true;
 
+  if (heap_->GetLiveHeapProfiler() != nullptr) {
+    heap_->RequestLiveHeapProfileDump(self);
+  }
+
   if (trace_config_.get() != nullptr && trace_config_->trace_file != "") {
     ScopedThreadStateChange tsc(self, ThreadState::kWaitingForMethodTracingStart);
     Trace::Start(trace_config_->trace_file.c_str(),
@@ -1568,6 +1578,8 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   monitor_timeout_ns_ = MsToNs(monitor_timeout_ms);
 
   verify_ = runtime_options.GetOrDefault(Opt::Verify);
+  DexVerificationCache::SetDirectory(runtime_options.GetOrDefault(Opt::DexVerificationCacheDir));
+  dex::SetVerifierThreads(runtime_options.GetOrDefault(Opt::DexVerifierThreads));
 
   target_sdk_version_ = runtime_options.GetOrDefault(Opt::TargetSdkVersion);
 
@@ -1824,6 +1836,19 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
 
   self->SetIsRuntimeThread(IsAotCompiler());
 
+  // The Perfetto Java heap profiler owns the heap sampler when it is enabled.
+  std::string live_heap_profile = runtime_options.GetOrDefault(Opt::LiveHeapProfile);
+  if (!live_heap_profile.empty() && !IsAotCompiler()) {
+    if (IsPerfettoJavaHeapStackProfEnabled()) {
+      LOG(WARNING) << "Ignoring -XX:LiveHeapProfile, the Perfetto Java heap profiler is enabled";
+    } else {
+      heap_->EnableLiveHeapProfiler(
+          live_heap_profile,
+          runtime_options.GetOrDefault(Opt::LiveHeapProfileSamplingInterval),
+          runtime_options.GetOrDefault(Opt::LiveHeapProfilePeriodMs));
+    }
+  }
+
   // Set us to runnable so tools using a runtime can allocate and GC by default
   self->TransitionFromSuspendedToRunnable();
 
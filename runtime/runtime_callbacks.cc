@@ -202,6 +202,11 @@ void RuntimeCallbacks::RemoveClassLoadCallback(ClassLoadCallback* cb) {
   Remove(cb, &class_callbacks_);
 }
 
+bool RuntimeCallbacks::HasClassLoadCallbacks() {
+  ReaderMutexLock mu(Thread::Current(), *callback_lock_);
+  return !class_callbacks_.empty();
+}
+
 void RuntimeCallbacks::ClassLoad(Handle<mirror::Class> klass) {
   for (ClassLoadCallback* cb : COPY(class_callbacks_)) {
     cb->ClassLoad(klass);
@@ -171,6 +171,7 @@ class RuntimeCallbacks {
 
   void AddClassLoadCallback(ClassLoadCallback* cb) REQUIRES(Locks::mutator_lock_);
   void RemoveClassLoadCallback(ClassLoadCallback* cb) REQUIRES(Locks::mutator_lock_);
+  bool HasClassLoadCallbacks() REQUIRES_SHARED(Locks::mutator_lock_);
 
   void BeginDefineClass() REQUIRES_SHARED(Locks::mutator_lock_);
   void EndDefineClass() REQUIRES_SHARED(Locks::mutator_lock_);
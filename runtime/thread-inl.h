@@ -426,7 +426,7 @@ inline void Thread::PoisonObjectPointersIfDebug() {
 
 inline bool Thread::ModifySuspendCount(Thread* self,
                                        int delta,
-                                       AtomicInteger* suspend_barrier,
+                                       SuspendBarrier* suspend_barrier,
                                        SuspendReason reason) {
   if (delta > 0 && ((gUseReadBarrier && this != self) || suspend_barrier != nullptr)) {
     // When delta > 0 (requesting a suspend), ModifySuspendCountInternal() may fail either if
@@ -59,6 +59,7 @@
 #include "base/utils.h"
 #include "class_linker-inl.h"
 #include "class_root-inl.h"
+#include "code_info_cache.h"
 #include "debugger.h"
 #include "dex/descriptors_names.h"
 #include "dex/dex_file-inl.h"
@@ -1453,7 +1454,7 @@ static void UnsafeLogFatalForSuspendCount(Thread* self, Thread* thread) NO_THREA
 
 bool Thread::ModifySuspendCountInternal(Thread* self,
                                         int delta,
-                                        AtomicInteger* suspend_barrier,
+                                        SuspendBarrier* suspend_barrier,
                                         SuspendReason reason) {
   if (kIsDebugBuild) {
     DCHECK(delta == -1 || delta == +1)
@@ -1524,7 +1525,7 @@ bool Thread::PassActiveSuspendBarriers(Thread* self) {
   // barriers. Then clear the list and the flag. The ModifySuspendCount
   // function requires the lock so we prevent a race between setting
   // the kActiveSuspendBarrier flag and clearing it.
-  AtomicInteger* pass_barriers[kMaxSuspendBarriers];
+  SuspendBarrier* pass_barriers[kMaxSuspendBarriers];
   {
     MutexLock mu(self, *Locks::thread_suspend_count_lock_);
     if (!ReadFlag(ThreadFlag::kActiveSuspendBarrier)) {
@@ -1547,14 +1548,25 @@ bool Thread::PassActiveSuspendBarriers(Thread* self) {
 
   uint32_t barrier_count = 0;
   for (uint32_t i = 0; i < kMaxSuspendBarriers; i++) {
-    AtomicInteger* pending_threads = pass_barriers[i];
-    if (pending_threads != nullptr) {
+    SuspendBarrier* barrier = pass_barriers[i];
+    if (barrier != nullptr) {
+      AtomicInteger* pending_threads = &barrier->pending_threads;
       bool done = false;
       do {
         int32_t cur_val = pending_threads->load(std::memory_order_relaxed);
         CHECK_GT(cur_val, 0) << "Unexpected value for PassActiveSuspendBarriers(): " << cur_val;
-        // Reduce value by 1.
-        done = pending_threads->CompareAndSetWeakRelaxed(cur_val, cur_val - 1);
+        if (cur_val == 1) {
+          // This is the last thread to pass the barrier. The requester has already accounted for
+          // the threads that were suspended, so no other thread can decrement the value now.
+          // Record this thread before releasing the requester, which may return as soon as it
+          // sees zero.
+          barrier->last_thread = this;
+          barrier->last_thread_pc = __builtin_return_address(0);
+          done = pending_threads->CompareAndSetWeakRelease(cur_val, 0);
+        } else {
+          // Reduce value by 1.
+          done = pending_threads->CompareAndSetWeakRelaxed(cur_val, cur_val - 1);
+        }
 #if ART_USE_FUTEXES
         if (done && (cur_val - 1) == 0) {  // Weak CAS may fail spuriously.
           futex(pending_threads->Address(), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
@@ -1568,11 +1580,11 @@ bool Thread::PassActiveSuspendBarriers(Thread* self) {
   return true;
 }
 
-void Thread::ClearSuspendBarrier(AtomicInteger* target) {
+void Thread::ClearSuspendBarrier(SuspendBarrier* target) {
   CHECK(ReadFlag(ThreadFlag::kActiveSuspendBarrier));
   bool clear_flag = true;
   for (uint32_t i = 0; i < kMaxSuspendBarriers; ++i) {
-    AtomicInteger* ptr = tlsPtr_.active_suspend_barriers[i];
+    SuspendBarrier* ptr = tlsPtr_.active_suspend_barriers[i];
     if (ptr == target) {
       tlsPtr_.active_suspend_barriers[i] = nullptr;
     } else if (ptr != nullptr) {
@@ -4038,10 +4050,16 @@ class ReferenceMapVisitor : public StackVisitor {
       StackReference<mirror::Object>* vreg_base =
           reinterpret_cast<StackReference<mirror::Object>*>(cur_quick_frame);
       uintptr_t native_pc_offset = method_header->NativeQuickPcOffset(GetCurrentQuickFramePc());
-      CodeInfo code_info = kPrecise
-          ? CodeInfo(method_header)  // We will need dex register maps.
+      // The cached CodeInfo is fully decoded, so it also has the dex register maps we need
+      // if `kPrecise`. Otherwise we only need the GC masks, so do not decode and cache the
+      // whole CodeInfo if it is not in the cache yet.
+      const bool use_cache = kPrecise || CodeInfoCache::IsCachedForCurrentThread(method_header);
+      CodeInfo code_info = use_cache
+          ? CodeInfoCache::Get(method_header)
           : CodeInfo::DecodeGcMasksOnly(method_header);
-      StackMap map = code_info.GetStackMapForNativePcOffset(native_pc_offset);
+      StackMap map = use_cache
+          ? CodeInfoCache::GetStackMapForNativePcOffset(method_header, code_info, native_pc_offset)
+          : code_info.GetStackMapForNativePcOffset(native_pc_offset);
       DCHECK(map.IsValid());
 
       T vreg_info(m, code_info, map, visitor_);
@@ -4242,6 +4260,7 @@ void Thread::VisitRoots(RootVisitor* visitor) {
                        RootInfo(kRootNativeStack, thread_id));
   }
   visitor->VisitRootIfNonNull(&tlsPtr_.monitor_enter_object, RootInfo(kRootNativeStack, thread_id));
+  visitor->VisitRootIfNonNull(&pending_heap_sample_, RootInfo(kRootNativeStack, thread_id));
   tlsPtr_.jni_env->VisitJniLocalRoots(visitor, RootInfo(kRootJNILocal, thread_id));
   tlsPtr_.jni_env->VisitMonitorRoots(visitor, RootInfo(kRootJNIMonitor, thread_id));
   HandleScopeVisitRoots(visitor, thread_id);
@@ -4297,6 +4316,11 @@ static void SweepCacheEntry(IsMarkedVisitor* visitor, const Instruction* inst, s
   if (inst == nullptr) {
     return;
   }
+  if (!IsAligned<sizeof(uint16_t)>(inst)) {
+    // Inline cache entry of an invoke-interface, see InterpreterCache::kInvokeInterfaceKeyOffset.
+    // The value is an ArtMethod*.
+    return;
+  }
   using Opcode = Instruction::Code;
   Opcode opcode = inst->Opcode();
   switch (opcode) {
@@ -4558,6 +4582,14 @@ void Thread::SetReadBarrierEntrypoints() {
   UpdateReadBarrierEntrypoints(&tlsPtr_.quick_entrypoints, /* is_active=*/ true);
 }
 
+CodeInfoCache* Thread::GetCodeInfoCache() {
+  DCHECK_EQ(this, Thread::Current());
+  if (UNLIKELY(code_info_cache_ == nullptr)) {
+    code_info_cache_ = std::make_unique<CodeInfoCache>();
+  }
+  return code_info_cache_.get();
+}
+
 void Thread::ClearAllInterpreterCaches() {
   static struct ClearInterpreterCacheClosure : Closure {
     void Run(Thread* thread) override {
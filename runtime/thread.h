@@ -87,6 +87,7 @@ class ArtMethod;
 class BaseMutex;
 class ClassLinker;
 class Closure;
+class CodeInfoCache;
 class Context;
 class DeoptimizationContextRecord;
 class DexFile;
@@ -112,6 +113,16 @@ class TLSData {
   virtual ~TLSData() {}
 };
 
+// The barrier of a suspend all request, see ThreadList::SuspendAllInternal(). Each thread that
+// has to suspend decrements `pending_threads` once. The thread that takes it to zero first records
+// itself and the native pc at which it passed the barrier, so that a slow request can be
+// attributed to that thread.
+struct SuspendBarrier {
+  AtomicInteger pending_threads;
+  Thread* last_thread = nullptr;
+  const void* last_thread_pc = nullptr;
+};
+
 // Thread priorities. These must match the Thread.MIN_PRIORITY,
 // Thread.NORM_PRIORITY, and Thread.MAX_PRIORITY constants.
 enum ThreadPriority {
@@ -321,7 +332,7 @@ class Thread {
   ALWAYS_INLINE
   bool ModifySuspendCount(Thread* self,
                           int delta,
-                          AtomicInteger* suspend_barrier,
+                          SuspendBarrier* suspend_barrier,
                           SuspendReason reason)
       WARN_UNUSED
       REQUIRES(Locks::thread_suspend_count_lock_);
@@ -1161,6 +1172,16 @@ class Thread {
     tls64_.trace_clock_base = clock_base;
   }
 
+  // The JVMTI plugin keeps a bitmap of the events enabled for this thread, so that it can filter
+  // out events nobody listens to without taking any locks. The runtime itself does not use it.
+  uint64_t GetJvmtiEventMask() const {
+    return tls64_.jvmti_event_mask.load(std::memory_order_relaxed);
+  }
+
+  void SetJvmtiEventMask(uint64_t mask) {
+    tls64_.jvmti_event_mask.store(mask, std::memory_order_relaxed);
+  }
+
   BaseMutex* GetHeldMutex(LockLevel level) const {
     return tlsPtr_.held_mutexes[level];
   }
@@ -1169,7 +1190,7 @@ class Thread {
     tlsPtr_.held_mutexes[level] = mutex;
   }
 
-  void ClearSuspendBarrier(AtomicInteger* target)
+  void ClearSuspendBarrier(SuspendBarrier* target)
       REQUIRES(Locks::thread_suspend_count_lock_);
 
   bool ReadFlag(ThreadFlag flag) const {
@@ -1360,6 +1381,22 @@ class Thread {
     return &interpreter_cache_;
   }
 
+  // Returns the thread-local cache of decoded CodeInfo used for stack walks done by this
+  // thread. It is allocated on first use.
+  CodeInfoCache* GetCodeInfoCache();
+
+  // The allocation picked by the heap sampler that the live heap profiler has not recorded yet.
+  void SetPendingHeapSample(mirror::Object* obj, size_t allocation_size) {
+    pending_heap_sample_ = obj;
+    pending_heap_sample_size_ = allocation_size;
+  }
+  mirror::Object* GetPendingHeapSample() const {
+    return pending_heap_sample_;
+  }
+  size_t GetPendingHeapSampleSize() const {
+    return pending_heap_sample_size_;
+  }
+
   // Clear all thread-local interpreter caches.
   //
   // Since the caches are keyed by memory pointer to dex instructions, this must be
@@ -1544,7 +1581,7 @@ class Thread {
 
   bool ModifySuspendCountInternal(Thread* self,
                                   int delta,
-                                  AtomicInteger* suspend_barrier,
+                                  SuspendBarrier* suspend_barrier,
                                   SuspendReason reason)
       WARN_UNUSED
       REQUIRES(Locks::thread_suspend_count_lock_);
@@ -1825,13 +1862,17 @@ class Thread {
   } tls32_;
 
   struct PACKED(8) tls_64bit_sized_values {
-    tls_64bit_sized_values() : trace_clock_base(0) {
+    tls_64bit_sized_values() : trace_clock_base(0), jvmti_event_mask(0u) {
     }
 
     // The clock base used for tracing.
     uint64_t trace_clock_base;
 
     RuntimeStats stats;
+
+    // Bitmap of the JVMTI events enabled specifically for this thread by any environment.
+    std::atomic<uint64_t> jvmti_event_mask;
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
   } tls64_;
 
   struct PACKED(sizeof(void*)) tls_ptr_sized_values {
@@ -1986,7 +2027,7 @@ class Thread {
     // Locks::thread_suspend_count_lock_.
     // They work effectively as art::Barrier, but implemented directly using AtomicInteger and futex
     // to avoid additional cost of a mutex and a condition variable, as used in art::Barrier.
-    AtomicInteger* active_suspend_barriers[kMaxSuspendBarriers];
+    SuspendBarrier* active_suspend_barriers[kMaxSuspendBarriers];
 
     // Thread-local allocation pointer. Moved here to force alignment for thread_local_pos on ARM.
     uint8_t* thread_local_start;
@@ -2076,6 +2117,14 @@ class Thread {
   // the caller is allowed to access all fields and methods in the Core Platform API.
   uint32_t core_platform_api_cookie_ = 0;
 
+  // Decoded CodeInfo for stack walks done by this thread, or null if not used yet.
+  std::unique_ptr<CodeInfoCache> code_info_cache_;
+
+  // The pending heap sample and its allocation size, or null. The object is a root, so that the
+  // sample is still found if the object moves before the profiler records it.
+  mirror::Object* pending_heap_sample_ = nullptr;
+  size_t pending_heap_sample_size_ = 0u;
+
   friend class gc::collector::SemiSpace;  // For getting stack traces.
   friend class Runtime;  // For CreatePeer.
   friend class QuickExceptionHandler;  // For dumping the stack.
@@ -17,9 +17,12 @@
 #include "thread_list.h"
 
 #include <dirent.h>
+#include <dlfcn.h>
+#include <inttypes.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <sstream>
 #include <vector>
 
@@ -28,6 +31,7 @@
 #include "nativehelper/scoped_local_ref.h"
 #include "nativehelper/scoped_utf_chars.h"
 
+#include "art_method-inl.h"
 #include "base/aborting.h"
 #include "base/histogram-inl.h"
 #include "base/mutex-inl.h"
@@ -44,6 +48,7 @@
 #include "lock_word.h"
 #include "monitor.h"
 #include "native_stack_dump.h"
+#include "runtime.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread.h"
 #include "trace.h"
@@ -140,6 +145,7 @@ void ThreadList::DumpForSigQuit(std::ostream& os) {
       suspend_all_historam_.CreateHistogram(&data);
       suspend_all_historam_.PrintConfidenceIntervals(os, 0.99, data);  // Dump time to suspend.
     }
+    DumpLateThreads(os);
   }
   bool dump_native_stack = Runtime::Current()->GetDumpNativeStackOnSigQuit();
   Dump(os, dump_native_stack);
@@ -315,6 +321,7 @@ size_t ThreadList::RunCheckpoint(Closure* checkpoint_function, Closure* callback
 
   std::vector<Thread*> suspended_count_modified_threads;
   size_t count = 0;
+  const uint64_t request_start_time = NanoTime();
   {
     // Call a checkpoint function for each thread, threads which are suspended get their checkpoint
     // manually called.
@@ -363,6 +370,7 @@ size_t ThreadList::RunCheckpoint(Closure* checkpoint_function, Closure* callback
         }
       }
     }
+    GetMetrics()->CheckpointRequestTime()->Add(NsToUs(NanoTime() - request_start_time));
     // Run the callback to be called inside this critical section.
     if (callback != nullptr) {
       callback->Run(self);
@@ -520,14 +528,22 @@ size_t ThreadList::FlipThreadRoots(Closure* thread_flip_visitor,
   // ThreadFlipBegin happens before we suspend all the threads, so it does not count towards the
   // pause.
   const uint64_t suspend_start_time = NanoTime();
-  SuspendAllInternal(self, self, nullptr);
+  Thread* last_thread = nullptr;
+  const void* last_thread_pc = nullptr;
+  SuspendAllInternal(
+      self, self, nullptr, SuspendReason::kInternal, &last_thread, &last_thread_pc);
   if (pause_listener != nullptr) {
     pause_listener->StartPause();
   }
 
   // Run the flip callback for the collector.
   Locks::mutator_lock_->ExclusiveLock(self);
-  suspend_all_historam_.AdjustAndAddValue(NanoTime() - suspend_start_time);
+  const uint64_t suspend_time = NanoTime() - suspend_start_time;
+  suspend_all_historam_.AdjustAndAddValue(suspend_time);
+  if (suspend_time > kLongThreadSuspendThreshold) {
+    LOG(WARNING) << "Suspending all threads for thread flip took: " << PrettyDuration(suspend_time)
+                 << RecordLateThread(last_thread, last_thread_pc, suspend_time);
+  }
   flip_callback->Run(self);
   Locks::mutator_lock_->ExclusiveUnlock(self);
   collector->RegisterPause(NanoTime() - suspend_start_time);
@@ -609,7 +625,10 @@ void ThreadList::SuspendAll(const char* cause, bool long_suspend) {
     ScopedTrace trace("Suspending mutator threads");
     const uint64_t start_time = NanoTime();
 
-    SuspendAllInternal(self, self);
+    Thread* last_thread = nullptr;
+    const void* last_thread_pc = nullptr;
+    SuspendAllInternal(
+        self, self, nullptr, SuspendReason::kInternal, &last_thread, &last_thread_pc);
     // All threads are known to have suspended (but a thread may still own the mutator lock)
     // Make sure this thread grabs exclusive access to the mutator lock and its protected data.
 #if HAVE_TIMED_RWLOCK
@@ -635,7 +654,8 @@ void ThreadList::SuspendAll(const char* cause, bool long_suspend) {
     const uint64_t suspend_time = end_time - start_time;
     suspend_all_historam_.AdjustAndAddValue(suspend_time);
     if (suspend_time > kLongThreadSuspendThreshold) {
-      LOG(WARNING) << "Suspending all threads took: " << PrettyDuration(suspend_time);
+      LOG(WARNING) << "Suspending all threads took: " << PrettyDuration(suspend_time)
+                   << RecordLateThread(last_thread, last_thread_pc, suspend_time);
     }
 
     if (kDebugLocking) {
@@ -656,7 +676,9 @@ void ThreadList::SuspendAll(const char* cause, bool long_suspend) {
 void ThreadList::SuspendAllInternal(Thread* self,
                                     Thread* ignore1,
                                     Thread* ignore2,
-                                    SuspendReason reason) {
+                                    SuspendReason reason,
+                                    Thread** last_thread,
+                                    const void** last_thread_pc) {
   Locks::mutator_lock_->AssertNotExclusiveHeld(self);
   Locks::thread_list_lock_->AssertNotHeld(self);
   Locks::thread_suspend_count_lock_->AssertNotHeld(self);
@@ -672,8 +694,10 @@ void ThreadList::SuspendAllInternal(Thread* self,
   //    kNative) and will never begin executing Java code without first checking
   //    the suspend-request flag.
 
-  // The atomic counter for number of threads that need to pass the barrier.
-  AtomicInteger pending_threads;
+  // The barrier with the atomic counter for number of threads that need to pass it.
+  SuspendBarrier barrier;
+  AtomicInteger& pending_threads = barrier.pending_threads;
+  const uint64_t request_start_time = NanoTime();
   uint32_t num_ignored = 0;
   if (ignore1 != nullptr) {
     ++num_ignored;
@@ -687,13 +711,18 @@ void ThreadList::SuspendAllInternal(Thread* self,
     // Update global suspend all state for attaching threads.
     ++suspend_all_count_;
     pending_threads.store(list_.size() - num_ignored, std::memory_order_relaxed);
-    // Increment everybody's suspend count (except those that should be ignored).
+    int32_t num_suspended = 0;
+    // Increment everybody's suspend count (except those that should be ignored). The request is
+    // a flag in each thread's state-and-flags word rather than a global epoch: suspend checks
+    // already poll that word with a single load, and the per-thread suspend counts are still
+    // needed for nested and single-thread suspension, so a global epoch would not remove this
+    // loop. Only the time spent here and in the wait below is measured.
     for (const auto& thread : list_) {
       if (thread == ignore1 || thread == ignore2) {
         continue;
       }
       VLOG(threads) << "requesting thread suspend: " << *thread;
-      bool updated = thread->ModifySuspendCount(self, +1, &pending_threads, reason);
+      bool updated = thread->ModifySuspendCount(self, +1, &barrier, reason);
       DCHECK(updated);
 
       // Must install the pending_threads counter first, then check thread->IsSuspend() and clear
@@ -701,11 +730,17 @@ void ThreadList::SuspendAllInternal(Thread* self,
       // that can lead a thread to miss a call to PassActiveSuspendBarriers().
       if (thread->IsSuspended()) {
         // Only clear the counter for the current thread.
-        thread->ClearSuspendBarrier(&pending_threads);
-        pending_threads.fetch_sub(1, std::memory_order_seq_cst);
+        thread->ClearSuspendBarrier(&barrier);
+        ++num_suspended;
       }
     }
+    // Account for the threads that were already suspended with a single update, the runnable
+    // threads cannot bring the counter to zero before that as they were counted too.
+    if (num_suspended != 0u) {
+      pending_threads.fetch_sub(num_suspended, std::memory_order_seq_cst);
+    }
   }
+  GetMetrics()->SuspendAllRequestTime()->Add(NsToUs(NanoTime() - request_start_time));
 
   // Wait for the barrier to be passed by all runnable threads. This wait
   // is done with a timeout so that we can detect problems.
@@ -715,7 +750,9 @@ void ThreadList::SuspendAllInternal(Thread* self,
 #endif
   const uint64_t start_time = NanoTime();
   while (true) {
-    int32_t cur_val = pending_threads.load(std::memory_order_relaxed);
+    // Acquire pairs with the release by the last thread to pass the barrier, see
+    // Thread::PassActiveSuspendBarriers().
+    int32_t cur_val = pending_threads.load(std::memory_order_acquire);
     if (LIKELY(cur_val > 0)) {
 #if ART_USE_FUTEXES
       if (futex(pending_threads.Address(), FUTEX_WAIT_PRIVATE, cur_val, &wait_timeout, nullptr, 0)
@@ -754,6 +791,96 @@ void ThreadList::SuspendAllInternal(Thread* self,
       break;
     }
   }
+  GetMetrics()->SuspendAllTimeToSafepoint()->Add(NsToUs(NanoTime() - request_start_time));
+  if (last_thread != nullptr) {
+    *last_thread = barrier.last_thread;
+  }
+  if (last_thread_pc != nullptr) {
+    *last_thread_pc = barrier.last_thread_pc;
+  }
+}
+
+// Describe a native pc by its offset in the mapped file and its nearest symbol, so that the
+// description does not depend on where the file is mapped.
+static std::string DescribeNativePc(const void* pc) {
+  Dl_info info;
+  if (pc == nullptr || dladdr(pc, &info) == 0 || info.dli_fname == nullptr) {
+    return StringPrintf("native code at pc %p", pc);
+  }
+  std::string description = StringPrintf(
+      "native code at %s+0x%" PRIxPTR,
+      info.dli_fname,
+      reinterpret_cast<uintptr_t>(pc) - reinterpret_cast<uintptr_t>(info.dli_fbase));
+  if (info.dli_sname != nullptr) {
+    description += StringPrintf(
+        " (%s+0x%" PRIxPTR ")",
+        info.dli_sname,
+        reinterpret_cast<uintptr_t>(pc) - reinterpret_cast<uintptr_t>(info.dli_saddr));
+  }
+  return description;
+}
+
+std::string ThreadList::RecordLateThread(Thread* last_thread,
+                                         const void* last_thread_pc,
+                                         uint64_t suspend_time) {
+  GetMetrics()->SlowSuspendAllCount()->AddOne();
+  std::ostringstream oss;
+  if (last_thread != nullptr) {
+    // The last thread is suspended now, and it cannot exit before it is resumed. If it has no
+    // managed frame, use the native pc at which it passed the suspend barrier instead.
+    uint32_t dex_pc = 0u;
+    ArtMethod* method = last_thread->GetCurrentMethod(&dex_pc,
+                                                      /*check_suspended=*/ true,
+                                                      /*abort_on_error=*/ false);
+    std::string location = (method != nullptr)
+        ? StringPrintf("%s at dex pc 0x%04x", method->PrettyMethod().c_str(), dex_pc)
+        : DescribeNativePc(last_thread_pc);
+    std::string thread_name;
+    last_thread->GetThreadName(thread_name);
+    oss << std::endl << "Late thread \"" << thread_name << "\" in " << location;
+
+    auto it = late_thread_stats_.find(location);
+    if (it == late_thread_stats_.end()) {
+      if (late_thread_stats_.size() == kMaxLateThreadLocations) {
+        // Make room by dropping the location that accounts for the least suspend time.
+        auto min_it = std::min_element(
+            late_thread_stats_.begin(),
+            late_thread_stats_.end(),
+            [](const auto& lhs, const auto& rhs) {
+              return lhs.second.total_suspend_time < rhs.second.total_suspend_time;
+            });
+        late_thread_stats_.erase(min_it);
+      }
+      it = late_thread_stats_.emplace(location, LateThreadStats()).first;
+    }
+    LateThreadStats& stats = it->second;
+    ++stats.count;
+    stats.total_suspend_time += suspend_time;
+    stats.max_suspend_time = std::max(stats.max_suspend_time, suspend_time);
+    stats.last_thread_name = std::move(thread_name);
+  }
+  return oss.str();
+}
+
+void ThreadList::DumpLateThreads(std::ostream& os) {
+  if (late_thread_stats_.empty()) {
+    return;
+  }
+  std::vector<const std::pair<const std::string, LateThreadStats>*> entries;
+  for (const auto& entry : late_thread_stats_) {
+    entries.push_back(&entry);
+  }
+  std::sort(entries.begin(), entries.end(), [](const auto* lhs, const auto* rhs) {
+    return lhs->second.total_suspend_time > rhs->second.total_suspend_time;
+  });
+  os << "Threads late for slow suspend all requests:\n";
+  for (const auto* entry : entries) {
+    const LateThreadStats& stats = entry->second;
+    os << "  " << entry->first << ": count=" << stats.count
+       << " total=" << PrettyDuration(stats.total_suspend_time)
+       << " max=" << PrettyDuration(stats.max_suspend_time)
+       << " last thread=\"" << stats.last_thread_name << "\"\n";
+  }
 }
 
 void ThreadList::ResumeAll() {
@@ -27,6 +27,8 @@
 
 #include <bitset>
 #include <list>
+#include <map>
+#include <string>
 #include <vector>
 
 namespace art {
@@ -199,12 +201,26 @@ class ThreadList {
   void SuspendAllDaemonThreadsForShutdown()
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
+  // If `last_thread` is not null, it receives the last thread to pass the suspend barrier, or null
+  // if all threads were already suspended, and `last_thread_pc` receives the native pc at which
+  // that thread passed the barrier. That thread cannot exit until it is resumed.
   void SuspendAllInternal(Thread* self,
                           Thread* ignore1,
                           Thread* ignore2 = nullptr,
-                          SuspendReason reason = SuspendReason::kInternal)
+                          SuspendReason reason = SuspendReason::kInternal,
+                          /*out*/ Thread** last_thread = nullptr,
+                          /*out*/ const void** last_thread_pc = nullptr)
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
+  // Attribute a slow suspend all request to the last thread to suspend and to where it was
+  // executing. Returns a description of that thread for logging.
+  std::string RecordLateThread(Thread* last_thread,
+                               const void* last_thread_pc,
+                               uint64_t suspend_time)
+      REQUIRES(Locks::mutator_lock_);
+
+  void DumpLateThreads(std::ostream& os) REQUIRES_SHARED(Locks::mutator_lock_);
+
   void AssertThreadsAreSuspended(Thread* self, Thread* ignore1, Thread* ignore2 = nullptr)
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
@@ -223,6 +239,17 @@ class ThreadList {
   // by mutator lock ensures no thread can read when another thread is modifying it.
   Histogram<uint64_t> suspend_all_historam_ GUARDED_BY(Locks::mutator_lock_);
 
+  // Statistics of the threads that were late for slow suspend all requests, keyed by the location
+  // at which they suspended. Guarded like suspend_all_historam_.
+  struct LateThreadStats {
+    uint64_t count = 0u;
+    uint64_t total_suspend_time = 0u;
+    uint64_t max_suspend_time = 0u;
+    std::string last_thread_name;
+  };
+  static constexpr size_t kMaxLateThreadLocations = 32u;
+  std::map<std::string, LateThreadStats> late_thread_stats_ GUARDED_BY(Locks::mutator_lock_);
+
   // Whether or not the current thread suspension is long.
   bool long_suspend_;
 
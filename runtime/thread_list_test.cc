@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "thread_list.h"
+
+#include <sstream>
+#include <string>
+
+#include "barrier.h"
+#include "base/atomic.h"
+#include "base/time_utils.h"
+#include "common_runtime_test.h"
+#include "scoped_thread_state_change-inl.h"
+#include "thread-inl.h"
+#include "thread_pool.h"
+
+namespace art {
+
+class ThreadListTest : public CommonRuntimeTest {
+ protected:
+  // Check that every thread but `self` is suspended, as they must be after SuspendAll().
+  static void ExpectOtherThreadsSuspended(Thread* self) REQUIRES(!Locks::thread_list_lock_) {
+    MutexLock mu(self, *Locks::thread_list_lock_);
+    for (Thread* thread : Runtime::Current()->GetThreadList()->GetList()) {
+      if (thread != self) {
+        EXPECT_TRUE(thread->IsSuspended()) << *thread;
+      }
+    }
+  }
+};
+
+// Checkpoint counting the threads that ran it.
+class CountingCheckpoint final : public Closure {
+ public:
+  CountingCheckpoint() : barrier_(0), runs_(0) {}
+
+  void Run(Thread* thread ATTRIBUTE_UNUSED) override {
+    runs_.fetch_add(1, std::memory_order_relaxed);
+    barrier_.Pass(Thread::Current());
+  }
+
+  void WaitForThreadsToRunThroughCheckpoint(size_t threads_running_checkpoint) {
+    Thread* self = Thread::Current();
+    ScopedThreadStateChange tsc(self, ThreadState::kWaitingForCheckPointsToRun);
+    barrier_.Increment(self, threads_running_checkpoint);
+  }
+
+  size_t GetRuns() const {
+    return runs_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  Barrier barrier_;
+  std::atomic<size_t> runs_;
+};
+
+// Check that the last thread to suspend, which stays runnable without a suspend check, is
+// reported as late.
+TEST_F(ThreadListTest, LateThreadAttribution) {
+  Thread* self = Thread::Current();
+  ThreadList* thread_list = Runtime::Current()->GetThreadList();
+  ThreadPool thread_pool("Thread list test pool", 1);
+  AtomicInteger started(0);
+  thread_pool.AddTask(self, new FunctionTask([&started](Thread* worker) {
+    ScopedObjectAccess soa(worker);
+    started.store(1, std::memory_order_seq_cst);
+    // Stay runnable for much longer than kLongThreadSuspendThreshold.
+    NanoSleep(MsToNs(100));
+  }));
+  thread_pool.StartWorkers(self);
+  while (started.load(std::memory_order_seq_cst) == 0) {
+    sched_yield();
+  }
+  {
+    ScopedSuspendAll ssa("Late thread test");
+  }
+  thread_pool.Wait(self, /*do_work=*/ false, /*may_hold_locks=*/ false);
+
+  std::ostringstream oss;
+  thread_list->DumpForSigQuit(oss);
+  std::string dump = oss.str();
+  EXPECT_NE(std::string::npos, dump.find("Threads late for slow suspend all requests"));
+  EXPECT_NE(std::string::npos, dump.find("last thread=\"Thread list test pool worker thread 0\""))
+      << dump;
+  // The worker has no managed frame, it is reported where it passed the suspend barrier.
+  EXPECT_NE(std::string::npos, dump.find("  native code at ")) << dump;
+}
+
+// Suspend all threads and run checkpoints from two threads at once, while some threads are
+// runnable and the others are in native code. SuspendAll() accounts for the threads that are
+// already suspended with a single update of its barrier, and must still wait for every runnable
+// thread.
+TEST_F(ThreadListTest, ConcurrentSuspendAllAndCheckpoints) {
+  static constexpr size_t kNumWorkers = 32u;
+  static constexpr size_t kNumIterations = 100u;
+  Thread* self = Thread::Current();
+  ThreadPool worker_pool("Thread list test worker pool", kNumWorkers);
+  ThreadPool requester_pool("Thread list test requester pool", 1);
+  std::atomic<bool> stop(false);
+  // Only incremented by runnable threads.
+  std::atomic<uint64_t> runnable_iterations(0u);
+  for (size_t i = 0; i != kNumWorkers; ++i) {
+    const bool runnable = (i % 2u) == 0u;
+    worker_pool.AddTask(self, new FunctionTask([&, runnable](Thread* worker) {
+      while (!stop.load(std::memory_order_relaxed)) {
+        if (runnable) {
+          ScopedObjectAccess soa(worker);
+          for (size_t j = 0; j != 100u; ++j) {
+            runnable_iterations.fetch_add(1u, std::memory_order_relaxed);
+            worker->AllowThreadSuspension();
+          }
+        } else {
+          NanoSleep(UsToNs(100));
+        }
+      }
+    }));
+  }
+  requester_pool.AddTask(self, new FunctionTask([&](Thread* requester) {
+    for (size_t i = 0; i != kNumIterations; ++i) {
+      CountingCheckpoint checkpoint;
+      size_t count;
+      {
+        ScopedObjectAccess soa(requester);
+        count = Runtime::Current()->GetThreadList()->RunCheckpoint(&checkpoint);
+      }
+      checkpoint.WaitForThreadsToRunThroughCheckpoint(count);
+      EXPECT_EQ(count, checkpoint.GetRuns());
+
+      ScopedSuspendAll ssa("Concurrent suspend all test requester");
+      ExpectOtherThreadsSuspended(requester);
+    }
+  }));
+  worker_pool.StartWorkers(self);
+  requester_pool.StartWorkers(self);
+
+  for (size_t i = 0; i != kNumIterations; ++i) {
+    ScopedSuspendAll ssa("Concurrent suspend all test");
+    ExpectOtherThreadsSuspended(self);
+    uint64_t iterations = runnable_iterations.load(std::memory_order_relaxed);
+    NanoSleep(UsToNs(100));
+    EXPECT_EQ(iterations, runnable_iterations.load(std::memory_order_relaxed));
+  }
+
+  requester_pool.Wait(self, /*do_work=*/ false, /*may_hold_locks=*/ false);
+  stop.store(true, std::memory_order_relaxed);
+  worker_pool.Wait(self, /*do_work=*/ false, /*may_hold_locks=*/ false);
+  EXPECT_NE(0u, runnable_iterations.load(std::memory_order_relaxed));
+}
+
+}  // namespace art
@@ -23,6 +23,7 @@
 #include "android-base/stringprintf.h"
 
 #include "art_method-inl.h"
+#include "barrier.h"
 #include "base/casts.h"
 #include "base/enums.h"
 #include "base/os.h"
@@ -36,11 +37,13 @@
 #include "debugger.h"
 #include "dex/descriptors_names.h"
 #include "dex/dex_file-inl.h"
+#include "dex/method_reference.h"
 #include "entrypoints/quick/quick_entrypoints.h"
 #include "gc/scoped_gc_critical_section.h"
 #include "instrumentation.h"
 #include "jit/jit.h"
 #include "jit/jit_code_cache.h"
+#include "jit/profile_saver.h"
 #include "mirror/class-inl.h"
 #include "mirror/dex_cache-inl.h"
 #include "mirror/object-inl.h"
@@ -50,6 +53,7 @@
 #include "stack.h"
 #include "thread.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 
 namespace art {
 
@@ -73,7 +77,6 @@ TraceClockSource Trace::default_clock_source_ = kDefaultTraceClockSource;
 
 Trace* volatile Trace::the_trace_ = nullptr;
 pthread_t Trace::sampling_pthread_ = 0U;
-std::unique_ptr<std::vector<ArtMethod*>> Trace::temp_stack_trace_;
 
 // The key identifying the tracer to update instrumentation.
 static constexpr const char* kTracerInstrumentationKey = "Tracer";
@@ -109,16 +112,6 @@ uint32_t Trace::EncodeTraceMethodAndAction(ArtMethod* method, TraceAction action
   return tmid;
 }
 
-std::vector<ArtMethod*>* Trace::AllocStackTrace() {
-  return (temp_stack_trace_.get() != nullptr)  ? temp_stack_trace_.release() :
-      new std::vector<ArtMethod*>();
-}
-
-void Trace::FreeStackTrace(std::vector<ArtMethod*>* stack_trace) {
-  stack_trace->clear();
-  temp_stack_trace_.reset(stack_trace);
-}
-
 void Trace::SetDefaultClockSource(TraceClockSource clock_source) {
 #if defined(__linux__)
   default_clock_source_ = clock_source;
@@ -204,8 +197,17 @@ static void Append8LE(uint8_t* buf, uint64_t val) {
   *buf++ = static_cast<uint8_t>(val >> 56);
 }
 
-static void GetSample(Thread* thread, void* arg) REQUIRES_SHARED(Locks::mutator_lock_) {
-  std::vector<ArtMethod*>* const stack_trace = Trace::AllocStackTrace();
+// Takes a stack sample of the thread and returns the innermost sampled method, or null if the
+// thread has no managed frames.
+static ArtMethod* GetSample(Thread* thread, Trace* the_trace)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  // Samples may be taken concurrently on different threads, so each sample gets its own vector
+  // which then replaces the thread's previous sample.
+  std::vector<ArtMethod*>* const stack_trace = new std::vector<ArtMethod*>();
+  std::vector<ArtMethod*>* const old_stack_trace = thread->GetStackTraceSample();
+  if (old_stack_trace != nullptr) {
+    stack_trace->reserve(old_stack_trace->size());
+  }
   StackVisitor::WalkStack(
       [&](const art::StackVisitor* stack_visitor) REQUIRES_SHARED(Locks::mutator_lock_) {
         ArtMethod* m = stack_visitor->GetMethod();
@@ -218,10 +220,65 @@ static void GetSample(Thread* thread, void* arg) REQUIRES_SHARED(Locks::mutator_
       thread,
       /* context= */ nullptr,
       art::StackVisitor::StackWalkKind::kIncludeInlinedFrames);
-  Trace* the_trace = reinterpret_cast<Trace*>(arg);
+  ArtMethod* const leaf_method = stack_trace->empty() ? nullptr : stack_trace->front();
   the_trace->CompareAndUpdateStackTrace(thread, stack_trace);
+  return leaf_method;
 }
 
+// Checkpoint taking a stack sample of each thread. Runnable threads sample themselves at their
+// next suspend point, and the sampling thread samples the threads that are already suspended, so
+// that no thread is stopped only to be sampled.
+class SampleCheckpoint final : public Closure {
+ public:
+  explicit SampleCheckpoint(Trace* the_trace)
+      : barrier_(0),
+        the_trace_(the_trace),
+        lock_("Sample checkpoint lock", kGenericBottomLock) {}
+
+  void Run(Thread* thread) override {
+    // Note thread and self may not be equal if thread was already suspended at
+    // the point of the request.
+    Thread* self = Thread::Current();
+    ScopedObjectAccess soa(self);
+    ArtMethod* leaf_method = GetSample(thread, the_trace_);
+    // Only threads that were runnable run the checkpoint themselves. Attribute a CPU sample to
+    // the method they were executing; suspended threads are not using the CPU. The method is
+    // resolved to a MethodReference here, while we hold the mutator lock, as its class may be
+    // unloaded before the sampling thread exports the samples.
+    if (thread == self && leaf_method != nullptr) {
+      ArtMethod* method =
+          leaf_method->GetNonObsoleteMethod()->GetInterfaceMethodIfProxy(kRuntimePointerSize);
+      if (!method->IsRuntimeMethod() && !method->IsNative()) {
+        MutexLock mu(self, lock_);
+        on_cpu_methods_.emplace_back(method->GetDexFile(), method->GetDexMethodIndex());
+      }
+    }
+    barrier_.Pass(self);
+  }
+
+  void WaitForThreadsToRunThroughCheckpoint(size_t threads_running_checkpoint) {
+    Thread* self = Thread::Current();
+    ScopedThreadStateChange tsc(self, ThreadState::kWaitingForCheckPointsToRun);
+    barrier_.Increment(self, threads_running_checkpoint);
+  }
+
+  // Returns the methods executed by the runnable threads. Must be called after all threads ran
+  // through the checkpoint.
+  std::vector<MethodReference> ReleaseOnCpuMethods() REQUIRES(!lock_) {
+    MutexLock mu(Thread::Current(), lock_);
+    return std::move(on_cpu_methods_);
+  }
+
+ private:
+  // The barrier to be passed through and for the requestor to wait upon.
+  Barrier barrier_;
+  Trace* const the_trace_;
+  Mutex lock_;
+  std::vector<MethodReference> on_cpu_methods_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(SampleCheckpoint);
+};
+
 static void ClearThreadStackTraceAndClockBase(Thread* thread, void* arg ATTRIBUTE_UNUSED) {
   thread->SetTraceClockBase(0);
   std::vector<ArtMethod*>* stack_trace = thread->GetStackTraceSample();
@@ -231,7 +288,6 @@ static void ClearThreadStackTraceAndClockBase(Thread* thread, void* arg ATTRIBUT
 
 void Trace::CompareAndUpdateStackTrace(Thread* thread,
                                        std::vector<ArtMethod*>* stack_trace) {
-  CHECK_EQ(pthread_self(), sampling_pthread_);
   std::vector<ArtMethod*>* old_stack_trace = thread->GetStackTraceSample();
   // Update the thread's stack trace sample.
   thread->SetStackTraceSample(stack_trace);
@@ -266,7 +322,7 @@ void Trace::CompareAndUpdateStackTrace(Thread* thread,
       LogMethodTraceEvent(thread, *rit, instrumentation::Instrumentation::kMethodEntered,
                           thread_clock_diff, wall_clock_diff);
     }
-    FreeStackTrace(old_stack_trace);
+    delete old_stack_trace;
   }
 }
 
@@ -289,16 +345,18 @@ void* Trace::RunSamplingThread(void* arg) {
         break;
       }
     }
-    {
-      // Avoid a deadlock between a thread doing garbage collection
-      // and the profile sampling thread, by blocking GC when sampling
-      // thread stacks (see b/73624630).
-      gc::ScopedGCCriticalSection gcs(self,
-                                      art::gc::kGcCauseInstrumentation,
-                                      art::gc::kCollectorTypeInstrumentation);
-      ScopedSuspendAll ssa(__FUNCTION__);
-      MutexLock mu(self, *Locks::thread_list_lock_);
-      runtime->GetThreadList()->ForEach(GetSample, the_trace);
+    // Sample the threads with a checkpoint rather than suspending all threads, so that sampling
+    // does not add a global pause on every tick. The trace is not deleted before this thread is
+    // joined, and we wait for all threads to run the checkpoint before the next tick.
+    SampleCheckpoint checkpoint(the_trace);
+    size_t threads_running_checkpoint = runtime->GetThreadList()->RunCheckpoint(&checkpoint);
+    if (threads_running_checkpoint != 0) {
+      checkpoint.WaitForThreadsToRunThroughCheckpoint(threads_running_checkpoint);
+    }
+    // Export the CPU samples to the profile, where they weight the hotness of methods.
+    std::vector<MethodReference> on_cpu_methods = checkpoint.ReleaseOnCpuMethods();
+    if (!on_cpu_methods.empty()) {
+      ProfileSaver::NotifyMethodSamples(on_cpu_methods);
     }
   }
 
@@ -878,9 +936,8 @@ void Trace::LogMethodTraceEvent(Thread* thread, ArtMethod* method,
                                 instrumentation::Instrumentation::InstrumentationEvent event,
                                 uint32_t thread_clock_diff, uint32_t wall_clock_diff) {
   // This method is called in both tracing modes (method and
-  // sampling). In sampling mode, this method is only called by the
-  // sampling thread. In method tracing mode, it can be called
-  // concurrently.
+  // sampling). In both modes, it can be called concurrently: samples
+  // are taken in a checkpoint by each sampled thread.
 
   // Ensure we always use the non-obsolete version of the method so that entry/exit events have the
   // same pointer value.
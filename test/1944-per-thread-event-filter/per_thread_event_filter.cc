@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <new>
+
+#include "android-base/macros.h"
+
+#include "jni.h"
+#include "jvmti.h"
+#include "scoped_local_ref.h"
+
+// Test infrastructure
+#include "jni_helper.h"
+#include "jvmti_helper.h"
+#include "test_env.h"
+
+namespace art {
+namespace Test1944PerThreadEventFilter {
+
+struct ThreadData {
+  std::atomic<jint> count;
+};
+
+static jmethodID gTarget = nullptr;
+// Events of the target method delivered on threads without ThreadData.
+static std::atomic<jint> gOtherCount(0);
+
+void cbMethodEntry(jvmtiEnv* jvmti, JNIEnv* env, jthread thread, jmethodID method) {
+  if (method != gTarget) {
+    return;
+  }
+  ThreadData* data = nullptr;
+  if (JvmtiErrorToException(
+          env, jvmti, jvmti->GetThreadLocalStorage(thread, reinterpret_cast<void**>(&data)))) {
+    return;
+  }
+  std::atomic<jint>* count = (data != nullptr) ? &data->count : &gOtherCount;
+  count->fetch_add(1, std::memory_order_relaxed);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_art_Test1944_setupTest(JNIEnv* env,
+                                                              jclass klass ATTRIBUTE_UNUSED,
+                                                              jobject target) {
+  gTarget = env->FromReflectedMethod(target);
+  jvmtiCapabilities caps{
+    .can_generate_method_entry_events = 1,
+  };
+  if (JvmtiErrorToException(env, jvmti_env, jvmti_env->AddCapabilities(&caps))) {
+    return;
+  }
+  jvmtiEventCallbacks cb{
+    .MethodEntry = cbMethodEntry,
+  };
+  JvmtiErrorToException(env, jvmti_env, jvmti_env->SetEventCallbacks(&cb, sizeof(cb)));
+}
+
+extern "C" JNIEXPORT void JNICALL Java_art_Test1944_setupThread(JNIEnv* env,
+                                                                jclass klass ATTRIBUTE_UNUSED,
+                                                                jthread thr) {
+  ThreadData* data = nullptr;
+  if (JvmtiErrorToException(
+          env, jvmti_env, jvmti_env->Allocate(sizeof(*data), reinterpret_cast<uint8_t**>(&data)))) {
+    return;
+  }
+  new (data) ThreadData{0};
+  JvmtiErrorToException(env, jvmti_env, jvmti_env->SetThreadLocalStorage(thr, data));
+}
+
+extern "C" JNIEXPORT void JNICALL Java_art_Test1944_setEnabled(JNIEnv* env,
+                                                               jclass klass ATTRIBUTE_UNUSED,
+                                                               jthread thr,
+                                                               jboolean enabled) {
+  JvmtiErrorToException(
+      env,
+      jvmti_env,
+      jvmti_env->SetEventNotificationMode(
+          enabled ? JVMTI_ENABLE : JVMTI_DISABLE, JVMTI_EVENT_METHOD_ENTRY, thr));
+}
+
+extern "C" JNIEXPORT jint JNICALL Java_art_Test1944_getAndResetCount(JNIEnv* env,
+                                                                     jclass klass ATTRIBUTE_UNUSED,
+                                                                     jthread thr) {
+  ThreadData* data = nullptr;
+  if (JvmtiErrorToException(
+          env, jvmti_env, jvmti_env->GetThreadLocalStorage(thr, reinterpret_cast<void**>(&data)))) {
+    return -1;
+  }
+  CHECK(data != nullptr);
+  return data->count.exchange(0, std::memory_order_relaxed);
+}
+
+extern "C" JNIEXPORT jint JNICALL Java_art_Test1944_getAndResetOtherCount(
+    JNIEnv* env ATTRIBUTE_UNUSED, jclass klass ATTRIBUTE_UNUSED) {
+  return gOtherCount.exchange(0, std::memory_order_relaxed);
+}
+
+}  // namespace Test1944PerThreadEventFilter
+}  // namespace art
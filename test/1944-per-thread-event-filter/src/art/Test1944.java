@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package art;
+
+import java.lang.reflect.Method;
+import java.util.concurrent.CyclicBarrier;
+
+public class Test1944 {
+  private static final int NUM_CALLS = 10;
+
+  public static void doNothing() {
+    // We count the method entry events of this method.
+  }
+
+  public static void run() throws Exception {
+    setupTest(Test1944.class.getDeclaredMethod("doNothing"));
+
+    // The main thread changes the event notification modes while both threads wait at the
+    // barrier, then lets both threads call the method.
+    final CyclicBarrier barrier = new CyclicBarrier(3);
+    Runnable threadRun = () -> {
+      try {
+        for (int phase = 0; phase < 2; ++phase) {
+          barrier.await();
+          for (int i = 0; i < NUM_CALLS; ++i) {
+            doNothing();
+          }
+          barrier.await();
+        }
+      } catch (Exception e) {
+        throw new Error("Failed at something", e);
+      }
+    };
+    Thread t1 = new Thread(threadRun, "T1 Thread");
+    Thread t2 = new Thread(threadRun, "T2 Thread");
+    setupThread(t1);
+    setupThread(t2);
+    t1.start();
+    t2.start();
+
+    System.out.println("Enabled on T1");
+    setEnabled(t1, true);
+    barrier.await();
+    barrier.await();
+    printCounts(t1, t2);
+
+    System.out.println("Enabled on T2");
+    setEnabled(t1, false);
+    setEnabled(t2, true);
+    barrier.await();
+    barrier.await();
+    printCounts(t1, t2);
+
+    setEnabled(t2, false);
+    t1.join();
+    t2.join();
+  }
+
+  private static void printCounts(Thread t1, Thread t2) {
+    System.out.println("\tEvents on T1: " + getAndResetCount(t1));
+    System.out.println("\tEvents on T2: " + getAndResetCount(t2));
+    System.out.println("\tEvents on other threads: " + getAndResetOtherCount());
+  }
+
+  public static native void setupTest(Method target);
+  public static native void setupThread(Thread t);
+  public static native void setEnabled(Thread t, boolean enabled);
+  public static native int getAndResetCount(Thread t);
+  public static native int getAndResetOtherCount();
+}
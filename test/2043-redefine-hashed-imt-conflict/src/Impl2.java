@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+class Impl2 implements Itf {
+  public int method0() {
+    return 1000;
+  }
+
+  public int method32() {
+    return 1032;
+  }
+
+  public int method77() {
+    return 1077;
+  }
+
+  public int method109() {
+    return 1109;
+  }
+
+  public int method132() {
+    return 1132;
+  }
+
+  public int method177() {
+    return 1177;
+  }
+
+  public int method216() {
+    return 1216;
+  }
+
+  public int method284() {
+    return 1284;
+  }
+
+  public int method323() {
+    return 1323;
+  }
+
+  public int method368() {
+    return 1368;
+  }
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The names of the methods are chosen so that they all get the same IMT index, see
+// ImTable::GetImtIndex(), which puts all of them in the conflict table of that index.
+// src-ex has a copy of this interface, which is used to redefine it.
+interface Itf {
+  int method0();
+  int method32();
+  int method77();
+  int method109();
+  int method132();
+  int method177();
+  int method216();
+  int method284();
+  int method323();
+  int method368();
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import art.Redefinition;
+import java.io.ByteArrayOutputStream;
+import java.io.InputStream;
+import java.util.zip.ZipEntry;
+import java.util.zip.ZipFile;
+
+public class Main {
+  public static final String TEST_NAME = "2043-redefine-hashed-imt-conflict";
+
+  public static void main(String[] args) throws Exception {
+    System.loadLibrary(args[0]);
+    Redefinition.setTestConfiguration(Redefinition.Config.COMMON_REDEFINE);
+    ensureJitCompiled(Main.class, "$noinline$callAll");
+
+    Itf[] receivers = { new Impl1(), new Impl2() };
+    callAll(receivers);
+    System.out.println("Before redefinition");
+
+    // The copy of Itf in src-ex is the only class of the dex file of the -ex jar.
+    byte[] dex_bytes =
+        readDexFile(System.getenv("DEX_LOCATION") + "/" + TEST_NAME + "-ex.jar");
+    Redefinition.doCommonClassRedefinition(Itf.class, new byte[0], dex_bytes);
+    System.out.println("Redefined Itf");
+
+    callAll(receivers);
+    System.out.println("After redefinition");
+  }
+
+  private static void callAll(Itf[] receivers) {
+    for (int repeat = 0; repeat < 100; ++repeat) {
+      for (int i = 0; i < receivers.length; ++i) {
+        $noinline$callAll(receivers[i], i * 1000);
+      }
+    }
+  }
+
+  public static void $noinline$callAll(Itf itf, int offset) {
+    expectEquals(0 + offset, itf.method0());
+    expectEquals(32 + offset, itf.method32());
+    expectEquals(77 + offset, itf.method77());
+    expectEquals(109 + offset, itf.method109());
+    expectEquals(132 + offset, itf.method132());
+    expectEquals(177 + offset, itf.method177());
+    expectEquals(216 + offset, itf.method216());
+    expectEquals(284 + offset, itf.method284());
+    expectEquals(323 + offset, itf.method323());
+    expectEquals(368 + offset, itf.method368());
+  }
+
+  public static void expectEquals(int expected, int actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+
+  private static byte[] readDexFile(String jar) throws Exception {
+    try (ZipFile zip = new ZipFile(jar)) {
+      ZipEntry entry = zip.getEntry("classes.dex");
+      ByteArrayOutputStream bytes = new ByteArrayOutputStream();
+      try (InputStream in = zip.getInputStream(entry)) {
+        byte[] buffer = new byte[4096];
+        int count;
+        while ((count = in.read(buffer)) != -1) {
+          bytes.write(buffer, 0, count);
+        }
+      }
+      return bytes.toByteArray();
+    }
+  }
+
+  public static native void ensureJitCompiled(Class<?> cls, String methodName);
+}
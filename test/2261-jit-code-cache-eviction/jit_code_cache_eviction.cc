@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jni.h>
+
+#include "jit/jit.h"
+#include "jit/jit_code_cache.h"
+#include "runtime.h"
+#include "scoped_thread_state_change-inl.h"
+
+namespace art {
+
+// Local class declared as a friend of JitCodeCache so that we can access its internals.
+class JitCodeCacheEvictionTestHelper {
+ public:
+  static jlong GetNumberOfEvictions(Thread* self) {
+    MutexLock mu(self, *Locks::jit_lock_);
+    return GetCodeCache()->number_of_evictions_;
+  }
+
+  static jlong GetNumberOfRecompilationsAfterEviction(Thread* self) {
+    MutexLock mu(self, *Locks::jit_lock_);
+    return GetCodeCache()->number_of_recompilations_after_eviction_;
+  }
+
+ private:
+  static jit::JitCodeCache* GetCodeCache() {
+    CHECK(Runtime::Current()->GetJit() != nullptr);
+    return Runtime::Current()->GetJit()->GetCodeCache();
+  }
+};
+
+extern "C" JNIEXPORT
+void Java_Main_doJitCodeCacheCollection(JNIEnv*, jclass) {
+  CHECK(Runtime::Current()->GetJit() != nullptr);
+  jit::JitCodeCache* cache = Runtime::Current()->GetJit()->GetCodeCache();
+  // Forcing JIT compilation disables code collection, re-enable it.
+  cache->SetGarbageCollectCode(true);
+  ScopedObjectAccess soa(Thread::Current());
+  cache->GarbageCollectCache(Thread::Current());
+}
+
+extern "C" JNIEXPORT
+jlong Java_Main_getNumberOfJitCodeEvictions(JNIEnv*, jclass) {
+  ScopedObjectAccess soa(Thread::Current());
+  return JitCodeCacheEvictionTestHelper::GetNumberOfEvictions(soa.Self());
+}
+
+extern "C" JNIEXPORT
+jlong Java_Main_getNumberOfJitRecompilationsAfterEviction(JNIEnv*, jclass) {
+  ScopedObjectAccess soa(Thread::Current());
+  return JitCodeCacheEvictionTestHelper::GetNumberOfRecompilationsAfterEviction(soa.Self());
+}
+
+}  // namespace art
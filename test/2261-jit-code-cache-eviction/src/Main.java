@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  public static void main(String[] args) throws Exception {
+    System.loadLibrary(args[0]);
+    if (isAotCompiled(Main.class, "hasJit")) {
+      throw new Error("This test must be run with --no-prebuild!");
+    }
+    if (hasJit()) {
+      testRecentlyUsedCodeIsKept();
+      testUnusedCodeIsEvictedAndRecompiled();
+    }
+    System.out.println("Done");
+  }
+
+  public static void testRecentlyUsedCodeIsKept() {
+    ensureJitBaselineCompiled(Main.class, "$noinline$hot");
+    ensureJitBaselineCompiled(Main.class, "$noinline$warm");
+    // Neither method is on the stack when we collect. The warm method only runs before every
+    // other collection, which used to be enough for its code to be thrown away and then
+    // recompiled as soon as it ran again.
+    for (int i = 0; i < 8; ++i) {
+      $noinline$hot();
+      if (i % 2 == 0) {
+        $noinline$warm();
+      }
+      doJitCodeCacheCollection();
+      assertTrue(hasJitCompiledEntrypoint(Main.class, "$noinline$hot"));
+      assertTrue(hasJitCompiledEntrypoint(Main.class, "$noinline$warm"));
+    }
+  }
+
+  public static void testUnusedCodeIsEvictedAndRecompiled() {
+    ensureJitBaselineCompiled(Main.class, "$noinline$cold");
+    long evictions = getNumberOfJitCodeEvictions();
+    long recompilations = getNumberOfJitRecompilationsAfterEviction();
+    $noinline$cold();
+    doJitCodeCacheCollection();
+    // The code is kept for one collection without being used.
+    doJitCodeCacheCollection();
+    assertTrue(hasJitCompiledEntrypoint(Main.class, "$noinline$cold"));
+    // And evicted on the next one.
+    doJitCodeCacheCollection();
+    assertFalse(hasJitCompiledEntrypoint(Main.class, "$noinline$cold"));
+    assertTrue(getNumberOfJitCodeEvictions() > evictions);
+
+    ensureJitBaselineCompiled(Main.class, "$noinline$cold");
+    assertTrue(hasJitCompiledEntrypoint(Main.class, "$noinline$cold"));
+    assertTrue(getNumberOfJitRecompilationsAfterEviction() > recompilations);
+  }
+
+  public static void $noinline$hot() {}
+  public static void $noinline$warm() {}
+  public static void $noinline$cold() {}
+
+  public static void assertTrue(boolean value) {
+    if (!value) {
+      throw new AssertionError("Expected true!");
+    }
+  }
+
+  public static void assertFalse(boolean value) {
+    if (value) {
+      throw new AssertionError("Expected false!");
+    }
+  }
+
+  public native static void doJitCodeCacheCollection();
+  public native static long getNumberOfJitCodeEvictions();
+  public native static long getNumberOfJitRecompilationsAfterEviction();
+
+  public native static boolean isAotCompiled(Class<?> cls, String methodName);
+  public native static boolean hasJitCompiledEntrypoint(Class<?> cls, String methodName);
+  public native static void ensureJitBaselineCompiled(Class<?> cls, String methodName);
+  private native static boolean hasJit();
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import dalvik.system.VMRuntime;
+import java.io.File;
+import java.lang.reflect.Method;
+
+public class Main {
+  public static void $noinline$optimizedMethod() {}
+  public static void $noinline$baselineMethod() {}
+
+  public static void main(String[] args) throws Exception {
+    System.loadLibrary(args[0]);
+    if (!hasJit()) {
+      return;
+    }
+
+    // Both runs use the same profile, so that the second run finds the JIT warmup cache written
+    // by the first one. The JIT warmup cache is next to the profile.
+    File file = new File(System.getenv("DEX_LOCATION") + "/2262-jit-warmup-cache.prof");
+    File warmupCacheFile = new File(file.getPath().replaceAll("\\.prof$", ".jit.prof"));
+    boolean restart = args.length > 1 && args[1].equals("restart");
+    if (!restart) {
+      file.delete();
+      warmupCacheFile.delete();
+    }
+    try {
+      file.createNewFile();
+      String codePath = System.getenv("DEX_LOCATION") + "/2262-jit-warmup-cache.jar";
+      VMRuntime.registerAppInfo(
+          "test.app",
+          file.getPath(),
+          file.getPath(),
+          new String[] {codePath},
+          VMRuntime.CODE_PATH_TYPE_PRIMARY_APK);
+
+      if (restart) {
+        checkRestart();
+      } else {
+        record(warmupCacheFile);
+      }
+    } finally {
+      if (restart) {
+        file.delete();
+        warmupCacheFile.delete();
+      }
+    }
+  }
+
+  private static void record(File warmupCacheFile) throws Exception {
+    ensureJitCompiled(Main.class, "$noinline$optimizedMethod");
+    ensureJitBaselineCompiled(Main.class, "$noinline$baselineMethod");
+    ensureProfileProcessing();
+
+    Method optimizedMethod = Main.class.getDeclaredMethod("$noinline$optimizedMethod");
+    if (!presentInProfile(warmupCacheFile.getPath(), optimizedMethod)) {
+      System.out.println("Optimized method not in JIT warmup cache");
+    }
+    Method baselineMethod = Main.class.getDeclaredMethod("$noinline$baselineMethod");
+    if (presentInProfile(warmupCacheFile.getPath(), baselineMethod)) {
+      System.out.println("Baseline method in JIT warmup cache");
+    }
+  }
+
+  private static void checkRestart() {
+    // Registering the profile queued the compilation of the methods in the JIT warmup cache.
+    // None of the methods has been called in this run.
+    waitForCompilation();
+    if (!hasJitCompiledCode(Main.class, "$noinline$optimizedMethod")) {
+      System.out.println("Optimized method not compiled from JIT warmup cache");
+    }
+    if (hasJitCompiledCode(Main.class, "$noinline$baselineMethod")) {
+      System.out.println("Baseline method compiled from JIT warmup cache");
+    }
+  }
+
+  // Checks if the profiles saver has the method as hot/warm.
+  public static native boolean presentInProfile(String profile, Method method);
+  // Ensures the profile saver does its usual processing.
+  public static native void ensureProfileProcessing();
+  public static native boolean hasJit();
+  public static native void ensureJitCompiled(Class<?> cls, String methodName);
+  public static native void ensureJitBaselineCompiled(Class<?> cls, String methodName);
+  public static native boolean hasJitCompiledCode(Class<?> cls, String methodName);
+  public static native void waitForCompilation();
+}
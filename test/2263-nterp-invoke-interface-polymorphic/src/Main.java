@@ -0,0 +1,643 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.invoke.MethodHandle;
+import java.lang.invoke.MethodHandles;
+import java.lang.invoke.MethodType;
+import java.lang.invoke.VarHandle;
+
+public class Main {
+  public static void main(String[] args) throws Throwable {
+    testInterfaceCalls();
+    testInvokePolymorphic();
+    System.out.println("Done");
+  }
+
+  // Call all methods of an interface with more methods than IMT entries, which guarantees
+  // IMT conflicts, with receivers of different classes at the same call sites.
+  static void testInterfaceCalls() {
+    Itf[] receivers = { new A(), new B(), new SubA(), new B(), new A(), new SubA() };
+    for (int iteration = 0; iteration < 3; ++iteration) {
+      for (Itf receiver : receivers) {
+        int sum = callAll(receiver);
+        int expected = receiver.base() * 48 + (47 * 48) / 2;
+        if (sum != expected) {
+          throw new Error("Expected " + expected + ", got " + sum + " for " + receiver);
+        }
+      }
+    }
+    // Default methods and methods of java.lang.Object are also called through the interface.
+    for (Itf receiver : receivers) {
+      expectEquals(receiver.base() + 1000, receiver.withDefault());
+      expectEquals(receiver.getClass().getName().hashCode(), receiver.toString().hashCode());
+    }
+  }
+
+  static int callAll(Itf receiver) {
+    int sum = 0;
+    sum += receiver.m0();
+    sum += receiver.m1();
+    sum += receiver.m2();
+    sum += receiver.m3();
+    sum += receiver.m4();
+    sum += receiver.m5();
+    sum += receiver.m6();
+    sum += receiver.m7();
+    sum += receiver.m8();
+    sum += receiver.m9();
+    sum += receiver.m10();
+    sum += receiver.m11();
+    sum += receiver.m12();
+    sum += receiver.m13();
+    sum += receiver.m14();
+    sum += receiver.m15();
+    sum += receiver.m16();
+    sum += receiver.m17();
+    sum += receiver.m18();
+    sum += receiver.m19();
+    sum += receiver.m20();
+    sum += receiver.m21();
+    sum += receiver.m22();
+    sum += receiver.m23();
+    sum += receiver.m24();
+    sum += receiver.m25();
+    sum += receiver.m26();
+    sum += receiver.m27();
+    sum += receiver.m28();
+    sum += receiver.m29();
+    sum += receiver.m30();
+    sum += receiver.m31();
+    sum += receiver.m32();
+    sum += receiver.m33();
+    sum += receiver.m34();
+    sum += receiver.m35();
+    sum += receiver.m36();
+    sum += receiver.m37();
+    sum += receiver.m38();
+    sum += receiver.m39();
+    sum += receiver.m40();
+    sum += receiver.m41();
+    sum += receiver.m42();
+    sum += receiver.m43();
+    sum += receiver.m44();
+    sum += receiver.m45();
+    sum += receiver.m46();
+    sum += receiver.m47();
+    return sum;
+  }
+
+  static int staticMethod(int a, long b) {
+    return a + (int) b;
+  }
+
+  int instanceField = 42;
+
+  int virtualMethod(int a) {
+    return a + instanceField;
+  }
+
+  private int directMethod(int a) {
+    return a * 2;
+  }
+
+  static int manyArguments(int a, int b, int c, int d, int e, int f) {
+    return a + b + c + d + e + f;
+  }
+
+  static void testInvokePolymorphic() throws Throwable {
+    MethodHandles.Lookup lookup = MethodHandles.lookup();
+    Main main = new Main();
+
+    MethodHandle staticHandle = lookup.findStatic(
+        Main.class, "staticMethod", MethodType.methodType(int.class, int.class, long.class));
+    MethodHandle virtualHandle = lookup.findVirtual(
+        Main.class, "virtualMethod", MethodType.methodType(int.class, int.class));
+    MethodHandle directHandle = lookup.findSpecial(
+        Main.class, "directMethod", MethodType.methodType(int.class, int.class), Main.class);
+    MethodHandle interfaceHandle = lookup.findVirtual(
+        Itf.class, "m3", MethodType.methodType(int.class));
+    MethodHandle getterHandle = lookup.findGetter(Main.class, "instanceField", int.class);
+    MethodHandle rangeHandle = lookup.findStatic(
+        Main.class,
+        "manyArguments",
+        MethodType.methodType(
+            int.class, int.class, int.class, int.class, int.class, int.class, int.class));
+    VarHandle varHandle = MethodHandles.lookup().findVarHandle(
+        Main.class, "instanceField", int.class);
+
+    for (int i = 0; i < 3; ++i) {
+      expectEquals(3, (int) staticHandle.invokeExact(1, 2L));
+      expectEquals(3, (int) staticHandle.invoke(1, 2));
+      expectEquals(43, (int) virtualHandle.invokeExact(main, 1));
+      expectEquals(4, (int) directHandle.invokeExact(main, 2));
+      expectEquals(103, (int) interfaceHandle.invokeExact((Itf) new A()));
+      expectEquals(203, (int) interfaceHandle.invokeExact((Itf) new B()));
+      expectEquals(42, (int) getterHandle.invokeExact(main));
+      expectEquals(21, (int) rangeHandle.invokeExact(1, 2, 3, 4, 5, 6));
+      expectEquals(42, (int) varHandle.get(main));
+    }
+
+    try {
+      int unused = (int) virtualHandle.invokeExact((Main) null, 1);
+      throw new Error("Expected NullPointerException");
+    } catch (NullPointerException expected) {
+    }
+    try {
+      MethodHandle nullHandle = null;
+      int unused = (int) nullHandle.invokeExact(1);
+      throw new Error("Expected NullPointerException");
+    } catch (NullPointerException expected) {
+    }
+    try {
+      int unused = (int) staticHandle.invokeExact(1, 2);
+      throw new Error("Expected WrongMethodTypeException");
+    } catch (java.lang.invoke.WrongMethodTypeException expected) {
+    }
+  }
+
+  static void expectEquals(int expected, int actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+}
+
+interface Itf {
+  int base();
+
+  default int withDefault() {
+    return base() + 1000;
+  }
+
+  int m0();
+  int m1();
+  int m2();
+  int m3();
+  int m4();
+  int m5();
+  int m6();
+  int m7();
+  int m8();
+  int m9();
+  int m10();
+  int m11();
+  int m12();
+  int m13();
+  int m14();
+  int m15();
+  int m16();
+  int m17();
+  int m18();
+  int m19();
+  int m20();
+  int m21();
+  int m22();
+  int m23();
+  int m24();
+  int m25();
+  int m26();
+  int m27();
+  int m28();
+  int m29();
+  int m30();
+  int m31();
+  int m32();
+  int m33();
+  int m34();
+  int m35();
+  int m36();
+  int m37();
+  int m38();
+  int m39();
+  int m40();
+  int m41();
+  int m42();
+  int m43();
+  int m44();
+  int m45();
+  int m46();
+  int m47();
+}
+
+class A implements Itf {
+  public int base() {
+    return 100;
+  }
+
+  public String toString() {
+    return getClass().getName();
+  }
+
+  public int m0() {
+    return base() + 0;
+  }
+
+  public int m1() {
+    return base() + 1;
+  }
+
+  public int m2() {
+    return base() + 2;
+  }
+
+  public int m3() {
+    return base() + 3;
+  }
+
+  public int m4() {
+    return base() + 4;
+  }
+
+  public int m5() {
+    return base() + 5;
+  }
+
+  public int m6() {
+    return base() + 6;
+  }
+
+  public int m7() {
+    return base() + 7;
+  }
+
+  public int m8() {
+    return base() + 8;
+  }
+
+  public int m9() {
+    return base() + 9;
+  }
+
+  public int m10() {
+    return base() + 10;
+  }
+
+  public int m11() {
+    return base() + 11;
+  }
+
+  public int m12() {
+    return base() + 12;
+  }
+
+  public int m13() {
+    return base() + 13;
+  }
+
+  public int m14() {
+    return base() + 14;
+  }
+
+  public int m15() {
+    return base() + 15;
+  }
+
+  public int m16() {
+    return base() + 16;
+  }
+
+  public int m17() {
+    return base() + 17;
+  }
+
+  public int m18() {
+    return base() + 18;
+  }
+
+  public int m19() {
+    return base() + 19;
+  }
+
+  public int m20() {
+    return base() + 20;
+  }
+
+  public int m21() {
+    return base() + 21;
+  }
+
+  public int m22() {
+    return base() + 22;
+  }
+
+  public int m23() {
+    return base() + 23;
+  }
+
+  public int m24() {
+    return base() + 24;
+  }
+
+  public int m25() {
+    return base() + 25;
+  }
+
+  public int m26() {
+    return base() + 26;
+  }
+
+  public int m27() {
+    return base() + 27;
+  }
+
+  public int m28() {
+    return base() + 28;
+  }
+
+  public int m29() {
+    return base() + 29;
+  }
+
+  public int m30() {
+    return base() + 30;
+  }
+
+  public int m31() {
+    return base() + 31;
+  }
+
+  public int m32() {
+    return base() + 32;
+  }
+
+  public int m33() {
+    return base() + 33;
+  }
+
+  public int m34() {
+    return base() + 34;
+  }
+
+  public int m35() {
+    return base() + 35;
+  }
+
+  public int m36() {
+    return base() + 36;
+  }
+
+  public int m37() {
+    return base() + 37;
+  }
+
+  public int m38() {
+    return base() + 38;
+  }
+
+  public int m39() {
+    return base() + 39;
+  }
+
+  public int m40() {
+    return base() + 40;
+  }
+
+  public int m41() {
+    return base() + 41;
+  }
+
+  public int m42() {
+    return base() + 42;
+  }
+
+  public int m43() {
+    return base() + 43;
+  }
+
+  public int m44() {
+    return base() + 44;
+  }
+
+  public int m45() {
+    return base() + 45;
+  }
+
+  public int m46() {
+    return base() + 46;
+  }
+
+  public int m47() {
+    return base() + 47;
+  }
+}
+
+class SubA extends A {
+  public int base() {
+    return 300;
+  }
+}
+
+class B implements Itf {
+  public int base() {
+    return 200;
+  }
+
+  public String toString() {
+    return getClass().getName();
+  }
+
+  public int m0() {
+    return base() + 0;
+  }
+
+  public int m1() {
+    return base() + 1;
+  }
+
+  public int m2() {
+    return base() + 2;
+  }
+
+  public int m3() {
+    return base() + 3;
+  }
+
+  public int m4() {
+    return base() + 4;
+  }
+
+  public int m5() {
+    return base() + 5;
+  }
+
+  public int m6() {
+    return base() + 6;
+  }
+
+  public int m7() {
+    return base() + 7;
+  }
+
+  public int m8() {
+    return base() + 8;
+  }
+
+  public int m9() {
+    return base() + 9;
+  }
+
+  public int m10() {
+    return base() + 10;
+  }
+
+  public int m11() {
+    return base() + 11;
+  }
+
+  public int m12() {
+    return base() + 12;
+  }
+
+  public int m13() {
+    return base() + 13;
+  }
+
+  public int m14() {
+    return base() + 14;
+  }
+
+  public int m15() {
+    return base() + 15;
+  }
+
+  public int m16() {
+    return base() + 16;
+  }
+
+  public int m17() {
+    return base() + 17;
+  }
+
+  public int m18() {
+    return base() + 18;
+  }
+
+  public int m19() {
+    return base() + 19;
+  }
+
+  public int m20() {
+    return base() + 20;
+  }
+
+  public int m21() {
+    return base() + 21;
+  }
+
+  public int m22() {
+    return base() + 22;
+  }
+
+  public int m23() {
+    return base() + 23;
+  }
+
+  public int m24() {
+    return base() + 24;
+  }
+
+  public int m25() {
+    return base() + 25;
+  }
+
+  public int m26() {
+    return base() + 26;
+  }
+
+  public int m27() {
+    return base() + 27;
+  }
+
+  public int m28() {
+    return base() + 28;
+  }
+
+  public int m29() {
+    return base() + 29;
+  }
+
+  public int m30() {
+    return base() + 30;
+  }
+
+  public int m31() {
+    return base() + 31;
+  }
+
+  public int m32() {
+    return base() + 32;
+  }
+
+  public int m33() {
+    return base() + 33;
+  }
+
+  public int m34() {
+    return base() + 34;
+  }
+
+  public int m35() {
+    return base() + 35;
+  }
+
+  public int m36() {
+    return base() + 36;
+  }
+
+  public int m37() {
+    return base() + 37;
+  }
+
+  public int m38() {
+    return base() + 38;
+  }
+
+  public int m39() {
+    return base() + 39;
+  }
+
+  public int m40() {
+    return base() + 40;
+  }
+
+  public int m41() {
+    return base() + 41;
+  }
+
+  public int m42() {
+    return base() + 42;
+  }
+
+  public int m43() {
+    return base() + 43;
+  }
+
+  public int m44() {
+    return base() + 44;
+  }
+
+  public int m45() {
+    return base() + 45;
+  }
+
+  public int m46() {
+    return base() + 46;
+  }
+
+  public int m47() {
+    return base() + 47;
+  }
+}
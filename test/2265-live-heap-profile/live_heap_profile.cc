@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jni.h>
+#include <unistd.h>
+
+#include "android-base/stringprintf.h"
+
+#include "gc/heap.h"
+#include "javaheapprof/live_heap_profiler.h"
+#include "runtime.h"
+#include "thread-current-inl.h"
+
+namespace art {
+
+extern "C" JNIEXPORT jstring JNICALL Java_Main_dumpLiveHeapProfile(JNIEnv* env, jclass) {
+  gc::Heap* heap = Runtime::Current()->GetHeap();
+  LiveHeapProfiler* profiler = heap->GetLiveHeapProfiler();
+  if (profiler == nullptr) {
+    return nullptr;
+  }
+  CHECK(heap->DumpLiveHeapProfile(Thread::Current()));
+  std::string path = android::base::StringPrintf(
+      "%s.%d.pprof", profiler->GetOutputPrefix().c_str(), getpid());
+  return env->NewStringUTF(path.c_str());
+}
+
+}  // namespace art
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Paths;
+import java.util.ArrayList;
+
+public class Main {
+  // Keep the allocations live, so that they are in the in-use part of the profile.
+  static ArrayList<byte[]> sLive = new ArrayList<>();
+
+  public static void main(String[] args) throws Exception {
+    System.loadLibrary(args[0]);
+    // With a 1KB sampling interval, allocating 4MB takes thousands of samples.
+    $noinline$allocate(4096, 1024);
+
+    String path = dumpLiveHeapProfile();
+    if (path == null) {
+      System.out.println("Live heap profiler not enabled");
+      return;
+    }
+    // The function names are in the string table of the profile.
+    String profile =
+        new String(Files.readAllBytes(Paths.get(path)), StandardCharsets.ISO_8859_1);
+    if (profile.contains("Main.$noinline$allocate")) {
+      System.out.println("Found the allocating method");
+    } else {
+      System.out.println("Allocating method not in " + path);
+    }
+    if (!profile.contains("byte[]")) {
+      System.out.println("Allocated class not in " + path);
+    }
+  }
+
+  public static void $noinline$allocate(int count, int size) {
+    for (int i = 0; i < count; ++i) {
+      sLive.add(new byte[size]);
+    }
+  }
+
+  // Writes the live heap profile and returns its path, or null if the profiler is not enabled.
+  public static native String dumpLiveHeapProfile();
+}
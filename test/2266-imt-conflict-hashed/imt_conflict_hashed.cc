@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jni.h>
+
+#include "art_method-inl.h"
+#include "class_linker.h"
+#include "imt_conflict_table.h"
+#include "imtable-inl.h"
+#include "mirror/class-inl.h"
+#include "runtime.h"
+#include "scoped_thread_state_change-inl.h"
+
+namespace art {
+
+extern "C" JNIEXPORT jint JNICALL Java_Main_getImtConflictTableEntries(JNIEnv*,
+                                                                      jclass,
+                                                                      jclass cls,
+                                                                      jobject method) {
+  ScopedObjectAccess soa(Thread::Current());
+  PointerSize pointer_size = Runtime::Current()->GetClassLinker()->GetImagePointerSize();
+  ArtMethod* interface_method = ArtMethod::FromReflectedMethod(soa, method);
+  ImTable* imt = soa.Decode<mirror::Class>(cls)->GetImt(pointer_size);
+  ArtMethod* imt_method = imt->Get(interface_method->GetImtIndex(), pointer_size);
+  if (!imt_method->IsRuntimeMethod() || imt_method->IsImtUnimplementedMethod()) {
+    return 0;
+  }
+  ImtConflictTable* table = imt_method->GetImtConflictTable(pointer_size);
+  size_t num_entries = table->NumEntries(pointer_size);
+  CHECK_EQ(table->IsHashed(pointer_size),
+           pointer_size == PointerSize::k64 && num_entries >= ImtConflictTable::kMinHashedEntries);
+  return num_entries;
+}
+
+}  // namespace art
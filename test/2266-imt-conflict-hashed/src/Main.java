@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.Method;
+
+public class Main {
+  public static void main(String[] args) throws Exception {
+    System.loadLibrary(args[0]);
+    Itf[] receivers = { new Impl1(), new Impl2() };
+    // Call through the conflict table before the calling method is JIT compiled.
+    for (int i = 0; i < receivers.length; ++i) {
+      $noinline$callAll(receivers[i], i * 1000);
+    }
+    System.out.println("Imt conflict table entries: " +
+        getImtConflictTableEntries(Impl1.class, Itf.class.getDeclaredMethod("method0")));
+
+    ensureJitCompiled(Main.class, "$noinline$callAll");
+    for (int repeat = 0; repeat < 1000; ++repeat) {
+      for (int i = 0; i < receivers.length; ++i) {
+        $noinline$callAll(receivers[i], i * 1000);
+      }
+    }
+  }
+
+  public static void $noinline$callAll(Itf itf, int offset) {
+    expectEquals(0 + offset, itf.method0());
+    expectEquals(32 + offset, itf.method32());
+    expectEquals(77 + offset, itf.method77());
+    expectEquals(109 + offset, itf.method109());
+    expectEquals(132 + offset, itf.method132());
+    expectEquals(177 + offset, itf.method177());
+    expectEquals(216 + offset, itf.method216());
+    expectEquals(284 + offset, itf.method284());
+    expectEquals(323 + offset, itf.method323());
+    expectEquals(368 + offset, itf.method368());
+  }
+
+  public static void expectEquals(int expected, int actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+
+  // Returns the number of entries of the conflict table at the IMT index of `method` in `cls`,
+  // or 0 if there is no conflict at that index.
+  public static native int getImtConflictTableEntries(Class<?> cls, Method method);
+  public static native void ensureJitCompiled(Class<?> cls, String methodName);
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unistd.h>
+
+#include <jni.h>
+
+#include "art_method-inl.h"
+#include "jit/jit.h"
+#include "jit/jit_code_cache.h"
+#include "mirror/class-inl.h"
+#include "nativehelper/ScopedUtfChars.h"
+#include "runtime.h"
+#include "scoped_thread_state_change-inl.h"
+
+namespace art {
+
+// Local class declared as a friend of JitCodeCache so that we can access its internals.
+class JitCodeCacheThrashTestHelper {
+ public:
+  static bool IsAtMaxCapacity(Thread* self) {
+    MutexLock mu(self, *Locks::jit_lock_);
+    return GetCodeCache()->IsAtMaxCapacity();
+  }
+
+  static jit::JitCodeCache* GetCodeCache() {
+    CHECK(Runtime::Current()->GetJit() != nullptr);
+    return Runtime::Current()->GetJit()->GetCodeCache();
+  }
+};
+
+static ArtMethod* FindMethod(ScopedObjectAccess& soa, jclass cls, jstring method_name)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  ScopedUtfChars chars(soa.Env(), method_name);
+  CHECK(chars.c_str() != nullptr);
+  ArtMethod* method = soa.Decode<mirror::Class>(cls)->FindDeclaredDirectMethodByName(
+      chars.c_str(), kRuntimePointerSize);
+  CHECK(method != nullptr) << "Unable to find method called " << chars.c_str();
+  return method;
+}
+
+// Unlike `ensureJitBaselineCompiled`, this keeps code collection enabled, so that compiling
+// into a full code cache collects it instead of failing.
+extern "C" JNIEXPORT
+void Java_Main_compileBaselineAllowingCollection(JNIEnv*,
+                                                 jclass,
+                                                 jclass cls,
+                                                 jstring method_name) {
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  CHECK(jit != nullptr);
+  jit::JitCodeCache* code_cache = JitCodeCacheThrashTestHelper::GetCodeCache();
+  code_cache->SetGarbageCollectCode(true);
+  Thread* self = Thread::Current();
+  ArtMethod* method;
+  {
+    ScopedObjectAccess soa(self);
+    method = FindMethod(soa, cls, method_name);
+  }
+  while (true) {
+    {
+      ScopedObjectAccess soa(self);
+      jit->CompileMethod(method, self, CompilationKind::kBaseline, /*prejit=*/ false);
+      if (code_cache->ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
+        return;
+      }
+    }
+    // Yield to the compiler thread.
+    usleep(1000);
+  }
+}
+
+extern "C" JNIEXPORT
+jlong Java_Main_getJitCodeAddress(JNIEnv*, jclass, jclass cls, jstring method_name) {
+  ScopedObjectAccess soa(Thread::Current());
+  const void* entry_point = FindMethod(soa, cls, method_name)->GetEntryPointFromQuickCompiledCode();
+  if (!JitCodeCacheThrashTestHelper::GetCodeCache()->ContainsPc(entry_point)) {
+    return 0;
+  }
+  return reinterpret_cast<jlong>(entry_point);
+}
+
+extern "C" JNIEXPORT
+jboolean Java_Main_isJitCodeCacheAtMaxCapacity(JNIEnv*, jclass) {
+  ScopedObjectAccess soa(Thread::Current());
+  return JitCodeCacheThrashTestHelper::IsAtMaxCapacity(soa.Self());
+}
+
+}  // namespace art
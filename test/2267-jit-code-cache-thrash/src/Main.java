@@ -0,0 +1,308 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  private static final int NUM_ROUNDS = 8;
+
+  private static final String[] COLD_METHODS = {
+      "$noinline$cold0",
+      "$noinline$cold1",
+      "$noinline$cold2",
+      "$noinline$cold3",
+      "$noinline$cold4",
+      "$noinline$cold5",
+      "$noinline$cold6",
+      "$noinline$cold7",
+      "$noinline$cold8",
+      "$noinline$cold9",
+      "$noinline$cold10",
+      "$noinline$cold11",
+      "$noinline$cold12",
+      "$noinline$cold13",
+      "$noinline$cold14",
+      "$noinline$cold15"
+  };
+
+  public static void main(String[] args) throws Exception {
+    System.loadLibrary(args[0]);
+    if (isAotCompiled(Main.class, "hasJit")) {
+      throw new Error("This test must be run with --no-prebuild!");
+    }
+    if (hasJit()) {
+      testHotCodeSurvivesColdChurn();
+    }
+    System.out.println("Done");
+  }
+
+  public static void testHotCodeSurvivesColdChurn() {
+    int[] data = new int[] { 1, 2, 3, 4, 5, 6, 7, 8 };
+    ensureJitCompiled(Main.class, "$noinline$hot");
+    long hotCode = getJitCodeAddress(Main.class, "$noinline$hot");
+    assertTrue(hotCode != 0);
+    long evictions = getNumberOfJitCodeEvictions();
+
+    // The cold methods do not all fit in the code cache, so compiling them keeps the cache at
+    // capacity and runs collections that evict the cold methods compiled in earlier rounds.
+    // The hot method runs between every compilation, and its optimized code must neither be
+    // evicted nor be compiled again.
+    for (int round = 0; round < NUM_ROUNDS; ++round) {
+      for (String cold : COLD_METHODS) {
+        compileBaselineAllowingCollection(Main.class, cold);
+        $noinline$hot(data);
+        assertEquals(hotCode, getJitCodeAddress(Main.class, "$noinline$hot"));
+      }
+    }
+    assertTrue(isJitCodeCacheAtMaxCapacity());
+    assertTrue(getNumberOfJitCodeEvictions() > evictions);
+  }
+
+  public static int $noinline$hot(int[] a) {
+    int sum = 0;
+    for (int value : a) {
+      sum += value;
+    }
+    return sum;
+  }
+
+  public static int $noinline$cold0(int[] a) {
+    int sum = 0;
+    for (int j = 0; j < a.length; ++j) {
+      switch (a[j] & 3) {
+        case 0: sum += a[j] * 3; break;
+        case 1: sum ^= a[j] << 1; break;
+        case 2: sum -= a[j] / 2; break;
+        default: sum |= a[j] >>> 1; break;
+      }
+    }
+    return sum;
+  }
+
+  public static int $noinline$cold1(int[] a) {
+    int sum = 1;
+    for (int j = 0; j < a.length; ++j) {
+      switch (a[j] & 3) {
+        case 0: sum += a[j] * 4; break;
+        case 1: sum ^= a[j] << 2; break;
+        case 2: sum -= a[j] / 3; break;
+        default: sum |= a[j] >>> 2; break;
+      }
+    }
+    return sum;
+  }
+
+  public static int $noinline$cold2(int[] a) {
+    int sum = 2;
+    for (int j = 0; j < a.length; ++j) {
+      switch (a[j] & 3) {
+        case 0: sum += a[j] * 5; break;
+        case 1: sum ^= a[j] << 3; break;
+        case 2: sum -= a[j] / 4; break;
+        default: sum |= a[j] >>> 3; break;
+      }
+    }
+    return sum;
+  }
+
+  public static int $noinline$cold3(int[] a) {
+    int sum = 3;
+    for (int j = 0; j < a.length; ++j) {
+      switch (a[j] & 3) {
+        case 0: sum += a[j] * 6; break;
+        case 1: sum ^= a[j] << 4; break;
+        case 2: sum -= a[j] / 5; break;
+        default: sum |= a[j] >>> 4; break;
+      }
+    }
+    return sum;
+  }
+
+  public static int $noinline$cold4(int[] a) {
+    int sum = 4;
+    for (int j = 0; j < a.length; ++j) {
+      switch (a[j] & 3) {
+        case 0: sum += a[j] * 7; break;
+        case 1: sum ^= a[j] << 5; break;
+        case 2: sum -= a[j] / 6; break;
+        default: sum |= a[j] >>> 5; break;
+      }
+    }
+    return sum;
+  }
+
+  public static int $noinline$cold5(int[] a) {
+    int sum = 5;
+    for (int j = 0; j < a.length; ++j) {
+      switch (a[j] & 3) {
+        case 0: sum += a[j] * 8; break;
+        case 1: sum ^= a[j] << 6; break;
+        case 2: sum -= a[j] / 7; break;
+        default: sum |= a[j] >>> 1; break;
+      }
+    }
+    return sum;
+  }
+
+  public static int $noinline$cold6(int[] a) {
+    int sum = 6;
+    for (int j = 0; j < a.length; ++j) {
+      switch (a[j] & 3) {
+        case 0: sum += a[j] * 9; break;
+        case 1: sum ^= a[j] << 7; break;
+        case 2: sum -= a[j] / 8; break;
+        default: sum |= a[j] >>> 2; break;
+      }
+    }
+    return sum;
+  }
+
+  public static int $noinline$cold7(int[] a) {
+    int sum = 7;
+    for (int j = 0; j < a.length; ++j) {
+      switch (a[j] & 3) {
+        case 0: sum += a[j] * 10; break;
+        case 1: sum ^= a[j] << 1; break;
+        case 2: sum -= a[j] / 9; break;
+        default: sum |= a[j] >>> 3; break;
+      }
+    }
+    return sum;
+  }
+
+  public static int $noinline$cold8(int[] a) {
+    int sum = 8;
+    for (int j = 0; j < a.length; ++j) {
+      switch (a[j] & 3) {
+        case 0: sum += a[j] * 11; break;
+        case 1: sum ^= a[j] << 2; break;
+        case 2: sum -= a[j] / 10; break;
+        default: sum |= a[j] >>> 4; break;
+      }
+    }
+    return sum;
+  }
+
+  public static int $noinline$cold9(int[] a) {
+    int sum = 9;
+    for (int j = 0; j < a.length; ++j) {
+      switch (a[j] & 3) {
+        case 0: sum += a[j] * 12; break;
+        case 1: sum ^= a[j] << 3; break;
+        case 2: sum -= a[j] / 11; break;
+        default: sum |= a[j] >>> 5; break;
+      }
+    }
+    return sum;
+  }
+
+  public static int $noinline$cold10(int[] a) {
+    int sum = 10;
+    for (int j = 0; j < a.length; ++j) {
+      switch (a[j] & 3) {
+        case 0: sum += a[j] * 13; break;
+        case 1: sum ^= a[j] << 4; break;
+        case 2: sum -= a[j] / 12; break;
+        default: sum |= a[j] >>> 1; break;
+      }
+    }
+    return sum;
+  }
+
+  public static int $noinline$cold11(int[] a) {
+    int sum = 11;
+    for (int j = 0; j < a.length; ++j) {
+      switch (a[j] & 3) {
+        case 0: sum += a[j] * 14; break;
+        case 1: sum ^= a[j] << 5; break;
+        case 2: sum -= a[j] / 13; break;
+        default: sum |= a[j] >>> 2; break;
+      }
+    }
+    return sum;
+  }
+
+  public static int $noinline$cold12(int[] a) {
+    int sum = 12;
+    for (int j = 0; j < a.length; ++j) {
+      switch (a[j] & 3) {
+        case 0: sum += a[j] * 15; break;
+        case 1: sum ^= a[j] << 6; break;
+        case 2: sum -= a[j] / 14; break;
+        default: sum |= a[j] >>> 3; break;
+      }
+    }
+    return sum;
+  }
+
+  public static int $noinline$cold13(int[] a) {
+    int sum = 13;
+    for (int j = 0; j < a.length; ++j) {
+      switch (a[j] & 3) {
+        case 0: sum += a[j] * 16; break;
+        case 1: sum ^= a[j] << 7; break;
+        case 2: sum -= a[j] / 15; break;
+        default: sum |= a[j] >>> 4; break;
+      }
+    }
+    return sum;
+  }
+
+  public static int $noinline$cold14(int[] a) {
+    int sum = 14;
+    for (int j = 0; j < a.length; ++j) {
+      switch (a[j] & 3) {
+        case 0: sum += a[j] * 17; break;
+        case 1: sum ^= a[j] << 1; break;
+        case 2: sum -= a[j] / 16; break;
+        default: sum |= a[j] >>> 5; break;
+      }
+    }
+    return sum;
+  }
+
+  public static int $noinline$cold15(int[] a) {
+    int sum = 15;
+    for (int j = 0; j < a.length; ++j) {
+      switch (a[j] & 3) {
+        case 0: sum += a[j] * 18; break;
+        case 1: sum ^= a[j] << 2; break;
+        case 2: sum -= a[j] / 17; break;
+        default: sum |= a[j] >>> 1; break;
+      }
+    }
+    return sum;
+  }
+
+  public static void assertTrue(boolean value) {
+    if (!value) {
+      throw new AssertionError("Expected true!");
+    }
+  }
+
+  public static void assertEquals(long expected, long actual) {
+    if (expected != actual) {
+      throw new AssertionError("Expected " + expected + " got " + actual);
+    }
+  }
+
+  public native static void compileBaselineAllowingCollection(Class<?> cls, String methodName);
+  public native static long getJitCodeAddress(Class<?> cls, String methodName);
+  public native static boolean isJitCodeCacheAtMaxCapacity();
+  public native static long getNumberOfJitCodeEvictions();
+
+  public native static boolean isAotCompiled(Class<?> cls, String methodName);
+  public native static void ensureJitCompiled(Class<?> cls, String methodName);
+  private native static boolean hasJit();
+}
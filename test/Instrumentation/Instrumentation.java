@@ -32,4 +32,13 @@ public class Instrumentation {
     System.out.println("returnPrimitive");
     return 0;
   }
+
+  // Static methods invoked by the test, which don't need the class to be usable.
+  private static int callee() {
+    return 1;
+  }
+
+  private static int caller() {
+    return callee() + 1;
+  }
 }
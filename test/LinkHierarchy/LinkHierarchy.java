@@ -0,0 +1,498 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// A deep class hierarchy with many overloaded and overriding virtual methods,
+// for testing vtable construction in the class linker.
+class LinkHierarchy {
+  interface Overloads {
+    void o(int i);
+    void o(long l);
+    void o(String s);
+    void o(Object o);
+  }
+
+  static class C0 implements Overloads {
+    public void o(int i) {}
+    public void o(long l) {}
+    public void o(String s) {}
+    public void o(Object o) {}
+    void m0_0() {}
+    void m0_1() {}
+    void m0_2() {}
+    void m0_3() {}
+    void m0_4() {}
+    void m0_5() {}
+    void m0_6() {}
+    void m0_7() {}
+    void p0(int i) {}
+    void p0(long l) {}
+    void p0(String s) {}
+    void p0(Object o) {}
+    public String toString() { return "C0"; }
+  }
+
+  static class C1 extends C0 {
+    public void o(int i) {}
+    public void o(long l) {}
+    public void o(String s) {}
+    public void o(Object o) {}
+    void m0_0() {}
+    void m0_1() {}
+    void m0_2() {}
+    void m0_3() {}
+    void m0_4() {}
+    void m0_5() {}
+    void m0_6() {}
+    void m0_7() {}
+    void p0(int i) {}
+    void p0(long l) {}
+    void p0(String s) {}
+    void p0(Object o) {}
+    void m1_0() {}
+    void m1_1() {}
+    void m1_2() {}
+    void m1_3() {}
+    void m1_4() {}
+    void m1_5() {}
+    void m1_6() {}
+    void m1_7() {}
+    void p1(int i) {}
+    void p1(long l) {}
+    void p1(String s) {}
+    void p1(Object o) {}
+    public String toString() { return "C1"; }
+  }
+
+  static class C2 extends C1 {
+    void m1_0() {}
+    void m1_1() {}
+    void m1_2() {}
+    void m1_3() {}
+    void m1_4() {}
+    void m1_5() {}
+    void m1_6() {}
+    void m1_7() {}
+    void p1(int i) {}
+    void p1(long l) {}
+    void p1(String s) {}
+    void p1(Object o) {}
+    void m2_0() {}
+    void m2_1() {}
+    void m2_2() {}
+    void m2_3() {}
+    void m2_4() {}
+    void m2_5() {}
+    void m2_6() {}
+    void m2_7() {}
+    void p2(int i) {}
+    void p2(long l) {}
+    void p2(String s) {}
+    void p2(Object o) {}
+    public String toString() { return "C2"; }
+  }
+
+  static class C3 extends C2 {
+    public void o(int i) {}
+    public void o(long l) {}
+    public void o(String s) {}
+    public void o(Object o) {}
+    void m2_0() {}
+    void m2_1() {}
+    void m2_2() {}
+    void m2_3() {}
+    void m2_4() {}
+    void m2_5() {}
+    void m2_6() {}
+    void m2_7() {}
+    void p2(int i) {}
+    void p2(long l) {}
+    void p2(String s) {}
+    void p2(Object o) {}
+    void m3_0() {}
+    void m3_1() {}
+    void m3_2() {}
+    void m3_3() {}
+    void m3_4() {}
+    void m3_5() {}
+    void m3_6() {}
+    void m3_7() {}
+    void p3(int i) {}
+    void p3(long l) {}
+    void p3(String s) {}
+    void p3(Object o) {}
+    public String toString() { return "C3"; }
+  }
+
+  static class C4 extends C3 {
+    void m3_0() {}
+    void m3_1() {}
+    void m3_2() {}
+    void m3_3() {}
+    void m3_4() {}
+    void m3_5() {}
+    void m3_6() {}
+    void m3_7() {}
+    void p3(int i) {}
+    void p3(long l) {}
+    void p3(String s) {}
+    void p3(Object o) {}
+    void m4_0() {}
+    void m4_1() {}
+    void m4_2() {}
+    void m4_3() {}
+    void m4_4() {}
+    void m4_5() {}
+    void m4_6() {}
+    void m4_7() {}
+    void p4(int i) {}
+    void p4(long l) {}
+    void p4(String s) {}
+    void p4(Object o) {}
+    public String toString() { return "C4"; }
+  }
+
+  static class C5 extends C4 {
+    public void o(int i) {}
+    public void o(long l) {}
+    public void o(String s) {}
+    public void o(Object o) {}
+    void m4_0() {}
+    void m4_1() {}
+    void m4_2() {}
+    void m4_3() {}
+    void m4_4() {}
+    void m4_5() {}
+    void m4_6() {}
+    void m4_7() {}
+    void p4(int i) {}
+    void p4(long l) {}
+    void p4(String s) {}
+    void p4(Object o) {}
+    void m5_0() {}
+    void m5_1() {}
+    void m5_2() {}
+    void m5_3() {}
+    void m5_4() {}
+    void m5_5() {}
+    void m5_6() {}
+    void m5_7() {}
+    void p5(int i) {}
+    void p5(long l) {}
+    void p5(String s) {}
+    void p5(Object o) {}
+    public String toString() { return "C5"; }
+  }
+
+  static class C6 extends C5 {
+    void m5_0() {}
+    void m5_1() {}
+    void m5_2() {}
+    void m5_3() {}
+    void m5_4() {}
+    void m5_5() {}
+    void m5_6() {}
+    void m5_7() {}
+    void p5(int i) {}
+    void p5(long l) {}
+    void p5(String s) {}
+    void p5(Object o) {}
+    void m6_0() {}
+    void m6_1() {}
+    void m6_2() {}
+    void m6_3() {}
+    void m6_4() {}
+    void m6_5() {}
+    void m6_6() {}
+    void m6_7() {}
+    void p6(int i) {}
+    void p6(long l) {}
+    void p6(String s) {}
+    void p6(Object o) {}
+    public String toString() { return "C6"; }
+  }
+
+  static class C7 extends C6 {
+    public void o(int i) {}
+    public void o(long l) {}
+    public void o(String s) {}
+    public void o(Object o) {}
+    void m6_0() {}
+    void m6_1() {}
+    void m6_2() {}
+    void m6_3() {}
+    void m6_4() {}
+    void m6_5() {}
+    void m6_6() {}
+    void m6_7() {}
+    void p6(int i) {}
+    void p6(long l) {}
+    void p6(String s) {}
+    void p6(Object o) {}
+    void m7_0() {}
+    void m7_1() {}
+    void m7_2() {}
+    void m7_3() {}
+    void m7_4() {}
+    void m7_5() {}
+    void m7_6() {}
+    void m7_7() {}
+    void p7(int i) {}
+    void p7(long l) {}
+    void p7(String s) {}
+    void p7(Object o) {}
+    public String toString() { return "C7"; }
+  }
+
+  static class C8 extends C7 {
+    void m7_0() {}
+    void m7_1() {}
+    void m7_2() {}
+    void m7_3() {}
+    void m7_4() {}
+    void m7_5() {}
+    void m7_6() {}
+    void m7_7() {}
+    void p7(int i) {}
+    void p7(long l) {}
+    void p7(String s) {}
+    void p7(Object o) {}
+    void m8_0() {}
+    void m8_1() {}
+    void m8_2() {}
+    void m8_3() {}
+    void m8_4() {}
+    void m8_5() {}
+    void m8_6() {}
+    void m8_7() {}
+    void p8(int i) {}
+    void p8(long l) {}
+    void p8(String s) {}
+    void p8(Object o) {}
+    public String toString() { return "C8"; }
+  }
+
+  static class C9 extends C8 {
+    public void o(int i) {}
+    public void o(long l) {}
+    public void o(String s) {}
+    public void o(Object o) {}
+    void m8_0() {}
+    void m8_1() {}
+    void m8_2() {}
+    void m8_3() {}
+    void m8_4() {}
+    void m8_5() {}
+    void m8_6() {}
+    void m8_7() {}
+    void p8(int i) {}
+    void p8(long l) {}
+    void p8(String s) {}
+    void p8(Object o) {}
+    void m9_0() {}
+    void m9_1() {}
+    void m9_2() {}
+    void m9_3() {}
+    void m9_4() {}
+    void m9_5() {}
+    void m9_6() {}
+    void m9_7() {}
+    void p9(int i) {}
+    void p9(long l) {}
+    void p9(String s) {}
+    void p9(Object o) {}
+    public String toString() { return "C9"; }
+  }
+
+  static class C10 extends C9 {
+    void m9_0() {}
+    void m9_1() {}
+    void m9_2() {}
+    void m9_3() {}
+    void m9_4() {}
+    void m9_5() {}
+    void m9_6() {}
+    void m9_7() {}
+    void p9(int i) {}
+    void p9(long l) {}
+    void p9(String s) {}
+    void p9(Object o) {}
+    void m10_0() {}
+    void m10_1() {}
+    void m10_2() {}
+    void m10_3() {}
+    void m10_4() {}
+    void m10_5() {}
+    void m10_6() {}
+    void m10_7() {}
+    void p10(int i) {}
+    void p10(long l) {}
+    void p10(String s) {}
+    void p10(Object o) {}
+    public String toString() { return "C10"; }
+  }
+
+  static class C11 extends C10 {
+    public void o(int i) {}
+    public void o(long l) {}
+    public void o(String s) {}
+    public void o(Object o) {}
+    void m10_0() {}
+    void m10_1() {}
+    void m10_2() {}
+    void m10_3() {}
+    void m10_4() {}
+    void m10_5() {}
+    void m10_6() {}
+    void m10_7() {}
+    void p10(int i) {}
+    void p10(long l) {}
+    void p10(String s) {}
+    void p10(Object o) {}
+    void m11_0() {}
+    void m11_1() {}
+    void m11_2() {}
+    void m11_3() {}
+    void m11_4() {}
+    void m11_5() {}
+    void m11_6() {}
+    void m11_7() {}
+    void p11(int i) {}
+    void p11(long l) {}
+    void p11(String s) {}
+    void p11(Object o) {}
+    public String toString() { return "C11"; }
+  }
+
+  static class C12 extends C11 {
+    void m11_0() {}
+    void m11_1() {}
+    void m11_2() {}
+    void m11_3() {}
+    void m11_4() {}
+    void m11_5() {}
+    void m11_6() {}
+    void m11_7() {}
+    void p11(int i) {}
+    void p11(long l) {}
+    void p11(String s) {}
+    void p11(Object o) {}
+    void m12_0() {}
+    void m12_1() {}
+    void m12_2() {}
+    void m12_3() {}
+    void m12_4() {}
+    void m12_5() {}
+    void m12_6() {}
+    void m12_7() {}
+    void p12(int i) {}
+    void p12(long l) {}
+    void p12(String s) {}
+    void p12(Object o) {}
+    public String toString() { return "C12"; }
+  }
+
+  static class C13 extends C12 {
+    public void o(int i) {}
+    public void o(long l) {}
+    public void o(String s) {}
+    public void o(Object o) {}
+    void m12_0() {}
+    void m12_1() {}
+    void m12_2() {}
+    void m12_3() {}
+    void m12_4() {}
+    void m12_5() {}
+    void m12_6() {}
+    void m12_7() {}
+    void p12(int i) {}
+    void p12(long l) {}
+    void p12(String s) {}
+    void p12(Object o) {}
+    void m13_0() {}
+    void m13_1() {}
+    void m13_2() {}
+    void m13_3() {}
+    void m13_4() {}
+    void m13_5() {}
+    void m13_6() {}
+    void m13_7() {}
+    void p13(int i) {}
+    void p13(long l) {}
+    void p13(String s) {}
+    void p13(Object o) {}
+    public String toString() { return "C13"; }
+  }
+
+  static class C14 extends C13 {
+    void m13_0() {}
+    void m13_1() {}
+    void m13_2() {}
+    void m13_3() {}
+    void m13_4() {}
+    void m13_5() {}
+    void m13_6() {}
+    void m13_7() {}
+    void p13(int i) {}
+    void p13(long l) {}
+    void p13(String s) {}
+    void p13(Object o) {}
+    void m14_0() {}
+    void m14_1() {}
+    void m14_2() {}
+    void m14_3() {}
+    void m14_4() {}
+    void m14_5() {}
+    void m14_6() {}
+    void m14_7() {}
+    void p14(int i) {}
+    void p14(long l) {}
+    void p14(String s) {}
+    void p14(Object o) {}
+    public String toString() { return "C14"; }
+  }
+
+  static class C15 extends C14 {
+    public void o(int i) {}
+    public void o(long l) {}
+    public void o(String s) {}
+    public void o(Object o) {}
+    void m14_0() {}
+    void m14_1() {}
+    void m14_2() {}
+    void m14_3() {}
+    void m14_4() {}
+    void m14_5() {}
+    void m14_6() {}
+    void m14_7() {}
+    void p14(int i) {}
+    void p14(long l) {}
+    void p14(String s) {}
+    void p14(Object o) {}
+    void m15_0() {}
+    void m15_1() {}
+    void m15_2() {}
+    void m15_3() {}
+    void m15_4() {}
+    void m15_5() {}
+    void m15_6() {}
+    void m15_7() {}
+    void p15(int i) {}
+    void p15(long l) {}
+    void p15(String s) {}
+    void p15(Object o) {}
+    public String toString() { return "C15"; }
+  }
+}
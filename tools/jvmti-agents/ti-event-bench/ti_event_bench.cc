@@ -0,0 +1,212 @@
+// Copyright (C) 2026 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <android-base/logging.h>
+
+#include <atomic>
+#include <chrono>
+#include <jni.h>
+#include <jvmti.h>
+#include <string>
+
+namespace tieventbench {
+
+namespace {
+
+#define CHECK_JVMTI(x) CHECK_EQ((x), JVMTI_ERROR_NONE)
+
+// Special art ti-version number. We will use this as a fallback if we cannot get a regular JVMTI
+// env.
+static constexpr jint kArtTiVersion = JVMTI_VERSION_1_2 | 0x40000000;
+
+// The benchmarked event and, if not empty, the name of the only thread it is enabled on.
+static jvmtiEvent bench_event;
+static std::string bench_thread_name;
+
+static std::atomic<uint64_t> event_count(0u);
+static std::chrono::steady_clock::time_point start_time;
+
+static bool ParseEvent(const std::string& name, /*out*/ jvmtiEvent* event) {
+  if (name == "VMObjectAlloc") {
+    *event = JVMTI_EVENT_VM_OBJECT_ALLOC;
+  } else if (name == "MethodEntry") {
+    *event = JVMTI_EVENT_METHOD_ENTRY;
+  } else if (name == "MethodExit") {
+    *event = JVMTI_EVENT_METHOD_EXIT;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+static void CountEvent() {
+  event_count.fetch_add(1u, std::memory_order_relaxed);
+}
+
+static void JNICALL VMObjectAllocCb(jvmtiEnv* jvmti ATTRIBUTE_UNUSED,
+                                    JNIEnv* env ATTRIBUTE_UNUSED,
+                                    jthread thread ATTRIBUTE_UNUSED,
+                                    jobject obj ATTRIBUTE_UNUSED,
+                                    jclass klass ATTRIBUTE_UNUSED,
+                                    jlong size ATTRIBUTE_UNUSED) {
+  CountEvent();
+}
+
+static void JNICALL MethodEntryCb(jvmtiEnv* jvmti ATTRIBUTE_UNUSED,
+                                  JNIEnv* env ATTRIBUTE_UNUSED,
+                                  jthread thread ATTRIBUTE_UNUSED,
+                                  jmethodID method ATTRIBUTE_UNUSED) {
+  CountEvent();
+}
+
+static void JNICALL MethodExitCb(jvmtiEnv* jvmti ATTRIBUTE_UNUSED,
+                                 JNIEnv* env ATTRIBUTE_UNUSED,
+                                 jthread thread ATTRIBUTE_UNUSED,
+                                 jmethodID method ATTRIBUTE_UNUSED,
+                                 jboolean was_popped_by_exception ATTRIBUTE_UNUSED,
+                                 jvalue return_value ATTRIBUTE_UNUSED) {
+  CountEvent();
+}
+
+// Enable the benchmarked event on `thread` if it is the requested thread.
+static void MaybeEnableOnThread(jvmtiEnv* jvmti, JNIEnv* env, jthread thread) {
+  jvmtiThreadInfo info;
+  if (jvmti->GetThreadInfo(thread, &info) != JVMTI_ERROR_NONE) {
+    return;
+  }
+  if (bench_thread_name == info.name) {
+    LOG(INFO) << "Enabling event " << bench_event << " on thread " << info.name;
+    CHECK_JVMTI(jvmti->SetEventNotificationMode(JVMTI_ENABLE, bench_event, thread));
+  }
+  CHECK_JVMTI(jvmti->Deallocate(reinterpret_cast<unsigned char*>(info.name)));
+  env->DeleteLocalRef(info.thread_group);
+  env->DeleteLocalRef(info.context_class_loader);
+}
+
+static void JNICALL ThreadStartCb(jvmtiEnv* jvmti, JNIEnv* env, jthread thread) {
+  MaybeEnableOnThread(jvmti, env, thread);
+}
+
+static void StartBenchmark(jvmtiEnv* jvmti, JNIEnv* env) {
+  start_time = std::chrono::steady_clock::now();
+  if (bench_thread_name.empty()) {
+    CHECK_JVMTI(jvmti->SetEventNotificationMode(JVMTI_ENABLE, bench_event, nullptr));
+    return;
+  }
+  CHECK_JVMTI(jvmti->SetEventNotificationMode(JVMTI_ENABLE, JVMTI_EVENT_THREAD_START, nullptr));
+  jint thread_count = 0;
+  jthread* threads = nullptr;
+  CHECK_JVMTI(jvmti->GetAllThreads(&thread_count, &threads));
+  for (jint i = 0; i != thread_count; ++i) {
+    MaybeEnableOnThread(jvmti, env, threads[i]);
+    env->DeleteLocalRef(threads[i]);
+  }
+  CHECK_JVMTI(jvmti->Deallocate(reinterpret_cast<unsigned char*>(threads)));
+}
+
+static void JNICALL DataDumpRequestCb(jvmtiEnv* jvmti ATTRIBUTE_UNUSED) {
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+  uint64_t count = event_count.load(std::memory_order_relaxed);
+  LOG(INFO) << "Event " << bench_event << " dispatched " << count << " times in "
+            << elapsed.count() << "s ("
+            << (elapsed.count() > 0.0 ? count / elapsed.count() : 0.0) << " events/s)";
+}
+
+static void JNICALL VMDeathCb(jvmtiEnv* jvmti, JNIEnv* env ATTRIBUTE_UNUSED) {
+  DataDumpRequestCb(jvmti);
+}
+
+static void JNICALL VMInitCb(jvmtiEnv* jvmti, JNIEnv* env, jthread thread ATTRIBUTE_UNUSED) {
+  StartBenchmark(jvmti, env);
+}
+
+static jint SetupJvmtiEnv(JavaVM* vm, jvmtiEnv** jvmti) {
+  jint res = vm->GetEnv(reinterpret_cast<void**>(jvmti), JVMTI_VERSION_1_1);
+  if (res != JNI_OK || *jvmti == nullptr) {
+    LOG(ERROR) << "Unable to access JVMTI, error code " << res;
+    return vm->GetEnv(reinterpret_cast<void**>(jvmti), kArtTiVersion);
+  }
+  return res;
+}
+
+// Options are "event[,thread_name]".
+static bool ProcessOptions(const std::string& options) {
+  size_t comma_pos = options.find(',');
+  if (!ParseEvent(options.substr(0, comma_pos), &bench_event)) {
+    LOG(ERROR) << "Unknown event in options '" << options << "'";
+    return false;
+  }
+  if (comma_pos != std::string::npos) {
+    bench_thread_name = options.substr(comma_pos + 1);
+  }
+  return true;
+}
+
+static jint AgentStart(JavaVM* vm, char* options, bool is_onload) {
+  android::base::InitLogging(/* argv= */ nullptr);
+  if (!ProcessOptions(options != nullptr ? options : "")) {
+    return JNI_ERR;
+  }
+  jvmtiEnv* jvmti = nullptr;
+  if (SetupJvmtiEnv(vm, &jvmti) != JNI_OK) {
+    LOG(ERROR) << "Could not get JVMTI env or ArtTiEnv!";
+    return JNI_ERR;
+  }
+  jvmtiCapabilities caps{
+    .can_generate_method_entry_events = 1,
+    .can_generate_method_exit_events = 1,
+    .can_generate_vm_object_alloc_events = 1,
+  };
+  CHECK_JVMTI(jvmti->AddCapabilities(&caps));
+  jvmtiEventCallbacks cb{
+    .VMInit = VMInitCb,
+    .VMDeath = VMDeathCb,
+    .ThreadStart = ThreadStartCb,
+    .MethodEntry = MethodEntryCb,
+    .MethodExit = MethodExitCb,
+    .DataDumpRequest = DataDumpRequestCb,
+    .VMObjectAlloc = VMObjectAllocCb,
+  };
+  CHECK_JVMTI(jvmti->SetEventCallbacks(&cb, sizeof(cb)));
+  CHECK_JVMTI(jvmti->SetEventNotificationMode(JVMTI_ENABLE, JVMTI_EVENT_VM_DEATH, nullptr));
+  CHECK_JVMTI(
+      jvmti->SetEventNotificationMode(JVMTI_ENABLE, JVMTI_EVENT_DATA_DUMP_REQUEST, nullptr));
+  if (is_onload) {
+    CHECK_JVMTI(jvmti->SetEventNotificationMode(JVMTI_ENABLE, JVMTI_EVENT_VM_INIT, nullptr));
+  } else {
+    JNIEnv* env = nullptr;
+    CHECK_EQ(vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6), JNI_OK);
+    StartBenchmark(jvmti, env);
+  }
+  return JNI_OK;
+}
+
+}  // namespace
+
+// Late attachment (e.g. 'am attach-agent').
+extern "C" JNIEXPORT jint JNICALL Agent_OnAttach(JavaVM* vm,
+                                                 char* options,
+                                                 void* reserved ATTRIBUTE_UNUSED) {
+  return AgentStart(vm, options, /*is_onload=*/false);
+}
+
+// Early attachment
+extern "C" JNIEXPORT jint JNICALL Agent_OnLoad(JavaVM* jvm,
+                                               char* options,
+                                               void* reserved ATTRIBUTE_UNUSED) {
+  return AgentStart(jvm, options, /*is_onload=*/true);
+}
+
+}  // namespace tieventbench